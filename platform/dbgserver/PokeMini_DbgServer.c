@@ -0,0 +1,902 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Headless debugger, serves the GDB remote protocol
+//
+// Registers (g/G/p/P), in this order, little-endian:
+//   0 BA, 1 HL, 2 X, 3 Y, 4 SP, 5 PC (16-bits)
+//   6 V, 7 I, 8 XI, 9 YI, 10 N, 11 F, 12 E, 13 U (8-bits)
+// Addresses are physical, 21-bits. Z0/Z1 are breakpoints, Z2/Z3/Z4 are
+// write/read/access watchpoints of any length. bs/bc run backwards when
+// history is recorded ("monitor record on").
+// Extensions:
+//   qPokeMini.ReadMulti:addr,len;addr,len...  Read several blocks at once
+//   qXfer:pokemini-trace:read::off,len        Last executed addresses, u32 each, newest first
+//   qXfer:pokemini-tracefile:read::off,len    Run trace recorded with "monitor tracefile"
+//   qRcmd ("monitor help")                    Emulator commands
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+
+#include "PokeMini.h"
+#include "Hardware_Debug.h"
+#include "PokeMini_Debug.h"
+#include "Profiler.h"
+#include "GDBRemote.h"
+#include "MemSearch.h"
+
+const char *AppName = "PokeMini " PokeMini_Version " Debug Server";
+
+#define PMSNDBUFFER	2048
+
+// Used by Hardware_Debug
+int dclc_fullrange = 1;
+int dclc_debugout = 1;
+
+// Server options
+int dsrv_port = 1234;
+char dsrv_unix[PMTMPV] = "";
+int dsrv_once = 0;
+int dsrv_verbose = 0;
+
+const TCommandLineCustom CustomArgs[] = {
+	{ "-port", &dsrv_port, COMMANDLINE_INT, 1, 65535 },
+	{ "-unix", (int *)dsrv_unix, COMMANDLINE_STR, PMTMPV-1 },
+	{ "-once", &dsrv_once, COMMANDLINE_INTSET, 1 },
+	{ "-verbose", &dsrv_verbose, COMMANDLINE_INTSET, 1 },
+	{ "", NULL, COMMANDLINE_EOL }
+};
+
+// Session state
+static int DbgSrv_Running = 0;		// Cleared when emulation stops
+static int DbgSrv_Signal = 5;		// Last stop signal
+static int DbgSrv_HistoryEnd = 0;	// Reverse execution reached the oldest step
+static int DbgSrv_SwBreak = 0;		// Client understands swbreak stop reason
+static char DbgSrv_Status[256];		// Last status message
+static char DbgSrv_TraceFile[PMTMPV];	// Last run trace file
+
+static char DbgSrv_Packet[GDBREMOTE_PACKETSIZE + 1];
+static char DbgSrv_Reply[GDBREMOTE_PACKETSIZE + 1];
+
+// Console output, sent before the next stop reply
+static char DbgSrv_Console[4096];
+static int DbgSrv_ConsoleLen = 0;
+
+static const char DbgSrv_Hex[] = "0123456789abcdef";
+
+// Registers
+typedef struct {
+	int size;
+	void *ptr;
+} TDbgSrv_Reg;
+
+static const TDbgSrv_Reg DbgSrv_Regs[] = {
+	{ 2, &MinxCPU.BA.W.L }, { 2, &MinxCPU.HL.W.L },
+	{ 2, &MinxCPU.X.W.L }, { 2, &MinxCPU.Y.W.L },
+	{ 2, &MinxCPU.SP.W.L }, { 2, &MinxCPU.PC.W.L },
+	{ 1, &MinxCPU.PC.B.I }, { 1, &MinxCPU.HL.B.I },
+	{ 1, &MinxCPU.X.B.I }, { 1, &MinxCPU.Y.B.I },
+	{ 1, &MinxCPU.N.B.H }, { 1, &MinxCPU.F },
+	{ 1, &MinxCPU.E }, { 1, &MinxCPU.U1 }
+};
+#define DBGSRV_NUMREGS	(int)(sizeof(DbgSrv_Regs) / sizeof(TDbgSrv_Reg))
+
+static const char *DbgSrv_KeyNames[] = {
+	"", "a", "b", "c", "up", "down", "left", "right", "power", "shock"
+};
+
+// -----------------------------
+// Messaging from Hardware_Debug
+// -----------------------------
+
+static void DbgSrv_ConsoleAdd(const char *txt, int len)
+{
+	if (len > (int)sizeof(DbgSrv_Console) - DbgSrv_ConsoleLen) len = sizeof(DbgSrv_Console) - DbgSrv_ConsoleLen;
+	memcpy(DbgSrv_Console + DbgSrv_ConsoleLen, txt, len);
+	DbgSrv_ConsoleLen += len;
+}
+
+void Set_StatusLabel(const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	vsnprintf(DbgSrv_Status, sizeof(DbgSrv_Status), format, args);
+	va_end(args);
+	if (dsrv_verbose) fprintf(stderr, "%s\n", DbgSrv_Status);
+}
+
+void Add_InfoMessage(const char *format, ...)
+{
+	char txt[512];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(txt, sizeof(txt), format, args);
+	va_end(args);
+	DbgSrv_ConsoleAdd(txt, strlen(txt));
+	if (dsrv_verbose) fputs(txt, stderr);
+}
+
+void Cmd_DebugOutput(int ctrl)
+{
+}
+
+void Add_DebugOutputChar(unsigned char ch)
+{
+	char txt = (char)ch;
+	if ((ch < 0x20) && (ch != 0x0A)) return;	// Disallow controls except new lines
+	DbgSrv_ConsoleAdd(&txt, 1);
+}
+
+void Add_DebugOutputBinary(unsigned char bin)
+{
+}
+
+void Add_DebugOutputNumber8(unsigned char num, int reg)
+{
+	char txt[16];
+	if (reg == 1) sprintf(txt, "%02X", num);
+	else if (reg == 2) sprintf(txt, "%i", num);
+	else sprintf(txt, "%i", (int)(int8_t)num);
+	DbgSrv_ConsoleAdd(txt, strlen(txt));
+}
+
+void Add_DebugOutputNumber16(unsigned char num, int reg)
+{
+	static unsigned char numlow = 0x00;
+	char txt[16];
+	if (reg & 1) {
+		if (reg & 2) sprintf(txt, "%i", (int)(int16_t)(numlow + num * 256));
+		else sprintf(txt, "%i", numlow + num * 256);
+		DbgSrv_ConsoleAdd(txt, strlen(txt));
+	} else numlow = num;
+}
+
+void Add_DebugOutputFixed8_8(unsigned char num, int reg)
+{
+	static unsigned char numlow = 0x00;
+	char txt[64];
+	if (reg & 1) {
+		sprintf(txt, "%.2f", (float)numlow / 256.0f + (float)(int8_t)num);
+		DbgSrv_ConsoleAdd(txt, strlen(txt));
+	} else numlow = num;
+}
+
+void set_emumode(int mode, int tempsave)
+{
+	if (mode == EMUMODE_STOP) DbgSrv_Running = 0;
+}
+
+static void DbgSrv_OnLoadStateFile(const char *filename, int success)
+{
+	if (success == 1) RevExec_Restart();
+}
+
+// -------
+// Helpers
+// -------
+
+static inline int DbgSrv_HexVal(int ch)
+{
+	if ((ch >= '0') && (ch <= '9')) return ch - '0';
+	if ((ch >= 'a') && (ch <= 'f')) return ch - 'a' + 10;
+	if ((ch >= 'A') && (ch <= 'F')) return ch - 'A' + 10;
+	return -1;
+}
+
+// Parse hex number, return pointer after it
+static const char *DbgSrv_ParseHex(const char *s, uint32_t *val)
+{
+	int v;
+	*val = 0;
+	while ((v = DbgSrv_HexVal(*s)) >= 0) {
+		*val = (*val << 4) | v;
+		s++;
+	}
+	return s;
+}
+
+// Parse "addr,len", return pointer after it or NULL
+static const char *DbgSrv_ParseAddrLen(const char *s, uint32_t *addr, uint32_t *len)
+{
+	s = DbgSrv_ParseHex(s, addr);
+	if (*s++ != ',') return NULL;
+	return DbgSrv_ParseHex(s, len);
+}
+
+static inline char *DbgSrv_PutHex8(char *out, uint8_t val)
+{
+	*out++ = DbgSrv_Hex[val >> 4];
+	*out++ = DbgSrv_Hex[val & 15];
+	return out;
+}
+
+// Convert text to hex, return end of output
+static char *DbgSrv_TextToHex(char *out, const char *txt, int len)
+{
+	while (len--) out = DbgSrv_PutHex8(out, (uint8_t)*txt++);
+	*out = 0;
+	return out;
+}
+
+static inline uint8_t DbgSrv_ReadMem(uint32_t addr)
+{
+	return MinxCPU_OnRead(0, addr & 0x1FFFFF);
+}
+
+static void DbgSrv_WriteMem(uint32_t addr, uint8_t data)
+{
+	addr &= 0x1FFFFF;
+	if (addr < 0x1000) {
+		PM_BIOS[addr] = data;
+	} else if (addr < 0x2000) {
+		PM_RAM[addr & 4095] = data;
+	} else if (addr < 0x2100) {
+		MinxCPU_OnWrite(0, addr, data);
+	} else {
+		PM_ROM[addr & PM_ROM_Mask] = data;
+	}
+}
+
+// Set PC from physical address
+static void DbgSrv_SetPC(uint32_t addr)
+{
+	if (addr >= 0x8000) {
+		MinxCPU.PC.B.I = (addr >> 15) & 0xFF;
+		MinxCPU.PC.W.L = 0x8000 | (addr & 0x7FFF);
+	} else {
+		MinxCPU.PC.W.L = addr;
+	}
+}
+
+static char *DbgSrv_GetReg(char *out, int reg)
+{
+	const TDbgSrv_Reg *r = &DbgSrv_Regs[reg];
+	if (r->size == 2) {
+		out = DbgSrv_PutHex8(out, *(uint16_t *)r->ptr & 0xFF);
+		out = DbgSrv_PutHex8(out, *(uint16_t *)r->ptr >> 8);
+	} else {
+		out = DbgSrv_PutHex8(out, *(uint8_t *)r->ptr);
+	}
+	*out = 0;
+	return out;
+}
+
+// Set register from little-endian hex, return pointer after it or NULL
+static const char *DbgSrv_SetReg(const char *s, int reg)
+{
+	const TDbgSrv_Reg *r = &DbgSrv_Regs[reg];
+	int i, hi, lo;
+	uint32_t val = 0;
+	for (i=0; i<r->size; i++) {
+		hi = DbgSrv_HexVal(s[0]);
+		lo = (hi < 0) ? -1 : DbgSrv_HexVal(s[1]);
+		if (lo < 0) return NULL;
+		val |= ((hi << 4) | lo) << (i * 8);
+		s += 2;
+	}
+	if (r->size == 2) *(uint16_t *)r->ptr = (uint16_t)val;
+	else *(uint8_t *)r->ptr = (uint8_t)val;
+	return s;
+}
+
+// Send console output as O packets
+static int DbgSrv_FlushConsole(void)
+{
+	int pos = 0, len;
+	while (pos < DbgSrv_ConsoleLen) {
+		len = DbgSrv_ConsoleLen - pos;
+		if (len > (GDBREMOTE_PACKETSIZE - 1) / 2) len = (GDBREMOTE_PACKETSIZE - 1) / 2;
+		DbgSrv_Reply[0] = 'O';
+		DbgSrv_TextToHex(DbgSrv_Reply + 1, DbgSrv_Console + pos, len);
+		if (!GDBRemote_PutString(DbgSrv_Reply)) return 0;
+		pos += len;
+	}
+	DbgSrv_ConsoleLen = 0;
+	return 1;
+}
+
+// Stop reply with reason and PC
+static int DbgSrv_StopReply(void)
+{
+	char *out = DbgSrv_Reply;
+	uint32_t pc = PhysicalPC();
+
+	if (!DbgSrv_FlushConsole()) return 0;
+	out += sprintf(out, "T%02x", DbgSrv_Signal);
+	if (DbgSrv_HistoryEnd) {
+		out += sprintf(out, "replaylog:begin;");
+	} else if (PMD_WatchHitAccess >= 0) {
+		out += sprintf(out, "%s:%x;", PMD_WatchHitAccess ? "watch" : "rwatch", (unsigned int)PMD_WatchHitAddr);
+	} else if (DbgSrv_SwBreak && PMD_TrapPoints && (PMD_TrapPoints[pc & PM_ROM_Mask] & TRAPPOINT_BREAK)) {
+		out += sprintf(out, "swbreak:;");
+	}
+	out += sprintf(out, "05:");
+	out = DbgSrv_GetReg(out, 5);
+	out += sprintf(out, ";06:");
+	out = DbgSrv_GetReg(out, 6);
+	strcpy(out, ";");
+	return GDBRemote_PutString(DbgSrv_Reply);
+}
+
+// Run until trap, interrupt or after frames, return 0 if client disconnected
+static int DbgSrv_Run(int frames)
+{
+	int intr = 0;
+
+	DbgSrv_Running = 1;
+	while (DbgSrv_Running) {
+		PokeMini_EmulateFrame();
+		if (PMD_TrapFound) break;
+		if (frames && !--frames) break;
+		intr = GDBRemote_Interrupted();
+		if (intr) break;
+	}
+	DbgSrv_Running = 0;
+	if (intr > 0) DbgSrv_Signal = 2;
+	return (intr >= 0);
+}
+
+// Prepare stop state before running
+static void DbgSrv_Resume(void)
+{
+	PMD_WatchHitAccess = -1;
+	DbgSrv_HistoryEnd = 0;
+	DbgSrv_Signal = 5;
+}
+
+// ------------
+// Query (qXfer)
+// ------------
+
+// Send slice of object, 'm' if more data follows and 'l' at the end
+static int DbgSrv_XferReply(const uint8_t *data, uint32_t size, uint32_t off, uint32_t len)
+{
+	if (len > GDBREMOTE_PACKETSIZE - 1) len = GDBREMOTE_PACKETSIZE - 1;
+	if (off >= size) return GDBRemote_PutString("l");
+	if (len > size - off) len = size - off;
+	DbgSrv_Reply[0] = (off + len < size) ? 'm' : 'l';
+	memcpy(DbgSrv_Reply + 1, data + off, len);
+	return GDBRemote_PutPacket(DbgSrv_Reply, len + 1);
+}
+
+static int DbgSrv_XferTrace(uint32_t off, uint32_t len)
+{
+	static uint8_t data[TRACECODE_LENGTH * 4];
+	uint32_t size = 0, addr;
+	int i;
+
+	for (i=1; i<=TRACECODE_LENGTH; i++) {
+		addr = TRACAddr[(TRACPoint + i) % TRACECODE_LENGTH];
+		if (addr == 0xFFFFFFFF) break;
+		data[size++] = addr & 0xFF;
+		data[size++] = (addr >> 8) & 0xFF;
+		data[size++] = (addr >> 16) & 0xFF;
+		data[size++] = (addr >> 24) & 0xFF;
+	}
+	return DbgSrv_XferReply(data, size, off, len);
+}
+
+static int DbgSrv_XferTraceFile(uint32_t off, uint32_t len)
+{
+	FILE *fi;
+	int size;
+
+	if (PMD_TraceWriter || !DbgSrv_TraceFile[0]) return GDBRemote_PutString("E01");
+	fi = fopen(DbgSrv_TraceFile, "rb");
+	if (!fi) return GDBRemote_PutString("E02");
+	if (len > GDBREMOTE_PACKETSIZE - 1) len = GDBREMOTE_PACKETSIZE - 1;
+	DbgSrv_Reply[0] = 'l';
+	size = 0;
+	if (!fseek(fi, off, SEEK_SET)) size = fread(DbgSrv_Reply + 1, 1, len, fi);
+	if ((uint32_t)size == len && fgetc(fi) != EOF) DbgSrv_Reply[0] = 'm';
+	fclose(fi);
+	return GDBRemote_PutPacket(DbgSrv_Reply, size + 1);
+}
+
+static int DbgSrv_Xfer(const char *s)
+{
+	uint32_t off, len;
+	const char *args = strstr(s, ":read:");
+	if (!args) return GDBRemote_PutString("");
+	args = strchr(args + 6, ':');
+	if (!args || !DbgSrv_ParseAddrLen(args + 1, &off, &len)) return GDBRemote_PutString("E00");
+	if (!strncmp(s, "pokemini-trace:", 15)) return DbgSrv_XferTrace(off, len);
+	if (!strncmp(s, "pokemini-tracefile:", 19)) return DbgSrv_XferTraceFile(off, len);
+	return GDBRemote_PutString("");
+}
+
+// Read several blocks in one reply
+static int DbgSrv_ReadMulti(const char *s)
+{
+	char *out = DbgSrv_Reply;
+	uint32_t addr, len, left = (GDBREMOTE_PACKETSIZE - 1) / 2;
+
+	while (*s) {
+		s = DbgSrv_ParseAddrLen(s, &addr, &len);
+		if (!s || (len > left)) return GDBRemote_PutString("E01");
+		left -= len;
+		while (len--) out = DbgSrv_PutHex8(out, DbgSrv_ReadMem(addr++));
+		if (*s == ';') s++;
+	}
+	*out = 0;
+	return GDBRemote_PutString(DbgSrv_Reply);
+}
+
+// ----------------
+// Monitor commands
+// ----------------
+
+static const char *DbgSrv_MonitorHelp =
+	"reset [hard]           Reset emulated system\n"
+	"key <name> <0|1>       Press or release a, b, c, up, down, left, right, power, shock\n"
+	"frames <n>             Run n frames, stop earlier on trap\n"
+	"cond <addr|*> [expr]   Add conditional breakpoint\n"
+	"tracepoint <addr|*> <message>  Add tracepoint, {expr} is replaced in message\n"
+	"clearcond              Remove conditional breakpoints and tracepoints\n"
+	"record <on|off>        Record history for reverse execution\n"
+	"tracefile <start file|stop>  Record run trace to file\n"
+	"state <load|save> <file>  Load or save emulator state\n"
+	"search start [8|16] [io]  Start RAM search, all addresses are candidates\n"
+	"search <op> [value]    Keep candidates where current <op> value or snapshot,\n"
+	"                       op is eq, ne, gt, lt, ge or le\n"
+	"search <inc|dec> <n>   Keep candidates increased or decreased by n\n"
+	"search snap            Take snapshot for next comparison\n"
+	"search list [max]      List candidates\n"
+	"cheat <freeze|patch> <addr> <value> [16]  Add cheat\n"
+	"cheat remove <addr> [16]  Remove cheat\n"
+	"cheat clear            Remove all cheats\n"
+	"cheat list             List cheats\n"
+	"cycles                 Cycles since hard reset\n"
+	"status                 Last status message\n";
+
+static const char *DbgSrv_SearchOps[] = { "eq", "ne", "gt", "lt", "ge", "le" };
+
+// Search commands
+static void DbgSrv_Search(char *arg, char *arg2, char *txt, int maxlen)
+{
+	int i, n, max, width = 1, withio = 0;
+	char tok[16];
+
+	if (!strcmp(arg, "start")) {
+		while (sscanf(arg2, "%15s%n", tok, &n) == 1) {
+			if (!strcmp(tok, "16")) width = 2;
+			else if (!strcmp(tok, "io")) withio = 1;
+			arg2 += n;
+		}
+		MemSearch_Start(width, withio);
+		snprintf(txt, maxlen, "%i candidates\n", MemSearch_Count());
+		return;
+	}
+	if (!MemSearch_Width()) {
+		snprintf(txt, maxlen, "No search, use 'search start'\n");
+		return;
+	}
+	if (!strcmp(arg, "snap")) {
+		MemSearch_Snapshot();
+	} else if (!strcmp(arg, "list")) {
+		max = *arg2 ? atoi(arg2) : 32;
+		for (i=MemSearch_Next(0); (i >= 0) && (max-- > 0) && (maxlen > 32); i=MemSearch_Next(i+1)) {
+			if (MemSearch_Width() == 2) n = snprintf(txt, maxlen, "%04X: %04X (%04X)\n", (unsigned int)MemSearch_Address(i), (unsigned int)MemSearch_Value(i), (unsigned int)MemSearch_PrevValue(i));
+			else n = snprintf(txt, maxlen, "%04X: %02X (%02X)\n", (unsigned int)MemSearch_Address(i), (unsigned int)MemSearch_Value(i), (unsigned int)MemSearch_PrevValue(i));
+			txt += n;
+			maxlen -= n;
+		}
+	} else if (!strcmp(arg, "inc") || !strcmp(arg, "dec")) {
+		n = (int)strtol(arg2, NULL, 0);
+		n = MemSearch_Filter(MEMSEARCH_EQUAL, MEMSEARCH_PREVIOUS, (*arg == 'd') ? -n : n);
+		snprintf(txt, maxlen, "%i candidates\n", n);
+	} else {
+		for (i=0; i<6; i++) {
+			if (!strcmp(arg, DbgSrv_SearchOps[i])) break;
+		}
+		if (i >= 6) {
+			snprintf(txt, maxlen, "Unknown search '%s'\n", arg);
+			return;
+		}
+		if (*arg2) n = MemSearch_Filter(i, MEMSEARCH_VALUE, (int32_t)strtol(arg2, NULL, 0));
+		else n = MemSearch_Filter(i, MEMSEARCH_PREVIOUS, 0);
+		snprintf(txt, maxlen, "%i candidates\n", n);
+	}
+}
+
+// Cheat commands
+static void DbgSrv_Cheat(char *arg, char *arg2, char *txt, int maxlen)
+{
+	TPokeMini_Cheat prev;
+	int i, n, value, type, hasprev = 0;
+	uint32_t addr;
+
+	if (!strcmp(arg, "clear")) {
+		PokeMini_CheatClear();
+	} else if (!strcmp(arg, "list")) {
+		for (i=0; (i<PokeMini_NumCheats) && (maxlen > 32); i++) {
+			n = snprintf(txt, maxlen, "%04X = %02X\n", PokeMini_Cheats[i].addr, PokeMini_Cheats[i].data);
+			txt += n;
+			maxlen -= n;
+		}
+	} else if (!strcmp(arg, "remove")) {
+		arg2 = (char *)DbgSrv_ParseHex((*arg2 == '$') ? arg2 + 1 : arg2, &addr);
+		while (*arg2 == ' ') arg2++;
+		i = PokeMini_CheatRemove(addr);
+		if (!strcmp(arg2, "16")) i |= PokeMini_CheatRemove(addr + 1);
+		if (!i) snprintf(txt, maxlen, "No cheat at %04X\n", (unsigned int)addr);
+	} else if (!strcmp(arg, "freeze") || !strcmp(arg, "patch")) {
+		type = (*arg == 'f') ? PokeMini_CheatFreeze : PokeMini_CheatPatch;
+		arg2 = (char *)DbgSrv_ParseHex((*arg2 == '$') ? arg2 + 1 : arg2, &addr);
+		value = (int)strtol(arg2, &arg2, 0);
+		while (*arg2 == ' ') arg2++;
+		if (!strcmp(arg2, "16")) {
+			// Both bytes or none, the low byte replaces any cheat there
+			for (n=0; n<PokeMini_NumCheats; n++) {
+				if (PokeMini_Cheats[n].addr == addr) {
+					prev = PokeMini_Cheats[n];
+					hasprev = 1;
+				}
+			}
+			i = (addr + 1 < 0x2000) && PokeMini_CheatAdd(addr, (uint8_t)value, type);
+			if (i && !PokeMini_CheatAdd(addr + 1, (uint8_t)(value >> 8), type)) {
+				PokeMini_CheatRemove(addr);
+				if (hasprev) PokeMini_CheatAdd(prev.addr, prev.data, prev.type);
+				i = 0;
+			}
+		} else {
+			i = PokeMini_CheatAdd(addr, (uint8_t)value, type);
+		}
+		if (!i) snprintf(txt, maxlen, "Couldn't add cheat, RAM only and up to %i\n", POKEMINI_MAXCHEATS);
+	} else {
+		snprintf(txt, maxlen, "Unknown cheat '%s'\n", arg);
+	}
+}
+
+// Execute command, output is written to txt
+static void DbgSrv_Monitor(char *cmd, char *txt, int maxlen)
+{
+	char *arg, *arg2, err[128];
+	uint32_t addr;
+	int i;
+
+	txt[0] = 0;
+	arg = strchr(cmd, ' ');
+	if (arg) {
+		*arg++ = 0;
+		while (*arg == ' ') arg++;
+	} else arg = cmd + strlen(cmd);
+	arg2 = strchr(arg, ' ');
+	if (arg2) {
+		*arg2++ = 0;
+		while (*arg2 == ' ') arg2++;
+	} else arg2 = arg + strlen(arg);
+
+	if (!strcmp(cmd, "help")) {
+		snprintf(txt, maxlen, "%s", DbgSrv_MonitorHelp);
+	} else if (!strcmp(cmd, "reset")) {
+		PokeMini_Reset(!strcmp(arg, "hard"));
+	} else if (!strcmp(cmd, "key")) {
+		for (i=MINX_KEY_A; i<=MINX_KEY_SHOCK; i++) {
+			if (!strcmp(arg, DbgSrv_KeyNames[i])) break;
+		}
+		if (i > MINX_KEY_SHOCK) snprintf(txt, maxlen, "Unknown key '%s'\n", arg);
+		else PokeMini_KeypadEvent(i, atoi(arg2));
+	} else if (!strcmp(cmd, "frames")) {
+		DbgSrv_Resume();
+		DbgSrv_Run(atoi(arg) > 0 ? atoi(arg) : 1);
+		snprintf(txt, maxlen, "%s\n", PMD_TrapFound ? DbgSrv_Status : "Done");
+	} else if (!strcmp(cmd, "cond") || !strcmp(cmd, "tracepoint")) {
+		if (*arg == '*') addr = BREAKCOND_ANYWHERE;
+		else DbgSrv_ParseHex((*arg == '$') ? arg + 1 : arg, &addr);
+		if (!strcmp(cmd, "cond")) i = BreakCond_Add(addr, arg2, BREAKCOND_BREAK, "", 0, err);
+		else i = BreakCond_Add(addr, "", BREAKCOND_LOG, arg2, 0, err);
+		if (i < 0) snprintf(txt, maxlen, "Error: %s\n", err);
+		else {
+			PMHD_BreakCondUpdate();
+			snprintf(txt, maxlen, "%i\n", i);
+		}
+	} else if (!strcmp(cmd, "clearcond")) {
+		BreakCond_ClearAll();
+		PMHD_BreakCondUpdate();
+	} else if (!strcmp(cmd, "record")) {
+		if (!PMHD_RevRecord(!strcmp(arg, "on"))) snprintf(txt, maxlen, "Not enough memory\n");
+	} else if (!strcmp(cmd, "tracefile")) {
+		if (!strcmp(arg, "start") && *arg2) {
+			PMHD_TraceRecordStop();
+			if (PMHD_TraceRecordStart(arg2)) strncpy(DbgSrv_TraceFile, arg2, PMTMPV-1);
+			else snprintf(txt, maxlen, "Error creating '%s'\n", arg2);
+		} else if (!PMHD_TraceRecordStop()) {
+			snprintf(txt, maxlen, "Error writing trace\n");
+		}
+	} else if (!strcmp(cmd, "state") && *arg2) {
+		if (!strcmp(arg, "load")) i = PokeMini_LoadSSFile(arg2);
+		else i = PokeMini_SaveSSFile(arg2, CommandLine.min_file);
+		if (!i) snprintf(txt, maxlen, "Error with state '%s'\n", arg2);
+	} else if (!strcmp(cmd, "search")) {
+		DbgSrv_Search(arg, arg2, txt, maxlen);
+	} else if (!strcmp(cmd, "cheat")) {
+		DbgSrv_Cheat(arg, arg2, txt, maxlen);
+	} else if (!strcmp(cmd, "cycles")) {
+		snprintf(txt, maxlen, "%llu\n", (unsigned long long)PMD_CycleCount);
+	} else if (!strcmp(cmd, "status")) {
+		snprintf(txt, maxlen, "%s\n", DbgSrv_Status);
+	} else {
+		snprintf(txt, maxlen, "Unknown command, try 'monitor help'\n");
+	}
+}
+
+// ------------
+// Breakpoints
+// ------------
+
+static int DbgSrv_BreakWatch(int insert, int type, uint32_t addr, uint32_t len)
+{
+	static const int flags[5] = { 0, 0, WATCHPOINT_WRITE, WATCHPOINT_READ, WATCHPOINT_RW };
+	const TWatchRange *range;
+	int i;
+
+	if (type <= 1) {
+		if (!PMD_TrapPoints) return 0;
+		if (insert) PMD_TrapPoints[addr & PM_ROM_Mask] |= TRAPPOINT_BREAK;
+		else PMD_TrapPoints[addr & PM_ROM_Mask] &= ~TRAPPOINT_BREAK;
+		return 1;
+	}
+	if (type > 4) return 0;
+	if (len <= 1) {
+		if (insert) return WatchPoints_Set(addr, WatchPoints_Get(addr) | flags[type]);
+		return WatchPoints_Set(addr, WatchPoints_Get(addr) & ~flags[type]);
+	}
+	if (insert) return WatchPoints_AddRange(addr, addr + len - 1, flags[type], -1);
+	for (i=0; i<WatchPoints_NumRanges(); i++) {
+		range = WatchPoints_GetRange(i);
+		if ((range->start == (addr & WATCHPOINTS_MASK)) && (range->end == ((addr + len - 1) & WATCHPOINTS_MASK)) && (range->flags == flags[type])) {
+			return WatchPoints_RemoveRange(i);
+		}
+	}
+	return 0;
+}
+
+// -----------------
+// Packet processing
+// -----------------
+
+// Process packet, return 1 to continue the session, 0 to end it
+static int DbgSrv_Command(char *pkt, int pktlen)
+{
+	char *out = DbgSrv_Reply, cmd[256], txt[2048];
+	const char *s;
+	uint32_t addr, len;
+	int i, hi, lo;
+
+	switch (pkt[0]) {
+		case '?':
+			return DbgSrv_StopReply();
+
+		case 'g':
+			for (i=0; i<DBGSRV_NUMREGS; i++) out = DbgSrv_GetReg(out, i);
+			return GDBRemote_PutString(DbgSrv_Reply);
+
+		case 'G':
+			s = pkt + 1;
+			for (i=0; i<DBGSRV_NUMREGS && s; i++) s = DbgSrv_SetReg(s, i);
+			return GDBRemote_PutString(s ? "OK" : "E01");
+
+		case 'p':
+			DbgSrv_ParseHex(pkt + 1, &addr);
+			if (addr >= DBGSRV_NUMREGS) return GDBRemote_PutString("E01");
+			DbgSrv_GetReg(out, addr);
+			return GDBRemote_PutString(DbgSrv_Reply);
+
+		case 'P':
+			s = DbgSrv_ParseHex(pkt + 1, &addr);
+			if ((addr >= DBGSRV_NUMREGS) || (*s != '=') || !DbgSrv_SetReg(s + 1, addr)) return GDBRemote_PutString("E01");
+			return GDBRemote_PutString("OK");
+
+		case 'm':
+			if (!DbgSrv_ParseAddrLen(pkt + 1, &addr, &len)) return GDBRemote_PutString("E01");
+			if (len > (GDBREMOTE_PACKETSIZE - 1) / 2) len = (GDBREMOTE_PACKETSIZE - 1) / 2;
+			while (len--) out = DbgSrv_PutHex8(out, DbgSrv_ReadMem(addr++));
+			*out = 0;
+			return GDBRemote_PutString(DbgSrv_Reply);
+
+		case 'M':
+			s = DbgSrv_ParseAddrLen(pkt + 1, &addr, &len);
+			if (!s || (*s++ != ':')) return GDBRemote_PutString("E01");
+			while (len--) {
+				hi = DbgSrv_HexVal(s[0]);
+				lo = (hi < 0) ? -1 : DbgSrv_HexVal(s[1]);
+				if (lo < 0) return GDBRemote_PutString("E02");
+				DbgSrv_WriteMem(addr++, (hi << 4) | lo);
+				s += 2;
+			}
+			return GDBRemote_PutString("OK");
+
+		case 'X':
+			s = DbgSrv_ParseAddrLen(pkt + 1, &addr, &len);
+			if (!s || (*s++ != ':')) return GDBRemote_PutString("E01");
+			while (len-- && (s < pkt + pktlen)) {
+				if (*s == '}') {
+					s++;
+					DbgSrv_WriteMem(addr++, *s++ ^ 0x20);
+				} else DbgSrv_WriteMem(addr++, *s++);
+			}
+			return GDBRemote_PutString("OK");
+
+		case 'c':
+		case 's':
+			if (pkt[1]) {
+				DbgSrv_ParseHex(pkt + 1, &addr);
+				DbgSrv_SetPC(addr);
+			}
+			DbgSrv_Resume();
+			if (pkt[0] == 's') PokeMini_EmulateStep();
+			else if (!DbgSrv_Run(0)) return 0;
+			return DbgSrv_StopReply();
+
+		case 'b':
+			if ((pkt[1] != 's') && (pkt[1] != 'c')) return GDBRemote_PutString("");
+			if (!RevExec_Enabled) return GDBRemote_PutString("E01");
+			DbgSrv_Resume();
+			if (pkt[1] == 's') i = PMHD_RevStepBack(1);
+			else i = PMHD_RevContinue();
+			DbgSrv_HistoryEnd = !i;
+			return DbgSrv_StopReply();
+
+		case 'Z':
+		case 'z':
+			s = DbgSrv_ParseHex(pkt + 1, &addr);
+			i = addr;
+			if (*s++ != ',') return GDBRemote_PutString("E01");
+			s = DbgSrv_ParseAddrLen(s, &addr, &len);
+			if (!s) return GDBRemote_PutString("E01");
+			if (i > 4) return GDBRemote_PutString("");
+			return GDBRemote_PutString(DbgSrv_BreakWatch(pkt[0] == 'Z', i, addr, len) ? "OK" : "E02");
+
+		case 'H':
+		case 'T':
+			return GDBRemote_PutString("OK");
+
+		case 'D':
+			GDBRemote_PutString("OK");
+			return 0;
+
+		case 'k':
+			return 0;
+
+		case 'q':
+			if (!strncmp(pkt, "qSupported", 10)) {
+				DbgSrv_SwBreak = (strstr(pkt, "swbreak+") != NULL);
+				sprintf(DbgSrv_Reply, "PacketSize=%x;QStartNoAckMode+;swbreak+;ReverseStep+;ReverseContinue+;"
+					"qXfer:pokemini-trace:read+;qXfer:pokemini-tracefile:read+", GDBREMOTE_PACKETSIZE);
+				return GDBRemote_PutString(DbgSrv_Reply);
+			}
+			if (!strcmp(pkt, "qAttached")) return GDBRemote_PutString("1");
+			if (!strcmp(pkt, "qC")) return GDBRemote_PutString("QC1");
+			if (!strcmp(pkt, "qfThreadInfo")) return GDBRemote_PutString("m1");
+			if (!strcmp(pkt, "qsThreadInfo")) return GDBRemote_PutString("l");
+			if (!strncmp(pkt, "qXfer:", 6)) return DbgSrv_Xfer(pkt + 6);
+			if (!strncmp(pkt, "qPokeMini.ReadMulti:", 20)) return DbgSrv_ReadMulti(pkt + 20);
+			if (!strncmp(pkt, "qRcmd,", 6)) {
+				// Decode hex command
+				for (i=0, s=pkt+6; (i < (int)sizeof(cmd)-1) && (DbgSrv_HexVal(s[0]) >= 0) && (DbgSrv_HexVal(s[1]) >= 0); i++, s+=2) {
+					cmd[i] = (DbgSrv_HexVal(s[0]) << 4) | DbgSrv_HexVal(s[1]);
+				}
+				cmd[i] = 0;
+				DbgSrv_Monitor(cmd, txt, sizeof(txt));
+				if (!DbgSrv_FlushConsole()) return 0;
+				if (!txt[0]) return GDBRemote_PutString("OK");
+				i = strlen(txt);
+				if (i > (GDBREMOTE_PACKETSIZE - 1) / 2) i = (GDBREMOTE_PACKETSIZE - 1) / 2;
+				DbgSrv_TextToHex(DbgSrv_Reply, txt, i);
+				return GDBRemote_PutString(DbgSrv_Reply);
+			}
+			return GDBRemote_PutString("");
+
+		case 'Q':
+			if (!strcmp(pkt, "QStartNoAckMode")) {
+				if (!GDBRemote_PutString("OK")) return 0;
+				GDBRemote_NoAck();
+				return 1;
+			}
+			return GDBRemote_PutString("");
+
+		default:
+			return GDBRemote_PutString("");
+	}
+}
+
+// Serve client until it detach or disconnect
+static void DbgSrv_Session(void)
+{
+	int len;
+
+	DbgSrv_SwBreak = 0;
+	DbgSrv_Signal = 5;
+	for (;;) {
+		len = GDBRemote_GetPacket(DbgSrv_Packet, sizeof(DbgSrv_Packet));
+		if (len < 0) break;
+		if (!DbgSrv_Command(DbgSrv_Packet, len)) break;
+	}
+	GDBRemote_Close();
+}
+
+// Main function
+int main(int argc, char **argv)
+{
+	// Process arguments
+	PokeMini_InitDirs(argv[0], NULL);
+	CommandLineInit();
+	if (!CommandLineArgs(argc, argv, CustomArgs)) {
+		PrintHelpUsage(stdout);
+		printf("  -port n                TCP port on localhost (def 1234)\n");
+		printf("  -unix path             Listen on Unix socket instead\n");
+		printf("  -once                  Exit when the first client is done\n");
+		printf("  -verbose               Print messages to stderr\n");
+		return 1;
+	}
+
+	// Initialize the emulator
+	if (!PokeMini_Create(0, PMSNDBUFFER)) {
+		fprintf(stderr, "Error while initializing emulator\n");
+		return 1;
+	}
+	PMHD_MINLoaded();
+	PokeMini_OnLoadStateFile = DbgSrv_OnLoadStateFile;
+	PokeMini_OnReset = PMHD_Reset;
+	PokeMini_ApplyChanges();
+	MinxAudio_ChangeEngine(MINX_AUDIO_DISABLED);
+
+	// Load stuff & allocate dummy ROM
+	PokeMini_LoadFromCommandLines("Using FreeBIOS", "EEPROM data will be discarded!");
+	if (!PM_ROM_Alloc) {
+		if (!PokeMini_NewMIN(65536)) {
+			fprintf(stderr, "Not enough memory for 64KB ROM!\n");
+			return 1;
+		}
+	}
+	PMHD_MINLoaded();
+
+	// Listen
+	if (dsrv_unix[0]) {
+		if (!GDBRemote_ListenUnix(dsrv_unix)) {
+			fprintf(stderr, "Couldn't listen on '%s'\n", dsrv_unix);
+			return 1;
+		}
+		fprintf(stderr, "%s listening on %s\n", AppName, dsrv_unix);
+	} else {
+		if (!GDBRemote_ListenTCP(dsrv_port)) {
+			fprintf(stderr, "Couldn't listen on port %i\n", dsrv_port);
+			return 1;
+		}
+		fprintf(stderr, "%s listening on port %i\n", AppName, dsrv_port);
+	}
+
+	// Serve clients
+	while (GDBRemote_Accept()) {
+		DbgSrv_Session();
+		if (dsrv_once) break;
+	}
+	GDBRemote_Shutdown();
+
+	// Terminate...
+	PMHD_TraceRecordStop();
+	PMHD_FreeResources();
+	PokeMini_Destroy();
+	Profiler_Free();
+
+	return 0;
+}
@@ -28,12 +28,14 @@
 #include "PokeMini.h"
 #include "PokeMini_Debug.h"
 #include "Hardware_Debug.h"
+#include "Profiler.h"
 #include "ExportBMP.h"
 #include "ExportWAV.h"
 
 #include "PokeMiniIcon_96x128.h"
 #include "InstructionProc.h"
 #include "InstructionInfo.h"
+#include "CodeMap.h"
 #include "HelpSupport.h"
 #include "FileAssociation.h"
 
@@ -358,31 +360,71 @@ TSOpcDec CDisAsm_SOpcDec = {
 // -------
 
 static uint32_t *ProgramView_Table = NULL;
+static TCodeMap *ProgramView_CodeMap = NULL;
+static int ProgramView_LastOffset = 0;
 
-// Get physical address of program view top
-uint32_t ProgramView_GetTop(void)
+// Physical address of scrollbar offset
+static uint32_t ProgramView_OffsetToAddr(int offset)
 {
-	int pp = ProgramView.sboffset;
 	if (!dclc_fullrange) {
-		if (pp >= 0x8000) {
-			pp = (MinxCPU.PC.B.I << 15) | (pp & 0x7FFF);
+		if (offset >= 0x8000) {
+			return (MinxCPU.PC.B.I << 15) | (offset & 0x7FFF);
 		}
 	}
+	return offset;
+}
+
+// Scrollbar offset of physical address
+static int ProgramView_AddrToOffset(uint32_t addr)
+{
+	if (!dclc_fullrange) {
+		if (addr >= 0x8000) {
+			return 0x8000 | (addr & 0x7FFF);
+		}
+	}
+	return addr;
+}
+
+// Get physical address of program view top
+uint32_t ProgramView_GetTop(void)
+{
+	uint32_t pp = ProgramView_OffsetToAddr(ProgramView.sboffset);
+	if (ProgramView_CodeMap) pp = CodeMap_Align(ProgramView_CodeMap, pp);
 	return pp;
 }
 
 // Recalculate program view table
 uint32_t ProgramView_Recalc(uint32_t addr)
 {
-	int y, size;
+	int y;
 	for (y=0; y<ProgramView.total_lines; y++) {
-		GetInstructionInfo(MinxCPU_OnRead, 1, addr, NULL, &size);
 		ProgramView_Table[y] = addr;
-		addr += size;
+		addr = CodeMap_Next(ProgramView_CodeMap, MinxCPU_OnRead, addr);
 	}
 	return addr;
 }
 
+// Analyze code from vectors and PC
+void ProgramView_AnalyzeCode(int verbose)
+{
+	if (ProgramView_CodeMap && (ProgramView_CodeMap->size != PM_ROM_Size)) {
+		CodeMap_Destroy(ProgramView_CodeMap);
+		ProgramView_CodeMap = NULL;
+	}
+	if (!ProgramView_CodeMap) ProgramView_CodeMap = CodeMap_Create(PM_ROM_Size);
+	if (!ProgramView_CodeMap) return;
+	if (!CodeMap_Analyze(ProgramView_CodeMap, MinxCPU_OnRead, 1) ||
+	    !CodeMap_AddEntry(ProgramView_CodeMap, MinxCPU_OnRead, PhysicalPC())) {
+		CodeMap_Destroy(ProgramView_CodeMap);
+		ProgramView_CodeMap = NULL;
+		if (verbose) Add_InfoMessage("[Error] Not enough memory to analyze code\n");
+		return;
+	}
+	if (verbose) Add_InfoMessage("[Info] Code analyzed, %i instructions, %i references\n", ProgramView_CodeMap->instructions, ProgramView_CodeMap->numxref);
+	ProgramView.first_addr = -1;
+	ProgramView_Sync();
+}
+
 // Syncronize program view
 int ProgramView_Sync(void)
 {
@@ -404,6 +446,22 @@ void ProgramView_GotoAddr(uint32_t addr, int highlight)
 	int offset, laddr = addr;
 	if (addr >= 0x8000) laddr = 0x8000 | (addr & 0x7FFF);
 
+	// Step back by instructions when they are known
+	if (ProgramView_CodeMap && CodeMap_IsCode(ProgramView_CodeMap, addr)) {
+		ProgramView_Sync();
+		if (highlight) {
+			ProgramView.highlight_addr = addr;
+			ProgramView.highlight_rem = 16;
+		}
+		if ((addr < ProgramView.first_addr) || (addr >= ProgramView.last_addr)) {
+			for (offset = ProgramView.total_lines >> 1; offset > 0; offset--) {
+				addr = CodeMap_Prev(ProgramView_CodeMap, MinxCPU_OnRead, addr);
+			}
+			sgtkx_drawing_view_sbvalue(&ProgramView, ProgramView_AddrToOffset(addr));
+		}
+		return;
+	}
+
 	// Sync program viewI should had them separate
 	ProgramView_Sync();
 
@@ -458,6 +516,32 @@ static int ProgramView_resize(SGtkXDrawingView *widg, int width, int height, int
 	return (emumode == EMUMODE_STOP);
 }
 
+// Program view scroll event
+static int ProgramView_scroll(SGtkXDrawingView *widg, int value, int min, int max)
+{
+	uint32_t pp, npp;
+
+	// Snap to instruction, single steps move by one instruction
+	if (ProgramView_CodeMap) {
+		pp = ProgramView_OffsetToAddr(value);
+		if (value == ProgramView_LastOffset + 1) {
+			npp = CodeMap_Next(ProgramView_CodeMap, MinxCPU_OnRead, ProgramView_OffsetToAddr(ProgramView_LastOffset));
+		} else if (value == ProgramView_LastOffset - 1) {
+			npp = CodeMap_Prev(ProgramView_CodeMap, MinxCPU_OnRead, ProgramView_OffsetToAddr(ProgramView_LastOffset));
+		} else {
+			npp = CodeMap_Align(ProgramView_CodeMap, pp);
+		}
+		ProgramView_LastOffset = ProgramView_AddrToOffset(npp);
+		if (npp != pp) {
+			sgtkx_drawing_view_sbvalue(widg, ProgramView_LastOffset);
+			return 0;
+		}
+	}
+	ProgramView_LastOffset = value;
+
+	return (emumode == EMUMODE_STOP);
+}
+
 // Program view exposure event
 static int ProgramView_exposure(SGtkXDrawingView *widg, int width, int height, int pitch)
 {
@@ -466,7 +550,7 @@ static int ProgramView_exposure(SGtkXDrawingView *widg, int width, int height, i
 	InstructionInfo *opcode;
 	uint8_t data[4];
 	char opcodename[PMTMPV];
-	int size, onCur;
+	int size, onCur, cov;
 	int y, yc, ys = -1;
 
 	// Calculate height and selected item
@@ -480,6 +564,10 @@ static int ProgramView_exposure(SGtkXDrawingView *widg, int width, int height, i
 			pp = (MinxCPU.PC.B.I << 15) | (lp & 0x7FFF);
 		}
 	}
+	if (ProgramView_CodeMap) {
+		lp -= pp - CodeMap_Align(ProgramView_CodeMap, pp);
+		pp = CodeMap_Align(ProgramView_CodeMap, pp);
+	}
 	pPC = PhysicalPC();
 
 	// Decrement highlighting remain timer
@@ -522,6 +610,9 @@ static int ProgramView_exposure(SGtkXDrawingView *widg, int width, int height, i
 			} else if (PMD_TrapPoints[pp & PM_ROM_Mask] & TRAPPOINT_BREAK) {
 				color = 0xFF2000;
 				onCur = 1;
+			} else if (PMD_TrapPoints[pp & PM_ROM_Mask] & TRAPPOINT_COND) {
+				color = 0xC080FF;
+				onCur = 1;
 			} else if ((y-1) == ys) {
 				if (stripe & 1) color = 0xF8F8DC;
 				else color = 0xF8F8F8;
@@ -536,11 +627,19 @@ static int ProgramView_exposure(SGtkXDrawingView *widg, int width, int height, i
 		sgtkx_drawing_view_drawfrect(widg, 0, y * 12, widg->width, 12, color);
 		stripe++;
 
+		// Coverage mark
+		if (dclc_coverage_overlay && Coverage_Bits) {
+			cov = Coverage_Get(pp);
+			if (cov & (1 << COVERAGE_EXEC)) sgtkx_drawing_view_drawfrect(widg, 0, y * 12, 3, 12, 0x20A020);
+			else if (cov & (1 << COVERAGE_WRITE)) sgtkx_drawing_view_drawfrect(widg, 0, y * 12, 3, 12, 0xC02020);
+			else if (cov & (1 << COVERAGE_READ)) sgtkx_drawing_view_drawfrect(widg, 0, y * 12, 3, 12, 0x2060C0);
+		}
+
 		// Decode instruction
 		ProgramView_Table[y-1] = lastpp;
 		if (pp >= PM_ROM_Size) continue;
 		if (!dclc_fullrange && (lp >= 65536)) continue;
-		opcode = GetInstructionInfo(MinxCPU_OnRead, 1, pp, data, &size);
+		opcode = CodeMap_GetInstruction(ProgramView_CodeMap, MinxCPU_OnRead, pp, data, &size);
 		DisasmSingleOpcode(opcode, pp, data, opcodename, &CDisAsm_SOpcDec);
 		ProgramView_Table[y-1] = pp;
 
@@ -604,7 +703,7 @@ static int ProgramView_buttonpress(SGtkXDrawingView *widg, int button, int press
 
 	// Process selected item
 	pp = ProgramView_Table[ys];
-	opcode = GetInstructionInfo(MinxCPU_OnRead, 1, pp, data, &size);
+	opcode = GetInstructionInfo(MinxCPU_OnRead, 0, pp, data, &size);
 	DisasmSingleOpcode(opcode, pp, data, opcodename, &DefaultSOpcDec);
 	strcpy(ProgramView_leftbpress[1].text, opcodename);
 	ProgramView_leftbpress[2].number = PMD_TrapPoints[pp & PM_ROM_Mask] & TRAPPOINT_BREAK;
@@ -638,6 +737,7 @@ static int ProgramView_buttonpress(SGtkXDrawingView *widg, int button, int press
 			// Change breakpoint
 			PMD_TrapPoints[pp & PM_ROM_Mask] &= ~TRAPPOINT_BREAK;
 			if (ProgramView_leftbpress[2].number) PMD_TrapPoints[pp & PM_ROM_Mask] |= TRAPPOINT_BREAK;
+			if (ProgramView_leftbpress[0].number) ProgramView_AnalyzeCode(0);
 			refresh_debug(1);
 		}
 	} else if ((button == SGTKXDV_BMIDDLE) || (button == SGTKXDV_BRIGHT)) {
@@ -930,7 +1030,7 @@ static int StackView_exposure(SGtkXDrawingView *widg, int width, int height, int
 	pp = widg->sboffset + 0x1000;
 	for (y=1; y<yc+1; y++) {
 		if (emumode != EMUMODE_RUNFULL) {
-			watch = PMD_TrapPoints[pp & PM_ROM_Mask] & TRAPPOINT_WATCH;
+			watch = WatchPoints_Covered(pp);
 			if ((MinxCPU.SP.W.L - 1) == pp) {
 				if (watch) {
 					color = AnyView_TrapColor[watch + 1];
@@ -988,14 +1088,12 @@ static int StackView_buttonpress(SGtkXDrawingView *widg, int button, int press,
 	if (button == SGTKXDV_BLEFT) {
 		if (pp < 0x2000) {
 			AnyView_NewValue_CD[1].number = (int)PM_RAM[pp & 4095];
-			AnyView_NewValue_CD[3].number = PMD_TrapPoints[pp] & TRAPPOINT_WATCHREAD;
-			AnyView_NewValue_CD[4].number = PMD_TrapPoints[pp] & TRAPPOINT_WATCHWRITE;
+			AnyView_NewValue_CD[3].number = WatchPoints_Get(pp) & TRAPPOINT_WATCHREAD;
+			AnyView_NewValue_CD[4].number = WatchPoints_Get(pp) & TRAPPOINT_WATCHWRITE;
 			sprintf(AnyView_NewValue_CD[0].text, "Set new value for $%04X:", pp);
 			if (CustomDialog(MainWindow, "Change stack", AnyView_NewValue_CD)) {
 				PM_RAM[pp & 4095] = AnyView_NewValue_CD[1].number;
-				PMD_TrapPoints[pp] &= ~TRAPPOINT_WATCH;
-				if (AnyView_NewValue_CD[3].number) PMD_TrapPoints[pp] |= TRAPPOINT_WATCHREAD;
-				if (AnyView_NewValue_CD[4].number) PMD_TrapPoints[pp] |= TRAPPOINT_WATCHWRITE;
+				WatchPoints_Set(pp, (AnyView_NewValue_CD[3].number ? TRAPPOINT_WATCHREAD : 0) | (AnyView_NewValue_CD[4].number ? TRAPPOINT_WATCHWRITE : 0));
 				refresh_debug(1);
 			}
 		}
@@ -1084,7 +1182,7 @@ static int RAMView_exposure(SGtkXDrawingView *widg, int width, int height, int p
 		for (x=0; x<16; x++) {
 			dat = PM_RAM[pp & 4095];
 			sdat = (dat < 0x01) ? '.' : dat;
-			watch = PMD_TrapPoints[pp & PM_ROM_Mask] & TRAPPOINT_WATCH;
+			watch = WatchPoints_Covered(pp);
 			if (watch) {
 				sgtkx_drawing_view_drawfrect(widg, 56 + x * 20, y * 12, 16, 12, AnyView_TrapColor[watch]);
 			}
@@ -1135,41 +1233,37 @@ static int RAMView_buttonpress(SGtkXDrawingView *widg, int button, int press, in
 	if (button == SGTKXDV_BLEFT) {
 		if (pp < 0x2000) {
 			AnyView_NewValue_CD[1].number = (int)PM_RAM[pp & 4095];
-			AnyView_NewValue_CD[3].number = PMD_TrapPoints[pp] & TRAPPOINT_WATCHREAD;
-			AnyView_NewValue_CD[4].number = PMD_TrapPoints[pp] & TRAPPOINT_WATCHWRITE;
+			AnyView_NewValue_CD[3].number = WatchPoints_Get(pp) & TRAPPOINT_WATCHREAD;
+			AnyView_NewValue_CD[4].number = WatchPoints_Get(pp) & TRAPPOINT_WATCHWRITE;
 			sprintf(AnyView_NewValue_CD[0].text, "Set new value for $%04X:", pp);
 			if (CustomDialog(MainWindow, "Change RAM", AnyView_NewValue_CD)) {
 				PM_RAM[pp & 4095] = AnyView_NewValue_CD[1].number;
-				PMD_TrapPoints[pp] &= ~TRAPPOINT_WATCH;
-				if (AnyView_NewValue_CD[3].number) PMD_TrapPoints[pp] |= TRAPPOINT_WATCHREAD;
-				if (AnyView_NewValue_CD[4].number) PMD_TrapPoints[pp] |= TRAPPOINT_WATCHWRITE;
+				WatchPoints_Set(pp, (AnyView_NewValue_CD[3].number ? TRAPPOINT_WATCHREAD : 0) | (AnyView_NewValue_CD[4].number ? TRAPPOINT_WATCHWRITE : 0));
 				refresh_debug(1);
 			}
 		}
 	} else if (button == SGTKXDV_BMIDDLE) {
 		if (pp < 0x2000) {
-			val = PMD_TrapPoints[pp];
+			val = WatchPoints_Get(pp);
 				switch (val & TRAPPOINT_WATCH) {
 				case 0: val = TRAPPOINT_WATCHREAD | TRAPPOINT_WATCHWRITE; break;
 				case TRAPPOINT_WATCHREAD | TRAPPOINT_WATCHWRITE: val = TRAPPOINT_WATCHREAD; break;
 				case TRAPPOINT_WATCHREAD: val = TRAPPOINT_WATCHWRITE; break;
 				case TRAPPOINT_WATCHWRITE: val = 0; break;
 			}
-			PMD_TrapPoints[pp] &= ~TRAPPOINT_WATCH;
-			PMD_TrapPoints[pp] |= val;
+			WatchPoints_Set(pp, val);
 			refresh_debug(1);
 		}
 	} else if (button == SGTKXDV_BRIGHT) {
 		if (pp < 0x2000) {
-			val = PMD_TrapPoints[pp];
+			val = WatchPoints_Get(pp);
 				switch (val & TRAPPOINT_WATCH) {
 				case TRAPPOINT_WATCHREAD | TRAPPOINT_WATCHWRITE: val = 0;  break;
 				case TRAPPOINT_WATCHREAD: val = TRAPPOINT_WATCHREAD | TRAPPOINT_WATCHWRITE; break;
 				case TRAPPOINT_WATCHWRITE: val = TRAPPOINT_WATCHREAD; break;
 				case 0: val = TRAPPOINT_WATCHWRITE; break;
 			}
-			PMD_TrapPoints[pp] &= ~TRAPPOINT_WATCH;
-			PMD_TrapPoints[pp] |= val;
+			WatchPoints_Set(pp, val);
 			refresh_debug(1);
 		}
 	}
@@ -1225,7 +1319,7 @@ static int IOView_exposure(SGtkXDrawingView *widg, int width, int height, int pi
 		for (x=0; x<16; x++) {
 			dat = MinxCPU_OnRead(0, pp);
 			sdat = (dat < 0x01) ? '.' : dat;
-			watch = PMD_TrapPoints[pp & PM_ROM_Mask] & TRAPPOINT_WATCH;
+			watch = WatchPoints_Covered(pp);
 			if (watch) {
 				sgtkx_drawing_view_drawfrect(widg, 56 + x * 20, y * 12, 16, 12, AnyView_TrapColor[watch]);
 			}
@@ -1276,41 +1370,37 @@ static int IOView_buttonpress(SGtkXDrawingView *widg, int button, int press, int
 	if (button == SGTKXDV_BLEFT) {
 		if (pp < 0x2100) {
 			AnyView_NewValue_CD[1].number = (int)MinxCPU_OnRead(0, pp);
-			AnyView_NewValue_CD[3].number = PMD_TrapPoints[pp] & TRAPPOINT_WATCHREAD;
-			AnyView_NewValue_CD[4].number = PMD_TrapPoints[pp] & TRAPPOINT_WATCHWRITE;
+			AnyView_NewValue_CD[3].number = WatchPoints_Get(pp) & TRAPPOINT_WATCHREAD;
+			AnyView_NewValue_CD[4].number = WatchPoints_Get(pp) & TRAPPOINT_WATCHWRITE;
 			sprintf(AnyView_NewValue_CD[0].text, "Set new value for $%04X:", pp);
 			if (CustomDialog(MainWindow, "Change Hardware IO", AnyView_NewValue_CD)) {
 				MinxCPU_OnWrite(0, pp, AnyView_NewValue_CD[1].number);
-				PMD_TrapPoints[pp] &= ~TRAPPOINT_WATCH;
-				if (AnyView_NewValue_CD[3].number) PMD_TrapPoints[pp] |= TRAPPOINT_WATCHREAD;
-				if (AnyView_NewValue_CD[4].number) PMD_TrapPoints[pp] |= TRAPPOINT_WATCHWRITE;
+				WatchPoints_Set(pp, (AnyView_NewValue_CD[3].number ? TRAPPOINT_WATCHREAD : 0) | (AnyView_NewValue_CD[4].number ? TRAPPOINT_WATCHWRITE : 0));
 				refresh_debug(1);
 			}
 		}
 	} else if (button == SGTKXDV_BMIDDLE) {
 		if (pp < 0x2100) {
-			val = PMD_TrapPoints[pp];
+			val = WatchPoints_Get(pp);
 				switch (val & TRAPPOINT_WATCH) {
 				case 0: val = TRAPPOINT_WATCHREAD | TRAPPOINT_WATCHWRITE; break;
 				case TRAPPOINT_WATCHREAD | TRAPPOINT_WATCHWRITE: val = TRAPPOINT_WATCHREAD; break;
 				case TRAPPOINT_WATCHREAD: val = TRAPPOINT_WATCHWRITE; break;
 				case TRAPPOINT_WATCHWRITE: val = 0; break;
 			}
-			PMD_TrapPoints[pp] &= ~TRAPPOINT_WATCH;
-			PMD_TrapPoints[pp] |= val;
+			WatchPoints_Set(pp, val);
 			refresh_debug(1);
 		}
 	} else if (button == SGTKXDV_BRIGHT) {
 		if (pp < 0x2100) {
-			val = PMD_TrapPoints[pp];
+			val = WatchPoints_Get(pp);
 				switch (val & TRAPPOINT_WATCH) {
 				case TRAPPOINT_WATCHREAD | TRAPPOINT_WATCHWRITE: val = 0;  break;
 				case TRAPPOINT_WATCHREAD: val = TRAPPOINT_WATCHREAD | TRAPPOINT_WATCHWRITE; break;
 				case TRAPPOINT_WATCHWRITE: val = TRAPPOINT_WATCHREAD; break;
 				case 0: val = TRAPPOINT_WATCHWRITE; break;
 			}
-			PMD_TrapPoints[pp] &= ~TRAPPOINT_WATCH;
-			PMD_TrapPoints[pp] |= val;
+			WatchPoints_Set(pp, val);
 			refresh_debug(1);
 		}
 	}
@@ -1493,6 +1583,35 @@ GtkXCustomDialog AnyView_AddWPAt_CD[] = {
 	{GTKXCD_EOL, ""}
 };
 
+static GtkXCustomDialog AnyView_AddWPRange_CD[] = {
+	{GTKXCD_LABEL, "Range start address:"},
+	{GTKXCD_NUMIN, "", 0, 6, 1, 0, 2097151},
+	{GTKXCD_LABEL, "Range end address:"},
+	{GTKXCD_NUMIN, "", 0, 6, 1, 0, 2097151},
+	{GTKXCD_LABEL, "Prefix \"$\" for hexadecimal numbers"},
+	{GTKXCD_CHECK, "Read access", 1},
+	{GTKXCD_CHECK, "Write access", 1},
+	{GTKXCD_CHECK, "Only when data match:", 0},
+	{GTKXCD_NUMIN, "", 0, 2, 1, 0, 255},
+	{GTKXCD_LABEL, "Warning: Watchpoints are only triggered at\nthe end of the instruction causing it."},
+	{GTKXCD_EOL, ""}
+};
+
+static GtkXCustomDialog CPUWindow_AddCondBP_CD[] = {
+	{GTKXCD_LABEL, "Breakpoint address:"},
+	{GTKXCD_NUMIN, "", 0, 6, 1, 0, 2097151},
+	{GTKXCD_CHECK, "Any address (test before every instruction)", 0},
+	{GTKXCD_LABEL, "Condition, empty for always:"},
+	{GTKXCD_ENTRY, ""},
+	{GTKXCD_LABEL, "Trigger from hit:"},
+	{GTKXCD_NUMIN, "", 0, 6, 0, 0, 999999},
+	{GTKXCD_CHECK, "Tracepoint, log message and continue:", 0},
+	{GTKXCD_ENTRY, ""},
+	{GTKXCD_LABEL, "Registers: A B L H I BA HL X Y XI YI SP PC V N F E U\nCounters: CYC TMR1 TMR2 TMR3 HITS"},
+	{GTKXCD_LABEL, "Memory: [addr] byte, W[addr] word\n{expr} in message for hex value, {expr:d} for decimal"},
+	{GTKXCD_EOL, ""}
+};
+
 static GtkXCustomDialog CPUWindow_GotoCartIRQ_CD[] = {
 	{GTKXCD_LABEL, "Go to cartridge IRQ:"},
 	{GTKXCD_COMBO, "", 0, 27, 0, 0, 0, CartridgeIRQVectStr},
@@ -2397,6 +2516,155 @@ static void Menu_Debug_ResetHard(GtkWidget *widget, gpointer data)
 	refresh_debug(1);
 }
 
+static const char *Menu_Profiler_Resolve(uint32_t addr, uint32_t *symaddr)
+{
+	SymbItem *item = SymbWindow_GetCodeSymb(addr);
+	if (!item) return NULL;
+	*symaddr = item->addr;
+	return item->name;
+}
+
+static void Menu_Debug_Profiler(GtkWidget *widget, gpointer data)
+{
+	set_emumode(EMUMODE_STOP, 1);
+	if (Profiler_Active) {
+		Profiler_Stop();
+		Add_InfoMessage("[Info] Profiler stopped, %i samples (%i dropped)\n", Profiler_Samples(), Profiler_Dropped());
+	} else if (Profiler_Start(0)) {
+		Add_InfoMessage("[Info] Profiler started\n");
+	} else {
+		MessageDialog(MainWindow, "Not enough memory for profiler", "Profiler error", GTK_MESSAGE_ERROR, NULL);
+	}
+	set_emumode(EMUMODE_RESTORE, 1);
+}
+
+static void Menu_Debug_ProfilerSave(GtkWidget *widget, gpointer data)
+{
+	char tmp[PMTMPV];
+	int index = (int)data, res;
+
+	set_emumode(EMUMODE_STOP, 1);
+	if (!Profiler_Cycles) {
+		MessageDialog(MainWindow, "Profiler wasn't started", "Profiler error", GTK_MESSAGE_ERROR, NULL);
+		set_emumode(EMUMODE_RESTORE, 1);
+		return;
+	}
+	strcpy(tmp, CommandLine.min_file);
+	RemoveExtension(tmp);
+	strcat(tmp, index ? "_cycles.txt" : ".folded");
+	if (index) res = SaveFileDialogEx(MainWindow, "Save cycles per address", tmp, tmp, "Text (*.txt)\0*.txt\0All (*.*)\0*.*\0", 0);
+	else res = SaveFileDialogEx(MainWindow, "Save folded stacks", tmp, tmp, "Folded stacks (*.folded)\0*.folded\0All (*.*)\0*.*\0", 0);
+	if (res) {
+		if (index) res = Profiler_SaveCycles(tmp, Menu_Profiler_Resolve);
+		else res = Profiler_SaveFolded(tmp, Menu_Profiler_Resolve);
+		if (res) Add_InfoMessage("[Info] Profiler results saved to '%s'\n", tmp);
+		else MessageDialog(MainWindow, "Error saving profiler results", "Profiler error", GTK_MESSAGE_ERROR, NULL);
+	}
+	set_emumode(EMUMODE_RESTORE, 1);
+}
+
+static void Menu_Debug_Coverage(GtkWidget *widget, gpointer data)
+{
+	set_emumode(EMUMODE_STOP, 1);
+	if (Coverage_Active) {
+		Coverage_Stop();
+		Add_InfoMessage("[Info] Coverage stopped, %u bytes executed, %u read, %u written\n",
+			Coverage_Count(COVERAGE_EXEC, 0, 0x200000), Coverage_Count(COVERAGE_READ, 0, 0x200000), Coverage_Count(COVERAGE_WRITE, 0, 0x200000));
+	} else if (Coverage_Start()) {
+		Add_InfoMessage("[Info] Coverage started\n");
+	} else {
+		MessageDialog(MainWindow, "Not enough memory for coverage", "Coverage error", GTK_MESSAGE_ERROR, NULL);
+	}
+	set_emumode(EMUMODE_RESTORE, 1);
+}
+
+static void Menu_Debug_CoverageShow(GtkWidget *widget, gpointer data)
+{
+	GtkWidget *widg = gtk_item_factory_get_item(ItemFactory, "/Debugger/Coverage/Show on program view");
+	dclc_coverage_overlay = (gtk_check_menu_item_get_active(GTK_CHECK_MENU_ITEM(widg)) == TRUE);
+	refresh_debug(1);
+}
+
+static void Menu_Debug_CoverageFile(GtkWidget *widget, gpointer data)
+{
+	char tmp[PMTMPV];
+	int index = (int)data, res;
+
+	set_emumode(EMUMODE_STOP, 1);
+	if (index && !Coverage_Bits) {
+		MessageDialog(MainWindow, "Coverage wasn't started", "Coverage error", GTK_MESSAGE_ERROR, NULL);
+		set_emumode(EMUMODE_RESTORE, 1);
+		return;
+	}
+	strcpy(tmp, CommandLine.min_file);
+	RemoveExtension(tmp);
+	strcat(tmp, ".pmcov");
+	if (index) res = SaveFileDialogEx(MainWindow, "Save and merge coverage", tmp, tmp, "PokeMini Coverage (*.pmcov)\0*.pmcov\0All (*.*)\0*.*\0", 0);
+	else res = OpenFileDialogEx(MainWindow, "Load and merge coverage", tmp, tmp, "PokeMini Coverage (*.pmcov)\0*.pmcov\0All (*.*)\0*.*\0", 0);
+	if (res) {
+		if (index) res = Coverage_Save(tmp, 1);
+		else res = Coverage_Load(tmp);
+		if (res) Add_InfoMessage("[Info] Coverage merged %s '%s'\n", index ? "into" : "from", tmp);
+		else MessageDialog(MainWindow, "Error merging coverage file", "Coverage error", GTK_MESSAGE_ERROR, NULL);
+	}
+	set_emumode(EMUMODE_RESTORE, 1);
+	refresh_debug(1);
+}
+
+static void Menu_Debug_CoverageClear(GtkWidget *widget, gpointer data)
+{
+	Coverage_Clear();
+	Add_InfoMessage("[Info] Coverage cleared\n");
+	refresh_debug(1);
+}
+
+static void Menu_Debug_RevRecord(GtkWidget *widget, gpointer data)
+{
+	GtkWidget *widg = gtk_item_factory_get_item(ItemFactory, "/Debugger/Reverse/Record history");
+	int enable = (gtk_check_menu_item_get_active(GTK_CHECK_MENU_ITEM(widg)) == TRUE);
+	if (enable == RevExec_Enabled) return;
+	set_emumode(EMUMODE_STOP, 1);
+	if (!PMHD_RevRecord(enable)) {
+		MessageDialog(MainWindow, "Not enough memory for history", "Reverse error", GTK_MESSAGE_ERROR, NULL);
+		gtk_check_menu_item_set_active(GTK_CHECK_MENU_ITEM(widg), 0);
+	} else if (enable) {
+		Add_InfoMessage("[Info] Recording history for reverse execution\n");
+	} else {
+		Add_InfoMessage("[Info] History stopped\n");
+	}
+	set_emumode(EMUMODE_RESTORE, 1);
+}
+
+static void Menu_Debug_RevStepBack(GtkWidget *widget, gpointer data)
+{
+	if (!RevExec_Enabled) {
+		Set_StatusLabel("[Reverse] History isn't being recorded");
+		return;
+	}
+	set_emumode(EMUMODE_STOP, 0);
+	if (!PMHD_RevStepBack(1)) Set_StatusLabel("[Reverse] Reached oldest step in history");
+	refresh_debug(1);
+}
+
+static void Menu_Debug_RevContinue(GtkWidget *widget, gpointer data)
+{
+	if (!RevExec_Enabled) {
+		Set_StatusLabel("[Reverse] History isn't being recorded");
+		return;
+	}
+	set_emumode(EMUMODE_STOP, 0);
+	PMHD_RevContinue();
+	refresh_debug(1);
+}
+
+static void Menu_Debug_AnalyzeCode(GtkWidget *widget, gpointer data)
+{
+	set_emumode(EMUMODE_STOP, 1);
+	ProgramView_AnalyzeCode(1);
+	set_emumode(EMUMODE_RESTORE, 1);
+	refresh_debug(1);
+}
+
 static void Menu_Debug_ResetSoft(GtkWidget *widget, gpointer data)
 {
 	Add_InfoMessage("[Info] Emulator has been soft reset (Partial)\n");
@@ -2446,6 +2714,59 @@ static void Menu_Break_DelAllBP(GtkWidget *widget, gpointer data)
 	refresh_debug(1);
 }
 
+static void Menu_Break_AddCondBP(GtkWidget *widget, gpointer data)
+{
+	char err[PMTMPV];
+	uint32_t addr;
+
+	set_emumode(EMUMODE_STOP, 1);
+
+	CPUWindow_AddCondBP_CD[1].number = PhysicalPC();
+	if (CustomDialog(MainWindow, "Add conditional breakpoint...", CPUWindow_AddCondBP_CD)) {
+		addr = CPUWindow_AddCondBP_CD[2].number ? BREAKCOND_ANYWHERE : CPUWindow_AddCondBP_CD[1].number;
+		if (BreakCond_Add(addr, CPUWindow_AddCondBP_CD[4].text,
+			CPUWindow_AddCondBP_CD[7].number ? BREAKCOND_LOG : BREAKCOND_BREAK,
+			CPUWindow_AddCondBP_CD[8].text, CPUWindow_AddCondBP_CD[6].number, err) < 0) {
+			MessageDialog(MainWindow, err, "Add conditional breakpoint...", GTK_MESSAGE_ERROR, NULL);
+		}
+		PMHD_BreakCondUpdate();
+		refresh_debug(1);
+	}
+
+	set_emumode(EMUMODE_RESTORE, 1);
+}
+
+static void Menu_Break_ListCondBP(GtkWidget *widget, gpointer data)
+{
+	TBreakCond *bc;
+	int i;
+
+	if (!BreakCond_Num()) {
+		Add_InfoMessage("[Info] No conditional breakpoints\n");
+		return;
+	}
+	for (i=0; i<BreakCond_Num(); i++) {
+		bc = BreakCond_Get(i);
+		if (bc->addr == BREAKCOND_ANYWHERE) Add_InfoMessage("[Info] #%i Any address", i);
+		else Add_InfoMessage("[Info] #%i $%06X", i, (int)bc->addr);
+		Add_InfoMessage(" if (%s), %u hits", bc->cond[0] ? bc->cond : "always", (unsigned int)bc->hits);
+		if (bc->action == BREAKCOND_LOG) Add_InfoMessage(", log \"%s\"\n", bc->log);
+		else Add_InfoMessage(", break from hit %u\n", (unsigned int)bc->passcount);
+	}
+}
+
+static void Menu_Break_ResetHits(GtkWidget *widget, gpointer data)
+{
+	BreakCond_ResetHits();
+}
+
+static void Menu_Break_DelAllCondBP(GtkWidget *widget, gpointer data)
+{
+	BreakCond_ClearAll();
+	PMHD_BreakCondUpdate();
+	refresh_debug(1);
+}
+
 static void Menu_Break_EnableWP(GtkWidget *widget, gpointer data)
 {
 	GtkWidget *widg = gtk_item_factory_get_item(ItemFactory, "/Break/Enable watchpoints");
@@ -2465,14 +2786,39 @@ static void Menu_Break_AddWPAt(GtkWidget *widget, gpointer data)
 	if (CustomDialog(MainWindow, "Add watchpoing at...", AnyView_AddWPAt_CD)) {
 		for (i=0; i<AnyView_AddWPAt_CD[3].number; i++) {
 			num = AnyView_AddWPAt_CD[1].number + i;
-			if ((num < 0) || (num >= PM_ROM_Size)) {
+			if ((num < 0) || (num >= WATCHPOINTS_SIZE)) {
 				MessageDialog(MainWindow, "Address out of range", "Add watchpoint at...", GTK_MESSAGE_ERROR, NULL);
 				set_emumode(EMUMODE_RESTORE, 1);
 				return;
 			}
-			PMD_TrapPoints[num] &= ~TRAPPOINT_WATCH;
-			if (AnyView_AddWPAt_CD[5].number) PMD_TrapPoints[num] |= TRAPPOINT_WATCHREAD;
-			if (AnyView_AddWPAt_CD[6].number) PMD_TrapPoints[num] |= TRAPPOINT_WATCHWRITE;
+			WatchPoints_Set(num, (AnyView_AddWPAt_CD[5].number ? TRAPPOINT_WATCHREAD : 0) | (AnyView_AddWPAt_CD[6].number ? TRAPPOINT_WATCHWRITE : 0));
+		}
+		refresh_debug(1);
+	}
+
+	set_emumode(EMUMODE_RESTORE, 1);
+}
+
+static void Menu_Break_AddWPRange(GtkWidget *widget, gpointer data)
+{
+	int flags;
+
+	set_emumode(EMUMODE_STOP, 1);
+
+	AnyView_AddWPRange_CD[1].number = 0x1000;
+	AnyView_AddWPRange_CD[3].number = 0x1FFF;
+	AnyView_AddWPRange_CD[5].number = 0;
+	AnyView_AddWPRange_CD[6].number = 1;
+	AnyView_AddWPRange_CD[7].number = 0;
+	if (CustomDialog(MainWindow, "Add range watchpoint...", AnyView_AddWPRange_CD)) {
+		flags = (AnyView_AddWPRange_CD[5].number ? WATCHPOINT_READ : 0) | (AnyView_AddWPRange_CD[6].number ? WATCHPOINT_WRITE : 0);
+		if (AnyView_AddWPRange_CD[1].number > AnyView_AddWPRange_CD[3].number) {
+			MessageDialog(MainWindow, "Start address is after end address", "Add range watchpoint...", GTK_MESSAGE_ERROR, NULL);
+		} else if (!flags) {
+			MessageDialog(MainWindow, "No access selected", "Add range watchpoint...", GTK_MESSAGE_ERROR, NULL);
+		} else if (!WatchPoints_AddRange(AnyView_AddWPRange_CD[1].number, AnyView_AddWPRange_CD[3].number, flags,
+			AnyView_AddWPRange_CD[7].number ? AnyView_AddWPRange_CD[8].number : -1)) {
+			MessageDialog(MainWindow, "Too many range watchpoints", "Add range watchpoint...", GTK_MESSAGE_ERROR, NULL);
 		}
 		refresh_debug(1);
 	}
@@ -2482,8 +2828,7 @@ static void Menu_Break_AddWPAt(GtkWidget *widget, gpointer data)
 
 static void Menu_Break_DelAllWP(GtkWidget *widget, gpointer data)
 {
-	int i;
-	for (i=0; i<PM_ROM_Size; i++) PMD_TrapPoints[i] &= ~TRAPPOINT_WATCH;
+	WatchPoints_ClearAll();
 	refresh_debug(1);
 }
 
@@ -2754,6 +3099,8 @@ TMenu_items_accel Menu_item_accel[] = {
 	{ SDLK_F3, 0, Menu_Debug_SingleStep },
 	{ SDLK_F3, 2, Menu_Debug_StepSkip },
 	{ SDLK_F2, 0, Menu_Debug_Stop },
+	{ SDLK_F3, 4, Menu_Debug_RevStepBack },
+	{ SDLK_F5, 4, Menu_Debug_RevContinue },
 	{ SDLK_r,  1, Menu_Debug_ResetHard },
 	{ SDLK_r,  2, Menu_Debug_ResetSoft },
 	{ 0, 0, NULL }
@@ -2917,6 +3264,21 @@ static GtkItemFactoryEntry CPUWindow_MenuItems[] = {
 	{ "/Debugger/PRC/Stall _CPU",            NULL,           Menu_DebPRC_StallCPU,         0, "<CheckItem>" },
 	{ "/Debugger/PRC/Stall _Cycles...",      NULL,           Menu_DebPRC_StallCycles,      0, "<Item>" },
 	{ "/Debugger/_IRQ call...",              NULL,           Menu_Debug_IRQCall,           0, "<Item>" },
+	{ "/Debugger/_Analyze code",             NULL,           Menu_Debug_AnalyzeCode,       0, "<Item>" },
+	{ "/Debugger/_Coverage",                 NULL,           NULL,                         0, "<Branch>" },
+	{ "/Debugger/Coverage/Start & Stop",     NULL,           Menu_Debug_Coverage,          0, "<Item>" },
+	{ "/Debugger/Coverage/Show on program view", NULL,       Menu_Debug_CoverageShow,      0, "<CheckItem>" },
+	{ "/Debugger/Coverage/Load and merge...", NULL,          Menu_Debug_CoverageFile,      0, "<Item>" },
+	{ "/Debugger/Coverage/Save and merge...", NULL,          Menu_Debug_CoverageFile,      1, "<Item>" },
+	{ "/Debugger/Coverage/Clear",            NULL,           Menu_Debug_CoverageClear,     0, "<Item>" },
+	{ "/Debugger/Pro_filer",                 NULL,           NULL,                         0, "<Branch>" },
+	{ "/Debugger/Profiler/Start & Stop",     NULL,           Menu_Debug_Profiler,          0, "<Item>" },
+	{ "/Debugger/Profiler/Save folded stacks...", NULL,      Menu_Debug_ProfilerSave,      0, "<Item>" },
+	{ "/Debugger/Profiler/Save cycles per address...", NULL, Menu_Debug_ProfilerSave,      1, "<Item>" },
+	{ "/Debugger/Re_verse",                  NULL,           NULL,                         0, "<Branch>" },
+	{ "/Debugger/Reverse/Record _history",   NULL,           Menu_Debug_RevRecord,         0, "<CheckItem>" },
+	{ "/Debugger/Reverse/Step _back",        "<ALT>F3",      Menu_Debug_RevStepBack,       0, "<Item>" },
+	{ "/Debugger/Reverse/Reverse _continue", "<ALT>F5",      Menu_Debug_RevContinue,       0, "<Item>" },
 	{ "/Debugger/_Reset",                    NULL,           NULL,                         0, "<Branch>" },
 	{ "/Debugger/Reset/_Soft (Partial)",     "<SHIFT>R",     Menu_Debug_ResetSoft,         0, "<Item>" },
 	{ "/Debugger/Reset/_Hard (Full)",        "<CTRL>R",      Menu_Debug_ResetHard,         0, "<Item>" },
@@ -2926,9 +3288,14 @@ static GtkItemFactoryEntry CPUWindow_MenuItems[] = {
 	{ "/Break/_Add breakpoint at...",        "<SHIFT>B",     Menu_Break_AddBPAt,           0, "<Item>" },
 	{ "/Break/_Delete breakpoint at...",     "<CTRL><SHIFT>B",Menu_Break_DelBPAt,          0, "<Item>" },
 	{ "/Break/_Delete all breakpoints",      NULL,           Menu_Break_DelAllBP,          0, "<Item>" },
+	{ "/Break/Add _conditional breakpoint...",NULL,          Menu_Break_AddCondBP,         0, "<Item>" },
+	{ "/Break/_List conditional breakpoints", NULL,          Menu_Break_ListCondBP,        0, "<Item>" },
+	{ "/Break/_Reset hit counts",            NULL,           Menu_Break_ResetHits,         0, "<Item>" },
+	{ "/Break/Delete all conditional breakpoints", NULL,     Menu_Break_DelAllCondBP,      0, "<Item>" },
 	{ "/Break/sep1",                         NULL,           NULL,                         0, "<Separator>" },
 	{ "/Break/_Enable watchpoints",          "<ALT><SHIFT>W",Menu_Break_EnableWP,          0, "<CheckItem>" },
 	{ "/Break/_Add Watchpoint at...",        "<SHIFT>W",     Menu_Break_AddWPAt,           0, "<Item>" },
+	{ "/Break/Add _range watchpoint...",     NULL,           Menu_Break_AddWPRange,        0, "<Item>" },
 	{ "/Break/_Delete all watchpoints",      NULL,           Menu_Break_DelAllWP,          0, "<Item>" },
 	{ "/Break/sep1",                         NULL,           NULL,                         0, "<Separator>" },
 	{ "/Break/_Enable exceptions",           NULL,           Menu_Break_EnableEx,          0, "<CheckItem>" },
@@ -3050,7 +3417,7 @@ int CPUWindow_Create(void)
 
 	// Program View
 	ProgramView.on_exposure = SGtkXDVCB(ProgramView_exposure);
-	ProgramView.on_scroll = SGtkXDVCB(AnyView_scroll);
+	ProgramView.on_scroll = SGtkXDVCB(ProgramView_scroll);
 	ProgramView.on_resize = SGtkXDVCB(ProgramView_resize);
 	ProgramView.on_motion = SGtkXDVCB(AnyView_motion);
 	ProgramView.on_buttonpress = SGtkXDVCB(ProgramView_buttonpress);
@@ -3178,6 +3545,8 @@ void CPUWindow_Destroy(void)
 	dclc_cpuwin_winw = width;
 	dclc_cpuwin_winh = height;
 	CPUWindow_CheckDirtyROM();
+	CodeMap_Destroy(ProgramView_CodeMap);
+	ProgramView_CodeMap = NULL;
 }
 
 void CPUWindow_Activate(void)
@@ -3374,6 +3743,8 @@ void CPUWindow_UpdateConfigs(void)
 	if (dclc_followPC) gtk_check_menu_item_set_active(GTK_CHECK_MENU_ITEM(widg), 1);
 	widg = gtk_item_factory_get_item(ItemFactory, "/Debugger/Follow SP");
 	if (dclc_followSP) gtk_check_menu_item_set_active(GTK_CHECK_MENU_ITEM(widg), 1);
+	widg = gtk_item_factory_get_item(ItemFactory, "/Debugger/Coverage/Show on program view");
+	if (dclc_coverage_overlay) gtk_check_menu_item_set_active(GTK_CHECK_MENU_ITEM(widg), 1);
 	widg = gtk_item_factory_get_item(ItemFactory, "/Debugger/PRC/Show Background");
 	if (dclc_PRC_bg) gtk_check_menu_item_set_active(GTK_CHECK_MENU_ITEM(widg), 1);
 	widg = gtk_item_factory_get_item(ItemFactory, "/Debugger/PRC/Show Sprites");
@@ -3453,6 +3824,11 @@ void CPUWindow_ROMResized(void)
 
 void CPUWindow_EmumodeChanged(void)
 {
+	// Code reached through indirect jumps
+	if ((emumode == EMUMODE_STOP) && ProgramView_CodeMap && !CodeMap_IsCode(ProgramView_CodeMap, PhysicalPC())) {
+		CodeMap_AddEntry(ProgramView_CodeMap, MinxCPU_OnRead, PhysicalPC());
+		ProgramView.first_addr = -1;
+	}
 	if (dclc_followPC) ProgramView_GotoAddr(PhysicalPC(), 0);
 	if (dclc_followSP) StackView_GotoSP();
 }
@@ -40,16 +40,6 @@ extern char ColorInfoFile[256];
 // Process menu item accelerator, execute callback and return if match
 int ProcessMenuItemAccel(int key, int modifier, TMenu_items_accel *list);
 
-// Messaging
-void Set_StatusLabel(const char *format, ...);
-void Add_InfoMessage(const char *format, ...);
-void Cmd_DebugOutput(int ctrl);
-void Add_DebugOutputChar(unsigned char ch);
-void Add_DebugOutputBinary(unsigned char bin);
-void Add_DebugOutputNumber8(unsigned char num, int reg);
-void Add_DebugOutputNumber16(unsigned char num, int reg);
-void Add_DebugOutputFixed8_8(unsigned char num, int reg);
-
 // Callbacks
 void PMDebug_OnLoadBIOSFile(const char *filename, int success);
 void PMDebug_OnLoadMINFile(const char *filename, int success);
@@ -69,6 +59,9 @@ uint32_t ProgramView_Recalc(uint32_t addr);
 // Syncronize program view
 int ProgramView_Sync(void);
 
+// Analyze code from vectors and PC
+void ProgramView_AnalyzeCode(int verbose);
+
 // Program view go to addr
 void ProgramView_GotoAddr(uint32_t addr, int highlight);
 
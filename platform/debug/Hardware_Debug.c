@@ -24,9 +24,11 @@
 
 #include "PokeMini.h"
 #include "InstructionProc.h"
+#include "TraceFile.h"
+#include "RevExec.h"
 #include "PokeMini_Debug.h"
 #include "Hardware_Debug.h"
-#include "CPUWindow.h"
+#include "Profiler.h"
 
 int PMD_TrapFound = 0;
 int PMD_EnableBreakpoints = 1;
@@ -39,12 +41,20 @@ int PMD_MessageWatchpoints = 0;
 int PMD_MessageExceptions = 1;
 int PMD_MessageHalt = 0;
 int PMD_MessageStop = 1;
-uint8_t *PMD_TrapPoints;	// Trap points for breakpoint & watchpoint:
-				// &1 = Breakpoint, &16 = Watchpoint Read, &32 = Watchpoint Write
+uint8_t *PMD_TrapPoints;	// Trap points for breakpoint, &1 = Breakpoint
+				// Watchpoints are in WatchPoints.h
+int PMD_WatchHitAccess = -1;	// Last watchpoint hit, -1 = None, 0 = Read, 1 = Write
+uint32_t PMD_WatchHitAddr = 0;
 
 uint32_t TRACAddr[TRACECODE_LENGTH];	// 0xFFFFFFFF == Invalid
 int TRACPoint = 0;
 
+TTraceWriter *PMD_TraceWriter = NULL;	// Run trace recording
+static TTraceEntry PMD_TraceEntry;	// Instruction being executed
+static uint64_t PMD_TraceCycle = 0;
+
+uint64_t PMD_CycleCount = 0;	// Cycles since hard reset
+
 int CYCTmr1Ena = 0;		// Cycles Timer 1
 uint32_t CYCTmr1Cnt = 0;
 int CYCTmr2Ena = 0;		// Cycles Timer 2
@@ -73,17 +83,20 @@ static void BreakpointReport(void)
 static void WatchpointReport(int access, uint32_t addr)
 {
 	int val;
+	PMD_WatchHitAccess = access;
+	PMD_WatchHitAddr = addr;
+	if (RevExec_Replaying) return;
 	if (dclc_fullrange) {
 		if (MinxCPU.PC.W.L >= 0x8000) {
 			val = (MinxCPU.PC.B.I << 15) | (MinxCPU.PC.W.L & 0x7FFF);
-			if (PMD_MessageBreakpoints) Add_InfoMessage("[Break] Watchpoint at $%06X before $%06X", access ? "write" : "read", (int)addr, val);
-			else Set_StatusLabel("[Break] Watchpoint at $%06X before $%06X", access ? "write" : "read", (int)addr, val);
+			if (PMD_MessageWatchpoints) Add_InfoMessage("[Break] Watchpoint %s at $%06X before $%06X", access ? "write" : "read", (int)addr, val);
+			else Set_StatusLabel("[Break] Watchpoint %s at $%06X before $%06X", access ? "write" : "read", (int)addr, val);
 		} else {
-			if (PMD_MessageBreakpoints) Add_InfoMessage("[Break] Watchpoint at $%06X before $%06X", access ? "write" : "read", (int)addr, (int)MinxCPU.PC.W.L);
-			else Set_StatusLabel("[Break] Watchpoint at $%06X before $%06X", access ? "write" : "read", (int)addr, (int)MinxCPU.PC.W.L);
+			if (PMD_MessageWatchpoints) Add_InfoMessage("[Break] Watchpoint %s at $%06X before $%06X", access ? "write" : "read", (int)addr, (int)MinxCPU.PC.W.L);
+			else Set_StatusLabel("[Break] Watchpoint %s at $%06X before $%06X", access ? "write" : "read", (int)addr, (int)MinxCPU.PC.W.L);
 		}
 	} else {
-		if (PMD_MessageBreakpoints) Add_InfoMessage("[Break] Watchpoint %s at $%06X before (%02X)$%04X", access ? "write" : "read", (int)addr, (int)MinxCPU.PC.B.I, (int)MinxCPU.PC.W.L);
+		if (PMD_MessageWatchpoints) Add_InfoMessage("[Break] Watchpoint %s at $%06X before (%02X)$%04X", access ? "write" : "read", (int)addr, (int)MinxCPU.PC.B.I, (int)MinxCPU.PC.W.L);
 		else Set_StatusLabel("[Break] Watchpoint %s at $%06X before (%02X)$%04X", access ? "write" : "read", (int)addr, (int)MinxCPU.PC.B.I, (int)MinxCPU.PC.W.L);
 	}
 }
@@ -106,6 +119,9 @@ int PMHD_MINLoaded(void)
 		memset(PMD_TrapPoints, 0, PM_ROM_Size);
 		PM_ROM_OldSize = PM_ROM_Size;
 	}
+	BreakCond_SetHost(MinxCPU_OnRead, &PMD_CycleCount, &CYCTmr1Cnt, &CYCTmr2Cnt, &CYCTmr3Cnt);
+	PMHD_BreakCondUpdate();
+	RevExec_Restart();
 
 	return 1;
 }
@@ -117,6 +133,23 @@ void PMHD_FreeResources(void)
 		free(PMD_TrapPoints);
 		PMD_TrapPoints = NULL;
 	}
+	WatchPoints_Free();
+	BreakCond_ClearAll();
+	PMHD_RevRecord(0);
+}
+
+// Update trap points after changing conditional breakpoints
+void PMHD_BreakCondUpdate(void)
+{
+	TBreakCond *bc;
+	int i;
+
+	if (!PMD_TrapPoints) return;
+	for (i=0; i<PM_ROM_Size; i++) PMD_TrapPoints[i] &= ~TRAPPOINT_COND;
+	for (i=0; i<BreakCond_Num(); i++) {
+		bc = BreakCond_Get(i);
+		if (bc->enabled && (bc->addr != BREAKCOND_ANYWHERE)) PMD_TrapPoints[bc->addr & PM_ROM_Mask] |= TRAPPOINT_COND;
+	}
 }
 
 // System reset
@@ -125,39 +158,221 @@ void PMHD_Reset(int hardreset)
 	int i;
 	for (i=0; i<TRACECODE_LENGTH; i++) TRACAddr[i] = 0xFFFFFFFF;
 	TRACPoint = 0;
+	if (hardreset) PMD_CycleCount = 0;
+	RevExec_Restart();
+}
+
+// Tracepoint message
+static void PMHD_BreakCondLog(const char *msg)
+{
+	Add_InfoMessage("[Trace] %s\n", msg);
+}
+
+// Prepare trace entry before executing
+static void PMHD_TraceRecordBegin(int stall)
+{
+	TTraceEntry *entry = &PMD_TraceEntry;
+	int size;
+	entry->cycle = PMD_TraceCycle;
+	entry->pc = PhysicalPC();
+	entry->status = MinxCPU.Status;
+	entry->numaccess = 0;
+	if (!stall && (MinxCPU.Status == MINX_STATUS_NORMAL)) {
+		GetInstructionInfo(MinxCPU_OnRead, 0, entry->pc, entry->opcode, &size);
+		entry->oplen = (size > 4) ? 4 : size;
+	} else entry->oplen = 0;
+}
+
+// Store executed instruction
+static void PMHD_TraceRecordStep(int cylc)
+{
+	TTraceEntry *entry = &PMD_TraceEntry;
+	entry->cycles = cylc;
+	entry->regs[TRACEREG_A] = MinxCPU.BA.B.L;
+	entry->regs[TRACEREG_B] = MinxCPU.BA.B.H;
+	entry->regs[TRACEREG_L] = MinxCPU.HL.B.L;
+	entry->regs[TRACEREG_H] = MinxCPU.HL.B.H;
+	entry->regs[TRACEREG_I] = MinxCPU.HL.B.I;
+	entry->regs[TRACEREG_XL] = MinxCPU.X.B.L;
+	entry->regs[TRACEREG_XH] = MinxCPU.X.B.H;
+	entry->regs[TRACEREG_XI] = MinxCPU.X.B.I;
+	entry->regs[TRACEREG_YL] = MinxCPU.Y.B.L;
+	entry->regs[TRACEREG_YH] = MinxCPU.Y.B.H;
+	entry->regs[TRACEREG_YI] = MinxCPU.Y.B.I;
+	entry->regs[TRACEREG_SPL] = MinxCPU.SP.B.L;
+	entry->regs[TRACEREG_SPH] = MinxCPU.SP.B.H;
+	entry->regs[TRACEREG_N] = MinxCPU.N.B.H;
+	entry->regs[TRACEREG_F] = MinxCPU.F;
+	entry->regs[TRACEREG_U] = MinxCPU.U1;
+	if (!TraceWriter_Add(PMD_TraceWriter, entry)) {
+		PMHD_TraceRecordStop();
+		Add_InfoMessage("[Error] Run trace write error, recording stopped\n");
+		return;
+	}
+	PMD_TraceCycle += cylc;
+}
+
+// Store memory access, opcode fetch is already in the entry
+static inline void PMHD_TraceRecordAccess(uint32_t addr, uint8_t data, int write)
+{
+	TTraceEntry *entry = &PMD_TraceEntry;
+	if (!write && (addr - entry->pc < entry->oplen)) return;
+	if (entry->numaccess >= TRACEFILE_MAXACCESS) return;
+	entry->access[entry->numaccess].addr = addr;
+	entry->access[entry->numaccess].data = data;
+	entry->access[entry->numaccess].write = write;
+	entry->numaccess++;
+}
+
+// Start recording run trace to file
+int PMHD_TraceRecordStart(const char *filename)
+{
+	PMHD_TraceRecordStop();
+	PMD_TraceWriter = TraceWriter_Open(filename);
+	if (!PMD_TraceWriter) return 0;
+	PMD_TraceCycle = 0;
+	return 1;
+}
+
+// Stop recording run trace
+int PMHD_TraceRecordStop(void)
+{
+	TTraceWriter *tw = PMD_TraceWriter;
+	if (!tw) return 1;
+	PMD_TraceWriter = NULL;
+	return TraceWriter_Close(tw);
+}
+
+// Execute instruction, recording trace if enabled
+// Flags are synced after each instruction so the debugger always sees them
+static inline int PMHD_Exec(void)
+{
+	int cylc;
+	if (!PMD_TraceWriter || RevExec_Replaying) {
+		cylc = Profiler_Exec();
+		MinxCPU_SyncFlags();
+		return cylc;
+	}
+	PMHD_TraceRecordBegin(0);
+	cylc = Profiler_Exec();
+	MinxCPU_SyncFlags();
+	PMHD_TraceRecordStep(cylc);
+	return cylc;
+}
+
+// CPU stalled by PRC
+static inline int PMHD_Stall(void)
+{
+	if (PMD_TraceWriter && !RevExec_Replaying) {
+		PMHD_TraceRecordBegin(1);
+		PMHD_TraceRecordStep(StallCycles);
+	}
+	return StallCycles;
 }
 
 static inline int PokeMini_BreakPointTest(int cylc)
 {
 	uint32_t pmaddr = PhysicalPC() & PM_ROM_Mask;
+	uint8_t trap;
 	TRACAddr[TRACPoint] = pmaddr;
 	TRACPoint--;
 	if (TRACPoint < 0) TRACPoint = TRACECODE_LENGTH - 1;
+	PMD_CycleCount += cylc;
 	if (CYCTmr1Ena) CYCTmr1Cnt += cylc;
 	if (CYCTmr2Ena) CYCTmr2Cnt += cylc;
 	if (CYCTmr3Ena) CYCTmr3Cnt += cylc;
-	if ((PMD_TrapPoints[pmaddr] & TRAPPOINT_BREAK) && PMD_EnableBreakpoints) {
+	if (!PMD_EnableBreakpoints) return 0;
+	trap = PMD_TrapPoints[pmaddr];
+	if (trap & TRAPPOINT_BREAK) return 1;
+	if ((trap & TRAPPOINT_COND) && BreakCond_Test(PhysicalPC(), RevExec_Replaying ? NULL : PMHD_BreakCondLog)) return 1;
+	if (BreakCond_Anywhere && BreakCond_Test(BREAKCOND_ANYWHERE, RevExec_Replaying ? NULL : PMHD_BreakCondLog)) return 1;
+	return 0;
+}
+
+// Execute instruction or stall and sync hardware, return 1 on breakpoint
+// This is the unit of reverse execution, replay must match recording
+static inline int PMHD_Step(int sound)
+{
+	int trap;
+	if (StallCPU) PokeHWCycles = PMHD_Stall();
+	else PokeHWCycles = PMHD_Exec();
+	MinxTimers_Sync();
+	MinxPRC_Sync();
+	if (sound) MinxAudio_Sync();
+	trap = PokeMini_BreakPointTest(PokeHWCycles);
+	RevExec_Record();
+	return trap;
+}
+
+// Replay step for reverse execution, audio isn't generated
+static int PMHD_ReplayStep(void)
+{
+	PMD_TrapFound = 0;
+	if (PMHD_Step(0)) PMD_TrapFound = 1;
+	return PMD_TrapFound;
+}
+
+// Start or stop recording history for reverse execution
+int PMHD_RevRecord(int enable)
+{
+	if (!enable) {
+		if (PokeMini_CustomKeypadEvent == RevExec_KeypadEvent) PokeMini_CustomKeypadEvent = NULL;
+		RevExec_Stop();
 		return 1;
 	}
-	return 0;
+	if (RevExec_Enabled) return 1;
+	if (!RevExec_Start(REVEXEC_DEFSNAPS, &PMD_CycleCount)) return 0;
+	PokeMini_CustomKeypadEvent = RevExec_KeypadEvent;
+	return 1;
 }
 
-// Emulate single instruction, return cycles ran
-int PokeMini_EmulateStep(void)
+// Messages and debug output are muted while replaying
+static void PMHD_RevMute(int mute)
 {
-	if (RequireSoundSync) {
-		if (StallCPU) PokeHWCycles = StallCycles;
-		else PokeHWCycles = MinxCPU_Exec();
-		MinxTimers_Sync();
-		MinxPRC_Sync();
-		MinxAudio_Sync();
+	static int msg[5], debugout;
+	if (mute) {
+		msg[0] = PMD_MessageExceptions; PMD_MessageExceptions = 0;
+		msg[1] = PMD_MessageHalt; PMD_MessageHalt = 0;
+		msg[2] = PMD_MessageStop; PMD_MessageStop = 0;
+		debugout = dclc_debugout; dclc_debugout = 0;
 	} else {
-		if (StallCPU) PokeHWCycles = StallCycles;
-		else PokeHWCycles = MinxCPU_Exec();
-		MinxTimers_Sync();
-		MinxPRC_Sync();
+		PMD_MessageExceptions = msg[0];
+		PMD_MessageHalt = msg[1];
+		PMD_MessageStop = msg[2];
+		dclc_debugout = debugout;
 	}
-	if (PokeMini_BreakPointTest(PokeHWCycles)) {
+}
+
+// Step back, return 0 if out of history
+int PMHD_RevStepBack(int steps)
+{
+	int res;
+	if (!RevExec_Enabled) return 0;
+	PMHD_RevMute(1);
+	res = RevExec_StepBack(PMHD_ReplayStep, (uint64_t)steps);
+	PMHD_RevMute(0);
+	PMD_TrapFound = 0;
+	return res;
+}
+
+// Run backwards until the previous trap, return 0 if reached the oldest step
+int PMHD_RevContinue(void)
+{
+	int res;
+	if (!RevExec_Enabled) return 0;
+	PMHD_RevMute(1);
+	res = RevExec_ContinueBack(PMHD_ReplayStep);
+	PMHD_RevMute(0);
+	PMD_TrapFound = 0;
+	if (res) Set_StatusLabel("[Reverse] Stopped at (%02X)$%04X", (int)MinxCPU.PC.B.I, (int)MinxCPU.PC.W.L);
+	else Set_StatusLabel("[Reverse] Reached oldest step in history");
+	return res;
+}
+
+// Emulate single instruction, return cycles ran
+int PokeMini_EmulateStep(void)
+{
+	if (PMHD_Step(RequireSoundSync)) {
 		set_emumode(EMUMODE_STOP, 0);
 		BreakpointReport();
 	}
@@ -172,7 +387,7 @@ int PokeMini_EmulateStepSkip(void)
 	if (pp >= 0x8000) {
 		pp = (MinxCPU.PC.B.I << 15) | (pp & 0x7FFF);
 	}
-	GetInstructionInfo(MinxCPU_OnRead, 1, pp, NULL, &size);
+	GetInstructionInfo(MinxCPU_OnRead, 0, pp, NULL, &size);
 	MinxCPU.PC.W.L += size;
 
 	return size;
@@ -185,16 +400,11 @@ int PokeMini_EmulateCycles(int lcylc)
 
 	if (RequireSoundSync) {
 		while (lcylc > 0) {
-			if (StallCPU) PokeHWCycles = StallCycles;
-			else PokeHWCycles = MinxCPU_Exec();
-			MinxTimers_Sync();
-			MinxPRC_Sync();
-			MinxAudio_Sync();
-			lcylc -= PokeHWCycles;
-			if (PokeMini_BreakPointTest(PokeHWCycles)) {
+			if (PMHD_Step(1)) {
 				PMD_TrapFound = 1;
 				BreakpointReport();
 			}
+			lcylc -= PokeHWCycles;
 			if (PMD_TrapFound) {
 				set_emumode(EMUMODE_STOP, 0);
 				return lcylc;
@@ -202,15 +412,11 @@ int PokeMini_EmulateCycles(int lcylc)
 		}
 	} else {
 		while (lcylc > 0) {
-			if (StallCPU) PokeHWCycles = StallCycles;
-			else PokeHWCycles = MinxCPU_Exec();
-			MinxTimers_Sync();
-			MinxPRC_Sync();
-			lcylc -= PokeHWCycles;
-			if (PokeMini_BreakPointTest(PokeHWCycles)) {
+			if (PMHD_Step(0)) {
 				PMD_TrapFound = 1;
 				BreakpointReport();
 			}
+			lcylc -= PokeHWCycles;
 			if (PMD_TrapFound) {
 				set_emumode(EMUMODE_STOP, 0);
 				return lcylc;
@@ -225,19 +431,33 @@ int PokeMini_EmulateCycles(int lcylc)
 static int PokeMini_EmulateFrameRun;
 int PokeMini_EmulateFrame(void)
 {
-	int lcylc = 0;
+	int lcylc = 0, cylc;
 
 	PMD_TrapFound = 0;
 	PokeMini_EmulateFrameRun = 1;
 
-	if (RequireSoundSync) {
+	if (RevExec_Enabled) {
+		// Sync every step while recording history
+		while (PokeMini_EmulateFrameRun) {
+			if (PMHD_Step(RequireSoundSync)) {
+				PMD_TrapFound = 1;
+				BreakpointReport();
+			}
+			lcylc += PokeHWCycles;
+			if (PMD_TrapFound) {
+				set_emumode(EMUMODE_STOP, 0);
+				return lcylc;
+			}
+		}
+	} else if (RequireSoundSync) {
 		while (PokeMini_EmulateFrameRun) {
 			PokeHWCycles = 0;
 			while (PokeHWCycles < CommandLine.synccycles) {
-				if (StallCPU) PokeHWCycles += StallCycles;
+				if (StallCPU) PokeHWCycles += PMHD_Stall();
 				else {
-					PokeHWCycles += MinxCPU_Exec();
-					if (PokeMini_BreakPointTest(PokeHWCycles)) {
+					cylc = PMHD_Exec();
+					PokeHWCycles += cylc;
+					if (PokeMini_BreakPointTest(cylc)) {
 						PMD_TrapFound = 1;
 						BreakpointReport();
 					}
@@ -259,10 +479,11 @@ int PokeMini_EmulateFrame(void)
 		while (PokeMini_EmulateFrameRun) {
 			PokeHWCycles = 0;
 			while (PokeHWCycles < CommandLine.synccycles) {
-				if (StallCPU) PokeHWCycles += StallCycles;
+				if (StallCPU) PokeHWCycles += PMHD_Stall();
 				else {
-					PokeHWCycles += MinxCPU_Exec();
-					if (PokeMini_BreakPointTest(PokeHWCycles)) {
+					cylc = PMHD_Exec();
+					PokeHWCycles += cylc;
+					if (PokeMini_BreakPointTest(cylc)) {
 						PMD_TrapFound = 1;
 						BreakpointReport();
 					}
@@ -287,12 +508,8 @@ int PokeMini_EmulateFrame(void)
 // Internal Processing
 // -------------------
 
-uint8_t MinxCPU_OnRead(int cpu, uint32_t addr)
+static inline uint8_t PMHD_OnRead(int cpu, uint32_t addr)
 {
-	if (cpu && (PMD_TrapPoints[addr & PM_ROM_Mask] & TRAPPOINT_WATCHREAD) && PMD_EnableWatchpoints) {
-		PMD_TrapFound = 1;
-		WatchpointReport(0, addr);
-	}
 	if (addr >= 0x2100) {
 		// ROM Read
 #ifdef PERFORMANCE
@@ -372,13 +589,32 @@ uint8_t MinxCPU_OnRead(int cpu, uint32_t addr)
 	return 0xFF;
 }
 
+uint8_t MinxCPU_OnRead(int cpu, uint32_t addr)
+{
+	uint8_t data;
+#ifdef COVERAGE
+	if (cpu) Coverage_Mark((cpu == 2) ? COVERAGE_EXEC : COVERAGE_READ, addr);
+#endif
+	data = PMHD_OnRead(cpu, addr);
+	if (cpu && PMD_EnableWatchpoints && WatchPoints_Test(addr, WATCHPOINT_READ, data)) {
+		PMD_TrapFound = 1;
+		WatchpointReport(0, addr);
+	}
+	if (cpu && PMD_TraceWriter) PMHD_TraceRecordAccess(addr, data, 0);
+	return data;
+}
+
 void MinxCPU_OnWrite(int cpu, uint32_t addr, uint8_t data)
 {
 	static uint8_t dataold = 0x00;
-	if (cpu && (PMD_TrapPoints[addr & PM_ROM_Mask] & TRAPPOINT_WATCHWRITE) && PMD_EnableWatchpoints) {
+#ifdef COVERAGE
+	if (cpu) Coverage_Mark(COVERAGE_WRITE, addr);
+#endif
+	if (cpu && PMD_EnableWatchpoints && WatchPoints_Test(addr, WATCHPOINT_WRITE, data)) {
 		PMD_TrapFound = 1;
 		WatchpointReport(1, addr);
 	}
+	if (cpu && PMD_TraceWriter) PMHD_TraceRecordAccess(addr, data, 1);
 	if (addr >= 0x2100) {
 		// ROM Write
 #ifndef PERFORMANCE
@@ -479,10 +715,11 @@ void MinxCPU_OnWrite(int cpu, uint32_t addr, uint8_t data)
 		}
 	} else if (addr >= 0x1300) {
 		// RAM Write
-		PM_RAM[addr-0x1000] = data;
+		PM_RAM[addr-0x1000] = PokeMini_CheatWrite(addr, data);
 		return;
 	} else if (addr >= 0x1000) {
 		// RAM Write / FrameBuffer
+		data = PokeMini_CheatWrite(addr, data);
 		PM_RAM[addr-0x1000] = data;
 		if (PRCColorMap) MinxColorPRC_WriteFramebuffer(addr-0x1000, data);
 		return;
@@ -20,22 +20,40 @@
 #define HARDWARE_EMU
 
 #include <stdint.h>
+#include "TraceFile.h"
+#include "WatchPoints.h"
+#include "BreakCond.h"
+#include "RevExec.h"
 
 enum {
 	TRAPPOINT_BREAK      = 1,	// Break
 	TRAPPOINT_WATCHREAD  = 2,	// Watch (Read)
 	TRAPPOINT_WATCHWRITE = 4,	// Watch (Write)
-	TRAPPOINT_WATCH      = 6	// Watch (Read & Write)
+	TRAPPOINT_WATCH      = 6,	// Watch (Read & Write)
+	TRAPPOINT_COND       = 8	// Conditional breakpoints in BreakCond.h
 };
 
-// Trap points for breakpoints/watchpoints
+// Trap points for breakpoints, watchpoints are in WatchPoints.h
 extern uint8_t *PMD_TrapPoints;
 
+// Set when the last emulation call stopped on a trap
+extern int PMD_TrapFound;
+
+// Last watchpoint hit, access is -1 for none, 0 for read and 1 for write
+extern int PMD_WatchHitAccess;
+extern uint32_t PMD_WatchHitAddr;
+
 // Trace code addresses
 #define TRACECODE_LENGTH 10000
 extern uint32_t TRACAddr[TRACECODE_LENGTH];
 extern int TRACPoint;
 
+// Run trace recording to file, NULL when not recording
+extern TTraceWriter *PMD_TraceWriter;
+
+// Cycles ran since hard reset
+extern uint64_t PMD_CycleCount;
+
 // Cycle timers
 extern int CYCTmr1Ena;
 extern uint32_t CYCTmr1Cnt;
@@ -72,9 +90,27 @@ int PMHD_MINLoaded();
 // Free resources
 void PMHD_FreeResources();
 
+// Update trap points after changing conditional breakpoints
+void PMHD_BreakCondUpdate(void);
+
 // System reset
 void PMHD_Reset(int hardreset);
 
+// Start recording run trace to file, return 0 on failure
+int PMHD_TraceRecordStart(const char *filename);
+
+// Stop recording run trace, return 0 on write error
+int PMHD_TraceRecordStop(void);
+
+// Start or stop recording history for reverse execution, return 0 on failure
+int PMHD_RevRecord(int enable);
+
+// Step back, return 0 if out of history
+int PMHD_RevStepBack(int steps);
+
+// Run backwards until the previous trap, return 0 if reached the oldest step
+int PMHD_RevContinue(void);
+
 // Get physical PC location
 uint32_t PokeMini_GetPhysicalPC();
 
@@ -196,7 +196,7 @@ static int MemView_exposure(SGtkXDrawingView *widg, int width, int height, int p
 		for (x=0; x<16; x++) {
 			dat = MinxCPU_OnRead(0, pp);
 			sdat = (dat < 0x01) ? '.' : dat;
-			watch = PMD_TrapPoints[pp & PM_ROM_Mask] & TRAPPOINT_WATCH;
+			watch = WatchPoints_Covered(pp);
 			if (watch) {
 				sgtkx_drawing_view_drawfrect(widg, 72 + x * 20, y * 12, 16, 12, AnyView_TrapColor[watch]);
 			}
@@ -249,15 +249,13 @@ static int MemView_buttonpress(SGtkXDrawingView *widg, int button, int press, in
 	if (button == SGTKXDV_BLEFT) {
 		if (pp < PM_ROM_Size) {
 			AnyView_NewValue_CD[1].number = (int)MinxCPU_OnRead(0, pp);
-			AnyView_NewValue_CD[3].number = PMD_TrapPoints[pp] & TRAPPOINT_WATCHREAD;
-			AnyView_NewValue_CD[4].number = PMD_TrapPoints[pp] & TRAPPOINT_WATCHWRITE;
+			AnyView_NewValue_CD[3].number = WatchPoints_Get(pp) & TRAPPOINT_WATCHREAD;
+			AnyView_NewValue_CD[4].number = WatchPoints_Get(pp) & TRAPPOINT_WATCHWRITE;
 			sprintf(AnyView_NewValue_CD[0].text, "Set new value for $%04X:", pp);
 			result = CustomDialog(MemWindow, "Change memory", AnyView_NewValue_CD);
 			if (result == 1) {
 				WriteToPMMem(pp, AnyView_NewValue_CD[1].number);
-				PMD_TrapPoints[pp] &= ~TRAPPOINT_WATCH;
-				if (AnyView_NewValue_CD[3].number) PMD_TrapPoints[pp] |= TRAPPOINT_WATCHREAD;
-				if (AnyView_NewValue_CD[4].number) PMD_TrapPoints[pp] |= TRAPPOINT_WATCHWRITE;
+				WatchPoints_Set(pp, (AnyView_NewValue_CD[3].number ? TRAPPOINT_WATCHREAD : 0) | (AnyView_NewValue_CD[4].number ? TRAPPOINT_WATCHWRITE : 0));
 				refresh_debug(1);
 			} else if (result == -1) {
 				MessageDialog(MemWindow, "Invalid number", "Change register", GTK_MESSAGE_ERROR, NULL);
@@ -317,14 +315,12 @@ static void MemW_Break_AddWPAt(GtkWidget *widget, gpointer data)
 	if (CustomDialog(MainWindow, "Add watchpoing at...", AnyView_AddWPAt_CD)) {
 		for (i=0; i<AnyView_AddWPAt_CD[3].number; i++) {
 			num = AnyView_AddWPAt_CD[1].number + i;
-			if ((num < 0) || (num >= PM_ROM_Size)) {
+			if ((num < 0) || (num >= WATCHPOINTS_SIZE)) {
 				MessageDialog(MemWindow, "Address out of range", "Add watchpoint at...", GTK_MESSAGE_ERROR, NULL);
 				set_emumode(EMUMODE_RESTORE, 1);
 				return;
 			}
-			PMD_TrapPoints[num] &= ~TRAPPOINT_WATCH;
-			if (AnyView_AddWPAt_CD[5].number) PMD_TrapPoints[num] |= TRAPPOINT_WATCHREAD;
-			if (AnyView_AddWPAt_CD[6].number) PMD_TrapPoints[num] |= TRAPPOINT_WATCHWRITE;
+			WatchPoints_Set(num, (AnyView_AddWPAt_CD[5].number ? TRAPPOINT_WATCHREAD : 0) | (AnyView_AddWPAt_CD[6].number ? TRAPPOINT_WATCHWRITE : 0));
 		}
 		refresh_debug(1);
 	}
@@ -334,8 +330,7 @@ static void MemW_Break_AddWPAt(GtkWidget *widget, gpointer data)
 
 static void MemW_Break_DelAllWP(GtkWidget *widget, gpointer data)
 {
-	int i;
-	for (i=0; i<PM_ROM_Size; i++) PMD_TrapPoints[i] &= ~TRAPPOINT_WATCH;
+	WatchPoints_ClearAll();
 	refresh_debug(1);
 }
 
@@ -25,6 +25,7 @@
 
 #include "PokeMini.h"
 #include "Hardware_Debug.h"
+#include "Profiler.h"
 #include "ExportBMP.h"
 #include "ExportWAV.h"
 #include "Joystick.h"
@@ -97,6 +98,7 @@ int dclc_PRC_bg = 1;
 int dclc_PRC_spr = 1;
 int dclc_PRC_stallcpu = 1;
 int dclc_PRC_stallcycles = 1;
+int dclc_coverage_overlay = 1;
 int dclc_cpuwin_refresh = 7;
 int dclc_cpuwin_winx = -16, dclc_cpuwin_winy = -16;
 int dclc_cpuwin_winw = -1, dclc_cpuwin_winh = -1;
@@ -159,6 +161,7 @@ const TCommandLineCustom CustomConf[] = {
 	{ "prc_sprites", &dclc_PRC_spr, COMMANDLINE_BOOL },
 	{ "prc_stallcpu", &dclc_PRC_stallcpu, COMMANDLINE_BOOL },
 	{ "prc_stallidlecycles", &dclc_PRC_stallcycles, COMMANDLINE_INT, 8, 64 },
+	{ "coverage_overlay", &dclc_coverage_overlay, COMMANDLINE_BOOL },
 	{ "debug_out", &dclc_debugout, COMMANDLINE_BOOL },
 	{ "auto_debug_out", &dclc_autodebugout, COMMANDLINE_BOOL },
 	{ "cpuwin_refresh", &dclc_cpuwin_refresh, COMMANDLINE_INT, 0, 1000 },
@@ -447,6 +450,7 @@ void PMDebug_OnLoadMINFile(const char *filename, int success)
 	if (success == 1) {
 		Add_InfoMessage("[Info] ROM '%s' loaded\n", filename);
 		SymbWindow_ROMLoaded(filename);
+		ProgramView_AnalyzeCode(1);
 		CPUWindow_Refresh(1);
 	} else if (success == -1) Add_InfoMessage("[Error] Loading ROM '%s': file not found\n", filename);
 	else if (success == -2) Add_InfoMessage("[Error] Loading ROM '%s': invalid size\n", filename);
@@ -478,8 +482,10 @@ void PMDebug_OnSaveEEPROMFile(const char *filename, int success)
 
 void PMDebug_OnLoadStateFile(const char *filename, int success)
 {
-	if (success == 1) Add_InfoMessage("[Info] State '%s' loaded\n", filename);
-	else if (success == -1) Add_InfoMessage("[Error] Loading state '%s': file not found\n", filename);
+	if (success == 1) {
+		Add_InfoMessage("[Info] State '%s' loaded\n", filename);
+		RevExec_Restart();
+	} else if (success == -1) Add_InfoMessage("[Error] Loading state '%s': file not found\n", filename);
 	else if (success == -2) Add_InfoMessage("[Error] Loading state '%s': invalid file\n", filename);
 	else if (success == -3) Add_InfoMessage("[Error] Loading state '%s': wrong version\n", filename);
 	else if (success == -4) Add_InfoMessage("[Error] Loading state '%s': invalid header\n", filename);
@@ -824,5 +830,11 @@ int main(int argc, char **argv)
 		sdump = NULL;
 	}
 
+	// Close run trace if still recording
+	PMHD_TraceRecordStop();
+
+	// Free profiler results
+	Profiler_Free();
+
 	return 0;
 }
@@ -35,6 +35,7 @@ extern int dclc_PRC_bg;			// Debugger Conf: PRC Background
 extern int dclc_PRC_spr;		// Debugger Conf: PRC Sprites
 extern int dclc_PRC_stallcpu;		// Debugger Conf: PRC Stall CPU
 extern int dclc_PRC_stallcycles;	// Debugger Conf: PRC Stall Idle Cycles
+extern int dclc_coverage_overlay;	// Debugger Conf: Coverage on program view
 extern int dclc_cpuwin_refresh;		// Debugger Conf: CPU Window refresh
 extern int dclc_cpuwin_winx, dclc_cpuwin_winy;
 extern int dclc_cpuwin_winw, dclc_cpuwin_winh;
@@ -105,6 +106,16 @@ extern volatile int emumode;	// Read-Only, current emulator mode
 extern FILE *sdump;
 extern double sdumptime;
 
+// Messaging, implemented by the frontend
+void Set_StatusLabel(const char *format, ...);
+void Add_InfoMessage(const char *format, ...);
+void Cmd_DebugOutput(int ctrl);
+void Add_DebugOutputChar(unsigned char ch);
+void Add_DebugOutputBinary(unsigned char bin);
+void Add_DebugOutputNumber8(unsigned char num, int reg);
+void Add_DebugOutputNumber16(unsigned char num, int reg);
+void Add_DebugOutputFixed8_8(unsigned char num, int reg);
+
 // Setup screen
 void setup_screen(void);
 
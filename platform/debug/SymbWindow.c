@@ -55,8 +55,8 @@ static SGtkXDrawingView DataView;
 static GtkLabel *PMSymbFile;
 
 static int SymbsModified = 0;
-static SymbItem *FirstCode = NULL;
-static SymbItem *FirstData = NULL;
+static SymbList FirstCode;
+static SymbList FirstData;
 
 static char pmsymbfile[PMTMPV];
 
@@ -136,43 +136,109 @@ static GtkXCustomDialog SymbView_ManageData_CD[] = {
 // Symb items handlers
 // -------------------
 
-void SymbItemsClearAll(SymbItem **list)
+void SymbItemsClearAll(SymbList *list)
 {
-	SymbItem *next, *item = *list;
-	while (item != NULL) {
-		next = item->next;
-		free(item);
-		item = next;
-	}
-	*list = NULL;
+	int i;
+	for (i=0; i<list->count; i++) free(list->byname[i]);
+	if (list->byname) free(list->byname);
+	if (list->byaddr) free(list->byaddr);
+	if (list->hash) free(list->hash);
+	memset(list, 0, sizeof(SymbList));
 }
 
-SymbItem *SymbItemsGetIndex(SymbItem **list, int index)
+static uint32_t SymbItemsHash(const char *name)
 {
-	SymbItem *item = *list;
-	if (index < 0) return NULL;
-	while (item != NULL) {
-		if (index-- == 0) return item;
-		item = item->next;
+	uint32_t hash = 2166136261u;
+	while (*name) hash = (hash ^ (uint8_t)*name++) * 16777619u;
+	return hash;
+}
+
+static int SymbItemsCmpName(const void *a, const void *b)
+{
+	return strcmp((*(SymbItem **)a)->name, (*(SymbItem **)b)->name);
+}
+
+static int SymbItemsCmpAddr(const void *a, const void *b)
+{
+	SymbItem *ia = *(SymbItem **)a;
+	SymbItem *ib = *(SymbItem **)b;
+	if (ia->addr != ib->addr) return (ia->addr < ib->addr) ? -1 : 1;
+	return strcmp(ia->name, ib->name);
+}
+
+// Arrays are only sorted when they are needed
+static void SymbItemsSortName(SymbList *list)
+{
+	if (list->namesorted) return;
+	qsort(list->byname, list->count, sizeof(SymbItem *), SymbItemsCmpName);
+	list->namesorted = 1;
+}
+
+static void SymbItemsSortAddr(SymbList *list)
+{
+	if (list->addrsorted) return;
+	qsort(list->byaddr, list->count, sizeof(SymbItem *), SymbItemsCmpAddr);
+	list->addrsorted = 1;
+}
+
+static int SymbItemsRehash(SymbList *list, int hashsize)
+{
+	SymbItem **hash, *item;
+	int i;
+	hash = (SymbItem **)calloc(hashsize, sizeof(SymbItem *));
+	if (!hash) return 0;
+	for (i=0; i<list->count; i++) {
+		item = list->byname[i];
+		item->hnext = hash[SymbItemsHash(item->name) & (hashsize - 1)];
+		hash[SymbItemsHash(item->name) & (hashsize - 1)] = item;
 	}
-	return NULL;
+	if (list->hash) free(list->hash);
+	list->hash = hash;
+	list->hashsize = hashsize;
+	return 1;
 }
 
-SymbItem *SymbItemsGet(SymbItem **list, char *symbname)
+SymbItem *SymbItemsGetIndex(SymbList *list, int index)
 {
-	SymbItem *item = *list;
+	if ((index < 0) || (index >= list->count)) return NULL;
+	SymbItemsSortName(list);
+	return list->byname[index];
+}
+
+SymbItem *SymbItemsGet(SymbList *list, char *symbname)
+{
+	SymbItem *item;
+	if (!list->hashsize) return NULL;
+	item = list->hash[SymbItemsHash(symbname) & (list->hashsize - 1)];
 	while (item != NULL) {
 		if (!strcmp(item->name, symbname)) return item;
-		item = item->next;
+		item = item->hnext;
 	}
 	return NULL;
 }
 
-void SymbItemsSet(SymbItem **list, SymbItem *setitem, int updateex)
+SymbItem *SymbItemsGetAddr(SymbList *list, uint32_t addr)
 {
-	SymbItem *item, *pitem, *newitem;
+	int lo = 0, hi = list->count - 1, mid, found = -1;
+	SymbItemsSortAddr(list);
+	while (lo <= hi) {
+		mid = (lo + hi) >> 1;
+		if (list->byaddr[mid]->addr <= addr) {
+			found = mid;
+			lo = mid + 1;
+		} else hi = mid - 1;
+	}
+	return (found >= 0) ? list->byaddr[found] : NULL;
+}
+
+void SymbItemsSet(SymbList *list, SymbItem *setitem, int updateex)
+{
+	SymbItem *item, **newarr;
+	uint32_t hidx;
+	int newalloc;
 	item = SymbItemsGet(list, setitem->name);
 	if (item != NULL) {
+		if (item->addr != setitem->addr) list->addrsorted = 0;
 		item->addr = setitem->addr;
 		if (updateex) {
 			item->size = setitem->size;
@@ -180,53 +246,84 @@ void SymbItemsSet(SymbItem **list, SymbItem *setitem, int updateex)
 		}
 		return;
 	}
-	newitem = (SymbItem *)malloc(sizeof(SymbItem));
-	memcpy(newitem, setitem, sizeof(SymbItem));
-	if (*list == NULL) {
-		*list = newitem;
-		newitem->prev = NULL;
-		newitem->next = NULL;
-		return;
+	if (list->count >= list->alloc) {
+		newalloc = list->alloc ? list->alloc * 2 : 256;
+		newarr = (SymbItem **)realloc(list->byname, newalloc * sizeof(SymbItem *));
+		if (!newarr) return;
+		list->byname = newarr;
+		newarr = (SymbItem **)realloc(list->byaddr, newalloc * sizeof(SymbItem *));
+		if (!newarr) return;
+		list->byaddr = newarr;
+		list->alloc = newalloc;
 	}
-	pitem = NULL;
-	item = *list;
-	while (item != NULL) {
-		if (strcmp(item->name, newitem->name) < 0) {
-			pitem = item;
-			item = item->next;
-		} else break;
+	if (list->count >= list->hashsize) {
+		if (!SymbItemsRehash(list, list->hashsize ? list->hashsize * 2 : 256)) return;
 	}
-	newitem->prev = pitem;
-	newitem->next = item;
-	if (pitem) {
-		pitem->next = newitem;
-	} else {
-		*list = newitem;
+	item = (SymbItem *)malloc(sizeof(SymbItem));
+	if (!item) return;
+	memcpy(item, setitem, sizeof(SymbItem));
+	hidx = SymbItemsHash(item->name) & (list->hashsize - 1);
+	item->hnext = list->hash[hidx];
+	list->hash[hidx] = item;
+	list->byname[list->count] = item;
+	list->byaddr[list->count] = item;
+	list->count++;
+	list->namesorted = 0;
+	list->addrsorted = 0;
+}
+
+static void SymbItemsRemoveFrom(SymbItem **arr, int count, SymbItem *item)
+{
+	int i;
+	for (i=0; i<count; i++) {
+		if (arr[i] == item) {
+			memmove(&arr[i], &arr[i+1], (count - i - 1) * sizeof(SymbItem *));
+			return;
+		}
 	}
-	if (item) item->prev = newitem;
 }
 
-void SymbItemsDelete(SymbItem **list, SymbItem *item)
+static void SymbItemsUnhash(SymbList *list, SymbItem *item)
 {
-	if (!item) return;
-	if (item->prev) {
-		item->prev->next = item->next;
-	} else {
-		*list = item->next;
+	SymbItem **link;
+	link = &list->hash[SymbItemsHash(item->name) & (list->hashsize - 1)];
+	while (*link != NULL) {
+		if (*link == item) {
+			*link = item->hnext;
+			break;
+		}
+		link = &(*link)->hnext;
 	}
-	if (item->next) item->next->prev = item->prev;
+}
+
+// Change name and address of an existing item, caller checks for duplicates
+void SymbItemsRename(SymbList *list, SymbItem *item, const char *name, uint32_t addr)
+{
+	uint32_t hidx;
+	if (!item || !list->hashsize) return;
+	SymbItemsUnhash(list, item);
+	strcpy(item->name, name);
+	item->addr = addr;
+	hidx = SymbItemsHash(item->name) & (list->hashsize - 1);
+	item->hnext = list->hash[hidx];
+	list->hash[hidx] = item;
+	list->namesorted = 0;
+	list->addrsorted = 0;
+}
+
+void SymbItemsDelete(SymbList *list, SymbItem *item)
+{
+	if (!item || !list->hashsize) return;
+	SymbItemsUnhash(list, item);
+	SymbItemsRemoveFrom(list->byname, list->count, item);
+	SymbItemsRemoveFrom(list->byaddr, list->count, item);
+	list->count--;
 	free(item);
 }
 
-int SymbItemsLength(SymbItem **list)
+int SymbItemsLength(SymbList *list)
 {
-	int count = 0;
-	SymbItem *item = *list;
-	while (item != NULL) {
-		count++;
-		item = item->next;
-	}
-	return count;
+	return list->count;
 }
 
 int SymbItemsSetFromFile(char *filename)
@@ -346,6 +443,7 @@ int SymbItemsSaveToFile(char *filename)
 {
 	SymbItem *item;
 	FILE *fo;
+	int i;
 
 	fo = fopen(filename, "w");
 	if (!fo) return 0;
@@ -355,17 +453,13 @@ int SymbItemsSaveToFile(char *filename)
 	fprintf(fo, "# Min file: %s\n", GetFilename(CommandLine.min_file));
 
 	// Write code
-	item = FirstCode;
-	while (item != NULL) {
+	for (i=0; (item = SymbItemsGetIndex(&FirstCode, i)) != NULL; i++) {
 		fprintf(fo, "CODE1 $%06X %s\n", item->addr, item->name);
-		item = item->next;
 	}
 
 	// Write data
-	item = FirstData;
-	while (item != NULL) {
+	for (i=0; (item = SymbItemsGetIndex(&FirstData, i)) != NULL; i++) {
 		fprintf(fo, "DATA1 $%06X %i %i %s\n", item->addr, item->size, item->ctrl, item->name);
-		item = item->next;
 	}
 
 	fclose(fo);
@@ -373,6 +467,11 @@ int SymbItemsSaveToFile(char *filename)
 	return 1;
 }
 
+SymbItem *SymbWindow_GetCodeSymb(uint32_t addr)
+{
+	return SymbItemsGetAddr(&FirstCode, addr);
+}
+
 void SymbWindow_Reload(void)
 {
 	char tmp[PMTMPV];
@@ -492,8 +591,8 @@ static int CodeView_exposure(SGtkXDrawingView *widg, int width, int height, int
 		sgtkx_drawing_view_drawtext(widg, 180, y * 12, 0x402090, "%s", item->name);
 
 		// Next item
-		item = item->next;
 		pp++;
+		item = SymbItemsGetIndex(&FirstCode, pp);
 	}
 
 	// Draw top bar
@@ -553,8 +652,7 @@ static int CodeView_buttonpress(SGtkXDrawingView *widg, int button, int press, i
 					if (strcmp(item->name, SymbView_ManageCode_CD[2].text) && SymbItemsGet(&FirstCode, SymbView_ManageCode_CD[2].text)) {
 						MessageDialog(SymbWindow, "Symbol already exists", "Manage code symbol", GTK_MESSAGE_ERROR, NULL);
 					} else {
-						strcpy(item->name, SymbView_ManageCode_CD[2].text);
-						item->addr = SymbView_ManageCode_CD[4].number;
+						SymbItemsRename(&FirstCode, item, SymbView_ManageCode_CD[2].text, SymbView_ManageCode_CD[4].number);
 						SymbsModified = 1;
 						SymbWindow_Reload();
 					}
@@ -616,7 +714,7 @@ static int DataView_exposure(SGtkXDrawingView *widg, int width, int height, int
 		}
 
 		// Draw trap
-		watch = PMD_TrapPoints[item->addr & PM_ROM_Mask] & TRAPPOINT_WATCH;
+		watch = WatchPoints_Covered(item->addr);
 		if (watch) {
 			sgtkx_drawing_view_drawfrect(widg, 82, y * 12, 72, 12, AnyView_TrapColor[watch]);
 		}
@@ -662,8 +760,8 @@ static int DataView_exposure(SGtkXDrawingView *widg, int width, int height, int
 		sgtkx_drawing_view_drawtext(widg, 180, y * 12, 0x402090, "%s", item->name);
 
 		// Next item
-		item = item->next;
 		pp++;
+		item = SymbItemsGetIndex(&FirstData, pp);
 	}
 
 	// Draw top bar
@@ -716,59 +814,47 @@ static int DataView_buttonpress(SGtkXDrawingView *widg, int button, int press, i
 		} else {
 			sprintf(SymbView_NewValue_CD[1].text, "%i", val);
 		}
-		SymbView_NewValue_CD[3].number = PMD_TrapPoints[item->addr] & TRAPPOINT_WATCHREAD;
-		SymbView_NewValue_CD[4].number = PMD_TrapPoints[item->addr] & TRAPPOINT_WATCHWRITE;
+		SymbView_NewValue_CD[3].number = WatchPoints_Get(item->addr) & TRAPPOINT_WATCHREAD;
+		SymbView_NewValue_CD[4].number = WatchPoints_Get(item->addr) & TRAPPOINT_WATCHWRITE;
 		sprintf(SymbView_NewValue_CD[0].text, "Set new value for $%04X (%s):", item->addr, item->name);
 		result = CustomDialog(SymbWindow, "Change memory", SymbView_NewValue_CD);
 		if (result == 1) {
 			val = atoi_Ex(SymbView_NewValue_CD[1].text, 0);
 			WriteToPMMem(item->addr, val);
-			PMD_TrapPoints[item->addr] &= ~TRAPPOINT_WATCH;
-			if (SymbView_NewValue_CD[3].number) PMD_TrapPoints[item->addr] |= TRAPPOINT_WATCHREAD;
-			if (SymbView_NewValue_CD[4].number) PMD_TrapPoints[item->addr] |= TRAPPOINT_WATCHWRITE;
+			WatchPoints_Set(item->addr, (SymbView_NewValue_CD[3].number ? TRAPPOINT_WATCHREAD : 0) | (SymbView_NewValue_CD[4].number ? TRAPPOINT_WATCHWRITE : 0));
 			if (item->size >= 1) {
 				WriteToPMMem(item->addr+1, val >> 8);
-				PMD_TrapPoints[item->addr+1] &= ~TRAPPOINT_WATCH;
-				if (SymbView_NewValue_CD[3].number) PMD_TrapPoints[item->addr+1] |= TRAPPOINT_WATCHREAD;
-				if (SymbView_NewValue_CD[4].number) PMD_TrapPoints[item->addr+1] |= TRAPPOINT_WATCHWRITE;
+				WatchPoints_Set(item->addr+1, (SymbView_NewValue_CD[3].number ? TRAPPOINT_WATCHREAD : 0) | (SymbView_NewValue_CD[4].number ? TRAPPOINT_WATCHWRITE : 0));
 			}
 			if (item->size >= 2) {
 				WriteToPMMem(item->addr+2, val >> 16);
-				PMD_TrapPoints[item->addr+2] &= ~TRAPPOINT_WATCH;
-				if (SymbView_NewValue_CD[3].number) PMD_TrapPoints[item->addr+2] |= TRAPPOINT_WATCHREAD;
-				if (SymbView_NewValue_CD[4].number) PMD_TrapPoints[item->addr+2] |= TRAPPOINT_WATCHWRITE;
+				WatchPoints_Set(item->addr+2, (SymbView_NewValue_CD[3].number ? TRAPPOINT_WATCHREAD : 0) | (SymbView_NewValue_CD[4].number ? TRAPPOINT_WATCHWRITE : 0));
 			}
 			if (item->size >= 3) {
 				WriteToPMMem(item->addr+3, val >> 24);
-				PMD_TrapPoints[item->addr+3] &= ~TRAPPOINT_WATCH;
-				if (SymbView_NewValue_CD[3].number) PMD_TrapPoints[item->addr+3] |= TRAPPOINT_WATCHREAD;
-				if (SymbView_NewValue_CD[4].number) PMD_TrapPoints[item->addr+3] |= TRAPPOINT_WATCHWRITE;
+				WatchPoints_Set(item->addr+3, (SymbView_NewValue_CD[3].number ? TRAPPOINT_WATCHREAD : 0) | (SymbView_NewValue_CD[4].number ? TRAPPOINT_WATCHWRITE : 0));
 			}
 			refresh_debug(1);
 		} else if (result == -1) {
 			MessageDialog(SymbWindow, "Invalid number", "Change memory", GTK_MESSAGE_ERROR, NULL);
 		}
 	} else if (button == SGTKXDV_BMIDDLE) {
-		val = PMD_TrapPoints[item->addr];
+		val = WatchPoints_Get(item->addr);
 		switch (val & TRAPPOINT_WATCH) {
 			case 0: val = TRAPPOINT_WATCHREAD | TRAPPOINT_WATCHWRITE; break;
 			case TRAPPOINT_WATCHREAD | TRAPPOINT_WATCHWRITE: val = TRAPPOINT_WATCHREAD; break;
 			case TRAPPOINT_WATCHREAD: val = TRAPPOINT_WATCHWRITE; break;
 			case TRAPPOINT_WATCHWRITE: val = 0; break;
 		}
-		PMD_TrapPoints[item->addr] &= ~TRAPPOINT_WATCH;
-		PMD_TrapPoints[item->addr] |= val;
+		WatchPoints_Set(item->addr, val);
 		if (item->size >= 1) {
-			PMD_TrapPoints[item->addr+1] &= ~TRAPPOINT_WATCH;
-			PMD_TrapPoints[item->addr+1] |= val;
+			WatchPoints_Set(item->addr+1, val);
 		}
 		if (item->size >= 2) {
-			PMD_TrapPoints[item->addr+2] &= ~TRAPPOINT_WATCH;
-			PMD_TrapPoints[item->addr+2] |= val;
+			WatchPoints_Set(item->addr+2, val);
 		}
 		if (item->size >= 3) {
-			PMD_TrapPoints[item->addr+3] &= ~TRAPPOINT_WATCH;
-			PMD_TrapPoints[item->addr+3] |= val;
+			WatchPoints_Set(item->addr+3, val);
 		}
 		refresh_debug(1);
 	} else if (button == SGTKXDV_BRIGHT) {
@@ -793,8 +879,7 @@ static int DataView_buttonpress(SGtkXDrawingView *widg, int button, int press, i
 					if (strcmp(item->name, SymbView_ManageData_CD[2].text) && SymbItemsGet(&FirstData, SymbView_ManageData_CD[2].text)) {
 						MessageDialog(SymbWindow, "Symbol already exists", "Manage data symbol", GTK_MESSAGE_ERROR, NULL);
 					} else {
-						strcpy(item->name, SymbView_ManageData_CD[2].text);
-						item->addr = SymbView_ManageData_CD[4].number;
+						SymbItemsRename(&FirstData, item, SymbView_ManageData_CD[2].text, SymbView_ManageData_CD[4].number);
 						item->size = 0;
 						if (SymbView_ManageData_CD[6].number) item->size = 1;
 						if (SymbView_ManageData_CD[7].number) item->size = 2;
@@ -23,8 +23,7 @@
 #include <gtk/gtk.h>
 
 typedef struct TSymbItem {
-	struct TSymbItem *prev;
-	struct TSymbItem *next;
+	struct TSymbItem *hnext;	// Next item with same hash
 	char name[PMTMPV];
 	uint32_t addr;
 	int size;	// Data only: 0 = 8-Bits, 1 = 16-Bits, 2 = 24-Bits, 3 = 32-Bits
@@ -32,6 +31,20 @@ typedef struct TSymbItem {
 			// Bit 0-1: 0 = None, 1 = Hexadecimal, 2 = Signed integer, 3 = Unsigned integer
 } SymbItem;
 
+typedef struct {
+	SymbItem **byname;	// Items sorted by name
+	SymbItem **byaddr;	// Items sorted by address
+	SymbItem **hash;	// Hash table by name
+	int count;		// Number of items
+	int alloc;		// Allocated items on arrays
+	int hashsize;		// Hash table size (power of 2)
+	int namesorted;		// byname is sorted
+	int addrsorted;		// byaddr is sorted
+} SymbList;
+
+// Get code symbol at or before address, NULL if none
+SymbItem *SymbWindow_GetCodeSymb(uint32_t addr);
+
 // This window management
 int SymbWindow_Create(void);
 void SymbWindow_Destroy(void);
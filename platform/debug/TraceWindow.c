@@ -179,7 +179,7 @@ static int TraceView_exposure(SGtkXDrawingView *widg, int width, int height, int
 
 		if (ppp != 0xFFFFFFFF) {
 			// Decode instruction
-			opcode = GetInstructionInfo(MinxCPU_OnRead, 1, ppp, data, &size);
+			opcode = GetInstructionInfo(MinxCPU_OnRead, 0, ppp, data, &size);
 			DisasmSingleOpcode(opcode, ppp, data, opcodename, &CDisAsm_SOpcDec);
 
 			// Draw instruction
@@ -272,6 +272,35 @@ static void TraceW_Refresh(GtkWidget *widget, gpointer data)
 	}
 }
 
+static void TraceW_RecordStart(GtkWidget *widget, gpointer data)
+{
+	char tmp[PMTMPV];
+	set_emumode(EMUMODE_STOP, 1);
+	strcpy(tmp, CommandLine.min_file);
+	RemoveExtension(tmp);
+	strcat(tmp, ".pmtrace");
+	if (SaveFileDialogEx(TraceWindow, "Record run trace", tmp, tmp, "PokeMini Trace (*.pmtrace)\0*.pmtrace\0All (*.*)\0*.*\0", 0)) {
+		if (PMHD_TraceRecordStart(tmp)) {
+			Add_InfoMessage("[Info] Recording run trace to '%s'\n", tmp);
+		} else {
+			MessageDialog(TraceWindow, "Error creating run trace file", "Run Trace Error", GTK_MESSAGE_ERROR, NULL);
+		}
+	}
+	set_emumode(EMUMODE_RESTORE, 1);
+}
+
+static void TraceW_RecordStop(GtkWidget *widget, gpointer data)
+{
+	if (!PMD_TraceWriter) return;
+	set_emumode(EMUMODE_STOP, 1);
+	if (PMHD_TraceRecordStop()) {
+		Add_InfoMessage("[Info] Run trace recording stopped\n");
+	} else {
+		MessageDialog(TraceWindow, "Error writing run trace file", "Run Trace Error", GTK_MESSAGE_ERROR, NULL);
+	}
+	set_emumode(EMUMODE_RESTORE, 1);
+}
+
 static gint TraceWindow_delete_event(GtkWidget *widget, GdkEvent *event, gpointer data)
 {
 	gtk_widget_hide(GTK_WIDGET(TraceWindow));
@@ -286,6 +315,10 @@ static gboolean TraceWindow_state_event(GtkWidget *widget, GdkEventWindowState *
 
 static GtkItemFactoryEntry TraceWindow_MenuItems[] = {
 
+	{ "/_File",                              NULL,           NULL,                     0, "<Branch>" },
+	{ "/File/Record to file...",             NULL,           TraceW_RecordStart,       0, "<Item>" },
+	{ "/File/Stop recording",                NULL,           TraceW_RecordStop,        0, "<Item>" },
+
 	{ "/_Debugger",                          NULL,           NULL,                     0, "<Branch>" },
 	{ "/Debugger/Run full speed",            "F5",           Menu_Debug_RunFull,       0, "<Item>" },
 	{ "/Debugger/Run debug frames (Sound)",  "<SHIFT>F5",    Menu_Debug_RunDFrameSnd,  0, "<Item>" },
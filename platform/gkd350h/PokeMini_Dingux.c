@@ -311,12 +311,12 @@ int main(int argc, char **argv)
 	while (emurunning) {
 		// Emulate and syncronize
 		if (RequireSoundSync) {
-			PokeMini_EmulateFrame();
+			PokeMini_EmulateFrameRunAhead(CommandLine.runahead);
 			// Sleep a little in the hope to free a few samples
 			while (MinxAudio_SyncWithAudio()) SDL_Delay(1);
 		} else {
 			time = SDL_GetTicks();
-			PokeMini_EmulateFrame();
+			PokeMini_EmulateFrameRunAhead(CommandLine.runahead);
 			do {
 				SDL_Delay(1);		// This lower CPU usage
 				time = SDL_GetTicks();
@@ -0,0 +1,889 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#define LIBPOKEMINI_WORKERS	// Batch worker processes
+#endif
+
+#include "PokeMini.h"
+#include "Hardware.h"
+#include "libpokemini.h"
+
+struct TLibPokeMini {
+	TPokeMini_Snapshot state;	// Hardware while swapped out
+	uint32_t keys;			// Pressed keys
+	int engine;			// Sound engine
+	int lcdmode;			// LCD mode
+	int lcddirty;			// LCD needs render
+	uint8_t *pixelsD;		// LCD pixels digital
+	uint8_t *pixelsA;		// LCD pixels analog + decay history
+	uint8_t *rom;			// ROM, NULL for none
+	int romsize, rommask;
+	uint8_t *colormap;		// Color information, NULL for none
+	uint8_t *colortop;
+	unsigned int coloroffset;
+	uint8_t colorflags;
+	int colorformat;
+	int freebios;			// Using FreeBIOS
+	uint8_t bios[4096];		// BIOS if not FreeBIOS
+	int32_t piezo[8];		// Piezo filter history
+	int audiolen;			// Samples in audio
+	int16_t audio[LIBPOKEMINI_AUDIOSIZE];
+};
+
+// Header of states
+typedef struct {
+	char id[4];			// "PMLS"
+	uint32_t version;		// PokeMini_ID
+	uint32_t size;			// Total size
+	uint32_t keys;			// Pressed keys
+} TLibPokeMini_StateHeader;
+
+static int LibPokeMini_Instances = 0;		// Number of instances
+static TLibPokeMini *LibPokeMini_Active = NULL;	// Instance on the core
+static uint8_t *LibPokeMini_CorePixelsD;	// LCD pixels allocated by the core
+static uint8_t *LibPokeMini_CorePixelsA;
+static TPokeMini_Snapshot LibPokeMini_PowerOn;	// State of new instances
+
+// Initialize core for the first instance
+static int LibPokeMini_Init(void)
+{
+	CommandLineInit();
+	CommandLine.eeprom_share = 1;	// No EEPROM files
+	CommandLine.updatertc = 0;	// Same start on every run
+	CommandLine.forcefreebios = 0;
+	CommandLine.bios_file[0] = 0;	// BIOS is set per instance
+	CommandLine.lcdmode = LCDMODE_ANALOG;
+	if (!PokeMini_Create(0, LIBPOKEMINI_AUDIOSIZE)) {
+		PokeMini_Destroy();
+		return 0;
+	}
+	LibPokeMini_CorePixelsD = LCDPixelsD;
+	LibPokeMini_CorePixelsA = LCDPixelsA;
+	MinxIO_FormatEEPROM();
+	PokeMini_Reset(1);
+	PokeMini_SaveSnapshot(&LibPokeMini_PowerOn);
+	return 1;
+}
+
+// Move core output into instance
+static void LibPokeMini_DrainAudio(TLibPokeMini *pm)
+{
+	int num = MinxAudio_SamplesInBuffer();
+	if (num > LIBPOKEMINI_AUDIOSIZE - pm->audiolen) {
+		// Drop oldest samples
+		int drop = num - (LIBPOKEMINI_AUDIOSIZE - pm->audiolen);
+		if (drop > pm->audiolen) drop = pm->audiolen;
+		memmove(pm->audio, pm->audio + drop, (pm->audiolen - drop) * sizeof(int16_t));
+		pm->audiolen -= drop;
+		if (num > LIBPOKEMINI_AUDIOSIZE - pm->audiolen) num = LIBPOKEMINI_AUDIOSIZE - pm->audiolen;
+	}
+	if (num <= 0) return;
+	MinxAudio_GetSamplesS16(pm->audio + pm->audiolen, num);
+	pm->audiolen += num;
+}
+
+// Save core into instance
+static void LibPokeMini_SwapOut(TLibPokeMini *pm)
+{
+	memcpy(PM_RAM, pm->state.RAM, LIBPOKEMINI_RAMSIZE);
+	PokeMini_SaveSnapshot(&pm->state);
+	LibPokeMini_DrainAudio(pm);
+	memcpy(pm->piezo, MinxAudio_PiezoHP, 4*sizeof(int32_t));
+	memcpy(pm->piezo + 4, MinxAudio_PiezoLP, 4*sizeof(int32_t));
+	pm->lcdmode = PokeMini_LCDMode;
+	pm->lcddirty = LCDDirty;
+	pm->rom = PM_ROM_Alloc ? PM_ROM : NULL;
+	pm->romsize = PM_ROM_Size;
+	pm->rommask = PM_ROM_Mask;
+	pm->colormap = PRCColorMap;
+	pm->colortop = PRCColorTop;
+	pm->coloroffset = PRCColorOffset;
+	pm->colorflags = PRCColorFlags;
+	pm->colorformat = PokeMini_ColorFormat;
+	PM_ROM_Alloc = 0;	// Owned by the instance now
+	PRCColorMap = NULL;
+}
+
+// Load instance into core
+static void LibPokeMini_SwapIn(TLibPokeMini *pm)
+{
+	if (pm->rom) {
+		PM_ROM = pm->rom;
+		PM_ROM_Alloc = 1;
+		PM_ROM_Size = pm->romsize;
+		PM_ROM_Mask = pm->rommask;
+	} else {
+		// Dummy ROM
+		PM_ROM = (uint8_t *)PM_RAM;
+		PM_ROM_Alloc = 0;
+		PM_ROM_Size = 0x2000;
+		PM_ROM_Mask = 0x1FFF;
+	}
+	PRCColorMap = pm->colormap;
+	PRCColorTop = pm->colortop;
+	PRCColorOffset = pm->coloroffset;
+	PRCColorFlags = pm->colorflags;
+	PokeMini_ColorFormat = pm->colorformat;
+	MinxColorPRC_ColorMapChanged();
+	if (pm->freebios) {
+		if (!PokeMini_FreeBIOS) PokeMini_LoadFreeBIOS();
+	} else {
+		memcpy(PM_BIOS, pm->bios, 4096);
+		PokeMini_FreeBIOS = 0;
+	}
+	LCDPixelsD = pm->pixelsD;
+	LCDPixelsA = pm->pixelsA;
+	LCDPixelsAS = pm->pixelsA + 96*64;
+	LCDDirty = pm->lcddirty;
+	PokeMini_LoadSnapshot(&pm->state);
+	PokeMini_SetLCDMode(pm->lcdmode);
+	if (SoundEngine != pm->engine) MinxAudio_ChangeEngine(pm->engine);
+	memcpy(MinxAudio_PiezoHP, pm->piezo, 4*sizeof(int32_t));
+	memcpy(MinxAudio_PiezoLP, pm->piezo + 4, 4*sizeof(int32_t));
+}
+
+// Make instance the active one
+// The RAM of every instance lives in pm->state.RAM between calls, so
+// the pointer from LibPokeMini_GetRAM stays valid, take writes from it
+static inline void LibPokeMini_Select(TLibPokeMini *pm)
+{
+	if (LibPokeMini_Active == pm) {
+		memcpy(PM_RAM, pm->state.RAM, LIBPOKEMINI_RAMSIZE);
+		return;
+	}
+	if (LibPokeMini_Active) LibPokeMini_SwapOut(LibPokeMini_Active);
+	LibPokeMini_SwapIn(pm);
+	LibPokeMini_Active = pm;
+}
+
+// Core RAM back into the instance
+static inline void LibPokeMini_SyncRAM(TLibPokeMini *pm)
+{
+	memcpy(pm->state.RAM, PM_RAM, LIBPOKEMINI_RAMSIZE);
+}
+
+// Version the library was built with
+uint32_t LibPokeMini_Version(void)
+{
+	return LIBPOKEMINI_VERSION;
+}
+
+// Create instance with FreeBIOS and no cartridge
+TLibPokeMini *LibPokeMini_Create(int flags)
+{
+	TLibPokeMini *pm;
+
+	if (!LibPokeMini_Instances && !LibPokeMini_Init()) return NULL;
+	pm = (TLibPokeMini *)malloc(sizeof(TLibPokeMini));
+	if (!pm) return NULL;
+	memset(pm, 0, sizeof(TLibPokeMini));
+	pm->pixelsD = (uint8_t *)malloc(96*64);
+	pm->pixelsA = (uint8_t *)malloc(96*64*2);
+	if (!pm->pixelsD || !pm->pixelsA) {
+		free(pm->pixelsD);
+		free(pm->pixelsA);
+		free(pm);
+		return NULL;
+	}
+	memset(pm->pixelsD, 0, 96*64);
+	memset(pm->pixelsA, 0, 96*64*2);
+	pm->state = LibPokeMini_PowerOn;
+	pm->engine = (flags & LIBPOKEMINI_NOSOUND) ? MINX_AUDIO_DISABLED : MINX_AUDIO_EMULATED;
+	pm->lcdmode = LCDMODE_ANALOG;
+	pm->rommask = 0x1FFF;
+	pm->romsize = 0x2000;
+	pm->freebios = 1;
+	LibPokeMini_Instances++;
+	return pm;
+}
+
+// Destroy instance
+void LibPokeMini_Destroy(TLibPokeMini *pm)
+{
+	if (!pm) return;
+	LibPokeMini_Select(pm);
+
+	// Free ROM and color information
+	if (PM_ROM_Alloc) free(PM_ROM);
+	PM_ROM = (uint8_t *)PM_RAM;
+	PM_ROM_Alloc = 0;
+	PokeMini_FreeColorInfo();
+
+	// Core pixels back
+	LCDPixelsD = LibPokeMini_CorePixelsD;
+	LCDPixelsA = LibPokeMini_CorePixelsA;
+	LCDPixelsAS = LibPokeMini_CorePixelsA + 96*64;
+	free(pm->pixelsD);
+	free(pm->pixelsA);
+	free(pm);
+	LibPokeMini_Active = NULL;
+
+	// Last instance shutdown the core
+	if (!--LibPokeMini_Instances) PokeMini_Destroy();
+}
+
+// Load BIOS file, NULL for FreeBIOS
+int LibPokeMini_LoadBIOS(TLibPokeMini *pm, const char *filename)
+{
+	LibPokeMini_Select(pm);
+	if (!filename) {
+		pm->freebios = 1;
+		return PokeMini_LoadFreeBIOS();
+	}
+	if (!PokeMini_LoadBIOSFile(filename)) {
+		if (pm->freebios) PokeMini_LoadFreeBIOS();
+		else memcpy(PM_BIOS, pm->bios, 4096);
+		return 0;
+	}
+	memcpy(pm->bios, PM_BIOS, 4096);
+	pm->freebios = 0;
+	return 1;
+}
+
+// Load ROM from .min, .minc or .zip and hard reset
+int LibPokeMini_LoadROM(TLibPokeMini *pm, const char *filename)
+{
+	LibPokeMini_Select(pm);
+	CommandLine.lcdmode = PokeMini_LCDMode;
+	if (!PokeMini_LoadROM(filename)) return 0;
+	// Colors on with color info, back to analog without it
+	if (PokeMini_LCDMode != CommandLine.lcdmode) PokeMini_SetLCDMode(CommandLine.lcdmode);
+	PokeMini_Reset(1);
+	LibPokeMini_SyncRAM(pm);
+	pm->keys = 0;
+	return 1;
+}
+
+// Load ROM from memory (copied) and hard reset
+int LibPokeMini_LoadROMMem(TLibPokeMini *pm, const void *data, int size)
+{
+	LibPokeMini_Select(pm);
+	if ((size <= 0x2100) || (size > 0x200000)) return 0;
+	PokeMini_FreeColorInfo();
+	if (!PokeMini_NewMIN(size)) return 0;
+	memcpy(PM_ROM, data, size);
+	NewMulticart();
+	if (PokeMini_LCDMode == LCDMODE_COLORS) PokeMini_SetLCDMode(LCDMODE_ANALOG);
+	PokeMini_Reset(1);
+	LibPokeMini_SyncRAM(pm);
+	pm->keys = 0;
+	return 1;
+}
+
+// Reset, hard reset also clears RAM
+void LibPokeMini_Reset(TLibPokeMini *pm, int hardreset)
+{
+	LibPokeMini_Select(pm);
+	PokeMini_Reset(hardreset);
+	LibPokeMini_SyncRAM(pm);
+}
+
+// Run until the end of the next frame
+int LibPokeMini_RunFrame(TLibPokeMini *pm)
+{
+	int cycles;
+	LibPokeMini_Select(pm);
+	cycles = PokeMini_EmulateFrame();
+	LibPokeMini_SyncRAM(pm);
+	if (pm->engine) LibPokeMini_DrainAudio(pm);
+	return cycles;
+}
+
+// Run at least the specified cycles
+int LibPokeMini_RunCycles(TLibPokeMini *pm, int cycles)
+{
+	int left;
+	LibPokeMini_Select(pm);
+	left = PokeMini_EmulateCycles(cycles);
+	LibPokeMini_SyncRAM(pm);
+	if (pm->engine) LibPokeMini_DrainAudio(pm);
+	return cycles - left;
+}
+
+// Run frames with keys per frame
+int LibPokeMini_RunFrames(TLibPokeMini *pm, const uint32_t *keys, int frames, uint8_t *output, int type)
+{
+	const uint8_t *pixels;
+	int i;
+
+	LibPokeMini_Select(pm);
+	for (i=0; i<frames; i++) {
+		if (keys) LibPokeMini_SetKeys(pm, keys[i]);
+		PokeMini_EmulateFrame();
+		LibPokeMini_SyncRAM(pm);
+		if (pm->engine) LibPokeMini_DrainAudio(pm);
+		if (output) {
+			pixels = LibPokeMini_GetPixels(pm, type);
+			if (!pixels) break;
+			memcpy(output, pixels, 96*64);
+			output += 96*64;
+		}
+	}
+	return i;
+}
+
+// Set pressed keys
+void LibPokeMini_SetKeys(TLibPokeMini *pm, uint32_t keys)
+{
+	uint32_t changed;
+	int key;
+
+	LibPokeMini_Select(pm);
+	changed = (pm->keys ^ keys) & 0x3FE;
+	for (key=LIBPOKEMINI_KEY_A; changed; key++) {
+		if (changed & (1 << key)) {
+			PokeMini_KeypadEvent(key, (keys >> key) & 1);
+			changed &= ~(1 << key);
+		}
+	}
+	LibPokeMini_SyncRAM(pm);
+	pm->keys = keys & 0x3FE;
+}
+
+// Get pressed keys
+uint32_t LibPokeMini_GetKeys(TLibPokeMini *pm)
+{
+	return pm->keys;
+}
+
+// Set LCD mode
+void LibPokeMini_SetLCDMode(TLibPokeMini *pm, int mode)
+{
+	LibPokeMini_Select(pm);
+	if ((mode < LIBPOKEMINI_LCD_ANALOG) || (mode > LIBPOKEMINI_LCD_COLORS)) return;
+	if ((mode == LIBPOKEMINI_LCD_COLORS) && !PRCColorMap) return;
+	PokeMini_SetLCDMode(mode);
+}
+
+// Get LCD mode
+int LibPokeMini_GetLCDMode(TLibPokeMini *pm)
+{
+	return (LibPokeMini_Active == pm) ? PokeMini_LCDMode : pm->lcdmode;
+}
+
+// Get pixels of the last frame
+const uint8_t *LibPokeMini_GetPixels(TLibPokeMini *pm, int type)
+{
+	switch (type) {
+		case LIBPOKEMINI_PIXELS_DIGITAL:
+			return pm->pixelsD;
+		case LIBPOKEMINI_PIXELS_ANALOG:
+			return pm->pixelsA;
+		case LIBPOKEMINI_PIXELS_COLOR:
+			LibPokeMini_Select(pm);
+			if (PokeMini_LCDMode != LCDMODE_COLORS) return NULL;
+			return PRCColorPixels;
+		default:
+			return NULL;
+	}
+}
+
+// Read audio samples generated so far
+int LibPokeMini_GetAudio(TLibPokeMini *pm, int16_t *samples, int maxsamples)
+{
+	int num;
+	if (LibPokeMini_Active == pm) LibPokeMini_DrainAudio(pm);
+	num = (maxsamples < pm->audiolen) ? maxsamples : pm->audiolen;
+	if (num <= 0) return 0;
+	memcpy(samples, pm->audio, num * sizeof(int16_t));
+	pm->audiolen -= num;
+	memmove(pm->audio, pm->audio + num, pm->audiolen * sizeof(int16_t));
+	return num;
+}
+
+// Audio samples generated so far
+const int16_t *LibPokeMini_PeekAudio(TLibPokeMini *pm, int *samples)
+{
+	if (LibPokeMini_Active == pm) LibPokeMini_DrainAudio(pm);
+	if (samples) *samples = pm->audiolen;
+	return pm->audio;
+}
+
+// Discard audio samples
+void LibPokeMini_SkipAudio(TLibPokeMini *pm, int samples)
+{
+	if ((samples < 0) || (samples >= pm->audiolen)) {
+		pm->audiolen = 0;
+		return;
+	}
+	pm->audiolen -= samples;
+	memmove(pm->audio, pm->audio + samples, pm->audiolen * sizeof(int16_t));
+}
+
+// RAM and I/O registers
+uint8_t *LibPokeMini_GetRAM(TLibPokeMini *pm)
+{
+	return pm->state.RAM;
+}
+
+// Read memory as the CPU sees it
+uint8_t LibPokeMini_ReadMem(TLibPokeMini *pm, uint32_t addr)
+{
+	uint8_t data;
+	LibPokeMini_Select(pm);
+	data = MinxCPU_OnRead(0, addr & 0x1FFFFF);
+	LibPokeMini_SyncRAM(pm);	// I/O reads may have side effects
+	return data;
+}
+
+// Write memory, ROM is patched
+void LibPokeMini_WriteMem(TLibPokeMini *pm, uint32_t addr, uint8_t data)
+{
+	LibPokeMini_Select(pm);
+	addr &= 0x1FFFFF;
+	if (addr < 0x1000) return;
+	else if (addr < 0x2100) {
+		MinxCPU_OnWrite(0, addr, data);
+		LibPokeMini_SyncRAM(pm);
+	} else if (PM_ROM_Alloc) PM_ROM[addr & PM_ROM_Mask] = data;
+}
+
+// Bytes required by LibPokeMini_SaveState
+int LibPokeMini_StateSize(void)
+{
+	return sizeof(TLibPokeMini_StateHeader) + sizeof(TPokeMini_Snapshot) + 96*64*3;
+}
+
+// Save state to memory
+int LibPokeMini_SaveState(TLibPokeMini *pm, void *state, int size)
+{
+	TLibPokeMini_StateHeader hdr;
+
+	if (size < LibPokeMini_StateSize()) return 0;
+	LibPokeMini_Select(pm);
+	memcpy(hdr.id, "PMLS", 4);
+	hdr.version = PokeMini_ID;
+	hdr.size = LibPokeMini_StateSize();
+	hdr.keys = pm->keys;
+	PokeMini_SaveSnapshot(&pm->state);
+	memcpy(state, &hdr, sizeof(hdr));
+	state = (uint8_t *)state + sizeof(hdr);
+	memcpy(state, &pm->state, sizeof(TPokeMini_Snapshot));
+	state = (uint8_t *)state + sizeof(TPokeMini_Snapshot);
+
+	// LCD output isn't part of the snapshot
+	memcpy(state, pm->pixelsD, 96*64);
+	memcpy((uint8_t *)state + 96*64, pm->pixelsA, 96*64*2);
+	return 1;
+}
+
+// Load state from memory
+int LibPokeMini_LoadState(TLibPokeMini *pm, const void *state, int size)
+{
+	TLibPokeMini_StateHeader hdr;
+
+	if (size < LibPokeMini_StateSize()) return 0;
+	memcpy(&hdr, state, sizeof(hdr));
+	if (memcmp(hdr.id, "PMLS", 4) || (hdr.version != PokeMini_ID) || (hdr.size != (uint32_t)LibPokeMini_StateSize())) return 0;
+	LibPokeMini_Select(pm);
+	state = (const uint8_t *)state + sizeof(hdr);
+	memcpy(&pm->state, state, sizeof(TPokeMini_Snapshot));
+	PokeMini_LoadSnapshot(&pm->state);
+	state = (const uint8_t *)state + sizeof(TPokeMini_Snapshot);
+	memcpy(pm->pixelsD, state, 96*64);
+	memcpy(pm->pixelsA, (const uint8_t *)state + 96*64, 96*64*2);
+	pm->keys = hdr.keys;
+	return 1;
+}
+
+//
+// Batch
+//
+
+#define LIBPOKEMINI_MAXWORKERS	256
+
+struct TLibPokeMini_Batch {
+	int num;			// Number of instances
+	uint8_t *rom;			// ROM, shared by all instances
+	int romsize, rommask;
+
+	// Arena, shared with workers
+	uint8_t *arena;
+	size_t arenasize;
+	TPokeMini_Snapshot *states;	// Hardware [num]
+	uint32_t *keys;			// Keys to hold on next step [num]
+	uint32_t *pressed;		// Keys pressed on hardware [num]
+	uint8_t *pixelsD;		// LCD pixels digital [num][96*64]
+	uint8_t *pixelsA;		// LCD pixels analog [num][96*64]
+	uint8_t *pixelsAS;		// LCD pixels analog decay [num][96*64]
+	uint8_t *ram;			// RAM and I/O after step [num][LIBPOKEMINI_RAMSIZE]
+
+	// Template
+	TPokeMini_Snapshot tstate;
+	uint32_t tkeys;
+	uint8_t tpixels[96*64*3];
+
+	// Workers
+	int workers;
+#ifdef LIBPOKEMINI_WORKERS
+	pid_t pid[LIBPOKEMINI_MAXWORKERS];
+	int fd[LIBPOKEMINI_MAXWORKERS];		// Frames to run and completion, parent side
+#endif
+};
+
+// Load batch ROM into core, sound and colors disabled
+static void LibPokeMini_BatchSwapIn(TLibPokeMini_Batch *b)
+{
+	if (LibPokeMini_Active) {
+		LibPokeMini_SwapOut(LibPokeMini_Active);
+		LibPokeMini_Active = NULL;
+	}
+	PM_ROM = b->rom;
+	PM_ROM_Alloc = 0;
+	PM_ROM_Size = b->romsize;
+	PM_ROM_Mask = b->rommask;
+	PRCColorMap = NULL;
+	if (!PokeMini_FreeBIOS) PokeMini_LoadFreeBIOS();
+	PokeMini_SetLCDMode(LCDMODE_ANALOG);
+	if (SoundEngine != MINX_AUDIO_DISABLED) MinxAudio_ChangeEngine(MINX_AUDIO_DISABLED);
+}
+
+// Step one instance, core must have the batch swapped in
+static void LibPokeMini_BatchRun(TLibPokeMini_Batch *b, int index, int frames)
+{
+	uint32_t changed;
+	int key;
+
+	LCDPixelsD = b->pixelsD + index * 96*64;
+	LCDPixelsA = b->pixelsA + index * 96*64;
+	LCDPixelsAS = b->pixelsAS + index * 96*64;
+	PokeMini_LoadSnapshot(&b->states[index]);
+	changed = (b->pressed[index] ^ b->keys[index]) & 0x3FE;
+	for (key=LIBPOKEMINI_KEY_A; changed; key++) {
+		if (changed & (1 << key)) {
+			PokeMini_KeypadEvent(key, (b->keys[index] >> key) & 1);
+			changed &= ~(1 << key);
+		}
+	}
+	b->pressed[index] = b->keys[index] & 0x3FE;
+	while (frames--) PokeMini_EmulateFrame();
+	PokeMini_SaveSnapshot(&b->states[index]);
+	memcpy(b->ram + index * LIBPOKEMINI_RAMSIZE, PM_RAM, LIBPOKEMINI_RAMSIZE);
+}
+
+// Copy template over instance
+static void LibPokeMini_BatchCopyTemplate(TLibPokeMini_Batch *b, int index)
+{
+	b->states[index] = b->tstate;
+	b->keys[index] = b->pressed[index] = b->tkeys;
+	memcpy(b->pixelsD + index * 96*64, b->tpixels, 96*64);
+	memcpy(b->pixelsA + index * 96*64, b->tpixels + 96*64, 96*64);
+	memcpy(b->pixelsAS + index * 96*64, b->tpixels + 96*64*2, 96*64);
+	memcpy(b->ram + index * LIBPOKEMINI_RAMSIZE, b->tstate.RAM, LIBPOKEMINI_RAMSIZE);
+}
+
+#ifdef LIBPOKEMINI_WORKERS
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0	// SO_NOSIGPIPE is set instead
+#endif
+
+// Receive or send all bytes, retry if interrupted
+// Sending to a dead worker fails without raising SIGPIPE
+static int LibPokeMini_SockIO(int fd, void *data, int size, int wr)
+{
+	ssize_t ret;
+	while (size) {
+		ret = wr ? send(fd, data, size, MSG_NOSIGNAL) : recv(fd, data, size, 0);
+		if ((ret < 0) && (errno == EINTR)) continue;
+		if (ret <= 0) return 0;
+		data = (uint8_t *)data + ret;
+		size -= ret;
+	}
+	return 1;
+}
+
+// Worker process, steps instances first to last-1 until told to quit with 0 frames
+// Workers of later batches inherit the parent end, so EOF alone can't stop us
+static void LibPokeMini_BatchWorker(TLibPokeMini_Batch *b, int first, int last, int fd)
+{
+	int i, frames;
+
+	LibPokeMini_BatchSwapIn(b);
+	while (LibPokeMini_SockIO(fd, &frames, sizeof(int), 0) && (frames > 0)) {
+		for (i=first; i<last; i++) LibPokeMini_BatchRun(b, i, frames);
+		if (!LibPokeMini_SockIO(fd, &frames, sizeof(int), 1)) break;
+	}
+	_exit(0);
+}
+
+// Start workers, return 0 on failure
+static int LibPokeMini_BatchStartWorkers(TLibPokeMini_Batch *b, int workers)
+{
+	int w, j, sv[2];
+#ifdef SO_NOSIGPIPE
+	int on = 1;
+#endif
+
+	for (w=0; w<workers; w++) {
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv)) return 0;
+#ifdef SO_NOSIGPIPE
+		setsockopt(sv[0], SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+		setsockopt(sv[1], SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+		fflush(NULL);
+		b->pid[w] = fork();
+		if (b->pid[w] == 0) {
+			// Only keep our own socket end
+			for (j=0; j<w; j++) close(b->fd[j]);
+			close(sv[0]);
+			LibPokeMini_BatchWorker(b, w * b->num / workers, (w + 1) * b->num / workers, sv[1]);
+		}
+		close(sv[1]);
+		if (b->pid[w] < 0) {
+			close(sv[0]);
+			return 0;
+		}
+		b->fd[w] = sv[0];
+		b->workers = w + 1;
+	}
+	return 1;
+}
+
+// Stop workers
+static void LibPokeMini_BatchStopWorkers(TLibPokeMini_Batch *b)
+{
+	int w, quit = 0;
+	for (w=0; w<b->workers; w++) {
+		LibPokeMini_SockIO(b->fd[w], &quit, sizeof(int), 1);
+		close(b->fd[w]);
+	}
+	for (w=0; w<b->workers; w++) {
+		while ((waitpid(b->pid[w], NULL, 0) < 0) && (errno == EINTR));
+	}
+	b->workers = 0;
+}
+
+#endif
+
+// Create batch of ROM file
+TLibPokeMini_Batch *LibPokeMini_BatchCreate(const char *filename, int num, int workers)
+{
+	TLibPokeMini_Batch *b;
+	size_t size;
+	int i;
+
+	if (num <= 0) return NULL;
+#ifdef LIBPOKEMINI_WORKERS
+	if (workers > LIBPOKEMINI_MAXWORKERS) workers = LIBPOKEMINI_MAXWORKERS;
+	if (workers > num) workers = num;
+#else
+	workers = 0;
+#endif
+	if (!LibPokeMini_Instances && !LibPokeMini_Init()) return NULL;
+	b = (TLibPokeMini_Batch *)malloc(sizeof(TLibPokeMini_Batch));
+	if (!b) goto fail_instance;
+	memset(b, 0, sizeof(TLibPokeMini_Batch));
+	b->num = num;
+
+	// Arena, each array aligned to 64 bytes
+	size = 0;
+	size += (num * sizeof(TPokeMini_Snapshot) + 63) & ~63;
+	size += (num * sizeof(uint32_t) * 2 + 63) & ~63;
+	size += (num * 96*64 * 3 + 63) & ~63;
+	size += num * LIBPOKEMINI_RAMSIZE;
+	b->arenasize = size;
+#ifdef LIBPOKEMINI_WORKERS
+	b->arena = (uint8_t *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (b->arena == (uint8_t *)MAP_FAILED) b->arena = NULL;
+#else
+	b->arena = (uint8_t *)malloc(size);
+	if (b->arena) memset(b->arena, 0, size);
+#endif
+	if (!b->arena) goto fail_batch;
+	b->states = (TPokeMini_Snapshot *)b->arena;
+	b->keys = (uint32_t *)(b->arena + ((num * sizeof(TPokeMini_Snapshot) + 63) & ~63));
+	b->pressed = b->keys + num;
+	b->pixelsD = (uint8_t *)b->keys + ((num * sizeof(uint32_t) * 2 + 63) & ~63);
+	b->pixelsA = b->pixelsD + num * 96*64;
+	b->pixelsAS = b->pixelsA + num * 96*64;
+	b->ram = b->pixelsD + ((num * 96*64 * 3 + 63) & ~63);
+
+	// Load ROM and take it from the core
+	if (LibPokeMini_Active) {
+		LibPokeMini_SwapOut(LibPokeMini_Active);
+		LibPokeMini_Active = NULL;
+	}
+	PM_ROM = (uint8_t *)PM_RAM;
+	PM_ROM_Alloc = 0;
+	LCDPixelsD = b->pixelsD;
+	LCDPixelsA = b->pixelsA;
+	LCDPixelsAS = b->pixelsAS;
+	CommandLine.lcdmode = LCDMODE_ANALOG;
+	if (!PokeMini_LoadROM(filename) || !PM_ROM_Alloc) goto fail_arena;
+	b->rom = PM_ROM;
+	b->romsize = PM_ROM_Size;
+	b->rommask = PM_ROM_Mask;
+	PokeMini_FreeColorInfo();
+	LibPokeMini_BatchSwapIn(b);
+
+	// Template is the first instance after hard reset
+	PokeMini_Reset(1);
+	PokeMini_SaveSnapshot(&b->tstate);
+	b->tkeys = 0;
+	memcpy(b->tpixels, b->pixelsD, 96*64);
+	memcpy(b->tpixels + 96*64, b->pixelsA, 96*64);
+	memcpy(b->tpixels + 96*64*2, b->pixelsAS, 96*64);
+	for (i=0; i<num; i++) LibPokeMini_BatchCopyTemplate(b, i);
+	LibPokeMini_Instances++;
+
+#ifdef LIBPOKEMINI_WORKERS
+	if (workers > 0) {
+		if (!LibPokeMini_BatchStartWorkers(b, workers)) {
+			LibPokeMini_BatchDestroy(b);
+			return NULL;
+		}
+	}
+#endif
+	return b;
+
+fail_arena:
+	LCDPixelsD = LibPokeMini_CorePixelsD;
+	LCDPixelsA = LibPokeMini_CorePixelsA;
+	LCDPixelsAS = LibPokeMini_CorePixelsA + 96*64;
+#ifdef LIBPOKEMINI_WORKERS
+	munmap(b->arena, b->arenasize);
+#else
+	free(b->arena);
+#endif
+fail_batch:
+	free(b);
+fail_instance:
+	if (!LibPokeMini_Instances) PokeMini_Destroy();
+	return NULL;
+}
+
+// Destroy batch
+void LibPokeMini_BatchDestroy(TLibPokeMini_Batch *b)
+{
+	if (!b) return;
+#ifdef LIBPOKEMINI_WORKERS
+	LibPokeMini_BatchStopWorkers(b);
+#endif
+
+	// Core pixels and dummy ROM back if the batch was loaded
+	if (!LibPokeMini_Active) {
+		LCDPixelsD = LibPokeMini_CorePixelsD;
+		LCDPixelsA = LibPokeMini_CorePixelsA;
+		LCDPixelsAS = LibPokeMini_CorePixelsA + 96*64;
+		PM_ROM = (uint8_t *)PM_RAM;
+		PM_ROM_Alloc = 0;
+		PM_ROM_Size = 0x2000;
+		PM_ROM_Mask = 0x1FFF;
+	}
+	free(b->rom);
+#ifdef LIBPOKEMINI_WORKERS
+	munmap(b->arena, b->arenasize);
+#else
+	free(b->arena);
+#endif
+	free(b);
+
+	// Last instance shutdown the core
+	if (!--LibPokeMini_Instances) PokeMini_Destroy();
+}
+
+// Number of instances
+int LibPokeMini_BatchSize(TLibPokeMini_Batch *b)
+{
+	return b->num;
+}
+
+// Run frames on all instances
+int LibPokeMini_BatchStep(TLibPokeMini_Batch *b, const uint32_t *keys, int frames)
+{
+	int i;
+
+	if (keys) memcpy(b->keys, keys, b->num * sizeof(uint32_t));
+	if (frames <= 0) return 1;
+#ifdef LIBPOKEMINI_WORKERS
+	if (b->workers) {
+		int w, ok = 1;
+		for (w=0; w<b->workers; w++) {
+			if (!LibPokeMini_SockIO(b->fd[w], &frames, sizeof(int), 1)) ok = 0;
+		}
+		for (w=0; w<b->workers; w++) {
+			if (!LibPokeMini_SockIO(b->fd[w], &i, sizeof(int), 0)) ok = 0;
+		}
+		return ok;
+	}
+#endif
+	LibPokeMini_BatchSwapIn(b);
+	for (i=0; i<b->num; i++) LibPokeMini_BatchRun(b, i, frames);
+	return 1;
+}
+
+// Pixels of all instances
+const uint8_t *LibPokeMini_BatchPixels(TLibPokeMini_Batch *b, int type)
+{
+	if (type == LIBPOKEMINI_PIXELS_DIGITAL) return b->pixelsD;
+	if (type == LIBPOKEMINI_PIXELS_ANALOG) return b->pixelsA;
+	return NULL;
+}
+
+// RAM of all instances
+const uint8_t *LibPokeMini_BatchRAM(TLibPokeMini_Batch *b)
+{
+	return b->ram;
+}
+
+// Set template from state
+int LibPokeMini_BatchSetTemplate(TLibPokeMini_Batch *b, const void *state, int size)
+{
+	TLibPokeMini_StateHeader hdr;
+
+	if (size < LibPokeMini_StateSize()) return 0;
+	memcpy(&hdr, state, sizeof(hdr));
+	if (memcmp(hdr.id, "PMLS", 4) || (hdr.version != PokeMini_ID) || (hdr.size != (uint32_t)LibPokeMini_StateSize())) return 0;
+	state = (const uint8_t *)state + sizeof(hdr);
+	memcpy(&b->tstate, state, sizeof(TPokeMini_Snapshot));
+	state = (const uint8_t *)state + sizeof(TPokeMini_Snapshot);
+	memcpy(b->tpixels, state, 96*64*3);
+	b->tkeys = hdr.keys;
+	return 1;
+}
+
+// Set template from instance
+void LibPokeMini_BatchSaveTemplate(TLibPokeMini_Batch *b, int index)
+{
+	if ((index < 0) || (index >= b->num)) return;
+	b->tstate = b->states[index];
+	b->tkeys = b->pressed[index];
+	memcpy(b->tpixels, b->pixelsD + index * 96*64, 96*64);
+	memcpy(b->tpixels + 96*64, b->pixelsA + index * 96*64, 96*64);
+	memcpy(b->tpixels + 96*64*2, b->pixelsAS + index * 96*64, 96*64);
+}
+
+// Reset instances to template
+void LibPokeMini_BatchReset(TLibPokeMini_Batch *b, const uint8_t *mask)
+{
+	int i;
+	for (i=0; i<b->num; i++) {
+		if (!mask || mask[i]) LibPokeMini_BatchCopyTemplate(b, i);
+	}
+}
@@ -0,0 +1,225 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LIBPOKEMINI_H
+#define LIBPOKEMINI_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// libpokemini, emulator core as a library
+//
+// Only this header is public. The minor version is bumped when calls are
+// added and the major when existing calls or the savestate layout change,
+// compare LibPokeMini_Version() against LIBPOKEMINI_VERSION at runtime.
+//
+// The core keeps the emulated hardware in globals, so each instance owns a
+// copy of it and the instance used by the last call is swapped in (about
+// 32KB of copies per switch). Any number of instances can exist but calls
+// must come from one thread at a time.
+
+#define LIBPOKEMINI_VERSION_MAJOR	1
+#define LIBPOKEMINI_VERSION_MINOR	2
+#define LIBPOKEMINI_VERSION		((LIBPOKEMINI_VERSION_MAJOR << 16) | LIBPOKEMINI_VERSION_MINOR)
+
+#if defined(_WIN32) && defined(LIBPOKEMINI_BUILD)
+#define LIBPOKEMINI_API		__declspec(dllexport)
+#elif defined(_WIN32) && defined(LIBPOKEMINI_DLL)
+#define LIBPOKEMINI_API		__declspec(dllimport)
+#elif defined(__GNUC__) && (__GNUC__ >= 4)
+#define LIBPOKEMINI_API		__attribute__((visibility("default")))
+#else
+#define LIBPOKEMINI_API
+#endif
+
+// Screen size, pixels are 1 byte each without padding
+#define LIBPOKEMINI_WIDTH	96
+#define LIBPOKEMINI_HEIGHT	64
+
+// RAM and I/O registers from 0x1000 (LCD framebuffer at 0x1000, I/O at 0x2000)
+#define LIBPOKEMINI_RAMSIZE	0x1100
+
+// Cycles per frame at 4MHz (~72Hz)
+#define LIBPOKEMINI_FRAMECYCLES	55634
+
+// Audio output, signed 16-bits mono
+#define LIBPOKEMINI_AUDIOFREQ	44100
+#define LIBPOKEMINI_AUDIOSIZE	8192	// Samples kept per instance until read
+
+// Create flags
+#define LIBPOKEMINI_NOSOUND	0x01	// Don't emulate audio output
+
+// Keys, bit number in LibPokeMini_SetKeys mask
+enum {
+	LIBPOKEMINI_KEY_A = 1,
+	LIBPOKEMINI_KEY_B = 2,
+	LIBPOKEMINI_KEY_C = 3,
+	LIBPOKEMINI_KEY_UP = 4,
+	LIBPOKEMINI_KEY_DOWN = 5,
+	LIBPOKEMINI_KEY_LEFT = 6,
+	LIBPOKEMINI_KEY_RIGHT = 7,
+	LIBPOKEMINI_KEY_POWER = 8,
+	LIBPOKEMINI_KEY_SHOCK = 9
+};
+
+// LCD modes
+enum {
+	LIBPOKEMINI_LCD_ANALOG = 0,	// Mix frames like the real LCD
+	LIBPOKEMINI_LCD_3SHADES,
+	LIBPOKEMINI_LCD_2SHADES,
+	LIBPOKEMINI_LCD_COLORS		// Unofficial colors, needs color information
+};
+
+// Pixel buffers
+enum {
+	LIBPOKEMINI_PIXELS_DIGITAL = 0,	// 0 or 1 per pixel, as the LCD shows now
+	LIBPOKEMINI_PIXELS_ANALOG,	// 0 to 255 intensity with LCD persistence
+	LIBPOKEMINI_PIXELS_COLOR	// Palette index, LIBPOKEMINI_LCD_COLORS only
+};
+
+typedef struct TLibPokeMini TLibPokeMini;
+
+// Version the library was built with (LIBPOKEMINI_VERSION)
+LIBPOKEMINI_API uint32_t LibPokeMini_Version(void);
+
+// Create instance with FreeBIOS and no cartridge, return NULL on failure
+LIBPOKEMINI_API TLibPokeMini *LibPokeMini_Create(int flags);
+
+// Destroy instance
+LIBPOKEMINI_API void LibPokeMini_Destroy(TLibPokeMini *pm);
+
+// Load BIOS file, NULL for FreeBIOS, return 0 on failure
+// Takes effect on next reset
+LIBPOKEMINI_API int LibPokeMini_LoadBIOS(TLibPokeMini *pm, const char *filename);
+
+// Load ROM from .min, .minc or .zip and hard reset, return 0 on failure
+// Color information (.minc) beside the ROM switches to LIBPOKEMINI_LCD_COLORS
+LIBPOKEMINI_API int LibPokeMini_LoadROM(TLibPokeMini *pm, const char *filename);
+
+// Load ROM from memory (copied) and hard reset, return 0 on failure
+LIBPOKEMINI_API int LibPokeMini_LoadROMMem(TLibPokeMini *pm, const void *data, int size);
+
+// Reset, hard reset also clears RAM
+LIBPOKEMINI_API void LibPokeMini_Reset(TLibPokeMini *pm, int hardreset);
+
+// Run until the end of the next frame, return cycles ran
+LIBPOKEMINI_API int LibPokeMini_RunFrame(TLibPokeMini *pm);
+
+// Run at least the specified cycles, return cycles ran
+LIBPOKEMINI_API int LibPokeMini_RunCycles(TLibPokeMini *pm, int cycles);
+
+// Run frames, keys[frame] is set before each frame when keys isn't NULL
+// Pixels of type are copied to output[frame * 96 * 64] when output isn't NULL
+// Return frames ran, less than requested only if type is unavailable
+LIBPOKEMINI_API int LibPokeMini_RunFrames(TLibPokeMini *pm, const uint32_t *keys, int frames, uint8_t *output, int type);
+
+// Set pressed keys, bit (1 << LIBPOKEMINI_KEY_*) set when pressed
+LIBPOKEMINI_API void LibPokeMini_SetKeys(TLibPokeMini *pm, uint32_t keys);
+
+// Get pressed keys
+LIBPOKEMINI_API uint32_t LibPokeMini_GetKeys(TLibPokeMini *pm);
+
+// Set LCD mode (LIBPOKEMINI_LCD_*)
+LIBPOKEMINI_API void LibPokeMini_SetLCDMode(TLibPokeMini *pm, int mode);
+
+// Get LCD mode
+LIBPOKEMINI_API int LibPokeMini_GetLCDMode(TLibPokeMini *pm);
+
+// Get LIBPOKEMINI_WIDTH x LIBPOKEMINI_HEIGHT pixels of the last frame, NULL if unavailable
+// Digital and analog are owned by the instance and valid until it's destroyed,
+// color aliases the core page being shown so it's only valid until the next call
+LIBPOKEMINI_API const uint8_t *LibPokeMini_GetPixels(TLibPokeMini *pm, int type);
+
+// Read audio samples generated so far, return number of samples
+LIBPOKEMINI_API int LibPokeMini_GetAudio(TLibPokeMini *pm, int16_t *samples, int maxsamples);
+
+// Audio samples generated so far without copying, valid until the next call
+LIBPOKEMINI_API const int16_t *LibPokeMini_PeekAudio(TLibPokeMini *pm, int *samples);
+
+// Discard audio samples from the start, negative for all
+LIBPOKEMINI_API void LibPokeMini_SkipAudio(TLibPokeMini *pm, int samples);
+
+// Get LIBPOKEMINI_RAMSIZE bytes of RAM and I/O registers of the instance
+// Valid until destroyed, writes are seen by the core on the next call
+LIBPOKEMINI_API uint8_t *LibPokeMini_GetRAM(TLibPokeMini *pm);
+
+// Read and write memory as the CPU sees it (21-bits address)
+LIBPOKEMINI_API uint8_t LibPokeMini_ReadMem(TLibPokeMini *pm, uint32_t addr);
+LIBPOKEMINI_API void LibPokeMini_WriteMem(TLibPokeMini *pm, uint32_t addr, uint8_t data);
+
+// Bytes required by LibPokeMini_SaveState
+// States are tied to the library build, the ROM isn't included but the
+// LCD output is, so analog pixels replay identically after loading
+LIBPOKEMINI_API int LibPokeMini_StateSize(void);
+
+// Save state to memory, return 0 if size is too small
+LIBPOKEMINI_API int LibPokeMini_SaveState(TLibPokeMini *pm, void *state, int size);
+
+// Load state from memory, return 0 if the state is invalid
+LIBPOKEMINI_API int LibPokeMini_LoadState(TLibPokeMini *pm, const void *state, int size);
+
+// Batch, many instances of one ROM stepped in lockstep
+//
+// Hardware, LCD output and RAM of every instance live in one arena, each
+// kind contiguous across instances, so pixels of all instances form a
+// single [num][64][96] tensor. Steps are split between worker processes
+// sharing the arena (the core can't run twice in one process), resets
+// copy a template over the instances. Sound and colors are disabled.
+
+typedef struct TLibPokeMini_Batch TLibPokeMini_Batch;
+
+// Create num instances of ROM file after hard reset, workers processes
+// to step them (0 to step in the caller), return NULL on failure
+// Workers aren't supported on Windows and are ignored there
+LIBPOKEMINI_API TLibPokeMini_Batch *LibPokeMini_BatchCreate(const char *filename, int num, int workers);
+
+// Destroy batch and stop workers
+LIBPOKEMINI_API void LibPokeMini_BatchDestroy(TLibPokeMini_Batch *batch);
+
+// Number of instances
+LIBPOKEMINI_API int LibPokeMini_BatchSize(TLibPokeMini_Batch *batch);
+
+// Run frames on all instances, keys[n] is held on instance n when keys
+// isn't NULL, return 0 if a worker failed
+LIBPOKEMINI_API int LibPokeMini_BatchStep(TLibPokeMini_Batch *batch, const uint32_t *keys, int frames);
+
+// Pixels of the last frame on all instances, [num][64][96] contiguous
+// LIBPOKEMINI_PIXELS_DIGITAL or LIBPOKEMINI_PIXELS_ANALOG, valid until destroyed
+LIBPOKEMINI_API const uint8_t *LibPokeMini_BatchPixels(TLibPokeMini_Batch *batch, int type);
+
+// RAM and I/O registers of all instances after the last step or reset,
+// [num][LIBPOKEMINI_RAMSIZE] contiguous, valid until destroyed
+LIBPOKEMINI_API const uint8_t *LibPokeMini_BatchRAM(TLibPokeMini_Batch *batch);
+
+// Set template from LibPokeMini_SaveState, return 0 if the state is invalid
+LIBPOKEMINI_API int LibPokeMini_BatchSetTemplate(TLibPokeMini_Batch *batch, const void *state, int size);
+
+// Set template from instance
+LIBPOKEMINI_API void LibPokeMini_BatchSaveTemplate(TLibPokeMini_Batch *batch, int index);
+
+// Reset instances to template, mask[n] selects instance n, NULL for all
+LIBPOKEMINI_API void LibPokeMini_BatchReset(TLibPokeMini_Batch *batch, const uint8_t *mask);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
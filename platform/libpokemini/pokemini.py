@@ -0,0 +1,395 @@
+#  PokeMini - Pokemon-Mini Emulator
+#  Copyright (C) 2009-2015  JustBurn
+#
+#  This program is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""Python bindings for libpokemini (ctypes, NumPy optional)
+
+Pixels, RAM and pending audio are returned as views that alias the library
+memory, NumPy arrays when NumPy is installed or memoryviews otherwise. The
+digital and analog pixel views and RAM stay valid and keep updating until
+close(). Color pixels and audio alias memory that moves when another
+instance is called, so fetch them again after stepping a different instance.
+
+The library is searched in POKEMINI_LIB, beside this file and then on the
+system library path.
+"""
+
+import ctypes
+import os
+import sys
+
+try:
+    import numpy
+except ImportError:
+    numpy = None
+
+WIDTH = 96
+HEIGHT = 64
+FRAMECYCLES = 55634
+AUDIOFREQ = 44100
+RAMSIZE = 0x1100
+
+NOSOUND = 0x01
+
+KEY_A = 1
+KEY_B = 2
+KEY_C = 3
+KEY_UP = 4
+KEY_DOWN = 5
+KEY_LEFT = 6
+KEY_RIGHT = 7
+KEY_POWER = 8
+KEY_SHOCK = 9
+
+LCD_ANALOG = 0
+LCD_3SHADES = 1
+LCD_2SHADES = 2
+LCD_COLORS = 3
+
+PIXELS_DIGITAL = 0
+PIXELS_ANALOG = 1
+PIXELS_COLOR = 2
+
+_PIXELS = {'digital': PIXELS_DIGITAL, 'analog': PIXELS_ANALOG, 'color': PIXELS_COLOR}
+
+# Required library version (major, minor)
+_VERSION = (1, 2)
+
+
+def _load_library():
+    if sys.platform == 'win32':
+        names = ['pokemini.dll']
+    elif sys.platform == 'darwin':
+        names = ['libpokemini.dylib', 'libpokemini.so']
+    else:
+        names = ['libpokemini.so.1', 'libpokemini.so']
+    paths = []
+    if os.environ.get('POKEMINI_LIB'):
+        paths.append(os.environ['POKEMINI_LIB'])
+    here = os.path.dirname(os.path.abspath(__file__))
+    paths += [os.path.join(here, name) for name in names] + names
+    for path in paths:
+        try:
+            return ctypes.CDLL(path)
+        except OSError:
+            pass
+    raise OSError('libpokemini not found, set POKEMINI_LIB')
+
+
+def _bind(lib):
+    c_pm = ctypes.c_void_p
+    u8p = ctypes.POINTER(ctypes.c_uint8)
+    u32p = ctypes.POINTER(ctypes.c_uint32)
+    s16p = ctypes.POINTER(ctypes.c_int16)
+    protos = {
+        'Version': (ctypes.c_uint32, []),
+        'Create': (c_pm, [ctypes.c_int]),
+        'Destroy': (None, [c_pm]),
+        'LoadBIOS': (ctypes.c_int, [c_pm, ctypes.c_char_p]),
+        'LoadROM': (ctypes.c_int, [c_pm, ctypes.c_char_p]),
+        'LoadROMMem': (ctypes.c_int, [c_pm, ctypes.c_void_p, ctypes.c_int]),
+        'Reset': (None, [c_pm, ctypes.c_int]),
+        'RunFrame': (ctypes.c_int, [c_pm]),
+        'RunCycles': (ctypes.c_int, [c_pm, ctypes.c_int]),
+        'RunFrames': (ctypes.c_int, [c_pm, u32p, ctypes.c_int, u8p, ctypes.c_int]),
+        'SetKeys': (None, [c_pm, ctypes.c_uint32]),
+        'GetKeys': (ctypes.c_uint32, [c_pm]),
+        'SetLCDMode': (None, [c_pm, ctypes.c_int]),
+        'GetLCDMode': (ctypes.c_int, [c_pm]),
+        'GetPixels': (u8p, [c_pm, ctypes.c_int]),
+        'GetAudio': (ctypes.c_int, [c_pm, s16p, ctypes.c_int]),
+        'PeekAudio': (s16p, [c_pm, ctypes.POINTER(ctypes.c_int)]),
+        'SkipAudio': (None, [c_pm, ctypes.c_int]),
+        'GetRAM': (u8p, [c_pm]),
+        'ReadMem': (ctypes.c_uint8, [c_pm, ctypes.c_uint32]),
+        'WriteMem': (None, [c_pm, ctypes.c_uint32, ctypes.c_uint8]),
+        'StateSize': (ctypes.c_int, []),
+        'SaveState': (ctypes.c_int, [c_pm, ctypes.c_void_p, ctypes.c_int]),
+        'LoadState': (ctypes.c_int, [c_pm, ctypes.c_void_p, ctypes.c_int]),
+        'BatchCreate': (c_pm, [ctypes.c_char_p, ctypes.c_int, ctypes.c_int]),
+        'BatchDestroy': (None, [c_pm]),
+        'BatchSize': (ctypes.c_int, [c_pm]),
+        'BatchStep': (ctypes.c_int, [c_pm, u32p, ctypes.c_int]),
+        'BatchPixels': (u8p, [c_pm, ctypes.c_int]),
+        'BatchRAM': (u8p, [c_pm]),
+        'BatchSetTemplate': (ctypes.c_int, [c_pm, ctypes.c_void_p, ctypes.c_int]),
+        'BatchSaveTemplate': (None, [c_pm, ctypes.c_int]),
+        'BatchReset': (None, [c_pm, u8p]),
+    }
+    for name, (restype, argtypes) in protos.items():
+        func = getattr(lib, 'LibPokeMini_' + name)
+        func.restype = restype
+        func.argtypes = argtypes
+    version = lib.LibPokeMini_Version()
+    if (version >> 16) != _VERSION[0] or (version & 0xFFFF) < _VERSION[1]:
+        raise OSError('libpokemini %d.%d is incompatible, need %d.%d or newer' %
+                      ((version >> 16), (version & 0xFFFF), _VERSION[0], _VERSION[1]))
+    return lib
+
+
+_lib = None
+
+
+def library():
+    """Return the loaded library, loading it on first use"""
+    global _lib
+    if _lib is None:
+        _lib = _bind(_load_library())
+    return _lib
+
+
+def _view(ptr, ctype, count, shape):
+    # Alias count elements at ptr, without copying
+    if not ptr:
+        return None
+    array = (ctype * count).from_address(ctypes.addressof(ptr.contents))
+    if numpy is not None:
+        return numpy.ctypeslib.as_array(array).reshape(shape)
+    view = memoryview(array).cast('B')
+    if ctype is ctypes.c_int16:
+        view = view.cast('h')
+    elif len(shape) > 1:
+        view = view.cast('B', shape)
+    return view
+
+
+def keymask(*keys):
+    """Build key mask from KEY_* values"""
+    mask = 0
+    for key in keys:
+        mask |= 1 << key
+    return mask
+
+
+class PokeMini(object):
+    """Emulator instance"""
+
+    def __init__(self, rom=None, bios=None, sound=True):
+        self._lib = library()
+        self._pm = self._lib.LibPokeMini_Create(0 if sound else NOSOUND)
+        if not self._pm:
+            raise MemoryError('libpokemini instance creation failed')
+        self._keys = None
+        if bios is not None:
+            self.load_bios(bios)
+        if rom is not None:
+            self.load_rom(rom)
+
+    def close(self):
+        """Destroy instance, views of it become invalid"""
+        if self._pm:
+            self._lib.LibPokeMini_Destroy(self._pm)
+            self._pm = None
+
+    def __del__(self):
+        self.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def load_bios(self, filename=None):
+        """Load BIOS file, None for FreeBIOS"""
+        name = None if filename is None else os.fsencode(filename)
+        if not self._lib.LibPokeMini_LoadBIOS(self._pm, name):
+            raise IOError('Loading BIOS failed')
+
+    def load_rom(self, rom):
+        """Load ROM from filename or bytes and hard reset"""
+        if isinstance(rom, (bytes, bytearray, memoryview)):
+            data = bytes(rom)
+            ok = self._lib.LibPokeMini_LoadROMMem(self._pm, data, len(data))
+        else:
+            ok = self._lib.LibPokeMini_LoadROM(self._pm, os.fsencode(rom))
+        if not ok:
+            raise IOError('Loading ROM failed')
+
+    def reset(self, hard=True):
+        self._lib.LibPokeMini_Reset(self._pm, 1 if hard else 0)
+
+    @property
+    def keys(self):
+        """Pressed keys mask, bit (1 << KEY_*)"""
+        return self._lib.LibPokeMini_GetKeys(self._pm)
+
+    @keys.setter
+    def keys(self, mask):
+        self._lib.LibPokeMini_SetKeys(self._pm, mask)
+
+    @property
+    def lcdmode(self):
+        return self._lib.LibPokeMini_GetLCDMode(self._pm)
+
+    @lcdmode.setter
+    def lcdmode(self, mode):
+        self._lib.LibPokeMini_SetLCDMode(self._pm, mode)
+
+    def run_frame(self):
+        """Run one frame, return cycles ran"""
+        return self._lib.LibPokeMini_RunFrame(self._pm)
+
+    def run_cycles(self, cycles):
+        """Run at least the specified cycles, return cycles ran"""
+        return self._lib.LibPokeMini_RunCycles(self._pm, cycles)
+
+    def step(self, actions, n_frames=None, pixels='analog', out=None):
+        """Run frames in a single library call
+
+        actions is a key mask held for all frames or one mask per frame.
+        Returns a (n_frames, 64, 96) array with the pixels of every frame,
+        written into out when given, or None when pixels is None.
+        """
+        if isinstance(actions, int):
+            n_frames = 1 if n_frames is None else n_frames
+            self._lib.LibPokeMini_SetKeys(self._pm, actions)
+            keys = None
+        else:
+            if n_frames is None:
+                n_frames = len(actions)
+            elif len(actions) < n_frames:
+                raise ValueError('Less actions than frames')
+            if self._keys is None or len(self._keys) < n_frames:
+                self._keys = (ctypes.c_uint32 * n_frames)()
+            self._keys[:n_frames] = [int(a) for a in actions[:n_frames]]
+            keys = self._keys
+        output = None
+        if pixels is not None:
+            size = n_frames * WIDTH * HEIGHT
+            if out is None:
+                out = numpy.empty((n_frames, HEIGHT, WIDTH), numpy.uint8) if numpy is not None else bytearray(size)
+            if len(memoryview(out).cast('B')) < size:
+                raise ValueError('Output is too small')
+            output = (ctypes.c_uint8 * size).from_buffer(out)
+        ran = self._lib.LibPokeMini_RunFrames(self._pm, keys, n_frames, output, _PIXELS[pixels] if pixels else 0)
+        if ran < n_frames:
+            raise ValueError('Pixels %s unavailable in this LCD mode' % pixels)
+        return out
+
+    def pixels(self, kind='analog'):
+        """View (64, 96) of the last frame pixels: digital, analog or color"""
+        ptr = self._lib.LibPokeMini_GetPixels(self._pm, _PIXELS[kind])
+        return _view(ptr, ctypes.c_uint8, WIDTH * HEIGHT, (HEIGHT, WIDTH))
+
+    @property
+    def ram(self):
+        """View of RAM and I/O registers (0x1000 to 0x20FF), writable"""
+        return _view(self._lib.LibPokeMini_GetRAM(self._pm), ctypes.c_uint8, RAMSIZE, (RAMSIZE,))
+
+    @property
+    def audio(self):
+        """View of pending audio samples (signed 16-bits), call consume_audio after use"""
+        count = ctypes.c_int(0)
+        ptr = self._lib.LibPokeMini_PeekAudio(self._pm, ctypes.byref(count))
+        if not count.value:
+            return numpy.zeros(0, numpy.int16) if numpy is not None else memoryview(b'').cast('h')
+        return _view(ptr, ctypes.c_int16, count.value, (count.value,))
+
+    def consume_audio(self, samples=-1):
+        """Discard pending audio samples, all by default"""
+        self._lib.LibPokeMini_SkipAudio(self._pm, samples)
+
+    def read(self, addr):
+        return self._lib.LibPokeMini_ReadMem(self._pm, addr)
+
+    def write(self, addr, data):
+        self._lib.LibPokeMini_WriteMem(self._pm, addr, data)
+
+    def save_state(self):
+        """Return savestate as bytes"""
+        size = self._lib.LibPokeMini_StateSize()
+        buf = ctypes.create_string_buffer(size)
+        self._lib.LibPokeMini_SaveState(self._pm, buf, size)
+        return buf.raw
+
+    def load_state(self, state):
+        """Load savestate from save_state"""
+        if not self._lib.LibPokeMini_LoadState(self._pm, bytes(state), len(state)):
+            raise ValueError('Invalid state')
+
+
+class Batch(object):
+    """Many instances of one ROM stepped in lockstep
+
+    Pixels and RAM of all instances are single contiguous arrays that alias
+    the library arena and stay valid until close(). Steps are split between
+    worker processes, sound and colors are disabled.
+    """
+
+    def __init__(self, rom, num, workers=0):
+        self._lib = library()
+        self._batch = self._lib.LibPokeMini_BatchCreate(os.fsencode(rom), num, workers)
+        if not self._batch:
+            raise IOError('Creating batch failed')
+        self.num = num
+        self._keys = (ctypes.c_uint32 * num)()
+        self._mask = (ctypes.c_uint8 * num)()
+
+    def close(self):
+        """Destroy batch and stop workers, views of it become invalid"""
+        if self._batch:
+            self._lib.LibPokeMini_BatchDestroy(self._batch)
+            self._batch = None
+
+    def __del__(self):
+        self.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def __len__(self):
+        return self.num
+
+    def step(self, actions=None, n_frames=1):
+        """Run frames holding actions[n] keys on instance n, return pixels('analog')"""
+        keys = None
+        if actions is not None:
+            self._keys[:] = [int(a) for a in actions]
+            keys = self._keys
+        if not self._lib.LibPokeMini_BatchStep(self._batch, keys, n_frames):
+            raise RuntimeError('Batch worker failed')
+        return self.pixels()
+
+    def pixels(self, kind='analog'):
+        """View (num, 64, 96) of the last frame pixels: digital or analog"""
+        ptr = self._lib.LibPokeMini_BatchPixels(self._batch, _PIXELS[kind])
+        return _view(ptr, ctypes.c_uint8, self.num * WIDTH * HEIGHT, (self.num, HEIGHT, WIDTH))
+
+    @property
+    def ram(self):
+        """View (num, RAMSIZE) of RAM and I/O registers after the last step, read only"""
+        ptr = self._lib.LibPokeMini_BatchRAM(self._batch)
+        return _view(ptr, ctypes.c_uint8, self.num * RAMSIZE, (self.num, RAMSIZE))
+
+    def set_template(self, state):
+        """Set template from PokeMini.save_state"""
+        if not self._lib.LibPokeMini_BatchSetTemplate(self._batch, bytes(state), len(state)):
+            raise ValueError('Invalid state')
+
+    def save_template(self, index):
+        """Set template from instance"""
+        self._lib.LibPokeMini_BatchSaveTemplate(self._batch, index)
+
+    def reset(self, mask=None):
+        """Reset instances to template, mask[n] selects instance n, None for all"""
+        if mask is None:
+            self._lib.LibPokeMini_BatchReset(self._batch, None)
+        else:
+            self._mask[:] = [1 if m else 0 for m in mask]
+            self._lib.LibPokeMini_BatchReset(self._batch, self._mask)
@@ -221,10 +221,11 @@ void MinxCPU_OnWrite(int cpu, uint32_t addr, uint8_t data)
 		}
 	} else if (addr >= 0x1300) {
 		// RAM Write
-		PM_RAM[addr-0x1000] = data;
+		PM_RAM[addr-0x1000] = PokeMini_CheatWrite(addr, data);
 		return;
 	} else if (addr >= 0x1000) {
 		// RAM Write / FrameBuffer
+		data = PokeMini_CheatWrite(addr, data);
 		PM_RAM[addr-0x1000] = data;
 		if (PRCColorMap) MinxColorPRC_WriteFramebuffer(addr-0x1000, data);
 		return;
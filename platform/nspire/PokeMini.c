@@ -367,6 +367,7 @@ void PokeMini_FreeColorInfo()
 		free(PRCColorMap);
 		PRCColorMap = NULL;
 	}
+	MinxColorPRC_ColorMapChanged();
 }
 
 // Syncronize host time
@@ -444,6 +445,7 @@ int PokeMini_LoadColorStream(TPokeMini_StreamIO stream, void *stream_ptr)
 			PRCColorMap[i] = RemapMINC10_11[PRCColorMap[i] & 15] | (PRCColorMap[i] & 0xF0);
 		}
 	}
+	MinxColorPRC_ColorMapChanged();
 
 	return (readbytes > 0);
 }
@@ -498,7 +498,7 @@ int main(int argc, char **argv)
 	unsigned long NewTickSync = 0, CurrentTick = 0;
 	SDL_FillRect(sketch, NULL, 0);
 	while (emurunning) {
-		PokeMini_EmulateFrame();
+		PokeMini_EmulateFrameRunAhead(CommandLine.runahead);
 		// Screen rendering
 		// Render the menu or the game screen
 		if (cfg_vsync && !(--DropCount)) DropCount = 5; /* Drop 1 frame for every continuous 5 frames (75hz -> 60hz) */
@@ -29,6 +29,7 @@
 #include "Joystick.h"
 #include "Keyboard.h"
 #include "KeybMapSDL.h"
+#include "EmuThread.h"
 
 #include "Video_x1.h"
 #include "Video_x2.h"
@@ -71,6 +72,7 @@ const char *clc_zoom_txt[] = {
 int clc_zoom = 4, clc_bpp = 16, clc_fullscreen = 0;
 char clc_dump_sound[PMTMPV] = {0};
 int clc_displayfps = 0;
+int clc_threaded = 0;
 const TCommandLineCustom CustomArgs[] = {
 	{ "-dumpsound", (int *)&clc_dump_sound, COMMANDLINE_STR, PMTMPV-1 },
 	{ "-zoom", &clc_zoom, COMMANDLINE_INT, 1, 6 },
@@ -78,6 +80,9 @@ const TCommandLineCustom CustomArgs[] = {
 	{ "-windowed", &clc_fullscreen, COMMANDLINE_INTSET, 0 },
 	{ "-fullscreen", &clc_fullscreen, COMMANDLINE_INTSET, 1 },
 	{ "-displayfps", &clc_displayfps, COMMANDLINE_INTSET, 1 },
+#ifdef MULTITHREAD
+	{ "-threaded", &clc_threaded, COMMANDLINE_INTSET, 1 },
+#endif
 	{ "", NULL, COMMANDLINE_EOL }
 };
 const TCommandLineCustom CustomConf[] = {
@@ -85,6 +90,9 @@ const TCommandLineCustom CustomConf[] = {
 	{ "bpp", &clc_bpp, COMMANDLINE_INT, 16, 32 },
 	{ "fullscreen", &clc_fullscreen, COMMANDLINE_BOOL },
 	{ "displayfps", &clc_displayfps, COMMANDLINE_BOOL },
+#ifdef MULTITHREAD
+	{ "threaded", &clc_threaded, COMMANDLINE_BOOL },
+#endif
 	{ "", NULL, COMMANDLINE_EOL }
 };
 
@@ -96,6 +104,9 @@ TUIMenu_Item UIItems_Platform[] = {
 	{ 0,  2, "Depth: %dbpp", UIItems_PlatformC },
 	{ 0,  3, "Fullscreen: %s", UIItems_PlatformC },
 	{ 0,  4, "Display FPS: %s", UIItems_PlatformC },
+#ifdef MULTITHREAD
+	{ 0,  5, "Threaded: %s", UIItems_PlatformC },
+#endif
 	{ 0,  8, "Define Joystick...", UIItems_PlatformC },
 	{ 0,  9, "Define Keyboard...", UIItems_PlatformC },
 	PLATFORMDEF_SAVEOPTIONS,
@@ -131,6 +142,10 @@ int UIItems_PlatformC(int index, int reason)
 			case 4: // Display FPS
 				clc_displayfps = !clc_displayfps;
 				break;
+			case 5: // Threaded
+				clc_threaded = !clc_threaded;
+				zoomchanged = 1;
+				break;
 		}
 	}
 	if (reason == UIMENU_RIGHT) {
@@ -154,6 +169,10 @@ int UIItems_PlatformC(int index, int reason)
 			case 4: // Display FPS
 				clc_displayfps = !clc_displayfps;
 				break;
+			case 5: // Threaded
+				clc_threaded = !clc_threaded;
+				zoomchanged = 1;
+				break;
 			case 8: // Define Joystick...
 				JoystickEnterMenu();
 				break;
@@ -166,6 +185,7 @@ int UIItems_PlatformC(int index, int reason)
 	UIMenu_ChangeItem(UIItems_Platform, 2, "Depth: %dbpp", clc_bpp);
 	UIMenu_ChangeItem(UIItems_Platform, 3, "Fullscreen: %s", clc_fullscreen ? "Yes" : "No");
 	UIMenu_ChangeItem(UIItems_Platform, 4, "Display FPS: %s", clc_displayfps ? "Yes" : "No");
+	UIMenu_ChangeItem(UIItems_Platform, 5, "Threaded: %s", clc_threaded ? "Yes" : "No");
 	if (zoomchanged) {
 		SDL_UnlockSurface(screen);
 		setup_screen();
@@ -228,6 +248,18 @@ void setup_screen()
 	PMOff = (PMOffY * screen->pitch) + (PMOffX * 2);
 	UIOff = (UIOffY * screen->pitch) + (UIOffX * 2);
 	clc_bpp = depth;
+
+#ifdef MULTITHREAD
+	// Frame buffers for the emulation thread
+	if (clc_threaded) {
+		if (!EmuThread_Create(PMWidth, PMHeight, depth, PMOffX, PMOffY)) {
+			fprintf(stderr, "Couldn't create frame buffers, threading disabled\n");
+			clc_threaded = 0;
+		}
+	} else {
+		EmuThread_Destroy();
+	}
+#endif
 }
 
 // Capture screen
@@ -249,20 +281,56 @@ void capture_screen()
 	Close_ExportBMP(capf);
 }
 
+// Throttle emulation speed after each frame
+void emulatorpace()
+{
+	static unsigned long NewTickSync = 0;
+	unsigned long time;
+
+	if (!emulimiter) return;
+	if (RequireSoundSync) {
+		// Sleep a little in the hope to free a few samples
+		while (MinxAudio_SyncWithAudio()) SDL_Delay(1);
+	} else {
+		do {
+			SDL_Delay(1);		// This lower CPU usage
+			time = SDL_GetTicks();
+		} while (time < NewTickSync);
+		NewTickSync = time + 13;	// Aprox 72 times per sec
+	}
+}
+
 // Handle keyboard and quit events
 void handleevents(SDL_Event *event)
 {
 	switch (event->type) {
 	case SDL_KEYDOWN:
 		if (event->key.keysym.sym == SDLK_F9) {			// Capture screen
+#ifdef MULTITHREAD
+			// Emulation thread writes the LCD, pause it while reading
+			if (EmuThread_Running()) {
+				EmuThread_Stop();
+				capture_screen();
+				EmuThread_Start(emulatorpace);
+			} else capture_screen();
+#else
 			capture_screen();
+#endif
 		} else if (event->key.keysym.sym == SDLK_F4) {		// Emulator Exit
 			if (event->key.keysym.mod & KMOD_ALT) {
 				emurunning = 0;
 			}
 		} else if (event->key.keysym.sym == SDLK_F10) {		// Fullscreen/Window
 			clc_fullscreen = !clc_fullscreen;
+#ifdef MULTITHREAD
+			if (EmuThread_Running()) {
+				EmuThread_Stop();
+				setup_screen();
+				EmuThread_Start(emulatorpace);
+			} else setup_screen();
+#else
 			setup_screen();
+#endif
 			UIItems_PlatformC(0, UIMENU_LOAD);
 		} else if (event->key.keysym.sym == SDLK_F11) {		// Disable speed throttling
 			emulimiter = !emulimiter;
@@ -374,6 +442,61 @@ void menuloop()
 	SDL_EnableKeyRepeat(0, 0);
 }
 
+#ifdef MULTITHREAD
+// Threaded loop, emulation runs on its own thread while this one present frames
+void threadloop()
+{
+	SDL_Event event;
+	SDL_Surface *frame;
+	char title[256];
+	char fpstxt[16] = "72 FPS";
+	unsigned long time, NewTickFPS = 0;
+	int frames = 0;
+	void *pixels;
+
+	if (!EmuThread_Start(emulatorpace)) {
+		fprintf(stderr, "Couldn't start emulation thread, threading disabled\n");
+		clc_threaded = 0;
+		return;
+	}
+	while (emurunning && (UI_Status != UI_STATUS_MENU)) {
+		// Present latest frame
+		pixels = EmuThread_GetFrame(16);
+		if (pixels) {
+			// Display FPS counter
+			if (clc_displayfps) {
+				if (PokeMini_VideoDepth == 32)
+					UIDraw_String_32((uint32_t *)pixels, EmuThread_Pitch() >> 2, 4, 4, 10, fpstxt, UI_Font1_Pal32);
+				else
+					UIDraw_String_16((uint16_t *)pixels, EmuThread_Pitch() >> 1, 4, 4, 10, fpstxt, UI_Font1_Pal16);
+			}
+			frame = SDL_CreateRGBSurfaceFrom(pixels, PMWidth, PMHeight, screen->format->BitsPerPixel, EmuThread_Pitch(),
+				screen->format->Rmask, screen->format->Gmask, screen->format->Bmask, screen->format->Amask);
+			if (frame) {
+				SDL_BlitSurface(frame, NULL, rl_screen, NULL);
+				SDL_FreeSurface(frame);
+				SDL_Flip(rl_screen);
+			}
+		}
+
+		// Handle events
+		while (SDL_PollEvent(&event)) handleevents(&event);
+
+		// Calculate FPS from emulated frames
+		time = SDL_GetTicks();
+		if (time >= NewTickFPS) {
+			frames = EmuThread_Frames() - frames;
+			sprintf(title, "%s - %d%%", AppName, frames * 100 / 72);
+			sprintf(fpstxt, "%i FPS", frames);
+			SDL_WM_SetCaption(title, "PMEWindow");
+			NewTickFPS = time + 1000;
+			frames = EmuThread_Frames();
+		}
+	}
+	EmuThread_Stop();
+}
+#endif
+
 // Main function
 int main(int argc, char **argv)
 {
@@ -392,6 +515,9 @@ int main(int argc, char **argv)
 		printf("  -windowed              Display in window (default)\n");
 		printf("  -fullscreen            Display in fullscreen\n");
 		printf("  -displayfps            Display FPS counter on screen\n");
+#ifdef MULTITHREAD
+		printf("  -threaded              Emulate on a separated thread\n");
+#endif
 		printf("  -zoom n                Zoom display: 1 to 6 (def 4)\n");
 		printf("  -bpp n                 Bits-Per-Pixel: 16 or 32 (def 16)\n");
 		return 1;
@@ -464,25 +590,22 @@ int main(int argc, char **argv)
 	JoystickUpdateCallback(reopen_joystick);
 
 	// Emulator's loop
-	unsigned long time, NewTickFPS = 0, NewTickSync = 0;
+	unsigned long time, NewTickFPS = 0;
 	int fps = 72, fpscnt = 0;
 	while (emurunning) {
+#ifdef MULTITHREAD
+		// Emulate on a separated thread
+		if (clc_threaded) {
+			threadloop();
+			if (UI_Status == UI_STATUS_MENU) menuloop();
+			continue;
+		}
+#endif
+
 		// Emulate and syncronize
+		PokeMini_EmulateFrameRunAhead(CommandLine.runahead);
+		emulatorpace();
 		time = SDL_GetTicks();
-		if (RequireSoundSync) {
-			PokeMini_EmulateFrame();
-			// Sleep a little in the hope to free a few samples
-			if (emulimiter) while (MinxAudio_SyncWithAudio()) SDL_Delay(1);
-		} else {
-			PokeMini_EmulateFrame();
-			if (emulimiter) {
-				do {
-					SDL_Delay(1);		// This lower CPU usage
-					time = SDL_GetTicks();
-				} while (time < NewTickSync);
-				NewTickSync = time + 13;	// Aprox 72 times per sec
-			}
-		}
 
 		// Screen rendering
 		SDL_FillRect(screen, NULL, 0);
@@ -527,6 +650,10 @@ int main(int argc, char **argv)
 		}
 	}
 
+#ifdef MULTITHREAD
+	EmuThread_Destroy();
+#endif
+
 	// Disable sound & free UI
 	enablesound(0);
 	UIMenu_Destroy();
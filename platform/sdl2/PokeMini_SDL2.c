@@ -29,6 +29,8 @@
 #include "Joystick.h"
 #include "Keyboard.h"
 #include "KeybMapSDL2.h"
+#include "EmuThread.h"
+#include "FramePace.h"
 
 #include "Video_x1.h"
 #include "Video_x2.h"
@@ -53,6 +55,7 @@ SDL_Joystick *joystick = NULL;
 SDL_Haptic *haptic = NULL;
 int PMWidth, PMHeight;
 int PMOffX, PMOffY, UIOffX, UIOffY;
+int rendervsync = 0;
 
 FILE *sdump;
 void setup_screen();
@@ -75,6 +78,7 @@ const char *clc_zoom_txt[] = {
 int clc_zoom = 4, clc_bpp = 16, clc_fullscreen = 0;
 char clc_dump_sound[PMTMPV] = {0};
 int clc_displayfps = 0;
+int clc_threaded = 0;
 const TCommandLineCustom CustomArgs[] = {
 	{ "-dumpsound", (int *)&clc_dump_sound, COMMANDLINE_STR, PMTMPV-1 },
 	{ "-zoom", &clc_zoom, COMMANDLINE_INT, 1, 6 },
@@ -82,6 +86,9 @@ const TCommandLineCustom CustomArgs[] = {
 	{ "-windowed", &clc_fullscreen, COMMANDLINE_INTSET, 0 },
 	{ "-fullscreen", &clc_fullscreen, COMMANDLINE_INTSET, 1 },
 	{ "-displayfps", &clc_displayfps, COMMANDLINE_INTSET, 1 },
+#ifdef MULTITHREAD
+	{ "-threaded", &clc_threaded, COMMANDLINE_INTSET, 1 },
+#endif
 	{ "", NULL, COMMANDLINE_EOL }
 };
 const TCommandLineCustom CustomConf[] = {
@@ -89,6 +96,9 @@ const TCommandLineCustom CustomConf[] = {
 	{ "bpp", &clc_bpp, COMMANDLINE_INT, 16, 32 },
 	{ "fullscreen", &clc_fullscreen, COMMANDLINE_BOOL },
 	{ "displayfps", &clc_displayfps, COMMANDLINE_BOOL },
+#ifdef MULTITHREAD
+	{ "threaded", &clc_threaded, COMMANDLINE_BOOL },
+#endif
 	{ "", NULL, COMMANDLINE_EOL }
 };
 
@@ -100,6 +110,9 @@ TUIMenu_Item UIItems_Platform[] = {
 	{ 0,  2, "Depth: %dbpp", UIItems_PlatformC },
 	{ 0,  3, "Fullscreen: %s", UIItems_PlatformC },
 	{ 0,  4, "Display FPS: %s", UIItems_PlatformC },
+#ifdef MULTITHREAD
+	{ 0,  5, "Threaded: %s", UIItems_PlatformC },
+#endif
 	{ 0,  8, "Define Joystick...", UIItems_PlatformC },
 	{ 0,  9, "Define Keyboard...", UIItems_PlatformC },
 	PLATFORMDEF_SAVEOPTIONS,
@@ -135,6 +148,10 @@ int UIItems_PlatformC(int index, int reason)
 			case 4: // Display FPS
 				clc_displayfps = !clc_displayfps;
 				break;
+			case 5: // Threaded
+				clc_threaded = !clc_threaded;
+				zoomchanged = 1;
+				break;
 		}
 	}
 	if (reason == UIMENU_RIGHT) {
@@ -158,6 +175,10 @@ int UIItems_PlatformC(int index, int reason)
 			case 4: // Display FPS
 				clc_displayfps = !clc_displayfps;
 				break;
+			case 5: // Threaded
+				clc_threaded = !clc_threaded;
+				zoomchanged = 1;
+				break;
 			case 8: // Define Joystick...
 				JoystickEnterMenu();
 				break;
@@ -170,6 +191,7 @@ int UIItems_PlatformC(int index, int reason)
 	UIMenu_ChangeItem(UIItems_Platform, 2, "Depth: %dbpp", clc_bpp);
 	UIMenu_ChangeItem(UIItems_Platform, 3, "Fullscreen: %s", clc_fullscreen ? "Yes" : "No");
 	UIMenu_ChangeItem(UIItems_Platform, 4, "Display FPS: %s", clc_displayfps ? "Yes" : "No");
+	UIMenu_ChangeItem(UIItems_Platform, 5, "Threaded: %s", clc_threaded ? "Yes" : "No");
 	if (zoomchanged) {
 		setup_screen();
 		return 0;
@@ -235,7 +257,9 @@ void setup_screen()
 		fprintf(stderr, "Couldn't create SDL window: %s\n", SDL_GetError());
 		exit(1);
 	}
-	renderer = SDL_CreateRenderer(window, -1, 0);
+	// Threaded mode and frame pacing present at host vsync
+	rendervsync = clc_threaded || CommandLine.framepace;
+	renderer = SDL_CreateRenderer(window, -1, rendervsync ? SDL_RENDERER_PRESENTVSYNC : 0);
 	if (renderer == NULL) {
 		fprintf(stderr, "Couldn't create SDL renderer: %s\n", SDL_GetError());
 		exit(1);
@@ -251,6 +275,18 @@ void setup_screen()
 		exit(1);
 	}
 	SDL_SetWindowSize(window, PMWidth + decorationWidth, PMHeight + decorationHeight);
+
+#ifdef MULTITHREAD
+	// Frame buffers for the emulation thread
+	if (clc_threaded) {
+		if (!EmuThread_Create(PMWidth, PMHeight, depth, PMOffX, PMOffY)) {
+			fprintf(stderr, "Couldn't create frame buffers, threading disabled\n");
+			clc_threaded = 0;
+		}
+	} else {
+		EmuThread_Destroy();
+	}
+#endif
 }
 
 // Capture screen
@@ -272,20 +308,89 @@ void capture_screen()
 	Close_ExportBMP(capf);
 }
 
+// Throttle emulation speed after each frame
+void emulatorpace()
+{
+	static unsigned long NewTickSync = 0;
+	unsigned long time;
+
+	if (!emulimiter) return;
+	if (RequireSoundSync) {
+		// Sleep a little in the hope to free a few samples
+		while (MinxAudio_SyncWithAudio()) SDL_Delay(1);
+	} else {
+		do {
+			SDL_Delay(1);		// This lower CPU usage
+			time = SDL_GetTicks();
+		} while (time < NewTickSync);
+		NewTickSync = time + 13;	// Aprox 72 times per sec
+	}
+}
+
+// Host clock in microseconds
+int64_t hostclock_us()
+{
+	uint64_t count = SDL_GetPerformanceCounter();
+	uint64_t freq = SDL_GetPerformanceFrequency();
+	return (int64_t)((count / freq) * 1000000 + (count % freq) * 1000000 / freq);
+}
+
+// Start or stop haptic rumble
+void updatehaptic()
+{
+	static int oldrumbling = 0;
+
+	if (haptic) {
+		if (!oldrumbling && PokeMini_Rumbling) {
+			if (SDL_HapticRumblePlay(haptic, 1.0f, 60000) < 0) {
+				printf("SDL failed: %s\n", SDL_GetError());
+			}
+		} else if (oldrumbling && !PokeMini_Rumbling) {
+			SDL_HapticRumbleStop(haptic);
+		}
+	}
+	oldrumbling = PokeMini_Rumbling;
+}
+
 // Handle keyboard and quit events
 void handleevents(SDL_Event *event)
 {
 	switch (event->type) {
 	case SDL_KEYDOWN:
 		if (event->key.keysym.sym == SDLK_F9) {			// Capture screen
+#ifdef MULTITHREAD
+			// Emulation thread writes the LCD, pause it while reading
+			if (EmuThread_Running()) {
+				EmuThread_Stop();
+				capture_screen();
+				EmuThread_Start(emulatorpace);
+			} else capture_screen();
+#else
 			capture_screen();
+#endif
 		} else if ((event->key.keysym.mod & KMOD_ALT) && (event->key.keysym.sym == SDLK_RETURN)) {
 			clc_fullscreen = !clc_fullscreen;
+#ifdef MULTITHREAD
+			if (EmuThread_Running()) {
+				EmuThread_Stop();
+				setup_screen();
+				EmuThread_Start(emulatorpace);
+			} else setup_screen();
+#else
 			setup_screen();
+#endif
 			UIItems_PlatformC(0, UIMENU_LOAD);
 		} else if (event->key.keysym.sym == SDLK_F10) {		// Fullscreen/Window
 			clc_fullscreen = !clc_fullscreen;
+#ifdef MULTITHREAD
+			if (EmuThread_Running()) {
+				EmuThread_Stop();
+				setup_screen();
+				EmuThread_Start(emulatorpace);
+			} else setup_screen();
+#else
 			setup_screen();
+#endif
 			UIItems_PlatformC(0, UIMENU_LOAD);
 		} else if (event->key.keysym.sym == SDLK_F11) {		// Disable speed throttling
 			emulimiter = !emulimiter;
@@ -420,7 +525,63 @@ void menuloop()
 	PokeMini_ApplyChanges();
 	if (UI_Status == UI_STATUS_EXIT) emurunning = 0;
 	else enablesound(CommandLine.sound);
+
+	// Frame pacing need vsync
+	if (rendervsync != (clc_threaded || CommandLine.framepace)) setup_screen();
+	FramePace_Reset();
+}
+
+#ifdef MULTITHREAD
+// Threaded loop, emulation runs on its own thread while this one present frames
+void threadloop()
+{
+	SDL_Event event;
+	char title[256];
+	char fpstxt[16] = "72 FPS";
+	unsigned long time, NewTickFPS = 0;
+	int frames = 0;
+	void *pixels;
+
+	if (!EmuThread_Start(emulatorpace)) {
+		fprintf(stderr, "Couldn't start emulation thread, threading disabled\n");
+		clc_threaded = 0;
+		return;
+	}
+	while (emurunning && (UI_Status != UI_STATUS_MENU)) {
+		// Present latest frame, renderer waits for vsync
+		pixels = EmuThread_GetFrame(16);
+		if (pixels) {
+			// Display FPS counter
+			if (clc_displayfps) {
+				if (PokeMini_VideoDepth == 32)
+					UIDraw_String_32((uint32_t *)pixels, EmuThread_Pitch() >> 2, 4, 4, 10, fpstxt, UI_Font1_Pal32);
+				else
+					UIDraw_String_16((uint16_t *)pixels, EmuThread_Pitch() >> 1, 4, 4, 10, fpstxt, UI_Font1_Pal16);
+			}
+			SDL_UpdateTexture(texture, NULL, pixels, EmuThread_Pitch());
+			SDL_RenderClear(renderer);
+			SDL_RenderCopy(renderer, texture, NULL, NULL);
+			SDL_RenderPresent(renderer);
+		}
+		updatehaptic();
+
+		// Handle events
+		while (SDL_PollEvent(&event)) handleevents(&event);
+
+		// Calculate FPS from emulated frames
+		time = SDL_GetTicks();
+		if (time >= NewTickFPS) {
+			frames = EmuThread_Frames() - frames;
+			sprintf(title, "%s - %d%%", AppName, frames * 100 / 72);
+			sprintf(fpstxt, "%i FPS", frames);
+			SDL_SetWindowTitle(window, title);
+			NewTickFPS = time + 1000;
+			frames = EmuThread_Frames();
+		}
+	}
+	EmuThread_Stop();
 }
+#endif
 
 // Main function
 int main(int argc, char **argv)
@@ -442,6 +603,9 @@ int main(int argc, char **argv)
 		printf("  -windowed              Display in window (default)\n");
 		printf("  -fullscreen            Display in fullscreen\n");
 		printf("  -displayfps            Display FPS counter on screen\n");
+#ifdef MULTITHREAD
+		printf("  -threaded              Emulate on a separated thread\n");
+#endif
 		printf("  -zoom n                Zoom display: 1 to 6 (def 4)\n");
 		printf("  -bpp n                 Bits-Per-Pixel: 16 or 32 (def 16)\n");
 		return 1;
@@ -511,25 +675,32 @@ int main(int argc, char **argv)
 	enablesound(CommandLine.sound);
 
 	// Emulator's loop
-	unsigned long time, NewTickFPS = 0, NewTickSync = 0;
-	int fps = 72, fpscnt = 0, oldrumbling = 0;
+	unsigned long time, NewTickFPS = 0;
+	int fps = 72, fpscnt = 0, frames, i;
 	while (emurunning) {
+#ifdef MULTITHREAD
+		// Emulate on a separated thread
+		if (clc_threaded) {
+			threadloop();
+			if (UI_Status == UI_STATUS_MENU) menuloop();
+			continue;
+		}
+#endif
+
 		// Emulate and syncronize
-		time = SDL_GetTicks();
-		if (RequireSoundSync) {
-			PokeMini_EmulateFrame();
-			// Sleep a little in the hope to free a few samples
-			if (emulimiter) while (MinxAudio_SyncWithAudio()) SDL_Delay(1);
-		} else {
-			PokeMini_EmulateFrame();
-			if (emulimiter) {
-				do {
-					SDL_Delay(1);		// This lower CPU usage
-					time = SDL_GetTicks();
-				} while (time < NewTickSync);
-				NewTickSync = time + 13;	// Aprox 72 times per sec
+		if (CommandLine.framepace && emulimiter) {
+			// Renderer waits for vsync, plan frames against it
+			frames = FramePace_Plan(hostclock_us());
+			for (i=0; i<frames; i++) {
+				PokeMini_EmulateFrameRunAhead(CommandLine.runahead);
+				FramePace_FrameDone();
 			}
+		} else {
+			PokeMini_EmulateFrameRunAhead(CommandLine.runahead);
+			emulatorpace();
+			frames = 1;
 		}
+		time = SDL_GetTicks();
 
 		// Screen rendering
 		if (SDL_LockTexture(texture, NULL, &pixscreen, &bytpitch) >= 0) {
@@ -547,20 +718,11 @@ int main(int argc, char **argv)
 
 			// Render the menu or the game screen
 			if (PokeMini_Rumbling) {
-				PokeMini_VideoBlit((void *)((uint8_t *)pixscreen + pmoff + PokeMini_GenRumbleOffset(bytpitch)), pixpitch);
+				FramePace_Blit((void *)((uint8_t *)pixscreen + pmoff + PokeMini_GenRumbleOffset(bytpitch)), pixpitch);
 			} else {
-				PokeMini_VideoBlit((void *)((uint8_t *)pixscreen + pmoff), pixpitch);
+				FramePace_Blit((void *)((uint8_t *)pixscreen + pmoff), pixpitch);
 			}
-			if (haptic) {
-				if (!oldrumbling && PokeMini_Rumbling) {
-					if (SDL_HapticRumblePlay(haptic, 1.0f, 60000) < 0) {
-						printf("SDL failed: %s\n", SDL_GetError());
-					}
-				} else if (oldrumbling && !PokeMini_Rumbling) {
-					SDL_HapticRumbleStop(haptic);
-				}
-			}
-			oldrumbling = PokeMini_Rumbling;
+			updatehaptic();
 			LCDDirty = 0;
 
 			// Display FPS counter
@@ -587,7 +749,7 @@ int main(int argc, char **argv)
 		if (UI_Status == UI_STATUS_MENU) menuloop();
 
 		// calculate FPS
-		fpscnt++;
+		fpscnt += frames;
 		if (time >= NewTickFPS) {
 			fps = fpscnt;
 			sprintf(title, "%s - %d%%", AppName, fps * 100 / 72);
@@ -598,6 +760,10 @@ int main(int argc, char **argv)
 		}
 	}
 
+#ifdef MULTITHREAD
+	EmuThread_Destroy();
+#endif
+
 	// Disable sound & free UI
 	enablesound(0);
 	UIMenu_Destroy();
@@ -42,6 +42,7 @@ void CommandLineInit(void)
 	CommandLine.forcefreebios = 0;	// Force FreeBIOS
 	CommandLine.updatertc = 2;	// Update RTC (0=Off, 1=State, 2=Host)
 	CommandLine.eeprom_share = 0;	// EEPROM Share
+	CommandLine.eeprom_async = 1;	// EEPROM Write-behind
 #ifdef PERFORMANCE
 	CommandLine.sound = MINX_AUDIO_GENERATED;
 	CommandLine.piezofilter = 0;	// Piezo Filter
@@ -118,6 +119,9 @@ void CommandLineInit(void)
 #else
 	CommandLine.synccycles = 8;	// Sync cycles to 8 (Accurate)
 #endif
+	CommandLine.runahead = 0;	// No run-ahead
+	CommandLine.framepace = 0;	// Frontend own timing
+	CommandLine.coverage_file[0] = 0;	// No coverage
 }
 
 int CommandLineCustomArgs(int argc, char **argv, int *extra, const TCommandLineCustom *custom)
@@ -172,6 +176,8 @@ int CommandLineArgs(int argc, char **argv, const TCommandLineCustom *custom)
 			else if (!strcasecmp(*argv, "-hostrtc")) CommandLine.updatertc = 2;
 			else if (!strcasecmp(*argv, "-eepromshare")) CommandLine.eeprom_share = 1;
 			else if (!strcasecmp(*argv, "-noeepromshare")) CommandLine.eeprom_share = 0;
+			else if (!strcasecmp(*argv, "-eepromasync")) CommandLine.eeprom_async = 1;
+			else if (!strcasecmp(*argv, "-noeepromasync")) CommandLine.eeprom_async = 0;
 			else if (!strcasecmp(*argv, "-nosound")) CommandLine.sound = 0;
 			else if (!strcasecmp(*argv, "-sound")) CommandLine.sound = 4;
 			else if (!strcasecmp(*argv, "-soundgenerate")) CommandLine.sound = 1;
@@ -201,6 +207,13 @@ int CommandLineArgs(int argc, char **argv, const TCommandLineCustom *custom)
 			else if (!strcasecmp(*argv, "-custom2light")) { if (--argc) CommandLine.custompal[2] = BetweenNum(atoi_Ex(*++argv, 0xFFFFFF), 0x000000, 0xFFFFFF); }
 			else if (!strcasecmp(*argv, "-custom2dark")) { if (--argc) CommandLine.custompal[3] = BetweenNum(atoi_Ex(*++argv, 0x000000), 0x000000, 0xFFFFFF); }
 			else if (!strcasecmp(*argv, "-synccycles")) { if (--argc) CommandLine.synccycles = BetweenNum(atoi_Ex(*++argv, 8), 8, 512); }
+			else if (!strcasecmp(*argv, "-runahead")) { if (--argc) CommandLine.runahead = BetweenNum(atoi_Ex(*++argv, 0), 0, 3); }
+#ifdef FRAMEPACE
+			else if (!strcasecmp(*argv, "-framepace")) { if (--argc) CommandLine.framepace = BetweenNum(atoi_Ex(*++argv, 0), 0, 2); }
+#endif
+#ifdef COVERAGE
+			else if (!strcasecmp(*argv, "-coverage")) { if (--argc) strncpy(CommandLine.coverage_file, *++argv, PMTMPV-1); }
+#endif
 			else if (!strcasecmp(*argv, "-multicart")) { if (--argc) CommandLine.multicart = BetweenNum(atoi_Ex(*++argv, 0), 0, 2); }
 			else if (!strcasecmp(*argv, "-lcdcontrast")) { if (--argc) CommandLine.lcdcontrast = BetweenNum(atoi_Ex(*++argv, 64), 0, 100); }
 			else if (!strcasecmp(*argv, "-lcdbright")) { if (--argc) CommandLine.lcdbright = BetweenNum(atoi_Ex(*++argv, 0), -100, 100); }
@@ -277,6 +290,7 @@ int CommandLineConfFile(const char *filename, const char *platcfgfile, const TCo
 			else if (!strcasecmp(key, "romdir")) strncpy(CommandLine.rom_dir, value, PMTMPV-1);
 			else if (!strcasecmp(key, "rtc")) CommandLine.updatertc = BetweenNum(atoi_Ex(value, 2), 0, 2);
 			else if (!strcasecmp(key, "eepromshare")) CommandLine.eeprom_share = Str2Bool(value);
+			else if (!strcasecmp(key, "eepromasync")) CommandLine.eeprom_async = Str2Bool(value);
 			else if (!strcasecmp(key, "soundengine")) {
 				if (Str2Bool(value)) CommandLine.sound = 4;
 				else if (!strcasecmp(value, "generated")) CommandLine.sound = 1;
@@ -352,6 +366,8 @@ int CommandLineConfFile(const char *filename, const char *platcfgfile, const TCo
 			else if (!strcasecmp(key, "custom2dark")) CommandLine.custompal[3] = BetweenNum(atoi_Ex(value, 0x000000), 0x000000, 0xFFFFFF);
 			else if (!strcasecmp(key, "multicart")) CommandLine.multicart = BetweenNum(atoi_Ex(value, 0), 0, 2);
 			else if (!strcasecmp(key, "synccycles")) CommandLine.synccycles = BetweenNum(atoi_Ex(value, 8), 8, 512);
+			else if (!strcasecmp(key, "runahead")) CommandLine.runahead = BetweenNum(atoi_Ex(value, 0), 0, 3);
+			else if (!strcasecmp(key, "framepace")) CommandLine.framepace = BetweenNum(atoi_Ex(value, 0), 0, 2);
 			else if (!strcasecmp(key, "lcdcontrast")) CommandLine.lcdcontrast = BetweenNum(atoi_Ex(value, 64), 0, 100);
 			else if (!strcasecmp(key, "lcdbright")) CommandLine.lcdbright = BetweenNum(atoi_Ex(value, 0), -100, 100);
 			else PokeDPrint(POKEMSG_ERR, "Conf warning: Unknown '%s' key\n", key);
@@ -416,6 +432,7 @@ int CommandLineConfSave(void)
 			fprintf(fo, "romdir=%s\n", CommandLine.rom_dir);
 			fprintf(fo, "rtc=%d\n", CommandLine.updatertc);
 			fprintf(fo, "eepromshare=%s\n", Bool2StrAf(CommandLine.eeprom_share));
+			fprintf(fo, "eepromasync=%s\n", Bool2StrAf(CommandLine.eeprom_async));
 			if (CommandLine.sound == 4) fprintf(fo, "soundengine=directpwm\n");
 			else if (CommandLine.sound == 3) fprintf(fo, "soundengine=emulated\n");
 			else if (CommandLine.sound == 2) fprintf(fo, "soundengine=direct\n");
@@ -472,6 +489,8 @@ int CommandLineConfSave(void)
 			fprintf(fo, "custom2dark=0x%06X\n", (unsigned int)CommandLine.custompal[3]);
 			fprintf(fo, "multicart=%d\n", CommandLine.multicart);
 			fprintf(fo, "synccycles=%d\n", CommandLine.synccycles);
+			fprintf(fo, "runahead=%d\n", CommandLine.runahead);
+			fprintf(fo, "framepace=%d\n", CommandLine.framepace);
 			fprintf(fo, "lcdcontrast=%d\n", CommandLine.lcdcontrast);
 			fprintf(fo, "lcdbright=%d\n", CommandLine.lcdbright);
 			fclose(fo);
@@ -585,6 +604,8 @@ void PrintHelpUsage(FILE *fout)
 	fprintf(fout, "  -eeprom pokemini.eep   Load/Save EEPROM file\n");
 	fprintf(fout, "  -eepromshare           Share EEPROM to all ROMs\n");
 	fprintf(fout, "  -noeepromshare         Individual EEPROM for each ROM (def)\n");
+	fprintf(fout, "  -eepromasync           Save EEPROM on background (def)\n");
+	fprintf(fout, "  -noeepromasync         Save EEPROM only on exit\n");
 	fprintf(fout, "  -nostate               Discard auto-state save (def)\n");
 	fprintf(fout, "  -state pokemini.sta    Load/Save auto-state file\n");
 	fprintf(fout, "  -nortc                 No RTC\n");
@@ -615,9 +636,16 @@ void PrintHelpUsage(FILE *fout)
 	fprintf(fout, "  -custom2light 0xFFFFFF Palette Custom 2 Light\n");
 	fprintf(fout, "  -custom2dark 0x000000  Palette Custom 2 Dark\n");
 	fprintf(fout, "  -synccycles 8          Number of cycles per hardware sync.\n");
+	fprintf(fout, "  -runahead 0            Frames to run ahead (0 to 3)\n");
+#ifdef FRAMEPACE
+	fprintf(fout, "  -framepace 0           Pace to host vsync: 0=Off, 1=On, 2=Blend\n");
+#endif
 	fprintf(fout, "  -multicart 0           Multicart type (0 to 2)\n");
 	fprintf(fout, "  -lcdcontrast 64        LCD contrast boost in percent\n");
 	fprintf(fout, "  -lcdbright 0           LCD brightness offset in percent\n");
+#ifdef COVERAGE
+	fprintf(fout, "  -coverage file.pmcov   Merge code coverage into file\n");
+#endif
 }
 
 int PrintHelpUsageStr(char *out)
@@ -632,6 +660,8 @@ int PrintHelpUsageStr(char *out)
 		strcat(out, "  -eeprom pokemini.eep   Load/Save EEPROM file\n");
 		strcat(out, "  -eepromshare           Share EEPROM to all ROMs (def)\n");
 		strcat(out, "  -noeepromshare         Individual EEPROM for each ROM (def)\n");
+		strcat(out, "  -eepromasync           Save EEPROM on background (def)\n");
+		strcat(out, "  -noeepromasync         Save EEPROM only on exit\n");
 		strcat(out, "  -nostate               Discard auto-state save (def)\n");
 		strcat(out, "  -state pokemini.sta    Load/Save auto-state file\n");
 		strcat(out, "  -nortc                 No RTC\n");
@@ -662,9 +692,16 @@ int PrintHelpUsageStr(char *out)
 		strcat(out, "  -custom2light 0xFFFFFF Palette Custom 2 Light\n");
 		strcat(out, "  -custom2dark 0x000000  Palette Custom 2 Dark\n");
 		strcat(out, "  -synccycles 8          Number of cycles per hardware sync.\n");
+		strcat(out, "  -runahead 0            Frames to run ahead (0 to 3)\n");
+#ifdef FRAMEPACE
+		strcat(out, "  -framepace 0           Pace to host vsync: 0=Off, 1=On, 2=Blend\n");
+#endif
 		strcat(out, "  -multicart 0           Multicart type (0 to 2)\n");
 		strcat(out, "  -lcdcontrast 64        LCD contrast boost in percent\n");
 		strcat(out, "  -lcdbright 0           LCD brightness offset in percent\n");
+#ifdef COVERAGE
+		strcat(out, "  -coverage file.pmcov   Merge code coverage into file\n");
+#endif
 	}
 	return 4096;
 }
@@ -47,6 +47,7 @@ typedef struct {
 	char rom_dir[PMTMPV];
 	int updatertc;
 	int eeprom_share;
+	int eeprom_async;
 	int sound;
 	int piezofilter;
 	int lcdfilter;
@@ -62,6 +63,9 @@ typedef struct {
 	int joybutton[10];
 	int multicart;
 	int synccycles;
+	int runahead;
+	int framepace;
+	char coverage_file[PMTMPV];
 	int keyb_a[10];
 	int keyb_b[10];
 	uint32_t custompal[4];
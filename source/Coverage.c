@@ -0,0 +1,179 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PokeMini.h"
+#include "Coverage.h"
+
+#ifdef COVERAGE
+
+int Coverage_Active = 0;
+uint8_t *Coverage_Bits = NULL;
+
+static const char Coverage_Magic[8] = "PMCOVER";
+static char Coverage_Counted[PMTMPV];	// Last file this run was counted in
+
+static int Coverage_Alloc(void)
+{
+	if (Coverage_Bits) return 1;
+	Coverage_Bits = (uint8_t *)malloc(COVERAGE_MAPS * COVERAGE_MAPSIZE);
+	if (!Coverage_Bits) return 0;
+	memset(Coverage_Bits, 0, COVERAGE_MAPS * COVERAGE_MAPSIZE);
+	return 1;
+}
+
+int Coverage_Start(void)
+{
+	if (!Coverage_Alloc()) return 0;
+	Coverage_Active = 1;
+	return 1;
+}
+
+void Coverage_Stop(void)
+{
+	Coverage_Active = 0;
+}
+
+void Coverage_Clear(void)
+{
+	Coverage_Counted[0] = 0;
+	if (Coverage_Bits) memset(Coverage_Bits, 0, COVERAGE_MAPS * COVERAGE_MAPSIZE);
+}
+
+void Coverage_Free(void)
+{
+	Coverage_Active = 0;
+	Coverage_Counted[0] = 0;
+	if (Coverage_Bits) {
+		free(Coverage_Bits);
+		Coverage_Bits = NULL;
+	}
+}
+
+int Coverage_Get(uint32_t addr)
+{
+	int i, bits = 0;
+	if (!Coverage_Bits) return 0;
+	for (i=0; i<COVERAGE_MAPS; i++) {
+		if (Coverage_Bits[i * COVERAGE_MAPSIZE + ((addr >> 3) & (COVERAGE_MAPSIZE-1))] & (1 << (addr & 7))) bits |= 1 << i;
+	}
+	return bits;
+}
+
+uint32_t Coverage_Count(int map, uint32_t start, uint32_t end)
+{
+	const uint8_t *bits;
+	uint32_t addr, count = 0;
+	if (!Coverage_Bits) return 0;
+	if (end > COVERAGE_MAPSIZE * 8) end = COVERAGE_MAPSIZE * 8;
+	bits = Coverage_Bits + map * COVERAGE_MAPSIZE;
+	for (addr=start; (addr<end) && (addr & 7); addr++) count += (bits[addr >> 3] >> (addr & 7)) & 1;
+	for (; addr+8<=end; addr+=8) {
+		uint8_t b = bits[addr >> 3];
+		while (b) {
+			b &= b - 1;
+			count++;
+		}
+	}
+	for (; addr<end; addr++) count += (bits[addr >> 3] >> (addr & 7)) & 1;
+	return count;
+}
+
+static uint32_t Coverage_ReadU32(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void Coverage_WriteU32(uint8_t *p, uint32_t val)
+{
+	p[0] = (uint8_t)val;
+	p[1] = (uint8_t)(val >> 8);
+	p[2] = (uint8_t)(val >> 16);
+	p[3] = (uint8_t)(val >> 24);
+}
+
+// Merge file into maps, return runs in file or -1 on failure
+static int Coverage_Merge(const char *filename)
+{
+	uint8_t hdr[20], buf[4096];
+	uint32_t size, i;
+	int map, runs;
+	FILE *fi;
+
+	fi = fopen(filename, "rb");
+	if (!fi) return -1;
+	if (fread(hdr, 1, 20, fi) != 20 || memcmp(hdr, Coverage_Magic, 8) || (Coverage_ReadU32(hdr + 8) != COVERAGE_VERSION)) {
+		fclose(fi);
+		return -1;
+	}
+	runs = (int)Coverage_ReadU32(hdr + 12);
+	size = Coverage_ReadU32(hdr + 16);
+	if (size != COVERAGE_MAPSIZE) {
+		fclose(fi);
+		return -1;
+	}
+	for (map=0; map<COVERAGE_MAPS; map++) {
+		uint8_t *bits = Coverage_Bits + map * COVERAGE_MAPSIZE;
+		for (i=0; i<COVERAGE_MAPSIZE; i+=sizeof(buf)) {
+			uint32_t j;
+			if (fread(buf, 1, sizeof(buf), fi) != sizeof(buf)) {
+				fclose(fi);
+				return -1;
+			}
+			for (j=0; j<sizeof(buf); j++) bits[i + j] |= buf[j];
+		}
+	}
+	fclose(fi);
+	return runs;
+}
+
+int Coverage_Load(const char *filename)
+{
+	if (!Coverage_Alloc()) return 0;
+	return Coverage_Merge(filename) >= 0;
+}
+
+int Coverage_Save(const char *filename, int merge)
+{
+	uint8_t hdr[20];
+	int runs = 0, counted = 0;
+	FILE *fo;
+
+	if (!Coverage_Bits) return 0;
+	if (merge && FileExist(filename)) {
+		runs = Coverage_Merge(filename);
+		if (runs < 0) return 0;
+		// Saving again into the same file, this run is already in it
+		if (!strcmp(Coverage_Counted, filename)) counted = 1;
+	}
+	fo = fopen(filename, "wb");
+	if (!fo) return 0;
+	memcpy(hdr, Coverage_Magic, 8);
+	Coverage_WriteU32(hdr + 8, COVERAGE_VERSION);
+	Coverage_WriteU32(hdr + 12, counted ? runs : runs + 1);
+	Coverage_WriteU32(hdr + 16, COVERAGE_MAPSIZE);
+	if (fwrite(hdr, 1, 20, fo) != 20 || fwrite(Coverage_Bits, 1, COVERAGE_MAPS * COVERAGE_MAPSIZE, fo) != COVERAGE_MAPS * COVERAGE_MAPSIZE) {
+		fclose(fo);
+		return 0;
+	}
+	if (fclose(fo)) return 0;
+	strncpy(Coverage_Counted, filename, PMTMPV-1);
+	Coverage_Counted[PMTMPV-1] = 0;
+	return 1;
+}
+
+#endif
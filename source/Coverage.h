@@ -0,0 +1,87 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef POKEMINI_COVERAGE
+#define POKEMINI_COVERAGE
+
+#include <stdint.h>
+
+// Code coverage
+//
+// One bit per address over the 2MB physical range for each of opcode
+// fetch, data read and data write. CPU accesses are marked from the
+// memory callbacks, PRC rendering reads are marked for ROM only.
+// Saving merges into the existing file, so coverage accumulates across
+// runs. Only compiled with COVERAGE.
+//
+// File: "PMCOVER\0", u32 version, u32 runs, u32 map size, exec, read and write maps
+// All values are little-endian, address N is bit (N & 7) of byte (N >> 3).
+
+#define COVERAGE_VERSION	1
+
+// Bytes per map
+#define COVERAGE_MAPSIZE	0x40000
+
+// Maps
+enum {
+	COVERAGE_EXEC = 0,	// Opcode fetched
+	COVERAGE_READ,		// Data read
+	COVERAGE_WRITE,		// Data written
+	COVERAGE_MAPS
+};
+
+#ifdef COVERAGE
+
+extern int Coverage_Active;		// Recording
+extern uint8_t *Coverage_Bits;		// All maps, NULL if never started
+
+// Start recording, maps are kept from previous start or load
+// Return 0 on failure
+int Coverage_Start(void);
+
+// Stop recording, maps are kept
+void Coverage_Stop(void);
+
+// Clear maps, next save counts as a new run
+void Coverage_Clear(void);
+
+// Free maps
+void Coverage_Free(void);
+
+// Get maps bits of address, bit N set for map N
+int Coverage_Get(uint32_t addr);
+
+// Count addresses marked on map between start and end (exclusive)
+uint32_t Coverage_Count(int map, uint32_t start, uint32_t end);
+
+// Merge file into maps, return 0 on failure
+int Coverage_Load(const char *filename);
+
+// Save maps, merged with the existing file if merge is set, return 0 on failure
+// Saving again into the last saved file only updates the maps, not the runs
+int Coverage_Save(const char *filename, int merge);
+
+// Mark address on map
+static inline void Coverage_Mark(int map, uint32_t addr)
+{
+	if (Coverage_Active) Coverage_Bits[map * COVERAGE_MAPSIZE + ((addr >> 3) & (COVERAGE_MAPSIZE-1))] |= 1 << (addr & 7);
+}
+
+#endif
+
+#endif
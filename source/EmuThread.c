@@ -0,0 +1,211 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PokeMini.h"
+#include "Hardware.h"
+#include "EmuThread.h"
+
+#ifdef MULTITHREAD
+
+#define EMUTHREAD_FRESH		4	// Middle buffer have a new frame
+#define EMUTHREAD_KEYS		64	// Size of keypad queue
+
+typedef struct {
+	uint8_t *buffer[3];
+	int rumbled[3];
+	int pitch, size, offset;
+	volatile int middle;
+	int back, front;
+	volatile int quit;
+	volatile int frames;
+	int running;
+	TEmuThread_Pace pace;
+	PMThread thread;
+	PMMutex mutex;
+	PMCond cond;
+	uint8_t keys[EMUTHREAD_KEYS];
+	int keyread, keywrite;
+} TEmuThread;
+
+static TEmuThread EmuThread;
+
+// Keypad event from host thread
+static void EmuThread_KeypadEvent(uint8_t key, int pressed)
+{
+	PMMutex_Lock(&EmuThread.mutex);
+	if (((EmuThread.keywrite + 1) & (EMUTHREAD_KEYS-1)) != EmuThread.keyread) {
+		EmuThread.keys[EmuThread.keywrite] = key | (pressed ? 0x80 : 0x00);
+		EmuThread.keywrite = (EmuThread.keywrite + 1) & (EMUTHREAD_KEYS-1);
+	}
+	PMMutex_Unlock(&EmuThread.mutex);
+}
+
+// Apply queued keypad events
+static void EmuThread_FlushKeys(void)
+{
+	PMMutex_Lock(&EmuThread.mutex);
+	while (EmuThread.keyread != EmuThread.keywrite) {
+		MinxIO_Keypad(EmuThread.keys[EmuThread.keyread] & 0x7F, EmuThread.keys[EmuThread.keyread] >> 7);
+		EmuThread.keyread = (EmuThread.keyread + 1) & (EMUTHREAD_KEYS-1);
+	}
+	PMMutex_Unlock(&EmuThread.mutex);
+}
+
+// Blit LCD into back buffer and swap it with the middle one
+static void EmuThread_Publish(void)
+{
+	uint8_t *buffer = EmuThread.buffer[EmuThread.back];
+	int pitchW = EmuThread.pitch / (PokeMini_VideoDepth >> 3);
+
+	// Rumble shift the LCD, clear what it leaves behind
+	if (PokeMini_Rumbling || EmuThread.rumbled[EmuThread.back]) memset(buffer, 0, EmuThread.size);
+	EmuThread.rumbled[EmuThread.back] = PokeMini_Rumbling;
+	if (PokeMini_Rumbling) {
+		PokeMini_VideoBlit((void *)(buffer + EmuThread.offset + PokeMini_GenRumbleOffset(EmuThread.pitch)), pitchW);
+	} else {
+		PokeMini_VideoBlit((void *)(buffer + EmuThread.offset), pitchW);
+	}
+	LCDDirty = 0;
+
+	// Swap and wake up host
+	EmuThread.back = PMAtomic_Exchange(&EmuThread.middle, EmuThread.back | EMUTHREAD_FRESH) & 3;
+	PMMutex_Lock(&EmuThread.mutex);
+	PMCond_Signal(&EmuThread.cond);
+	PMMutex_Unlock(&EmuThread.mutex);
+}
+
+static int EmuThread_Loop(void *data)
+{
+	while (!PMAtomic_Get(&EmuThread.quit)) {
+		EmuThread_FlushKeys();
+		PokeMini_EmulateFrameRunAhead(CommandLine.runahead);
+		EmuThread_Publish();
+		PMAtomic_Set(&EmuThread.frames, EmuThread.frames + 1);
+		if (EmuThread.pace) EmuThread.pace();
+	}
+	return 0;
+}
+
+int EmuThread_Create(int width, int height, int depth, int offx, int offy)
+{
+	int i;
+	if (EmuThread.running) return 0;
+	EmuThread_Destroy();
+	EmuThread.pitch = width * (depth >> 3);
+	EmuThread.size = EmuThread.pitch * height;
+	EmuThread.offset = offy * EmuThread.pitch + offx * (depth >> 3);
+	for (i=0; i<3; i++) {
+		EmuThread.buffer[i] = (uint8_t *)malloc(EmuThread.size);
+		if (!EmuThread.buffer[i]) {
+			EmuThread_Destroy();
+			return 0;
+		}
+		memset(EmuThread.buffer[i], 0, EmuThread.size);
+		EmuThread.rumbled[i] = 0;
+	}
+	EmuThread.back = 0;
+	EmuThread.middle = 1;
+	EmuThread.front = 2;
+	return 1;
+}
+
+void EmuThread_Destroy(void)
+{
+	int i;
+	EmuThread_Stop();
+	for (i=0; i<3; i++) {
+		if (EmuThread.buffer[i]) {
+			free(EmuThread.buffer[i]);
+			EmuThread.buffer[i] = NULL;
+		}
+	}
+}
+
+int EmuThread_Start(TEmuThread_Pace pace)
+{
+	int i;
+	if (EmuThread.running) return 1;
+	if (!EmuThread.buffer[0]) return 0;
+
+	// Clear anything the host drawn over the frames
+	for (i=0; i<3; i++) memset(EmuThread.buffer[i], 0, EmuThread.size);
+	EmuThread.middle &= 3;
+	EmuThread.pace = pace;
+	EmuThread.quit = 0;
+	EmuThread.frames = 0;
+	EmuThread.keyread = 0;
+	EmuThread.keywrite = 0;
+	PMMutex_Init(&EmuThread.mutex);
+	PMCond_Init(&EmuThread.cond);
+
+	// Keypad events are queued from now on
+	PokeMini_CustomKeypadEvent = EmuThread_KeypadEvent;
+	if (!PMThread_Create(&EmuThread.thread, EmuThread_Loop, NULL)) {
+		PokeMini_CustomKeypadEvent = NULL;
+		PMCond_Destroy(&EmuThread.cond);
+		PMMutex_Destroy(&EmuThread.mutex);
+		return 0;
+	}
+	EmuThread.running = 1;
+	return 1;
+}
+
+void EmuThread_Stop(void)
+{
+	if (!EmuThread.running) return;
+	PMAtomic_Set(&EmuThread.quit, 1);
+	PMThread_Join(EmuThread.thread);
+	PokeMini_CustomKeypadEvent = NULL;
+	EmuThread_FlushKeys();
+	PMCond_Destroy(&EmuThread.cond);
+	PMMutex_Destroy(&EmuThread.mutex);
+	EmuThread.running = 0;
+}
+
+int EmuThread_Running(void)
+{
+	return EmuThread.running;
+}
+
+void *EmuThread_GetFrame(int ms)
+{
+	if (!EmuThread.running) return NULL;
+	if (!(PMAtomic_Get(&EmuThread.middle) & EMUTHREAD_FRESH)) {
+		if (ms <= 0) return NULL;
+		PMMutex_Lock(&EmuThread.mutex);
+		if (!(PMAtomic_Get(&EmuThread.middle) & EMUTHREAD_FRESH)) {
+			PMCond_TimedWait(&EmuThread.cond, &EmuThread.mutex, ms);
+		}
+		PMMutex_Unlock(&EmuThread.mutex);
+		if (!(PMAtomic_Get(&EmuThread.middle) & EMUTHREAD_FRESH)) return NULL;
+	}
+	EmuThread.front = PMAtomic_Exchange(&EmuThread.middle, EmuThread.front) & 3;
+	return EmuThread.buffer[EmuThread.front];
+}
+
+int EmuThread_Pitch(void)
+{
+	return EmuThread.pitch;
+}
+
+int EmuThread_Frames(void)
+{
+	return PMAtomic_Get(&EmuThread.frames);
+}
+
+#endif
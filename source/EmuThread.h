@@ -0,0 +1,63 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef POKEMINI_EMUTHREAD
+#define POKEMINI_EMUTHREAD
+
+#include <stdint.h>
+
+// Emulation thread (only when compiled with MULTITHREAD)
+//
+// Emulation and the LCD blit run on their own thread, each finished frame
+// is published into a lock-free triple buffer and the host thread presents
+// the latest one at its own pace. Keypad events from the host thread are
+// queued and applied before the next frame.
+
+#ifdef MULTITHREAD
+
+// Called by the emulation thread after each frame to throttle speed
+typedef void (*TEmuThread_Pace)(void);
+
+// Create the frame buffers, LCD is blit at offx,offy. Emulation must be stopped
+int EmuThread_Create(int width, int height, int depth, int offx, int offy);
+
+// Free the frame buffers, stop emulation if needed
+void EmuThread_Destroy(void);
+
+// Start emulation thread, return false on failure
+int EmuThread_Start(TEmuThread_Pace pace);
+
+// Stop emulation thread and wait for it
+void EmuThread_Stop(void);
+
+// Return true if emulation thread is running
+int EmuThread_Running(void);
+
+// Return latest frame, NULL if none was published in the last ms milliseconds
+// Frame is owned by the caller until the next call
+void *EmuThread_GetFrame(int ms);
+
+// Frame buffer pitch in bytes
+int EmuThread_Pitch(void);
+
+// Number of frames emulated since start
+int EmuThread_Frames(void);
+
+#endif
+
+#endif
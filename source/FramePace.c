@@ -0,0 +1,160 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PokeMini.h"
+#include "FramePace.h"
+
+// Emulated frame period in nanoseconds (CPU at 4MHz)
+#define FRAMEPACE_PERIOD	((int64_t)POKEMINI_FRAME_CYC * 250)
+
+// Maximum period adjust for audio, in 1/1000
+#define FRAMEPACE_AUDIOADJ	5
+
+typedef struct {
+	int started;
+	int64_t emutime;	// Time of last emulated frame (ns)
+	int64_t vsync;		// Time of last vsync (ns)
+	int64_t period;		// Current frame period (ns)
+	int audiofill;		// Filtered audio FIFO fill, 4 bits fraction
+	int weight;		// Weight of last frame, 0 to 256
+	uint8_t level[2][96*64];// Intensities of previous and last frame
+	uint8_t blend[96*64];
+	int last;		// Index of last frame in level[]
+} TFramePace;
+
+static TFramePace FramePace;
+
+void FramePace_Reset(void)
+{
+	FramePace.started = 0;
+	FramePace.period = FRAMEPACE_PERIOD;
+	FramePace.audiofill = MinxAudio_FIFOThreshold << 4;
+	FramePace.weight = 256;
+}
+
+// Audio rate control, stretch the period while the FIFO is above threshold
+static void FramePace_AudioControl(void)
+{
+	int delta, range;
+	if (!AudioEnabled || !RequireSoundSync || !MinxAudio_TotalSamples()) {
+		FramePace.period = FRAMEPACE_PERIOD;
+		return;
+	}
+
+	// Host audio drain in chunks, filter it out
+	FramePace.audiofill += MinxAudio_SamplesInBuffer() - (FramePace.audiofill >> 4);
+	range = MinxAudio_TotalSamples() >> 2;
+	delta = (FramePace.audiofill >> 4) - MinxAudio_FIFOThreshold;
+	if (delta > range) delta = range;
+	if (delta < -range) delta = -range;
+	FramePace.period = FRAMEPACE_PERIOD + FRAMEPACE_PERIOD * FRAMEPACE_AUDIOADJ * delta / (range * 1000);
+}
+
+int FramePace_Plan(int64_t vsync_us)
+{
+	int64_t vsync = vsync_us * 1000, target;
+	int frames;
+
+	if (!CommandLine.framepace) return 1;
+	if (!FramePace.started || (vsync < FramePace.vsync)) {
+		FramePace_Reset();
+		FramePace.started = 1;
+		FramePace.emutime = vsync;
+		FramePace.vsync = vsync;
+		return 1;
+	}
+	FramePace.vsync = vsync;
+	FramePace_AudioControl();
+
+	// Blending need the frame after vsync
+	target = vsync;
+	if (CommandLine.framepace == FRAMEPACE_BLEND) target += FramePace.period;
+	if (target < FramePace.emutime) frames = 0;
+	else frames = (int)((target - FramePace.emutime) / FramePace.period);
+
+	// Too far behind (host stall), drop the time
+	if (frames > FRAMEPACE_MAXFRAMES) {
+		frames = FRAMEPACE_MAXFRAMES;
+		FramePace.emutime = target;
+	} else {
+		FramePace.emutime += frames * FramePace.period;
+	}
+
+	// Phase of vsync between previous and last frame
+	FramePace.weight = (int)((vsync - FramePace.emutime + FramePace.period) * 256 / FramePace.period);
+	if (FramePace.weight < 0) FramePace.weight = 0;
+	if (FramePace.weight > 256) FramePace.weight = 256;
+
+	return frames;
+}
+
+void FramePace_FrameDone(void)
+{
+	uint8_t *level;
+	int i, level0, levelM, level1;
+
+	if (CommandLine.framepace != FRAMEPACE_BLEND) return;
+	FramePace.last ^= 1;
+	level = FramePace.level[FramePace.last];
+
+	// Same intensities the blitters use
+	level0 = MinxLCD.Pixel0Intensity;
+	level1 = MinxLCD.Pixel1Intensity;
+	levelM = (level0 + level1) >> 1;
+	if (PokeMini_LCDMode == LCDMODE_ANALOG) {
+		memcpy(level, LCDPixelsA, 96*64);
+	} else if (PokeMini_LCDMode == LCDMODE_3SHADES) {
+		for (i=0; i<96*64; i++) {
+			switch (LCDPixelsD[i] + LCDPixelsA[i]) {
+				case 2: level[i] = level1; break;
+				case 1: level[i] = levelM; break;
+				default: level[i] = level0; break;
+			}
+		}
+	} else if (PokeMini_LCDMode == LCDMODE_2SHADES) {
+		for (i=0; i<96*64; i++) level[i] = LCDPixelsD[i] ? level1 : level0;
+	}
+}
+
+void FramePace_Blit(void *screen, int pitchW)
+{
+	TPokeMini_DrawVideoPtr blit;
+	uint8_t *prev, *last, *pixelsA;
+	int i, weight;
+
+	// Unofficial colors are palette indexes, present the last frame
+	if ((CommandLine.framepace != FRAMEPACE_BLEND) || (PokeMini_LCDMode == LCDMODE_COLORS) || !PokeMini_VideoCurrent) {
+		PokeMini_VideoBlit(screen, pitchW);
+		return;
+	}
+
+	// Blend and present through the analog blitter
+	prev = FramePace.level[FramePace.last ^ 1];
+	last = FramePace.level[FramePace.last];
+	weight = FramePace.weight;
+	for (i=0; i<96*64; i++) {
+		FramePace.blend[i] = (prev[i] * (256 - weight) + last[i] * weight) >> 8;
+	}
+	if (PokeMini_VideoDepth == 32) blit = (TPokeMini_DrawVideoPtr)PokeMini_VideoCurrent->Get32(CommandLine.lcdfilter, LCDMODE_ANALOG);
+	else blit = (TPokeMini_DrawVideoPtr)PokeMini_VideoCurrent->Get16(CommandLine.lcdfilter, LCDMODE_ANALOG);
+	if (!blit) blit = PokeMini_VideoBlit;
+	pixelsA = LCDPixelsA;
+	LCDPixelsA = FramePace.blend;
+	blit(screen, pitchW);
+	LCDPixelsA = pixelsA;
+}
@@ -0,0 +1,55 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef POKEMINI_FRAMEPACE
+#define POKEMINI_FRAMEPACE
+
+#include <stdint.h>
+
+// Frame pacing
+//
+// Plan 72Hz emulated frames against the host refresh: for each host
+// vsync timestamp return how many frames to emulate so emulation keeps
+// real time, optionally blending the two nearest LCD frames by phase.
+// Emulated time is slightly stretched or shrunk to keep the audio FIFO
+// around its threshold, so audio doesn't need to throttle emulation.
+// Frontends that use it define FRAMEPACE to expose the option and menu.
+
+// Maximum frames per vsync before dropping time
+#define FRAMEPACE_MAXFRAMES	4
+
+// Pacing modes
+enum {
+	FRAMEPACE_OFF = 0,	// Frontend own timing
+	FRAMEPACE_ON,		// Nearest frame
+	FRAMEPACE_BLEND		// Blend the two nearest frames, one frame of latency
+};
+
+// Restart pacing, next plan emulate a single frame
+void FramePace_Reset(void);
+
+// Return frames to emulate before presenting at the vsync time (microseconds)
+int FramePace_Plan(int64_t vsync_us);
+
+// Call after each planned frame
+void FramePace_FrameDone(void);
+
+// Blit frame to present, blended with the previous one in FRAMEPACE_BLEND
+void FramePace_Blit(void *screen, int pitchW);
+
+#endif
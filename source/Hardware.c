@@ -17,6 +17,8 @@
 */
 
 #include "PokeMini.h"
+#include "Hardware.h"
+#include "Profiler.h"
 
 // Emulate X cycles, return remaining
 int PokeMini_EmulateCycles(int lcylc)
@@ -24,7 +26,7 @@ int PokeMini_EmulateCycles(int lcylc)
 	if (RequireSoundSync) {
 		while (lcylc > 0) {
 			if (StallCPU) PokeHWCycles = StallCycles;
-			else PokeHWCycles = MinxCPU_Exec();
+			else PokeHWCycles = Profiler_Exec();
 			MinxTimers_Sync();
 			MinxPRC_Sync();
 			MinxAudio_Sync();
@@ -33,7 +35,7 @@ int PokeMini_EmulateCycles(int lcylc)
 	} else {
 		while (lcylc > 0) {
 			if (StallCPU) PokeHWCycles = StallCycles;
-			else PokeHWCycles = MinxCPU_Exec();
+			else PokeHWCycles = Profiler_Exec();
 			MinxTimers_Sync();
 			MinxPRC_Sync();
 			lcylc -= PokeHWCycles;
@@ -43,6 +45,24 @@ int PokeMini_EmulateCycles(int lcylc)
 	return lcylc;
 }
 
+// Run-ahead state
+static int RunAheadLeft = 0;		// Frames ahead left, 0 = Real frame
+static int RunAheadPresent = 0;		// Presenting color frame ahead
+static TPokeMini_Snapshot RunAheadSS;
+static uint8_t RunAheadColor[96*64];
+
+// Frames the presented frame blends with, per LCD mode
+static const int RunAheadHistory[4] = { 4, 2, 1, 1 };
+
+// Return color pixels to CVRAM after presenting a frame ahead
+static inline void PokeMini_RunAheadRelease(void)
+{
+	if (RunAheadPresent) {
+		PRCColorPixels = PRCColorVMem + (MinxColorPRC.ActivePage ? 0x2000 : 0);
+		RunAheadPresent = 0;
+	}
+}
+
 // Emulate 1 frame, return cycles ran
 static int PokeMini_EmulateFrameRun;
 int PokeMini_EmulateFrame(void)
@@ -51,13 +71,14 @@ int PokeMini_EmulateFrame(void)
 	int synccylc = CommandLine.synccycles;
 
 	PokeMini_EmulateFrameRun = 1;
+	PokeMini_RunAheadRelease();
 
-	if (RequireSoundSync) {
+	if (RequireSoundSync && !RunAheadLeft) {
 		while (PokeMini_EmulateFrameRun) {
 			PokeHWCycles = 0;
 			while (PokeHWCycles < synccylc) {
 				if (StallCPU) PokeHWCycles += StallCycles;
-				else PokeHWCycles += MinxCPU_Exec();
+				else PokeHWCycles += Profiler_Exec();
 			}
 			MinxTimers_Sync();
 			MinxPRC_Sync();
@@ -69,7 +90,7 @@ int PokeMini_EmulateFrame(void)
 			PokeHWCycles = 0;
 			while (PokeHWCycles < synccylc) {
 				if (StallCPU) PokeHWCycles += StallCycles;
-				else PokeHWCycles += MinxCPU_Exec();
+				else PokeHWCycles += Profiler_Exec();
 			}
 			MinxTimers_Sync();
 			MinxPRC_Sync();
@@ -80,12 +101,61 @@ int PokeMini_EmulateFrame(void)
 	return lcylc;
 }
 
+// Emulate 1 frame followed by N frames ahead, return cycles ran on the real frame
+int PokeMini_EmulateFrameRunAhead(int frames)
+{
+	int cycles = PokeMini_EmulateFrame();
+#ifdef PROFILER
+	int profiling = Profiler_Active;
+#endif
+#ifdef COVERAGE
+	int covering = Coverage_Active;
+#endif
+	if (frames <= 0) return cycles;
+
+	// Frames ahead, without audio, EEPROM commits, profiling or coverage
+	PokeMini_SaveSnapshot(&RunAheadSS);
+	PokeMini_RunningAhead = 1;
+#ifdef PROFILER
+	Profiler_Active = 0;
+#endif
+#ifdef COVERAGE
+	Coverage_Active = 0;
+#endif
+	for (RunAheadLeft = frames; RunAheadLeft > 0; RunAheadLeft--) {
+		PokeMini_EmulateFrame();
+	}
+#ifdef PROFILER
+	Profiler_Active = profiling;
+#endif
+#ifdef COVERAGE
+	Coverage_Active = covering;
+#endif
+	PokeMini_RunningAhead = 0;
+
+	// Roll back, LCD pixels aren't part of the state so they keep the
+	// frame ahead, color pixels are in CVRAM and need a copy
+	if ((PokeMini_LCDMode == LCDMODE_COLORS) && PRCColorPixels) {
+		memcpy(RunAheadColor, PRCColorPixels, 96*64);
+		PokeMini_LoadSnapshot(&RunAheadSS);
+		PRCColorPixels = RunAheadColor;
+		RunAheadPresent = 1;
+	} else {
+		PokeMini_LoadSnapshot(&RunAheadSS);
+	}
+
+	return cycles;
+}
+
 // -------------------
 // Internal Processing
 // -------------------
 
 uint8_t MinxCPU_OnRead(int cpu, uint32_t addr)
 {
+#ifdef COVERAGE
+	if (cpu) Coverage_Mark((cpu == 2) ? COVERAGE_EXEC : COVERAGE_READ, addr);
+#endif
 #ifdef PERFORMANCE
 	if (addr >= 0x2100) {
 		// ROM Read (ROM Cartridge)
@@ -173,6 +243,9 @@ uint8_t MinxCPU_OnRead(int cpu, uint32_t addr)
 
 void MinxCPU_OnWrite(int cpu, uint32_t addr, uint8_t data)
 {
+#ifdef COVERAGE
+	if (cpu) Coverage_Mark(COVERAGE_WRITE, addr);
+#endif
 #ifdef PERFORMANCE
 	if (addr >= 0x2100) {
 		// Do nothing...
@@ -254,10 +327,11 @@ void MinxCPU_OnWrite(int cpu, uint32_t addr, uint8_t data)
 		}
 	} else if (addr >= 0x1300) {
 		// RAM Write
-		PM_RAM[addr-0x1000] = data;
+		PM_RAM[addr-0x1000] = PokeMini_CheatWrite(addr, data);
 		return;
 	} else if (addr >= 0x1000) {
 		// RAM Write / FrameBuffer
+		data = PokeMini_CheatWrite(addr, data);
 		PM_RAM[addr-0x1000] = data;
 		if (PRCColorMap) MinxColorPRC_WriteFramebuffer(addr-0x1000, data);
 		return;
@@ -330,8 +404,11 @@ void MinxIRQ_OnIRQ(uint8_t intr)
 void MinxPRC_On72HzRefresh(int prcrender)
 {
 	// Frame rendered
-	if ((PokeMini_LCDMode == LCDMODE_3SHADES) && (prcrender)) memcpy(LCDPixelsA, LCDPixelsD, 96*64);
-	if (LCDDirty) MinxLCD_Render();
-	if (PokeMini_LCDMode == LCDMODE_ANALOG) MinxLCD_DecayRefresh();
+	// Frames ahead only render what the presented frame blends with
+	if (RunAheadLeft <= RunAheadHistory[PokeMini_LCDMode & 3]) {
+		if ((PokeMini_LCDMode == LCDMODE_3SHADES) && (prcrender)) memcpy(LCDPixelsA, LCDPixelsD, 96*64);
+		if (LCDDirty) MinxLCD_Render();
+		if (PokeMini_LCDMode == LCDMODE_ANALOG) MinxLCD_DecayRefresh();
+	}
 	PokeMini_EmulateFrameRun = 0;
 }
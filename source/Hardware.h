@@ -25,4 +25,9 @@ int PokeMini_EmulateCycles(int lcylc);
 // Emulate 1 frame, return cycles ran
 int PokeMini_EmulateFrame(void);
 
+// Emulate 1 frame followed by N frames ahead with the current input,
+// the last frame ahead is presented and the state is rolled back.
+// Return cycles ran on the real frame
+int PokeMini_EmulateFrameRunAhead(int frames);
+
 #endif
@@ -22,6 +22,7 @@ TMinxAudio MinxAudio;
 int AudioEnabled = 0;
 int SoundEngine = MINX_AUDIO_DISABLED;
 int PiezoFilter = 0;
+int32_t MinxAudio_PiezoHP[4], MinxAudio_PiezoLP[4];
 int RequireSoundSync = 0;
 int16_t *MinxAudio_FIFO = NULL;
 volatile int MinxAudio_ReadPtr = 0;
@@ -49,10 +50,10 @@ const uint32_t MinxAudio_CountFreq[32] = {
 // FIFO I/O
 //
 
+// Same pointers means empty, one slot is always kept free
 static inline int MinxAudio_iSamplesInBuffer(void)
 {
-	if (MinxAudio_WritePtr > MinxAudio_ReadPtr) return MinxAudio_WritePtr - MinxAudio_ReadPtr;
-	else return (MinxAudio_FIFOSize - MinxAudio_ReadPtr) + MinxAudio_WritePtr;
+	return (MinxAudio_WritePtr - MinxAudio_ReadPtr) & MinxAudio_FIFOMask;
 }
 
 int MinxAudio_TotalSamples(void)
@@ -67,7 +68,7 @@ int MinxAudio_SamplesInBuffer(void)
 
 static inline void MinxAudio_FIFOWrite(int16_t data)
 {
-	if (MinxAudio_iSamplesInBuffer() < MinxAudio_FIFOSize) {
+	if (MinxAudio_iSamplesInBuffer() < MinxAudio_FIFOMask) {
 		MinxAudio_FIFO[MinxAudio_WritePtr] = data;
 		MinxAudio_WritePtr = (MinxAudio_WritePtr + 1) & MinxAudio_FIFOMask;
 	}
@@ -349,15 +350,14 @@ int16_t MinxAudio_PiezoFilter(int32_t Sample)
 	int32_t HP_pCoeff = 40960;
 	int32_t LP_pCoeff = 4096;
 	int32_t LP_nCoeff = (65535 - LP_pCoeff);
-	static int32_t HPSamples[4], LPSamples[4];
 	int32_t TmpSamples[4];
 
 	// High pass to simulate a piezo crystal speaker
 	TmpSamples[0] = Sample;
-	TmpSamples[1] = (HP_pCoeff * (TmpSamples[0] + HPSamples[1] - HPSamples[0])) >> 16;
-	TmpSamples[2] = (HP_pCoeff * (TmpSamples[1] + HPSamples[2] - HPSamples[1])) >> 16;
-	TmpSamples[3] = (HP_pCoeff * (TmpSamples[2] + HPSamples[3] - HPSamples[2])) >> 16;
-	memcpy(HPSamples, TmpSamples, sizeof(HPSamples));
+	TmpSamples[1] = (HP_pCoeff * (TmpSamples[0] + MinxAudio_PiezoHP[1] - MinxAudio_PiezoHP[0])) >> 16;
+	TmpSamples[2] = (HP_pCoeff * (TmpSamples[1] + MinxAudio_PiezoHP[2] - MinxAudio_PiezoHP[1])) >> 16;
+	TmpSamples[3] = (HP_pCoeff * (TmpSamples[2] + MinxAudio_PiezoHP[3] - MinxAudio_PiezoHP[2])) >> 16;
+	memcpy(MinxAudio_PiezoHP, TmpSamples, sizeof(MinxAudio_PiezoHP));
 
 	// Amplify by 4
 	Sample = TmpSamples[3] << 2;
@@ -365,13 +365,13 @@ int16_t MinxAudio_PiezoFilter(int32_t Sample)
 	if (Sample > 32767) Sample = 32767;
 
 	// Low pass to kill the spikes in sound
-	LPSamples[0] = Sample;
-	LPSamples[1] = (LPSamples[1] * LP_pCoeff + LPSamples[0] * LP_nCoeff) >> 16;
-	LPSamples[2] = (LPSamples[2] * LP_pCoeff + LPSamples[1] * LP_nCoeff) >> 16;
-	LPSamples[3] = (LPSamples[3] * LP_pCoeff + LPSamples[2] * LP_nCoeff) >> 16;
+	MinxAudio_PiezoLP[0] = Sample;
+	MinxAudio_PiezoLP[1] = (MinxAudio_PiezoLP[1] * LP_pCoeff + MinxAudio_PiezoLP[0] * LP_nCoeff) >> 16;
+	MinxAudio_PiezoLP[2] = (MinxAudio_PiezoLP[2] * LP_pCoeff + MinxAudio_PiezoLP[1] * LP_nCoeff) >> 16;
+	MinxAudio_PiezoLP[3] = (MinxAudio_PiezoLP[3] * LP_pCoeff + MinxAudio_PiezoLP[2] * LP_nCoeff) >> 16;
 
 	// Amplify by 2, clamp and output
-	Sample = LPSamples[3] << 1;
+	Sample = MinxAudio_PiezoLP[3] << 1;
 	if (Sample < -32768) Sample = -32768;
 	if (Sample > 32767) Sample = 32767;
 
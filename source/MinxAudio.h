@@ -44,9 +44,15 @@ extern int SoundEngine;
 // Piezo Filter
 extern int PiezoFilter;
 
+// Piezo Filter history
+extern int32_t MinxAudio_PiezoHP[4], MinxAudio_PiezoLP[4];
+
 // Require sound sync
 extern int RequireSoundSync;
 
+// Samples in buffer to sync with
+extern int MinxAudio_FIFOThreshold;
+
 
 enum {
 	MINX_AUDIO_DISABLED = 0,	// Disabled
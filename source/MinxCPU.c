@@ -20,6 +20,11 @@
 
 TMinxCPU MinxCPU;
 
+#ifdef LAZYFLAGS
+uint8_t MinxCPU_LazyOp = MINX_LAZY_NONE;
+uint16_t MinxCPU_LazyA, MinxCPU_LazyB, MinxCPU_LazyR;
+#endif
+
 //
 // Functions
 //
@@ -35,6 +40,7 @@ int MinxCPU_Create(void)
 	MinxCPU.PC.D = 0;
 	MinxCPU.N.D = 0;
 	MinxCPU.E = 0;
+	MinxCPU_SyncFlags();
 	MinxCPU.F = 0xC0;
 	Set_U(0);
 	MinxCPU.Status = MINX_STATUS_NORMAL;
@@ -52,6 +58,7 @@ void MinxCPU_Reset(int hardreset)
 	MinxCPU.Status = MINX_STATUS_NORMAL;
 	MinxCPU.PC.W.L = ReadMem16(hardreset ? 0 : 2);
 	MinxCPU.E = 0x1F;
+	MinxCPU_SyncFlags();
 	MinxCPU.F = 0xC0;
 	Set_U(0);
 	MinxCPU_OnIRQHandle(MinxCPU.F, MinxCPU.Shift_U);
@@ -60,6 +67,7 @@ void MinxCPU_Reset(int hardreset)
 // Load State
 int MinxCPU_LoadState(FILE *fi, uint32_t bsize)
 {
+	MinxCPU_SyncFlags();
 	POKELOADSS_START(64);
 	POKELOADSS_32(MinxCPU.BA.D);
 	POKELOADSS_32(MinxCPU.HL.D);
@@ -83,6 +91,7 @@ int MinxCPU_LoadState(FILE *fi, uint32_t bsize)
 // Save State
 int MinxCPU_SaveState(FILE *fi)
 {
+	MinxCPU_SyncFlags();
 	POKESAVESS_START(64);
 	POKESAVESS_32(MinxCPU.BA.D);
 	POKESAVESS_32(MinxCPU.HL.D);
@@ -103,6 +112,119 @@ int MinxCPU_SaveState(FILE *fi)
 	POKESAVESS_END(64);
 }
 
+#ifdef LAZYFLAGS
+
+// Compute flags of the last lazy operation
+void MinxCPU_LazyFlags(void)
+{
+	register uint16_t A = MinxCPU_LazyA;
+	register uint16_t B = MinxCPU_LazyB;
+	register uint16_t RES = MinxCPU_LazyR;
+	register uint8_t F = MinxCPU.F & MINX_FLAG_SAVE_NUL;
+	switch (MinxCPU_LazyOp) {
+	case MINX_LAZY_ADD8:
+		if (RES == 0) F |= MINX_FLAG_ZERO;
+		if (RES < A) F |= MINX_FLAG_CARRY;
+		if ((A ^ RES) & ~(A ^ B) & 0x80) F |= MINX_FLAG_OVERFLOW;
+		if (RES & 0x80) F |= MINX_FLAG_SIGN;
+		break;
+	case MINX_LAZY_SUB8:
+		if (RES == 0) F |= MINX_FLAG_ZERO;
+		if (A < B) F |= MINX_FLAG_CARRY;
+		if ((A ^ RES) & (A ^ B) & 0x80) F |= MINX_FLAG_OVERFLOW;
+		if (RES & 0x80) F |= MINX_FLAG_SIGN;
+		break;
+	case MINX_LAZY_ADD16:
+		if (RES == 0) F |= MINX_FLAG_ZERO;
+		if (RES < A) F |= MINX_FLAG_CARRY;
+		if ((A ^ RES) & ~(A ^ B) & 0x8000) F |= MINX_FLAG_OVERFLOW;
+		if (RES & 0x8000) F |= MINX_FLAG_SIGN;
+		break;
+	case MINX_LAZY_SUB16:
+		if (RES == 0) F |= MINX_FLAG_ZERO;
+		if (A < B) F |= MINX_FLAG_CARRY;
+		if ((A ^ RES) & (A ^ B) & 0x8000) F |= MINX_FLAG_OVERFLOW;
+		if (RES & 0x8000) F |= MINX_FLAG_SIGN;
+		break;
+	}
+	MinxCPU.F = F;
+	MinxCPU_LazyOp = MINX_LAZY_NONE;
+}
+
+#endif
+
+// 8-Bits add with carry on BCD and/or Nibble mode
+uint8_t MinxCPU_ADC8Mode(uint8_t A, uint8_t B, uint8_t CARRY)
+{
+	register uint8_t RES;
+	MinxCPU_SyncFlags();
+	MinxCPU.F &= MINX_FLAG_SAVE_NUL;
+	switch (MinxCPU.F & 0x30) {
+	case 0x10: // BCD
+		if ((uint8_t)((A & 15) + (B & 15) + CARRY) >= 10) {
+			RES = A + B + CARRY + 6;
+		} else {
+			RES = A + B + CARRY;
+		}
+		if (RES >= 0xA0) RES += 0x60;
+		if (RES == 0) MinxCPU.F |= MINX_FLAG_ZERO;
+		if (RES < A) MinxCPU.F |= MINX_FLAG_CARRY;
+		return RES & 0xFF;
+	case 0x20: // Nibble
+		RES = (A & 15) + (B & 15) + CARRY;
+		if ((RES & 15) == 0) MinxCPU.F |= MINX_FLAG_ZERO;
+		if (RES >= 16) MinxCPU.F |= MINX_FLAG_CARRY;
+		if ((((A ^ RES) & 0x8) != 0) && (((A ^ B) & 0x8) == 0)) MinxCPU.F |= MINX_FLAG_OVERFLOW;
+		if (RES & 8) MinxCPU.F |= MINX_FLAG_SIGN;
+		return RES & 0x0F;
+	default:   // BCD and Nibble
+		if ((uint8_t)((A & 15) + (B & 15) + CARRY) >= 10) {
+			RES = (A & 15) + (B & 15) + CARRY + 6;
+		} else {
+			RES = (A & 15) + (B & 15) + CARRY;
+		}
+		if ((RES & 15) == 0) MinxCPU.F |= MINX_FLAG_ZERO;
+		if (RES >= 16) MinxCPU.F |= MINX_FLAG_CARRY;
+		return RES & 0x0F;
+	}
+}
+
+// 8-Bits subtract with carry on BCD and/or Nibble mode
+uint8_t MinxCPU_SBC8Mode(uint8_t A, uint8_t B, uint8_t CARRY)
+{
+	register uint8_t RES;
+	MinxCPU_SyncFlags();
+	MinxCPU.F &= MINX_FLAG_SAVE_NUL;
+	switch (MinxCPU.F & 0x30) {
+	case 0x10: // BCD
+		if ((uint8_t)((A & 15) - (B & 15) - CARRY) >= 10) {
+			RES = A - B - CARRY - 6;
+		} else {
+			RES = A - B - CARRY;
+		}
+		if (RES >= 0xA0) RES -= 0x60;
+		if (RES == 0) MinxCPU.F |= MINX_FLAG_ZERO;
+		if (A < B) MinxCPU.F |= MINX_FLAG_CARRY;
+		return RES & 0xFF;
+	case 0x20: // Nibble
+		RES = (A & 15) - (B & 15) - CARRY;
+		if ((RES & 15) == 0) MinxCPU.F |= MINX_FLAG_ZERO;
+		if (RES >= 16) MinxCPU.F |= MINX_FLAG_CARRY;
+		if ((((A ^ RES) & 0x8) != 0) && (((A ^ B) & 0x8) != 0)) MinxCPU.F |= MINX_FLAG_OVERFLOW;
+		if (RES & 8) MinxCPU.F |= MINX_FLAG_SIGN;
+		return RES & 0x0F;
+	default:   // BCD and Nibble
+		if ((uint8_t)((A & 15) - (B & 15) - CARRY) >= 10) {
+			RES = (A & 15) - (B & 15) - CARRY - 6;
+		} else {
+			RES = (A & 15) - (B & 15) - CARRY;
+		}
+		if ((RES & 15) == 0) MinxCPU.F |= MINX_FLAG_ZERO;
+		if (RES >= 16) MinxCPU.F |= MINX_FLAG_CARRY;
+		return RES & 0x0F;
+	}
+}
+
 // Force call Interrupt by the address
 int MinxCPU_CallIRQ(uint8_t addr)
 {
@@ -133,12 +133,20 @@ typedef struct {
 extern TMinxCPU MinxCPU;
 
 // Callbacks (Must be coded by the user)
+// cpu: 0 = Debugger or hardware access, 1 = CPU access, 2 = CPU opcode fetch
 uint8_t MinxCPU_OnRead(int cpu, uint32_t addr);
 void MinxCPU_OnWrite(int cpu, uint32_t addr, uint8_t data);
 void MinxCPU_OnException(int type, uint32_t opc);
 void MinxCPU_OnSleep(int type);
 void MinxCPU_OnIRQHandle(uint8_t flag, uint8_t shift_u);
 void MinxCPU_OnIRQAct(uint8_t intr);
+#ifdef PROFILER
+void MinxCPU_OnCall(void);		// After call or IRQ entry
+void MinxCPU_OnReturn(void);		// After return
+#else
+#define MinxCPU_OnCall()
+#define MinxCPU_OnReturn()
+#endif
 
 // Functions
 int MinxCPU_Create(void);		// Create MinxCPU
@@ -165,10 +173,10 @@ static inline uint8_t Fetch8(void)
 {
 	if (MinxCPU.PC.W.L & 0x8000) {
 		// Banked area
-		MinxCPU.IR = MinxCPU_OnRead(1, (MinxCPU.PC.W.L++ & 0x7FFF) | (MinxCPU.PC.B.I << 15));
+		MinxCPU.IR = MinxCPU_OnRead(2, (MinxCPU.PC.W.L++ & 0x7FFF) | (MinxCPU.PC.B.I << 15));
 	} else {
 		// Unbanked area
-		MinxCPU.IR = MinxCPU_OnRead(1, MinxCPU.PC.W.L++);
+		MinxCPU.IR = MinxCPU_OnRead(2, MinxCPU.PC.W.L++);
 	}
 	return MinxCPU.IR;
 }
@@ -194,224 +202,181 @@ int MinxCPU_ExecCF(void);
 int MinxCPU_ExecSPCE(void);
 int MinxCPU_ExecSPCF(void);
 
+// Lazy flags (LAZYFLAGS)
+// 16-Bits ADD/SUB/ADC/SBC/CMP and the 8-Bits ones on normal mode only
+// record the operation and operands, Z/C/V/S are computed when something
+// reads them.
+// Any code that reads or modifies MinxCPU.F low bits must call
+// MinxCPU_SyncFlags() first, mode and interrupt bits are always valid.
+#ifdef LAZYFLAGS
+enum {
+	MINX_LAZY_NONE,
+	MINX_LAZY_ADD8,
+	MINX_LAZY_SUB8,
+	MINX_LAZY_ADD16,
+	MINX_LAZY_SUB16
+};
+
+extern uint8_t MinxCPU_LazyOp;
+extern uint16_t MinxCPU_LazyA, MinxCPU_LazyB, MinxCPU_LazyR;
+void MinxCPU_LazyFlags(void);
+
+static inline void MinxCPU_SyncFlags(void)
+{
+	if (MinxCPU_LazyOp) MinxCPU_LazyFlags();
+}
+
+static inline void MinxCPU_LazySet(uint8_t op, uint16_t A, uint16_t B, uint16_t RES)
+{
+	MinxCPU_LazyOp = op;
+	MinxCPU_LazyA = A;
+	MinxCPU_LazyB = B;
+	MinxCPU_LazyR = RES;
+}
+#else
+static inline void MinxCPU_SyncFlags(void) {}
+#endif
+
 // Instructions Macros
 
+// 8-Bits arithmetic on BCD and/or Nibble mode (MinxCPU.c)
+uint8_t MinxCPU_ADC8Mode(uint8_t A, uint8_t B, uint8_t CARRY);
+uint8_t MinxCPU_SBC8Mode(uint8_t A, uint8_t B, uint8_t CARRY);
+
+// Normal mode flags are built without branches:
+// Z = bit 0, C = bit 1, V = bit 2 (from bit 7), S = bit 3 (from bit 7)
+
 static inline uint8_t ADD8(uint8_t A, uint8_t B)
 {
 	register uint8_t RES;
-	MinxCPU.F &= MINX_FLAG_SAVE_NUL;
-	switch (MinxCPU.F & 0x30) {
-	case 0x00: // Normal
-		RES = A + B;
-		if (RES == 0) MinxCPU.F |= MINX_FLAG_ZERO;
-		if (RES < A) MinxCPU.F |= MINX_FLAG_CARRY;
-		if ((((A ^ RES) & 0x80) != 0) && (((A ^ B) & 0x80) == 0)) MinxCPU.F |= MINX_FLAG_OVERFLOW;
-		if (RES & 128) MinxCPU.F |= MINX_FLAG_SIGN;
-		return RES & 0xFF;
-	case 0x10: // BCD
-		if ((uint8_t)((A & 15) + (B & 15)) >= 10) {
-			RES = A + B + 6;
-		} else {
-			RES = A + B;
-		}
-		if (RES >= 0xA0) RES += 0x60;
-		if (RES == 0) MinxCPU.F |= MINX_FLAG_ZERO;
-		if (RES < A) MinxCPU.F |= MINX_FLAG_CARRY;	
-		return RES & 0xFF;
-	case 0x20: // Nibble
-		RES = (A & 15) + (B & 15);
-		if ((RES & 15) == 0) MinxCPU.F |= MINX_FLAG_ZERO;
-		if (RES >= 16) MinxCPU.F |= MINX_FLAG_CARRY;
-		if ((((A ^ RES) & 0x8) != 0) && (((A ^ B) & 0x8) == 0)) MinxCPU.F |= MINX_FLAG_OVERFLOW;
-		if (RES & 8) MinxCPU.F |= MINX_FLAG_SIGN;
-		return RES & 0x0F;
-	default:   // BCD and Nibble
-		if ((uint8_t)((A & 15) + (B & 15)) >= 10) {
-			RES = (A & 15) + (B & 15) + 6;
-		} else {
-			RES = (A & 15) + (B & 15);
-		}
-		if ((RES & 15) == 0) MinxCPU.F |= MINX_FLAG_ZERO;
-		if (RES >= 16) MinxCPU.F |= MINX_FLAG_CARRY;
-		return RES & 0x0F;
-	}
+	if (MinxCPU.F & 0x30) return MinxCPU_ADC8Mode(A, B, 0);
+	RES = A + B;
+#ifdef LAZYFLAGS
+	MinxCPU_LazySet(MINX_LAZY_ADD8, A, B, RES);
+#else
+	MinxCPU.F = (MinxCPU.F & MINX_FLAG_SAVE_NUL) | (RES == 0) | ((RES < A) << 1) |
+		((((A ^ RES) & ~(A ^ B)) & 0x80) >> 5) | ((RES & 0x80) >> 4);
+#endif
+	return RES;
 }
 
 static inline uint16_t ADD16(uint16_t A, uint16_t B)
 {
 	register uint16_t RES;
 	RES = A + B;
+#ifdef LAZYFLAGS
+	MinxCPU_LazySet(MINX_LAZY_ADD16, A, B, RES);
+#else
 	MinxCPU.F &= MINX_FLAG_SAVE_NUL;
 	if (RES == 0) MinxCPU.F |= MINX_FLAG_ZERO;
 	if (RES < A) MinxCPU.F |= MINX_FLAG_CARRY;
 	if ((((A ^ RES) & 0x8000) != 0) && (((A ^ B) & 0x8000) == 0)) MinxCPU.F |= MINX_FLAG_OVERFLOW;
 	if (RES & 0x8000) MinxCPU.F |= MINX_FLAG_SIGN;
+#endif
 	return (uint16_t)RES;
 }
 
 static inline uint8_t ADC8(uint8_t A, uint8_t B)
 {
 	register uint8_t RES;
-	register uint8_t CARRY = (MinxCPU.F & MINX_FLAG_CARRY) ? 1 : 0;
-	MinxCPU.F &= MINX_FLAG_SAVE_NUL;
-	switch (MinxCPU.F & 0x30) {
-	case 0x00: // Normal
-		RES = A + B + CARRY;
-		if (RES == 0) MinxCPU.F |= MINX_FLAG_ZERO;
-		if (RES < A) MinxCPU.F |= MINX_FLAG_CARRY;
-		if ((((A ^ RES) & 0x80) != 0) && (((A ^ B) & 0x80) == 0)) MinxCPU.F |= MINX_FLAG_OVERFLOW;
-		if (RES & 128) MinxCPU.F |= MINX_FLAG_SIGN;
-		return RES & 0xFF;
-	case 0x10: // BCD
-		if ((uint8_t)((A & 15) + (B & 15) + CARRY) >= 10) {
-			RES = A + B + CARRY + 6;
-		} else {
-			RES = A + B + CARRY;
-		}
-		if (RES >= 0xA0) RES += 0x60;
-		if (RES == 0) MinxCPU.F |= MINX_FLAG_ZERO;
-		if (RES < A) MinxCPU.F |= MINX_FLAG_CARRY;	
-		return RES & 0xFF;
-	case 0x20: // Nibble
-		RES = (A & 15) + (B & 15) + CARRY;
-		if ((RES & 15) == 0) MinxCPU.F |= MINX_FLAG_ZERO;
-		if (RES >= 16) MinxCPU.F |= MINX_FLAG_CARRY;
-		if ((((A ^ RES) & 0x8) != 0) && (((A ^ B) & 0x8) == 0)) MinxCPU.F |= MINX_FLAG_OVERFLOW;
-		if (RES & 8) MinxCPU.F |= MINX_FLAG_SIGN;
-		return RES & 0x0F;
-	default:   // BCD and Nibble
-		if ((uint8_t)((A & 15) + (B & 15) + CARRY) >= 10) {
-			RES = (A & 15) + (B & 15) + CARRY + 6;
-		} else {
-			RES = (A & 15) + (B & 15) + CARRY;
-		}
-		if ((RES & 15) == 0) MinxCPU.F |= MINX_FLAG_ZERO;
-		if (RES >= 16) MinxCPU.F |= MINX_FLAG_CARRY;
-		return RES & 0x0F;
-	}
+	register uint8_t CARRY;
+	MinxCPU_SyncFlags();
+	CARRY = (MinxCPU.F & MINX_FLAG_CARRY) >> 1;
+	if (MinxCPU.F & 0x30) return MinxCPU_ADC8Mode(A, B, CARRY);
+	RES = A + B + CARRY;
+#ifdef LAZYFLAGS
+	MinxCPU_LazySet(MINX_LAZY_ADD8, A, B, RES);
+#else
+	MinxCPU.F = (MinxCPU.F & MINX_FLAG_SAVE_NUL) | (RES == 0) | ((RES < A) << 1) |
+		((((A ^ RES) & ~(A ^ B)) & 0x80) >> 5) | ((RES & 0x80) >> 4);
+#endif
+	return RES;
 }
 
 static inline uint16_t ADC16(uint16_t A, uint16_t B)
 {
 	register uint16_t RES;
+	MinxCPU_SyncFlags();
 	RES = A + B + ((MinxCPU.F & MINX_FLAG_CARRY) ? 1 : 0);
+#ifdef LAZYFLAGS
+	MinxCPU_LazySet(MINX_LAZY_ADD16, A, B, RES);
+#else
 	MinxCPU.F &= MINX_FLAG_SAVE_NUL;
 	if (RES == 0) MinxCPU.F |= MINX_FLAG_ZERO;
 	if (RES < A) MinxCPU.F |= MINX_FLAG_CARRY;
 	if ((((A ^ RES) & 0x8000) != 0) && (((A ^ B) & 0x8000) == 0)) MinxCPU.F |= MINX_FLAG_OVERFLOW;
 	if (RES & 0x8000) MinxCPU.F |= MINX_FLAG_SIGN;
+#endif
 	return (uint16_t)RES;
 }
 
 static inline uint8_t SUB8(uint8_t A, uint8_t B)
 {
 	register uint8_t RES;
-	MinxCPU.F &= MINX_FLAG_SAVE_NUL;
-	switch (MinxCPU.F & 0x30) {
-	case 0x00: // Normal
-		RES = A - B;
-		if (RES == 0) MinxCPU.F |= MINX_FLAG_ZERO;
-		if (A < B) MinxCPU.F |= MINX_FLAG_CARRY;
-		if ((((A ^ RES) & 0x80) != 0) && (((A ^ B) & 0x80) != 0)) MinxCPU.F |= MINX_FLAG_OVERFLOW;
-		if (RES & 128) MinxCPU.F |= MINX_FLAG_SIGN;
-		return RES & 0xFF;
-	case 0x10: // BCD
-		if ((uint8_t)((A & 15) - (B & 15)) >= 10) {
-			RES = A - B - 6;
-		} else {
-			RES = A - B;
-		}
-		if (RES >= 0xA0) RES -= 0x60;
-		if (RES == 0) MinxCPU.F |= MINX_FLAG_ZERO;
-		if (A < B) MinxCPU.F |= MINX_FLAG_CARRY;	
-		return RES & 0xFF;
-	case 0x20: // Nibble
-		RES = (A & 15) - (B & 15);
-		if ((RES & 15) == 0) MinxCPU.F |= MINX_FLAG_ZERO;
-		if (RES >= 16) MinxCPU.F |= MINX_FLAG_CARRY;
-		if ((((A ^ RES) & 0x8) != 0) && (((A ^ B) & 0x8) != 0)) MinxCPU.F |= MINX_FLAG_OVERFLOW;
-		if (RES & 8) MinxCPU.F |= MINX_FLAG_SIGN;
-		return RES & 0x0F;
-	default:   // BCD and Nibble
-		if ((uint8_t)((A & 15) - (B & 15)) >= 10) {
-			RES = (A & 15) - (B & 15) - 6;
-		} else {
-			RES = (A & 15) - (B & 15);
-		}
-		if ((RES & 15) == 0) MinxCPU.F |= MINX_FLAG_ZERO;
-		if (RES >= 16) MinxCPU.F |= MINX_FLAG_CARRY;
-		return RES & 0x0F;
-	}
+	if (MinxCPU.F & 0x30) return MinxCPU_SBC8Mode(A, B, 0);
+	RES = A - B;
+#ifdef LAZYFLAGS
+	MinxCPU_LazySet(MINX_LAZY_SUB8, A, B, RES);
+#else
+	MinxCPU.F = (MinxCPU.F & MINX_FLAG_SAVE_NUL) | (RES == 0) | ((A < B) << 1) |
+		((((A ^ RES) & (A ^ B)) & 0x80) >> 5) | ((RES & 0x80) >> 4);
+#endif
+	return RES;
 }
 
 static inline uint16_t SUB16(uint16_t A, uint16_t B)
 {
 	register uint16_t RES;
 	RES = A - B;
+#ifdef LAZYFLAGS
+	MinxCPU_LazySet(MINX_LAZY_SUB16, A, B, RES);
+#else
 	MinxCPU.F &= MINX_FLAG_SAVE_NUL;
 	if (RES == 0) MinxCPU.F |= MINX_FLAG_ZERO;
 	if (A < B) MinxCPU.F |= MINX_FLAG_CARRY;
 	if ((((A ^ RES) & 0x8000) != 0) && (((A ^ B) & 0x8000) != 0)) MinxCPU.F |= MINX_FLAG_OVERFLOW;
 	if (RES & 0x8000) MinxCPU.F |= MINX_FLAG_SIGN;
+#endif
 	return (uint16_t)RES;
 }
 
 static inline uint8_t SBC8(uint8_t A, uint8_t B)
 {
 	register uint8_t RES;
-	register uint8_t CARRY = (MinxCPU.F & MINX_FLAG_CARRY) ? 1 : 0;
-	MinxCPU.F &= MINX_FLAG_SAVE_NUL;
-	switch (MinxCPU.F & 0x30) {
-	case 0x00: // Normal
-		RES = A - B - CARRY;
-		if (RES == 0) MinxCPU.F |= MINX_FLAG_ZERO;
-		if (A < B) MinxCPU.F |= MINX_FLAG_CARRY;
-		if ((((A ^ RES) & 0x80) != 0) && (((A ^ B) & 0x80) != 0)) MinxCPU.F |= MINX_FLAG_OVERFLOW;
-		if (RES & 128) MinxCPU.F |= MINX_FLAG_SIGN;
-		return RES & 0xFF;
-	case 0x10: // BCD
-		if ((uint8_t)((A & 15) - (B & 15) - CARRY) >= 10) {
-			RES = A - B - CARRY - 6;
-		} else {
-			RES = A - B - CARRY;
-		}
-		if (RES >= 0xA0) RES -= 0x60;
-		if (RES == 0) MinxCPU.F |= MINX_FLAG_ZERO;
-		if (A < B) MinxCPU.F |= MINX_FLAG_CARRY;	
-		return RES & 0xFF;
-	case 0x20: // Nibble
-		RES = (A & 15) - (B & 15) - CARRY;
-		if ((RES & 15) == 0) MinxCPU.F |= MINX_FLAG_ZERO;
-		if (RES >= 16) MinxCPU.F |= MINX_FLAG_CARRY;
-		if ((((A ^ RES) & 0x8) != 0) && (((A ^ B) & 0x8) != 0)) MinxCPU.F |= MINX_FLAG_OVERFLOW;
-		if (RES & 8) MinxCPU.F |= MINX_FLAG_SIGN;
-		return RES & 0x0F;
-	default:   // BCD and Nibble
-		if ((uint8_t)((A & 15) - (B & 15) - CARRY) >= 10) {
-			RES = (A & 15) - (B & 15) - CARRY - 6;
-		} else {
-			RES = (A & 15) - (B & 15) - CARRY;
-		}
-		if ((RES & 15) == 0) MinxCPU.F |= MINX_FLAG_ZERO;
-		if (RES >= 16) MinxCPU.F |= MINX_FLAG_CARRY;
-		return RES & 0x0F;
-	}
+	register uint8_t CARRY;
+	MinxCPU_SyncFlags();
+	CARRY = (MinxCPU.F & MINX_FLAG_CARRY) >> 1;
+	if (MinxCPU.F & 0x30) return MinxCPU_SBC8Mode(A, B, CARRY);
+	RES = A - B - CARRY;
+#ifdef LAZYFLAGS
+	MinxCPU_LazySet(MINX_LAZY_SUB8, A, B, RES);
+#else
+	MinxCPU.F = (MinxCPU.F & MINX_FLAG_SAVE_NUL) | (RES == 0) | ((A < B) << 1) |
+		((((A ^ RES) & (A ^ B)) & 0x80) >> 5) | ((RES & 0x80) >> 4);
+#endif
+	return RES;
 }
 
 static inline uint16_t SBC16(uint16_t A, uint16_t B)
 {
 	register uint16_t RES;
+	MinxCPU_SyncFlags();
 	RES = A - B - ((MinxCPU.F & MINX_FLAG_CARRY) ? 1 : 0);
+#ifdef LAZYFLAGS
+	MinxCPU_LazySet(MINX_LAZY_SUB16, A, B, RES);
+#else
 	MinxCPU.F &= MINX_FLAG_SAVE_NUL;
 	if (RES == 0) MinxCPU.F |= MINX_FLAG_ZERO;
 	if (A < B) MinxCPU.F |= MINX_FLAG_CARRY;
 	if ((((A ^ RES) & 0x8000) != 0) && (((A ^ B) & 0x8000) != 0)) MinxCPU.F |= MINX_FLAG_OVERFLOW;
 	if (RES & 0x8000) MinxCPU.F |= MINX_FLAG_SIGN;
+#endif
 	return (uint16_t)RES;
 }
 
 static inline uint8_t AND8(uint8_t A, uint8_t B)
 {
+	MinxCPU_SyncFlags();
 	A &= B;
 	MinxCPU.F &= MINX_FLAG_SAVE_CO;
 	if (A == 0) MinxCPU.F |= MINX_FLAG_ZERO;
@@ -421,6 +386,7 @@ static inline uint8_t AND8(uint8_t A, uint8_t B)
 
 static inline uint8_t OR8(uint8_t A, uint8_t B)
 {
+	MinxCPU_SyncFlags();
 	A |= B;
 	MinxCPU.F &= MINX_FLAG_SAVE_CO;
 	if (A == 0) MinxCPU.F |= MINX_FLAG_ZERO;
@@ -430,6 +396,7 @@ static inline uint8_t OR8(uint8_t A, uint8_t B)
 
 static inline uint8_t XOR8(uint8_t A, uint8_t B)
 {
+	MinxCPU_SyncFlags();
 	A ^= B;
 	MinxCPU.F &= MINX_FLAG_SAVE_CO;
 	if (A == 0) MinxCPU.F |= MINX_FLAG_ZERO;
@@ -439,6 +406,7 @@ static inline uint8_t XOR8(uint8_t A, uint8_t B)
 
 static inline uint8_t INC8(uint8_t A)
 {
+	MinxCPU_SyncFlags();
 	A++;
 	MinxCPU.F &= MINX_FLAG_SAVE_COS;
 	if (A == 0) MinxCPU.F |= MINX_FLAG_ZERO;
@@ -447,6 +415,7 @@ static inline uint8_t INC8(uint8_t A)
 
 static inline uint16_t INC16(uint16_t A)
 {
+	MinxCPU_SyncFlags();
 	A++;
 	MinxCPU.F &= MINX_FLAG_SAVE_COS;
 	if (A == 0) MinxCPU.F |= MINX_FLAG_ZERO;
@@ -455,6 +424,7 @@ static inline uint16_t INC16(uint16_t A)
 
 static inline uint8_t DEC8(uint8_t A)
 {
+	MinxCPU_SyncFlags();
 	A--;
 	MinxCPU.F &= MINX_FLAG_SAVE_COS;
 	if (A == 0) MinxCPU.F |= MINX_FLAG_ZERO;
@@ -463,6 +433,7 @@ static inline uint8_t DEC8(uint8_t A)
 
 static inline uint16_t DEC16(uint16_t A)
 {
+	MinxCPU_SyncFlags();
 	A--;
 	MinxCPU.F &= MINX_FLAG_SAVE_COS;
 	if (A == 0) MinxCPU.F |= MINX_FLAG_ZERO;
@@ -491,6 +462,7 @@ static inline void CALLS(uint16_t OFFSET)
 	MinxCPU.PC.B.I = MinxCPU.U1;
 	MinxCPU.U2 = MinxCPU.U1;
 	MinxCPU.PC.W.L = MinxCPU.PC.W.L + OFFSET - 1;
+	MinxCPU_OnCall();
 }
 
 static inline void JMPS(uint16_t OFFSET)
@@ -508,6 +480,7 @@ static inline void CALLU(uint16_t ADDR)
 	MinxCPU.PC.B.I = MinxCPU.U1;
 	MinxCPU.U2 = MinxCPU.U1;
 	MinxCPU.PC.W.L = ADDR;
+	MinxCPU_OnCall();
 }
 
 static inline void JMPU(uint16_t ADDR)
@@ -536,15 +509,18 @@ static inline void RET(void)
 	MinxCPU.PC.B.H = POP();
 	MinxCPU.PC.B.I = POP();
 	Set_U(MinxCPU.PC.B.I);
+	MinxCPU_OnReturn();
 }
 
 static inline void RETI(void)
 {
+	MinxCPU_SyncFlags();
 	MinxCPU.F = POP();
 	MinxCPU.PC.B.L = POP();
 	MinxCPU.PC.B.H = POP();
 	MinxCPU.PC.B.I = POP();
 	Set_U(MinxCPU.PC.B.I);
+	MinxCPU_OnReturn();
 	MinxCPU_OnIRQHandle(MinxCPU.F, MinxCPU.Shift_U);
 }
 
@@ -556,10 +532,12 @@ static inline void CALLX(uint16_t ADDR)
 	MinxCPU.PC.B.I = MinxCPU.U1;
 	MinxCPU.U2 = MinxCPU.U1;
 	MinxCPU.PC.W.L = ReadMem16((MinxCPU.HL.B.I << 16) + ADDR);
+	MinxCPU_OnCall();
 }
 
 static inline void CALLI(uint16_t ADDR)
 {
+	MinxCPU_SyncFlags();
 	PUSH(MinxCPU.PC.B.I);
 	PUSH(MinxCPU.PC.B.H);
 	PUSH(MinxCPU.PC.B.L);
@@ -568,11 +546,13 @@ static inline void CALLI(uint16_t ADDR)
 	MinxCPU.PC.B.I = MinxCPU.U1;
 	MinxCPU.U2 = MinxCPU.U1;
 	MinxCPU.PC.W.L = ReadMem16(ADDR);
+	MinxCPU_OnCall();
 	MinxCPU_OnIRQHandle(MinxCPU.F, MinxCPU.Shift_U);
 }
 
 static inline void JMPI(uint16_t ADDR)
 {
+	MinxCPU_SyncFlags();
 	PUSH(MinxCPU.F);
 	MinxCPU.F |= 0xC0;
 	MinxCPU.PC.B.I = MinxCPU.U1;
@@ -583,6 +563,7 @@ static inline void JMPI(uint16_t ADDR)
 
 static inline uint8_t SAL(uint8_t A)
 {
+	MinxCPU_SyncFlags();
 	MinxCPU.F &= MINX_FLAG_SAVE_NUL;
 	if (A & 0x80) MinxCPU.F |= MINX_FLAG_CARRY;
 	if ((!(A & 0x40)) != (!(A & 0x80))) MinxCPU.F |= MINX_FLAG_OVERFLOW;
@@ -594,6 +575,7 @@ static inline uint8_t SAL(uint8_t A)
 
 static inline uint8_t SHL(uint8_t A)
 {
+	MinxCPU_SyncFlags();
 	MinxCPU.F &= MINX_FLAG_SAVE_O;
 	if (A & 0x80) MinxCPU.F |= MINX_FLAG_CARRY;
 	A = A << 1;
@@ -604,6 +586,7 @@ static inline uint8_t SHL(uint8_t A)
 
 static inline uint8_t SAR(uint8_t A)
 {
+	MinxCPU_SyncFlags();
 	MinxCPU.F &= MINX_FLAG_SAVE_NUL;
 	if (A & 0x01) MinxCPU.F |= MINX_FLAG_CARRY;
 	A = (A & 0x80) | (A >> 1);
@@ -614,6 +597,7 @@ static inline uint8_t SAR(uint8_t A)
 
 static inline uint8_t SHR(uint8_t A)
 {
+	MinxCPU_SyncFlags();
 	MinxCPU.F &= MINX_FLAG_SAVE_O;
 	if (A & 0x01) MinxCPU.F |= MINX_FLAG_CARRY;
 	A = A >> 1;
@@ -624,7 +608,9 @@ static inline uint8_t SHR(uint8_t A)
 
 static inline uint8_t ROLC(uint8_t A)
 {
-	register uint8_t CARRY = (MinxCPU.F & MINX_FLAG_CARRY) ? 1 : 0;
+	register uint8_t CARRY;
+	MinxCPU_SyncFlags();
+	CARRY = (MinxCPU.F & MINX_FLAG_CARRY) ? 1 : 0;
 	MinxCPU.F &= MINX_FLAG_SAVE_O;
 	if (A & 0x80) MinxCPU.F |= MINX_FLAG_CARRY;
 	A = (A << 1) | CARRY;
@@ -635,6 +621,7 @@ static inline uint8_t ROLC(uint8_t A)
 
 static inline uint8_t ROL(uint8_t A)
 {
+	MinxCPU_SyncFlags();
 	MinxCPU.F &= MINX_FLAG_SAVE_O;
 	if (A & 0x80) MinxCPU.F |= MINX_FLAG_CARRY;
 	A = (A << 1) | (A >> 7);
@@ -645,7 +632,9 @@ static inline uint8_t ROL(uint8_t A)
 
 static inline uint8_t RORC(uint8_t A)
 {
-	register uint8_t CARRY = (MinxCPU.F & MINX_FLAG_CARRY) ? 0x80 : 0x00;
+	register uint8_t CARRY;
+	MinxCPU_SyncFlags();
+	CARRY = (MinxCPU.F & MINX_FLAG_CARRY) ? 0x80 : 0x00;
 	MinxCPU.F &= MINX_FLAG_SAVE_O;
 	if (A & 0x01) MinxCPU.F |= MINX_FLAG_CARRY;
 	A = (A >> 1) | CARRY;
@@ -656,6 +645,7 @@ static inline uint8_t RORC(uint8_t A)
 
 static inline uint8_t ROR(uint8_t A)
 {
+	MinxCPU_SyncFlags();
 	MinxCPU.F &= MINX_FLAG_SAVE_O;
 	if (A & 0x01) MinxCPU.F |= MINX_FLAG_CARRY;
 	A = (A >> 1) | (A << 7);
@@ -666,6 +656,7 @@ static inline uint8_t ROR(uint8_t A)
 
 static inline uint8_t NOT(uint8_t A)
 {
+	MinxCPU_SyncFlags();
 	MinxCPU.F &= MINX_FLAG_SAVE_CO;
 	A = A ^ 0xFF;
 	if (A == 0) MinxCPU.F |= MINX_FLAG_ZERO;
@@ -675,6 +666,7 @@ static inline uint8_t NOT(uint8_t A)
 
 static inline uint8_t NEG(uint8_t A)
 {
+	MinxCPU_SyncFlags();
 	MinxCPU.F &= MINX_FLAG_SAVE_NUL;
 	A = -A;
 	if (A == 0) MinxCPU.F |= MINX_FLAG_ZERO; else MinxCPU.F |= MINX_FLAG_CARRY;
@@ -697,6 +689,7 @@ static inline void STOP(void)
 
 static inline void MUL(void)
 {
+	MinxCPU_SyncFlags();
 	MinxCPU.F &= MINX_FLAG_SAVE_NUL;
 	MinxCPU.HL.W.L = (uint16_t)MinxCPU.HL.B.L * (uint16_t)MinxCPU.BA.B.L;
 	if (MinxCPU.HL.W.L == 0) MinxCPU.F |= MINX_FLAG_ZERO;
@@ -706,6 +699,7 @@ static inline void MUL(void)
 static inline void DIV(void)
 {
 	uint16_t RES;
+	MinxCPU_SyncFlags();
 	MinxCPU.F &= MINX_FLAG_SAVE_NUL;
 	if (MinxCPU.BA.B.L == 0) {
 		MinxCPU_OnException(EXCEPTION_DIVISION_BY_ZERO, 0);
@@ -510,6 +510,7 @@ int MinxCPU_ExecCE(void)
 		case 0x6D: // ??? HL, #nn
 			I8A = Fetch8();
 			MinxCPU.HL.W.L = ADD16(MinxCPU.X.W.L, ((I8A << 4) * 3) + ((I8A & 0x08) >> 3));
+			MinxCPU_SyncFlags();
 			MinxCPU.F &= ~MINX_FLAG_CARRY; // It seems that carry gets clear?
 			return 40;
 		case 0x6E: // ??? SP, #nn00+L
@@ -518,6 +519,7 @@ int MinxCPU_ExecCE(void)
 			return 16;
 		case 0x6F: // ??? HL, L
 			MinxCPU.HL.W.L = ADD16(MinxCPU.X.W.L, ((MinxCPU.HL.B.L << 4) * 3) + ((MinxCPU.HL.B.L & 0x08) >> 3));
+			MinxCPU_SyncFlags();
 			MinxCPU.F &= ~MINX_FLAG_CARRY; // It seems that carry gets clear?
 			return 40;
 
@@ -816,12 +818,14 @@ int MinxCPU_ExecCE(void)
 			MinxCPU.BA.B.L = MinxCPU.N.B.H;
 			return 8;
 		case 0xC1: // MOV A, F
+			MinxCPU_SyncFlags();
 			MinxCPU.BA.B.L = MinxCPU.F;
 			return 8;
 		case 0xC2: // MOV N, A
 			MinxCPU.N.B.H = MinxCPU.BA.B.L;
 			return 8;
 		case 0xC3: // MOV F, A
+			MinxCPU_SyncFlags();
 			MinxCPU.F = MinxCPU.BA.B.L;
 			MinxCPU_OnIRQHandle(MinxCPU.F, MinxCPU.Shift_U);
 			return 8;
@@ -927,24 +931,28 @@ int MinxCPU_ExecCE(void)
 
 		case 0xE0: // JL #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if ( ((MinxCPU.F & MINX_FLAG_OVERFLOW)!=0) != ((MinxCPU.F & MINX_FLAG_SIGN)!=0) ) {
 				JMPS(S8_TO_16(I8A));
 			}
 			return 12;
 		case 0xE1: // JLE #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if ( (((MinxCPU.F & MINX_FLAG_OVERFLOW)==0) != ((MinxCPU.F & MINX_FLAG_SIGN)==0)) || ((MinxCPU.F & MINX_FLAG_ZERO)!=0) ) {
 				JMPS(S8_TO_16(I8A));
 			}
 			return 12;
 		case 0xE2: // JG #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if ( (((MinxCPU.F & MINX_FLAG_OVERFLOW)!=0) == ((MinxCPU.F & MINX_FLAG_SIGN)!=0)) && ((MinxCPU.F & MINX_FLAG_ZERO)==0) ) {
 				JMPS(S8_TO_16(I8A));
 			}
 			return 12;
 		case 0xE3: // JGE #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if ( ((MinxCPU.F & MINX_FLAG_OVERFLOW)==0) == ((MinxCPU.F & MINX_FLAG_SIGN)==0) ) {
 				JMPS(S8_TO_16(I8A));
 			}
@@ -952,24 +960,28 @@ int MinxCPU_ExecCE(void)
 
 		case 0xE4: // JO #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if (MinxCPU.F & MINX_FLAG_OVERFLOW) {
 				JMPS(S8_TO_16(I8A));
 			}
 			return 12;
 		case 0xE5: // JNO #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if (!(MinxCPU.F & MINX_FLAG_OVERFLOW)) {
 				JMPS(S8_TO_16(I8A));
 			}
 			return 12;
 		case 0xE6: // JP #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if (!(MinxCPU.F & MINX_FLAG_SIGN)) {
 				JMPS(S8_TO_16(I8A));
 			}
 			return 12;
 		case 0xE7: // JNP #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if (MinxCPU.F & MINX_FLAG_SIGN) {
 				JMPS(S8_TO_16(I8A));
 			}
@@ -1027,24 +1039,28 @@ int MinxCPU_ExecCE(void)
 
 		case 0xF0: // CALLL #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if ( ((MinxCPU.F & MINX_FLAG_OVERFLOW)!=0) != ((MinxCPU.F & MINX_FLAG_SIGN)!=0) ) {
 				CALLS(S8_TO_16(I8A));
 			}
 			return 12;
 		case 0xF1: // CALLLE #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if ( (((MinxCPU.F & MINX_FLAG_OVERFLOW)==0) != ((MinxCPU.F & MINX_FLAG_SIGN)==0)) || ((MinxCPU.F & MINX_FLAG_ZERO)!=0) ) {
 				CALLS(S8_TO_16(I8A));
 			}
 			return 12;
 		case 0xF2: // CALLG #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if ( (((MinxCPU.F & MINX_FLAG_OVERFLOW)!=0) == ((MinxCPU.F & MINX_FLAG_SIGN)!=0)) && ((MinxCPU.F & MINX_FLAG_ZERO)==0) ) {
 				CALLS(S8_TO_16(I8A));
 			}
 			return 12;
 		case 0xF3: // CALLGE #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if ( ((MinxCPU.F & MINX_FLAG_OVERFLOW)==0) == ((MinxCPU.F & MINX_FLAG_SIGN)==0) ) {
 				CALLS(S8_TO_16(I8A));
 			}
@@ -1052,24 +1068,28 @@ int MinxCPU_ExecCE(void)
 
 		case 0xF4: // CALLO #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if (MinxCPU.F & MINX_FLAG_OVERFLOW) {
 				CALLS(S8_TO_16(I8A));
 			}
 			return 12;
 		case 0xF5: // CALLNO #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if (!(MinxCPU.F & MINX_FLAG_OVERFLOW)) {
 				CALLS(S8_TO_16(I8A));
 			}
 			return 12;
 		case 0xF6: // CALLNS #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if (!(MinxCPU.F & MINX_FLAG_SIGN)) {
 				CALLS(S8_TO_16(I8A));
 			}
 			return 12;
 		case 0xF7: // CALLS #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if (MinxCPU.F & MINX_FLAG_SIGN) {
 				CALLS(S8_TO_16(I8A));
 			}
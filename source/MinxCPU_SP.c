@@ -43,24 +43,28 @@ int MinxCPU_ExecSPCF(void)
 			MinxCPU.BA.W.L = DEC16(MinxCPU.BA.W.L);
 			return 16;
 		case 0x04: case 0x05: case 0x06: case 0x07: // Decrement BA if Carry = 0
+			MinxCPU_SyncFlags();
 			if (!(MinxCPU.F & MINX_FLAG_CARRY)) MinxCPU.BA.W.L = DEC16(MinxCPU.BA.W.L);
 			return 16;
 		case 0x08: case 0x09: case 0x0A: case 0x0B: // Increment BA
 			MinxCPU.BA.W.L = INC16(MinxCPU.BA.W.L);
 			return 16;
 		case 0x0C: case 0x0D: case 0x0E: case 0x0F: // Increment BA if Carry = 0
+			MinxCPU_SyncFlags();
 			if (!(MinxCPU.F & MINX_FLAG_CARRY)) MinxCPU.BA.W.L = INC16(MinxCPU.BA.W.L);
 			return 16;
 		case 0x10: case 0x11: case 0x12: case 0x13: // Decrement BA
 			MinxCPU.BA.W.L = DEC16(MinxCPU.BA.W.L);
 			return 16;
 		case 0x14: case 0x15: case 0x16: case 0x17: // Decrement BA if Carry = 0
+			MinxCPU_SyncFlags();
 			if (!(MinxCPU.F & MINX_FLAG_CARRY)) MinxCPU.BA.W.L = DEC16(MinxCPU.BA.W.L);
 			return 16;
 		case 0x18: case 0x19: case 0x1A: case 0x1B: // Increment BA (Doesn't save result!!)
 			INC16(MinxCPU.BA.W.L);
 			return 16;
 		case 0x1C: case 0x1D: case 0x1E: case 0x1F: // Increment BA if Carry = 0
+			MinxCPU_SyncFlags();
 			if (!(MinxCPU.F & MINX_FLAG_CARRY)) MinxCPU.BA.W.L = INC16(MinxCPU.BA.W.L);
 			return 16;
 
@@ -68,24 +72,28 @@ int MinxCPU_ExecSPCF(void)
 			MinxCPU.HL.W.L = DEC16(MinxCPU.HL.W.L);
 			return 16;
 		case 0x24: case 0x25: case 0x26: case 0x27: // Decrement HL if Carry = 0
+			MinxCPU_SyncFlags();
 			if (!(MinxCPU.F & MINX_FLAG_CARRY)) MinxCPU.HL.W.L = DEC16(MinxCPU.HL.W.L);
 			return 16;
 		case 0x28: case 0x29: case 0x2A: case 0x2B: // Increment HL
 			MinxCPU.HL.W.L = INC16(MinxCPU.HL.W.L);
 			return 16;
 		case 0x2C: case 0x2D: case 0x2E: case 0x2F: // Increment HL if Carry = 0
+			MinxCPU_SyncFlags();
 			if (!(MinxCPU.F & MINX_FLAG_CARRY)) MinxCPU.HL.W.L = INC16(MinxCPU.HL.W.L);
 			return 16;
 		case 0x30: case 0x31: case 0x32: case 0x33: // Decrement HL
 			MinxCPU.HL.W.L = DEC16(MinxCPU.HL.W.L);
 			return 16;
 		case 0x34: case 0x35: case 0x36: case 0x37: // Decrement HL if Carry = 0
+			MinxCPU_SyncFlags();
 			if (!(MinxCPU.F & MINX_FLAG_CARRY)) MinxCPU.HL.W.L = DEC16(MinxCPU.HL.W.L);
 			return 16;
 		case 0x38: case 0x39: case 0x3A: case 0x3B: // Increment HL (Doesn't save result!!)
 			INC16(MinxCPU.HL.W.L);
 			return 16;
 		case 0x3C: case 0x3D: case 0x3E: case 0x3F: // Increment HL if Carry = 0
+			MinxCPU_SyncFlags();
 			if (!(MinxCPU.F & MINX_FLAG_CARRY)) MinxCPU.HL.W.L = INC16(MinxCPU.HL.W.L);
 			return 16;
 
@@ -580,21 +580,25 @@ int MinxCPU_Exec(void)
 
 		case 0x9C: // AND F, #nn
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			MinxCPU.F = MinxCPU.F & I8A;
 			MinxCPU_OnIRQHandle(MinxCPU.F, MinxCPU.Shift_U);
 			return 12;
 		case 0x9D: // OR F, #nn
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			MinxCPU.F = MinxCPU.F | I8A;
 			MinxCPU_OnIRQHandle(MinxCPU.F, MinxCPU.Shift_U);
 			return 12;
 		case 0x9E: // XOR F, #nn
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			MinxCPU.F = MinxCPU.F ^ I8A;
 			MinxCPU_OnIRQHandle(MinxCPU.F, MinxCPU.Shift_U);
 			return 12;
 		case 0x9F: // MOV F, #nn
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			MinxCPU.F = I8A;
 			MinxCPU_OnIRQHandle(MinxCPU.F, MinxCPU.Shift_U);
 			return 12;
@@ -626,6 +630,7 @@ int MinxCPU_Exec(void)
 			PUSH(MinxCPU.Y.B.I);
 			return 16;
 		case 0xA7: // PUSH F
+			MinxCPU_SyncFlags();
 			PUSH(MinxCPU.F);
 			return 12;
 
@@ -657,6 +662,7 @@ int MinxCPU_Exec(void)
 			MinxCPU.X.B.I = POP();
 			return 12;
 		case 0xAF: // POP F
+			MinxCPU_SyncFlags();
 			MinxCPU.F = POP();
 			MinxCPU_OnIRQHandle(MinxCPU.F, MinxCPU.Shift_U);
 			return 8;
@@ -884,6 +890,7 @@ int MinxCPU_Exec(void)
 
 		case 0xE0: // CALLC #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if (MinxCPU.F & MINX_FLAG_CARRY) {
 				CALLS(S8_TO_16(I8A));
 				return 20;
@@ -891,6 +898,7 @@ int MinxCPU_Exec(void)
 			return 8;
 		case 0xE1: // CALLNC #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if (!(MinxCPU.F & MINX_FLAG_CARRY)) {
 				CALLS(S8_TO_16(I8A));
 				return 20;
@@ -898,6 +906,7 @@ int MinxCPU_Exec(void)
 			return 8;
 		case 0xE2: // CALLZ #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if (MinxCPU.F & MINX_FLAG_ZERO) {
 				CALLS(S8_TO_16(I8A));
 				return 20;
@@ -905,6 +914,7 @@ int MinxCPU_Exec(void)
 			return 8;
 		case 0xE3: // CALLNZ #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if (!(MinxCPU.F & MINX_FLAG_ZERO)) {
 				CALLS(S8_TO_16(I8A));
 				return 20;
@@ -913,24 +923,28 @@ int MinxCPU_Exec(void)
 
 		case 0xE4: // JC #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if (MinxCPU.F & MINX_FLAG_CARRY) {
 				JMPS(S8_TO_16(I8A));
 			}
 			return 8;
 		case 0xE5: // JNC #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if (!(MinxCPU.F & MINX_FLAG_CARRY)) {
 				JMPS(S8_TO_16(I8A));
 			}
 			return 8;
 		case 0xE6: // JZ #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if (MinxCPU.F & MINX_FLAG_ZERO) {
 				JMPS(S8_TO_16(I8A));
 			}
 			return 8;
 		case 0xE7: // JNZ #ss
 			I8A = Fetch8();
+			MinxCPU_SyncFlags();
 			if (!(MinxCPU.F & MINX_FLAG_ZERO)) {
 				JMPS(S8_TO_16(I8A));
 			}
@@ -938,6 +952,7 @@ int MinxCPU_Exec(void)
 
 		case 0xE8: // CALLC #ssss
 			I16 = Fetch16();
+			MinxCPU_SyncFlags();
 			if (MinxCPU.F & MINX_FLAG_CARRY) {
 				CALLS(I16);
 				return 24;
@@ -945,6 +960,7 @@ int MinxCPU_Exec(void)
 			return 12;
 		case 0xE9: // CALLNC #ssss
 			I16 = Fetch16();
+			MinxCPU_SyncFlags();
 			if (!(MinxCPU.F & MINX_FLAG_CARRY)) {
 				CALLS(I16);
 				return 24;
@@ -952,6 +968,7 @@ int MinxCPU_Exec(void)
 			return 12;
 		case 0xEA: // CALLZ #ssss
 			I16 = Fetch16();
+			MinxCPU_SyncFlags();
 			if (MinxCPU.F & MINX_FLAG_ZERO) {
 				CALLS(I16);
 				return 24;
@@ -959,6 +976,7 @@ int MinxCPU_Exec(void)
 			return 12;
 		case 0xEB: // CALLNZ #ssss
 			I16 = Fetch16();
+			MinxCPU_SyncFlags();
 			if (!(MinxCPU.F & MINX_FLAG_ZERO)) {
 				CALLS(I16);
 				return 24;
@@ -967,24 +985,28 @@ int MinxCPU_Exec(void)
 
 		case 0xEC: // JC #ssss
 			I16 = Fetch16();
+			MinxCPU_SyncFlags();
 			if (MinxCPU.F & MINX_FLAG_CARRY) {
 				JMPS(I16);
 			}
 			return 12;
 		case 0xED: // JNC #ssss
 			I16 = Fetch16();
+			MinxCPU_SyncFlags();
 			if (!(MinxCPU.F & MINX_FLAG_CARRY)) {
 				JMPS(I16);
 			}
 			return 12;
 		case 0xEE: // JZ #ssss
 			I16 = Fetch16();
+			MinxCPU_SyncFlags();
 			if (MinxCPU.F & MINX_FLAG_ZERO) {
 				JMPS(I16);
 			}
 			return 12;
 		case 0xEF: // JNZ #ssss
 			I16 = Fetch16();
+			MinxCPU_SyncFlags();
 			if (!(MinxCPU.F & MINX_FLAG_ZERO)) {
 				JMPS(I16);
 			}
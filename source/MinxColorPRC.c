@@ -32,6 +32,18 @@ uint8_t *PRCColorTop = 0x00000000;
 // Bit 2 to 7 - Reserved
 uint8_t PRCColorFlags;
 
+// Contrast adjusted copy of PRCColorMap and PRCStaticColorMap
+static uint8_t *PRCColorMapAdj = NULL;
+static int PRCColorMapAdjSize = 0;
+static uint8_t PRCStaticColorMapAdj[8];
+static int PRCColorMapAdjLevel = 0;
+static int PRCColorMapAdjDirty = 1;
+
+// 4 pixels of each nibble for the current LNColor/HNColor pairs
+static uint8_t PRCColorExpandLN[16][4];
+static uint8_t PRCColorExpandHN[16][4];
+static int PRCColorExpandDirty = 3;	// Bit 0 = Low nibble, Bit 1 = High nibble
+
 //
 // Functions
 //
@@ -63,6 +75,12 @@ void MinxColorPRC_Destroy(void)
 		free(PRCColorPixelsOld);
 		PRCColorPixelsOld = NULL;
 	}
+	if (PRCColorMapAdj) {
+		free(PRCColorMapAdj);
+		PRCColorMapAdj = NULL;
+	}
+	PRCColorMapAdjSize = 0;
+	PRCColorMapAdjDirty = 1;
 }
 
 void MinxColorPRC_Reset(int hardreset)
@@ -71,6 +89,13 @@ void MinxColorPRC_Reset(int hardreset)
 	memset((void *)&MinxColorPRC, 0, sizeof(TMinxColorPRC));
 	MinxColorPRC.LNColor1 = 0xF0;
 	MinxColorPRC.HNColor1 = 0xF0;
+	PRCColorExpandDirty = 3;
+}
+
+void MinxColorPRC_StateChanged(void)
+{
+	PRCColorPixels = PRCColorVMem + (MinxColorPRC.ActivePage ? 0x2000 : 0);
+	PRCColorExpandDirty = 3;
 }
 
 int MinxColorPRC_LoadState(FILE *fi, uint32_t bsize)
@@ -91,6 +116,7 @@ int MinxColorPRC_LoadState(FILE *fi, uint32_t bsize)
 	POKELOADSS_END(16384+32);
 	MinxColorPRC.Address &= 0x3FFF;
 	PRCColorPixels = PRCColorVMem + (MinxColorPRC.ActivePage ? 0x2000 : 0);
+	PRCColorExpandDirty = 3;
 }
 
 int MinxColorPRC_SaveState(FILE *fi)
@@ -174,15 +200,19 @@ void MinxColorPRC_WriteReg(uint8_t reg, uint8_t val)
 			return;
 		case 0xF4: // Low Nibble Pixel 0
 			MinxColorPRC.LNColor0 = val;
+			PRCColorExpandDirty |= 1;
 			return;
 		case 0xF5: // High Nibble Pixel 0
 			MinxColorPRC.HNColor0 = val;
+			PRCColorExpandDirty |= 2;
 			return;
 		case 0xF6: // Low Nibble Pixel 1
 			MinxColorPRC.LNColor1 = val;
+			PRCColorExpandDirty |= 1;
 			return;
 		case 0xF7: // High Nibble Pixel 1
 			MinxColorPRC.HNColor1 = val;
+			PRCColorExpandDirty |= 2;
 			return;
 	}
 }
@@ -242,44 +272,107 @@ void MinxColorPRC_WriteCtrl(uint8_t val)
 	}
 }
 
+// Rebuild the nibble expansion tables that changed from LNColor/HNColor
+static void MinxColorPRC_UpdateExpand(void)
+{
+	int i, b;
+	for (i=0; i<16; i++) {
+		for (b=0; b<4; b++) {
+			if (PRCColorExpandDirty & 1) PRCColorExpandLN[i][b] = ((i >> b) & 1) ? MinxColorPRC.LNColor1 : MinxColorPRC.LNColor0;
+			if (PRCColorExpandDirty & 2) PRCColorExpandHN[i][b] = ((i >> b) & 1) ? MinxColorPRC.HNColor1 : MinxColorPRC.HNColor0;
+		}
+	}
+	PRCColorExpandDirty = 0;
+}
+
+// Expand byte into 8 pixels column
+static inline void MinxColorPRC_ExpandColumn(uint8_t *pix, uint8_t data)
+{
+	const uint8_t *lo, *hi;
+	if (PRCColorExpandDirty) MinxColorPRC_UpdateExpand();
+	lo = PRCColorExpandLN[data & 15];
+	hi = PRCColorExpandHN[data >> 4];
+	pix[0*96] = lo[0];
+	pix[1*96] = lo[1];
+	pix[2*96] = lo[2];
+	pix[3*96] = lo[3];
+	pix[4*96] = hi[0];
+	pix[5*96] = hi[1];
+	pix[6*96] = hi[2];
+	pix[7*96] = hi[3];
+}
+
 void MinxColorPRC_WriteFramebuffer(uint16_t addr, uint8_t data)
 {
-	int i;
 	if (MinxColorPRC.Modes & 1) return;
 	addr = (addr / 96) * 8*96 + (addr % 96);
-	for (i=0; i<4; i++) {
-		PRCColorPixels[addr] = (data & 1) ? MinxColorPRC.LNColor1 : MinxColorPRC.LNColor0;
-		data >>= 1; addr += 96;
-	}
-	for (i=4; i<8; i++) {
-		PRCColorPixels[addr] = (data & 1) ? MinxColorPRC.HNColor1 : MinxColorPRC.HNColor0;
-		data >>= 1; addr += 96;
-	}
+	MinxColorPRC_ExpandColumn(PRCColorPixels + addr, data);
 }
 
 void MinxColorPRC_WriteLCD(uint16_t addr, uint8_t data)
 {
-	int i, vaddr = addr & 0xFF;
+	int vaddr = addr & 0xFF;
 	if (MinxColorPRC.Modes & 2) return;
 	if (addr >= 2048) return;
 	if (vaddr >= 96) return;
 	vaddr = ((addr & 0x700) >> 8) * 8*96 + vaddr;
-	for (i=0; i<4; i++) {
-		PRCColorPixels[vaddr] = (data & 1) ? MinxColorPRC.LNColor1 : MinxColorPRC.LNColor0;
-		data >>= 1; vaddr += 96;
+	MinxColorPRC_ExpandColumn(PRCColorPixels + vaddr, data);
+}
+
+const uint8_t PRCStaticColorMap[8] = {0x00, 0xF0, 0x00, 0xF0, 0x00, 0xF0, 0x00, 0xF0};
+
+// Call when PRCColorMap is loaded, modified or freed
+void MinxColorPRC_ColorMapChanged(void)
+{
+	PRCColorMapAdjDirty = 1;
+}
+
+// Rebuild contrast adjusted color maps if contrast level or map changed
+static void MinxColorPRC_UpdateMapAdj(void)
+{
+	int i, size, out, level;
+
+	// Contrast level, as added to every color
+	level = (((MinxLCD.Contrast + 2) & 0x3C) << 2) - 0x80;
+	if (!PRCColorMapAdjDirty && (level == PRCColorMapAdjLevel)) return;
+
+	// Resize copy to the current map
+	size = PRCColorMap ? (int)(PRCColorTop - PRCColorMap) : 0;
+	if (size != PRCColorMapAdjSize) {
+		if (PRCColorMapAdj) free(PRCColorMapAdj);
+		PRCColorMapAdj = size ? (uint8_t *)malloc(size) : NULL;
+		PRCColorMapAdjSize = PRCColorMapAdj ? size : 0;
+	}
+
+	// Add level and clamp
+	for (i=0; i<PRCColorMapAdjSize; i++) {
+		out = level + (int)PRCColorMap[i];
+		if (out > 255) out = 255;
+		if (out < 0) out = 0;
+		PRCColorMapAdj[i] = (uint8_t)out;
 	}
-	for (i=4; i<8; i++) {
-		PRCColorPixels[vaddr] = (data & 1) ? MinxColorPRC.HNColor1 : MinxColorPRC.HNColor0;
-		data >>= 1; vaddr += 96;
+	for (i=0; i<8; i++) {
+		out = level + (int)PRCStaticColorMap[i];
+		if (out > 255) out = 255;
+		if (out < 0) out = 0;
+		PRCStaticColorMapAdj[i] = (uint8_t)out;
 	}
+	PRCColorMapAdjLevel = level;
+	PRCColorMapAdjDirty = 0;
 }
 
-const uint8_t PRCStaticColorMap[8] = {0x00, 0xF0, 0x00, 0xF0, 0x00, 0xF0, 0x00, 0xF0};
+// Contrast adjusted colors at map offset, static map if out of range
+static inline uint8_t *MinxColorPRC_MapAdj(int offset)
+{
+	offset -= (int)PRCColorOffset;
+	if ((offset < 0) || (offset >= PRCColorMapAdjSize)) return PRCStaticColorMapAdj;
+	return PRCColorMapAdj + offset;
+}
 
 static inline void MinxPRC_DrawSprite8x8_Color8(uint8_t cfg, int X, int Y, int DrawT, int MaskT)
 {
 	uint8_t *ColorMap;
-	int yC, xC, xP, level, out;
+	int yC, xC, xP;
 	uint8_t sdata, smask;
 
 	// No point to proceed if it's offscreen
@@ -287,9 +380,7 @@ static inline void MinxPRC_DrawSprite8x8_Color8(uint8_t cfg, int X, int Y, int D
 	if (Y >= 64) return;
 
 	// Pre calculate
-	level = (((MinxLCD.Contrast + 2) & 0x3C) << 2) - 0x80;
-	ColorMap = (uint8_t *)PRCColorMap + (MinxPRC.PRCSprBase >> 2) + (DrawT << 1) - PRCColorOffset;
-	if ((ColorMap < PRCColorMap) || (ColorMap >= PRCColorTop)) ColorMap = (uint8_t *)PRCStaticColorMap;
+	ColorMap = MinxColorPRC_MapAdj((MinxPRC.PRCSprBase >> 2) + (DrawT << 1));
 
 	// Draw sprite
 	for (yC=0; yC<8; yC++) {
@@ -309,10 +400,7 @@ static inline void MinxPRC_DrawSprite8x8_Color8(uint8_t cfg, int X, int Y, int D
 						if (cfg & 0x04) sdata = ~sdata;
 						sdata = sdata & (1 << (yC & 7));
 
-						out = level + (int)(sdata ? ColorMap[1] : *ColorMap);
-						if (out > 255) out = 255;
-						if (out < 0) out = 0;
-						PRCColorPixels[Y * 96 + X] = (uint8_t)out;
+						PRCColorPixels[Y * 96 + X] = sdata ? ColorMap[1] : *ColorMap;
 					}
 				}
 				X++;
@@ -325,10 +413,8 @@ static inline void MinxPRC_DrawSprite8x8_Color8(uint8_t cfg, int X, int Y, int D
 
 void MinxPRC_Render_Color8(void)
 {
-	int xC, yC, tx, ty, tileidxaddr, ltileidxaddr, outaddr, level, out;
-	int tiledataddr = 0;
-	uint8_t *ColorMap = (uint8_t *)PRCStaticColorMap;
-	uint8_t tileidx = 0, tdata, data;
+	int xC, yC, tx, ty, i, span, tiledataddr, shift;
+	uint8_t *ColorMap, *TileIdx, *out, tinv;
 
 	int SprTB, SprAddr;
 	int SprX, SprY, SprC;
@@ -339,41 +425,33 @@ void MinxPRC_Render_Color8(void)
 	PRCColorPixels = PRCColorVMem + (MinxColorPRC.ActivePage ? 0x2000 : 0);
 	if (MinxColorPRC.Modes & 4) return;
 
-	// Color contrast level
-	level = (((MinxLCD.Contrast + 2) & 0x3C) << 2) - 0x80;
+	// Contrast adjusted colors
+	MinxColorPRC_UpdateMapAdj();
 
 	if (PRCRenderBD) {
 		for (xC=0; xC<96*64; xC++) PRCColorPixels[xC] = 0x00;
 	}
 
 	if ((PRCRenderBG) && (PMR_PRC_MODE & 0x02)) {
-		outaddr = 0;
-		ltileidxaddr = -1;
+		out = PRCColorPixels;
+		tinv = (PMR_PRC_MODE & 0x01) ? 0xFF : 0x00;
 		for (yC=0; yC<64; yC++) {
 			ty = yC + MinxPRC.PRCMapPY;
-			for (xC=0; xC<96; xC++) {
-				tx = xC + MinxPRC.PRCMapPX;
-				tileidxaddr = 0x1360 + (ty >> 3) * MinxPRC.PRCMapTW + (tx >> 3);
-
-				// Read tile index
-				if (ltileidxaddr != tileidxaddr) {
-					ltileidxaddr = tileidxaddr;
-					tileidx = MinxPRC_OnRead(0, tileidxaddr);
-					tiledataddr = MinxPRC.PRCBGBase + (tileidx << 3);
-					ColorMap = (uint8_t *)PRCColorMap + (MinxPRC.PRCBGBase >> 2) + (tileidx << 1) - PRCColorOffset;
-					if ((ColorMap < PRCColorMap) || (ColorMap >= PRCColorTop)) ColorMap = (uint8_t *)PRCStaticColorMap;
+			shift = ty & 7;
+			TileIdx = PM_RAM + 0x360 + (ty >> 3) * MinxPRC.PRCMapTW;
+			tx = MinxPRC.PRCMapPX;
+
+			// One tile span at a time
+			for (xC=0; xC<96; xC+=span) {
+				span = 8 - (tx & 7);
+				if (span > 96 - xC) span = 96 - xC;
+				tiledataddr = MinxPRC.PRCBGBase + (TileIdx[tx >> 3] << 3);
+				ColorMap = MinxColorPRC_MapAdj((MinxPRC.PRCBGBase >> 2) + (TileIdx[tx >> 3] << 1));
+				tiledataddr += tx & 7;
+				tx += span;
+				for (i=0; i<span; i++) {
+					*out++ = ColorMap[((MinxPRC_OnRead(0, tiledataddr + i) ^ tinv) >> shift) & 1];
 				}
-
-				// Read tile data
-				tdata = MinxPRC_OnRead(0, tiledataddr + (tx & 7));
-				if (PMR_PRC_MODE & 0x01) tdata = ~tdata;
-				data = (tdata & (1 << (ty & 7))) ? ColorMap[1] : *ColorMap;
-
-				// Write result
-				out = level + (int)data;
-				if (out > 255) out = 255;
-				if (out < 0) out = 0;
-				PRCColorPixels[outaddr++] = (uint8_t)out;
 			}
 		}
 	}
@@ -398,7 +476,7 @@ void MinxPRC_Render_Color8(void)
 static inline void MinxPRC_DrawSprite8x8_Color4(uint8_t cfg, int X, int Y, int DrawT, int MaskT)
 {
 	uint8_t *ColorMap;
-	int yC, xC, xP, level, quad, out;
+	int yC, xC, xP, quad;
 	uint8_t sdata, smask;
 
 	// No point to proceed if it's offscreen
@@ -406,9 +484,7 @@ static inline void MinxPRC_DrawSprite8x8_Color4(uint8_t cfg, int X, int Y, int D
 	if (Y >= 64) return;
 
 	// Pre calculate
-	level = (((MinxLCD.Contrast + 2) & 0x3C) << 2) - 0x80;
-	ColorMap = (uint8_t *)PRCColorMap + MinxPRC.PRCSprBase + (DrawT << 3) - PRCColorOffset;
-	if ((ColorMap < PRCColorMap) || (ColorMap >= PRCColorTop)) ColorMap = (uint8_t *)PRCStaticColorMap;
+	ColorMap = MinxColorPRC_MapAdj(MinxPRC.PRCSprBase + (DrawT << 3));
 
 	// Draw sprite
 	for (yC=0; yC<8; yC++) {
@@ -429,10 +505,7 @@ static inline void MinxPRC_DrawSprite8x8_Color4(uint8_t cfg, int X, int Y, int D
 						if (cfg & 0x04) sdata = ~sdata;
 						sdata = sdata & (1 << (yC & 7));
 
-						out = level + (int)(sdata ? ColorMap[quad+1] : ColorMap[quad]);
-						if (out > 255) out = 255;
-						if (out < 0) out = 0;
-						PRCColorPixels[Y * 96 + X] = (uint8_t)out;
+						PRCColorPixels[Y * 96 + X] = sdata ? ColorMap[quad+1] : ColorMap[quad];
 					}
 				}
 				X++;
@@ -445,10 +518,8 @@ static inline void MinxPRC_DrawSprite8x8_Color4(uint8_t cfg, int X, int Y, int D
 
 void MinxPRC_Render_Color4(void)
 {
-	int xC, yC, tx, ty, tileidxaddr, ltileidxaddr, outaddr, level, quad, out;
-	int tiledataddr = 0;
-	uint8_t *ColorMap = (uint8_t *)PRCStaticColorMap;
-	uint8_t tileidx = 0, tdata, data;
+	int xC, yC, tx, ty, i, span, tiledataddr, shift;
+	uint8_t *ColorMap, *TileIdx, *out, tinv;
 
 	int SprTB, SprAddr;
 	int SprX, SprY, SprC;
@@ -459,42 +530,33 @@ void MinxPRC_Render_Color4(void)
 	PRCColorPixels = PRCColorVMem + (MinxColorPRC.ActivePage ? 0x2000 : 0);
 	if (MinxColorPRC.Modes & 4) return;
 
-	// Color contrast level
-	level = (((MinxLCD.Contrast + 2) & 0x3C) << 2) - 0x80;
+	// Contrast adjusted colors
+	MinxColorPRC_UpdateMapAdj();
 
 	if (PRCRenderBD) {
 		for (xC=0; xC<96*64; xC++) PRCColorPixels[xC] = 0x00;
 	}
 
 	if ((PRCRenderBG) && (PMR_PRC_MODE & 0x02)) {
-		outaddr = 0;
-		ltileidxaddr = -1;
+		out = PRCColorPixels;
+		tinv = (PMR_PRC_MODE & 0x01) ? 0xFF : 0x00;
 		for (yC=0; yC<64; yC++) {
 			ty = yC + MinxPRC.PRCMapPY;
-			for (xC=0; xC<96; xC++) {
-				tx = xC + MinxPRC.PRCMapPX;
-				quad = (ty & 4) + ((tx & 4) >> 1);
-				tileidxaddr = 0x1360 + (ty >> 3) * MinxPRC.PRCMapTW + (tx >> 3);
-
-				// Read tile index
-				if (ltileidxaddr != tileidxaddr) {
-					ltileidxaddr = tileidxaddr;
-					tileidx = MinxPRC_OnRead(0, tileidxaddr);
-					tiledataddr = MinxPRC.PRCBGBase + (tileidx << 3);
-					ColorMap = (uint8_t *)PRCColorMap + MinxPRC.PRCBGBase + (tileidx << 3) - PRCColorOffset;
-					if ((ColorMap < PRCColorMap) || (ColorMap >= PRCColorTop)) ColorMap = (uint8_t *)PRCStaticColorMap;
+			shift = ty & 7;
+			TileIdx = PM_RAM + 0x360 + (ty >> 3) * MinxPRC.PRCMapTW;
+			tx = MinxPRC.PRCMapPX;
+
+			// One tile span at a time, colors of the top or bottom quads
+			for (xC=0; xC<96; xC+=span) {
+				span = 8 - (tx & 7);
+				if (span > 96 - xC) span = 96 - xC;
+				tiledataddr = MinxPRC.PRCBGBase + (TileIdx[tx >> 3] << 3);
+				ColorMap = MinxColorPRC_MapAdj(tiledataddr) + (ty & 4);
+				tiledataddr += tx & 7;
+				for (i=0; i<span; i++) {
+					*out++ = ColorMap[((tx & 4) >> 1) + (((MinxPRC_OnRead(0, tiledataddr + i) ^ tinv) >> shift) & 1)];
+					tx++;
 				}
-
-				// Read tile data
-				tdata = MinxPRC_OnRead(0, tiledataddr + (tx & 7));
-				if (PMR_PRC_MODE & 0x01) tdata = ~tdata;
-				data = (tdata & (1 << (ty & 7))) ? ColorMap[quad+1] : ColorMap[quad];
-
-				// Write result
-				out = level + (int)data;
-				if (out > 255) out = 255;
-				if (out < 0) out = 0;
-				PRCColorPixels[outaddr++] = (uint8_t)out;
 			}
 		}
 	}
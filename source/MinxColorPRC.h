@@ -39,6 +39,7 @@ extern TMinxColorPRC MinxColorPRC;
 
 // For Unofficial Color Pokemon-Mini
 extern int PRCColorEnable;
+extern uint8_t *PRCColorVMem;
 extern uint8_t *PRCColorPixels;
 extern uint8_t *PRCColorPixelsOld;
 extern uint8_t *PRCColorMap;
@@ -57,6 +58,8 @@ void MinxColorPRC_Destroy(void);
 
 void MinxColorPRC_Reset(int hardreset);
 
+void MinxColorPRC_StateChanged(void);
+
 int MinxColorPRC_LoadState(FILE *fi, uint32_t bsize);
 
 int MinxColorPRC_SaveState(FILE *fi);
@@ -69,6 +72,8 @@ void MinxColorPRC_WriteFramebuffer(uint16_t addr, uint8_t data);
 
 void MinxColorPRC_WriteLCD(uint16_t addr, uint8_t data);
 
+void MinxColorPRC_ColorMapChanged(void);
+
 //
 // Internals
 //
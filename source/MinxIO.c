@@ -17,6 +17,7 @@
 */
 
 #include "PokeMini.h"
+#include "Hardware.h"
 
 TMinxIO MinxIO;
 uint8_t *EEPROM = NULL;
@@ -88,6 +89,10 @@ int MinxIO_LoadState(FILE *fi, uint32_t bsize)
 	POKELOADSS_16(MinxIO.EEPAddress);
 	POKELOADSS_X(22);
 	POKELOADSS_A(EEPROM, 8192);
+#ifdef MULTITHREAD
+	PokeMini_EEPROMDirty[0] = PokeMini_EEPROMDirty[1] = 0xFFFFFFFF;
+	PokeMini_EEPROMCommit();
+#endif
 	POKELOADSS_END(32+8192);
 }
 
@@ -315,6 +320,9 @@ void MinxIO_IODataWrite(void)
 	MinxIO_EEPROM_WEvent(Output);
 }
 
+// EEPROM is only reachable by bit-banging I/O pins. The BIOS has no EEPROM
+// routines (see PM_IRQBios), so each game carries its own, and they can't be
+// replaced with high-level calls without knowing each one of them
 void MinxIO_EEPROM_WEvent(uint8_t bits)
 {
 	uint8_t rise = bits & ~MinxIO.EEPLastPins;
@@ -333,6 +341,9 @@ void MinxIO_EEPROM_WEvent(uint8_t bits)
 	// "Stop" Command
 	if ((rise & MINX_EEPROM_DAT) && (bits & MINX_EEPROM_CLK)) {
 		MinxIO.ListenState = MINX_EEPROM_IDLE;
+#ifdef MULTITHREAD
+		if (PokeMini_EEPROMJournalLen && !PokeMini_RunningAhead) PokeMini_EEPROMCommit();
+#endif
 		return;
 	}
 
@@ -391,6 +402,10 @@ void MinxIO_EEPROM_Write(uint8_t data)
 	case MINX_EEPROM_WBYTE:
 		PokeMini_EEPROMWritten = 1;
 		EEPROM[MinxIO.EEPAddress & 0x1FFF] = data;
+#ifdef MULTITHREAD
+		// Frames ahead are rolled back, the writer must not see them
+		if (!PokeMini_RunningAhead) PokeMini_EEPROMLog(MinxIO.EEPAddress, data);
+#endif
 		MinxIO.EEPAddress++;
 		break;
 	case MINX_EEPROM_RBYTE:
@@ -64,6 +64,9 @@ extern uint8_t *LCDPixelsD;
 // LCD Pixels Analog (96 x 64, 0 to 255)
 extern uint8_t *LCDPixelsA;
 
+// LCD Pixels Analog decay history (96 x 64), second half of LCDPixelsA
+extern uint8_t *LCDPixelsAS;
+
 
 int MinxLCD_Create(void);
 
@@ -515,3 +515,132 @@ void PokeMini_GotoCurrentDir(void) {}
 void PokeMini_GotoExecDir(void) {}
 
 #endif
+
+#ifdef MULTITHREAD
+
+typedef struct {
+	TPMThreadFunc func;
+	void *data;
+} TPMThreadStart;
+
+#ifdef _WIN32
+
+static DWORD WINAPI PMThread_Entry(LPVOID param)
+{
+	TPMThreadStart start = *(TPMThreadStart *)param;
+	free(param);
+	return (DWORD)start.func(start.data);
+}
+
+int PMThread_Create(PMThread *thread, TPMThreadFunc func, void *data)
+{
+	TPMThreadStart *start = (TPMThreadStart *)malloc(sizeof(TPMThreadStart));
+	if (!start) return 0;
+	start->func = func;
+	start->data = data;
+	*thread = CreateThread(NULL, 0, PMThread_Entry, start, 0, NULL);
+	if (!*thread) {
+		free(start);
+		return 0;
+	}
+	return 1;
+}
+
+void PMThread_Join(PMThread thread)
+{
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+}
+
+void PMMutex_Init(PMMutex *mutex) { InitializeCriticalSection(mutex); }
+void PMMutex_Destroy(PMMutex *mutex) { DeleteCriticalSection(mutex); }
+void PMMutex_Lock(PMMutex *mutex) { EnterCriticalSection(mutex); }
+void PMMutex_Unlock(PMMutex *mutex) { LeaveCriticalSection(mutex); }
+
+void PMCond_Init(PMCond *cond) { InitializeConditionVariable(cond); }
+void PMCond_Destroy(PMCond *cond) {}
+void PMCond_Wait(PMCond *cond, PMMutex *mutex) { SleepConditionVariableCS(cond, mutex, INFINITE); }
+int PMCond_TimedWait(PMCond *cond, PMMutex *mutex, int ms) { return SleepConditionVariableCS(cond, mutex, ms) ? 1 : 0; }
+void PMCond_Signal(PMCond *cond) { WakeConditionVariable(cond); }
+void PMCond_Broadcast(PMCond *cond) { WakeAllConditionVariable(cond); }
+
+int PMAtomic_Get(volatile int *value) { return (int)InterlockedCompareExchange((volatile LONG *)value, 0, 0); }
+void PMAtomic_Set(volatile int *value, int newvalue) { InterlockedExchange((volatile LONG *)value, newvalue); }
+int PMAtomic_Exchange(volatile int *value, int newvalue) { return (int)InterlockedExchange((volatile LONG *)value, newvalue); }
+
+#else
+
+#include <sys/time.h>
+
+static void *PMThread_Entry(void *param)
+{
+	TPMThreadStart start = *(TPMThreadStart *)param;
+	free(param);
+	start.func(start.data);
+	return NULL;
+}
+
+int PMThread_Create(PMThread *thread, TPMThreadFunc func, void *data)
+{
+	TPMThreadStart *start = (TPMThreadStart *)malloc(sizeof(TPMThreadStart));
+	if (!start) return 0;
+	start->func = func;
+	start->data = data;
+	if (pthread_create(thread, NULL, PMThread_Entry, start)) {
+		free(start);
+		return 0;
+	}
+	return 1;
+}
+
+void PMThread_Join(PMThread thread)
+{
+	pthread_join(thread, NULL);
+}
+
+void PMMutex_Init(PMMutex *mutex) { pthread_mutex_init(mutex, NULL); }
+void PMMutex_Destroy(PMMutex *mutex) { pthread_mutex_destroy(mutex); }
+void PMMutex_Lock(PMMutex *mutex) { pthread_mutex_lock(mutex); }
+void PMMutex_Unlock(PMMutex *mutex) { pthread_mutex_unlock(mutex); }
+
+void PMCond_Init(PMCond *cond) { pthread_cond_init(cond, NULL); }
+void PMCond_Destroy(PMCond *cond) { pthread_cond_destroy(cond); }
+void PMCond_Wait(PMCond *cond, PMMutex *mutex) { pthread_cond_wait(cond, mutex); }
+void PMCond_Signal(PMCond *cond) { pthread_cond_signal(cond); }
+void PMCond_Broadcast(PMCond *cond) { pthread_cond_broadcast(cond); }
+
+int PMCond_TimedWait(PMCond *cond, PMMutex *mutex, int ms)
+{
+	struct timeval now;
+	struct timespec timeout;
+	gettimeofday(&now, NULL);
+	timeout.tv_sec = now.tv_sec + ms / 1000;
+	timeout.tv_nsec = (now.tv_usec + (ms % 1000) * 1000) * 1000;
+	if (timeout.tv_nsec >= 1000000000) {
+		timeout.tv_sec++;
+		timeout.tv_nsec -= 1000000000;
+	}
+	return pthread_cond_timedwait(cond, mutex, &timeout) ? 0 : 1;
+}
+
+int PMAtomic_Get(volatile int *value)
+{
+	return __sync_fetch_and_add(value, 0);
+}
+
+void PMAtomic_Set(volatile int *value, int newvalue)
+{
+	__sync_synchronize();
+	__sync_lock_test_and_set(value, newvalue);
+}
+
+int PMAtomic_Exchange(volatile int *value, int newvalue)
+{
+	// Test and set is only an acquire barrier
+	__sync_synchronize();
+	return __sync_lock_test_and_set(value, newvalue);
+}
+
+#endif
+
+#endif
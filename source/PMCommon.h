@@ -146,6 +146,48 @@ extern char PokeMini_ExecDir[PMTMPV];	// Launch directory
 extern char PokeMini_CurrDir[PMTMPV];	// Current directory
 #endif
 
+// Threads (only when compiled with MULTITHREAD)
+#ifdef MULTITHREAD
+#ifdef _WIN32
+#include <windows.h>
+typedef HANDLE PMThread;
+typedef CRITICAL_SECTION PMMutex;
+typedef CONDITION_VARIABLE PMCond;
+#else
+#include <pthread.h>
+typedef pthread_t PMThread;
+typedef pthread_mutex_t PMMutex;
+typedef pthread_cond_t PMCond;
+#endif
+
+typedef int (*TPMThreadFunc)(void *data);
+
+// Create thread, return false on failure
+int PMThread_Create(PMThread *thread, TPMThreadFunc func, void *data);
+
+// Wait for thread to finish
+void PMThread_Join(PMThread thread);
+
+// Mutex
+void PMMutex_Init(PMMutex *mutex);
+void PMMutex_Destroy(PMMutex *mutex);
+void PMMutex_Lock(PMMutex *mutex);
+void PMMutex_Unlock(PMMutex *mutex);
+
+// Condition variable, PMCond_TimedWait return false on timeout
+void PMCond_Init(PMCond *cond);
+void PMCond_Destroy(PMCond *cond);
+void PMCond_Wait(PMCond *cond, PMMutex *mutex);
+int PMCond_TimedWait(PMCond *cond, PMMutex *mutex, int ms);
+void PMCond_Signal(PMCond *cond);
+void PMCond_Broadcast(PMCond *cond);
+
+// Atomic integer with full memory barrier, PMAtomic_Exchange return old value
+int PMAtomic_Get(volatile int *value);
+void PMAtomic_Set(volatile int *value, int newvalue);
+int PMAtomic_Exchange(volatile int *value, int newvalue);
+#endif
+
 // For debugging
 enum {
 	POKEMSG_OUT,
@@ -99,6 +99,7 @@ void (*PokeMini_OnReset)(int hardreset) = NULL;
 
 int (*PokeMini_CustomLoadEEPROM)(const char *filename) = NULL;
 int (*PokeMini_CustomSaveEEPROM)(const char *filename) = NULL;
+void (*PokeMini_CustomKeypadEvent)(uint8_t key, int pressed) = NULL;
 
 // Number of cycles to process on hardware
 int PokeHWCycles = 0;
@@ -143,12 +144,22 @@ int PokeMini_Create(int flags, int soundfifo)
 	SetMulticart(CommandLine.multicart);
 #endif
 
+#ifdef COVERAGE
+	// Record coverage
+	if (strlen(CommandLine.coverage_file)) {
+		if (!Coverage_Start()) return 0;
+	}
+#endif
+
 	return 1;
 }
 
 // Destroy emulator and all interfaces
 void PokeMini_Destroy()
 {
+	// Stop EEPROM writer
+	PokeMini_EEPROMWriteBehind(NULL);
+
 	// Destroy all interfaces
 	MinxAudio_Destroy();
 	MinxLCD_Destroy();
@@ -168,6 +179,14 @@ void PokeMini_Destroy()
 
 	// Free color info
 	PokeMini_FreeColorInfo();
+
+#ifdef COVERAGE
+	// Merge coverage into file
+	if (strlen(CommandLine.coverage_file)) {
+		if (!Coverage_Save(CommandLine.coverage_file, 1)) PokeDPrint(POKEMSG_ERR, "Error saving coverage to '%s'\n", CommandLine.coverage_file);
+	}
+	Coverage_Free();
+#endif
 }
 
 // Apply changes from command lines
@@ -184,7 +203,8 @@ void PokeMini_ApplyChanges()
 // User press or release a Pokemon-Mini key
 void PokeMini_KeypadEvent(uint8_t key, int pressed)
 {
-	MinxIO_Keypad(key, pressed);
+	if (PokeMini_CustomKeypadEvent) PokeMini_CustomKeypadEvent(key, pressed);
+	else MinxIO_Keypad(key, pressed);
 }
 
 // Low power battery emulation
@@ -374,6 +394,7 @@ void PokeMini_FreeColorInfo()
 		free(PRCColorMap);
 		PRCColorMap = NULL;
 	}
+	MinxColorPRC_ColorMapChanged();
 }
 
 // Syncronize host time
@@ -451,6 +472,7 @@ int PokeMini_LoadColorStream(TPokeMini_StreamIO stream, void *stream_ptr)
 			PRCColorMap[i] = RemapMINC10_11[PRCColorMap[i] & 15] | (PRCColorMap[i] & 0xF0);
 		}
 	}
+	MinxColorPRC_ColorMapChanged();
 
 	return (readbytes > 0);
 }
@@ -507,6 +529,9 @@ int PokeMini_LoadEEPROMFile(const char *filename)
 	readbytes = fread(EEPROM, 1, 8192, fi);
 	fclose(fi);
 
+	// Writes that didn't made into the image
+	if (readbytes == 8192) PokeMini_ReplayEEPROMJournal(filename);
+
 	// Callback
 	if (PokeMini_OnLoadEEPROMFile) PokeMini_OnLoadEEPROMFile(filename, (readbytes == 8192) ? 1 : 0);
 
@@ -516,8 +541,7 @@ int PokeMini_LoadEEPROMFile(const char *filename)
 // Save EEPROM
 int PokeMini_SaveEEPROMFile(const char *filename)
 {
-	FILE *fo;
-	int writebytes, success;
+	int success;
 
 	// Custom EEPROM save
 	if (PokeMini_CustomSaveEEPROM) {
@@ -526,21 +550,291 @@ int PokeMini_SaveEEPROMFile(const char *filename)
 		return success;
 	}
 
-	// Open file
-	fo = fopen(filename, "wb");
-	if (fo == NULL) {
-		if (PokeMini_OnSaveEEPROMFile) PokeMini_OnSaveEEPROMFile(filename, -1);
+	// Write content
+	success = PokeMini_WriteEEPROMImage(filename, EEPROM);
+
+	// Callback
+	if (PokeMini_OnSaveEEPROMFile) PokeMini_OnSaveEEPROMFile(filename, success);
+
+	return (success == 1);
+}
+
+// Full path of EEPROM file plus extension, relative names are resolved
+// against the current directory so the writer thread and the loader
+// always agree on the files even if the directory changes later
+static void PokeMini_EEPROMPath(char *path, const char *filename, const char *ext)
+{
+#ifndef NO_DIRS
+	char dir[PMTMPV];
+	if ((filename[0] != '/') && (filename[0] != '\\') && !strchr(filename, ':')) {
+		PokeMini_GetCustomDir(dir, PMTMPV);
+		if (HasLastSlash(dir)) sprintf(path, "%s%s%s", dir, filename, ext);
+		else sprintf(path, "%s/%s%s", dir, filename, ext);
+		return;
+	}
+#endif
+	sprintf(path, "%s%s", filename, ext);
+}
+
+#ifdef MULTITHREAD
+
+// EEPROM write-behind writer
+#define EEPROM_WB_QUIET		1000	// Quiet time (ms) before saving the image
+#define EEPROM_WB_DEFERMAX	8	// Maximum times the image save can be deferred
+
+typedef struct {
+	PMThread thread;
+	PMMutex mutex;
+	PMCond cond;
+	int running;
+	int quit;
+	int flush;
+	int busy;
+	int error;
+	char filename[PMTMPV*2];
+	char jnlfile[PMTMPV*2+8];
+	uint8_t image[8192];
+	int imagedirty;
+	uint8_t journal[EEPROM_JOURNAL_MAX*3];
+	int journallen;
+} TEEPROMWriter;
+
+static TEEPROMWriter EEPWriter;
+
+static int PokeMini_EEPROMWriterThread(void *data)
+{
+	uint8_t image[8192];
+	uint8_t journal[EEPROM_JOURNAL_MAX*3];
+	int journallen, res, deferred = 0;
+	FILE *fo;
+
+	PMMutex_Lock(&EEPWriter.mutex);
+	while (!EEPWriter.quit || EEPWriter.journallen || EEPWriter.imagedirty) {
+		if (!EEPWriter.journallen && !EEPWriter.imagedirty) {
+			EEPWriter.flush = 0;
+			PMCond_Broadcast(&EEPWriter.cond);
+			PMCond_Wait(&EEPWriter.cond, &EEPWriter.mutex);
+			continue;
+		}
+		EEPWriter.busy = 1;
+
+		// Append pending writes into the journal
+		if (EEPWriter.journallen) {
+			journallen = EEPWriter.journallen;
+			memcpy(journal, EEPWriter.journal, journallen);
+			EEPWriter.journallen = 0;
+			PMMutex_Unlock(&EEPWriter.mutex);
+			fo = fopen(EEPWriter.jnlfile, "ab");
+			if (fo) {
+				if (!ftell(fo)) fwrite("PMEJ", 1, 4, fo);
+				fwrite(journal, 1, journallen, fo);
+				fclose(fo);
+			}
+			PMMutex_Lock(&EEPWriter.mutex);
+		}
+
+		// Wait until the game stop writing, coalescing all dirty pages
+		if (!EEPWriter.quit && !EEPWriter.flush && (deferred < EEPROM_WB_DEFERMAX)) {
+			EEPWriter.busy = 0;
+			if (PMCond_TimedWait(&EEPWriter.cond, &EEPWriter.mutex, EEPROM_WB_QUIET)) {
+				deferred++;
+				continue;
+			}
+			EEPWriter.busy = 1;
+		}
+		deferred = 0;
+
+		// Save whole image, journal up to this point isn't needed anymore
+		if (EEPWriter.imagedirty) {
+			memcpy(image, EEPWriter.image, 8192);
+			EEPWriter.imagedirty = 0;
+			EEPWriter.journallen = 0;
+			PMMutex_Unlock(&EEPWriter.mutex);
+			res = PokeMini_WriteEEPROMImage(EEPWriter.filename, image);
+			PMMutex_Lock(&EEPWriter.mutex);
+			EEPWriter.error = (res != 1);	// Reported by the emulator thread
+		}
+		EEPWriter.busy = 0;
+	}
+	EEPWriter.flush = 0;
+	PMCond_Broadcast(&EEPWriter.cond);
+	PMMutex_Unlock(&EEPWriter.mutex);
+
+	return 0;
+}
+
+// Stop writer after saving everything, clear written flag if the file is up to date
+static void PokeMini_EEPROMWriterStop(void)
+{
+	PokeMini_EEPROMCommit();
+	PMMutex_Lock(&EEPWriter.mutex);
+	EEPWriter.quit = 1;
+	PMCond_Broadcast(&EEPWriter.cond);
+	PMMutex_Unlock(&EEPWriter.mutex);
+	PMThread_Join(EEPWriter.thread);
+	PMCond_Destroy(&EEPWriter.cond);
+	PMMutex_Destroy(&EEPWriter.mutex);
+	EEPWriter.running = 0;
+	if (EEPWriter.error) PokeDPrint(POKEMSG_ERR, "Error saving EEPROM '%s': write error\n", EEPWriter.filename);
+	else if (!memcmp(EEPWriter.image, EEPROM, 8192)) PokeMini_EEPROMWritten = 0;
+}
+
+#endif
+
+// EEPROM dirty pages and journal of pending writes
+uint32_t PokeMini_EEPROMDirty[2] = {0, 0};
+uint8_t PokeMini_EEPROMJournal[EEPROM_JOURNAL_MAX*3];
+int PokeMini_EEPROMJournalLen = 0;
+int PokeMini_RunningAhead = 0;
+
+// Start EEPROM write-behind for this file, NULL to stop
+int PokeMini_EEPROMWriteBehind(const char *filename)
+{
+#ifdef MULTITHREAD
+	// Stop current writer, everything pending is saved
+	if (EEPWriter.running) PokeMini_EEPROMWriterStop();
+	PokeMini_EEPROMDirty[0] = PokeMini_EEPROMDirty[1] = 0;
+	PokeMini_EEPROMJournalLen = 0;
+	if (!filename || !StringIsSet((char *)filename) || !EEPROM) return 0;
+	if (!CommandLine.eeprom_async || PokeMini_CustomSaveEEPROM) return 0;
+
+	// Writer thread may outlive the current directory
+	PokeMini_EEPROMPath(EEPWriter.filename, filename, "");
+	PokeMini_EEPROMPath(EEPWriter.jnlfile, filename, ".jnl");
+
+	// Launch writer, replayed journal still needs to be saved
+	memcpy(EEPWriter.image, EEPROM, 8192);
+	EEPWriter.imagedirty = PokeMini_EEPROMWritten;
+	EEPWriter.error = 0;
+	EEPWriter.journallen = 0;
+	EEPWriter.quit = 0;
+	EEPWriter.flush = 0;
+	EEPWriter.busy = 0;
+	PMMutex_Init(&EEPWriter.mutex);
+	PMCond_Init(&EEPWriter.cond);
+	if (!PMThread_Create(&EEPWriter.thread, PokeMini_EEPROMWriterThread, NULL)) {
+		PMCond_Destroy(&EEPWriter.cond);
+		PMMutex_Destroy(&EEPWriter.mutex);
 		return 0;
 	}
+	EEPWriter.running = 1;
+	return 1;
+#else
+	return 0;
+#endif
+}
 
-	// Read content
-	writebytes = fwrite(EEPROM, 1, 8192, fo);
-	fclose(fo);
+// Hand dirty pages and pending journal to the writer
+void PokeMini_EEPROMCommit(void)
+{
+#ifdef MULTITHREAD
+	int i, len;
+	if (!EEPWriter.running) {
+		PokeMini_EEPROMDirty[0] = PokeMini_EEPROMDirty[1] = 0;
+		PokeMini_EEPROMJournalLen = 0;
+		return;
+	}
+	if (!PokeMini_EEPROMDirty[0] && !PokeMini_EEPROMDirty[1]) return;
+	PMMutex_Lock(&EEPWriter.mutex);
+	for (i=0; i<64; i++) {
+		if (PokeMini_EEPROMDirty[i >> 5] & ((uint32_t)1 << (i & 31))) {
+			memcpy(EEPWriter.image + i * EEPROM_PAGE_SIZE, EEPROM + i * EEPROM_PAGE_SIZE, EEPROM_PAGE_SIZE);
+		}
+	}
+	EEPWriter.imagedirty = 1;
+	len = PokeMini_EEPROMJournalLen;
+	if ((EEPWriter.journallen + len) <= EEPROM_JOURNAL_MAX*3) {
+		memcpy(EEPWriter.journal + EEPWriter.journallen, PokeMini_EEPROMJournal, len);
+		EEPWriter.journallen += len;
+	} else {
+		// Journal overflow, save the image now instead
+		EEPWriter.flush = 1;
+	}
+	PMCond_Broadcast(&EEPWriter.cond);
+	PMMutex_Unlock(&EEPWriter.mutex);
+#endif
+	PokeMini_EEPROMDirty[0] = PokeMini_EEPROMDirty[1] = 0;
+	PokeMini_EEPROMJournalLen = 0;
+}
 
-	// Callback
-	if (PokeMini_OnSaveEEPROMFile) PokeMini_OnSaveEEPROMFile(filename, (writebytes == 8192) ? 1 : 0);
+// Wait until the writer saved everything
+void PokeMini_EEPROMFlush(void)
+{
+#ifdef MULTITHREAD
+	if (!EEPWriter.running) return;
+	PokeMini_EEPROMCommit();
+	PMMutex_Lock(&EEPWriter.mutex);
+	EEPWriter.flush = 1;
+	PMCond_Broadcast(&EEPWriter.cond);
+	while (EEPWriter.journallen || EEPWriter.imagedirty || EEPWriter.busy) {
+		PMCond_Wait(&EEPWriter.cond, &EEPWriter.mutex);
+	}
+	if (EEPWriter.error) {
+		PokeDPrint(POKEMSG_ERR, "Error saving EEPROM '%s': write error\n", EEPWriter.filename);
+		EEPWriter.error = 0;
+	} else if (!memcmp(EEPWriter.image, EEPROM, 8192)) {
+		// File is up to date
+		PokeMini_EEPROMWritten = 0;
+	}
+	PMMutex_Unlock(&EEPWriter.mutex);
+#endif
+}
+
+// Write EEPROM image safely and discard journal, return 1 on success
+int PokeMini_WriteEEPROMImage(const char *filename, const uint8_t *image)
+{
+	char tmpfile[PMTMPV*2+8];
+	FILE *fo;
+	int writebytes;
+
+	// Write into temporary file
+	sprintf(tmpfile, "%s.tmp", filename);
+	fo = fopen(tmpfile, "wb");
+	if (fo == NULL) return -1;
+	writebytes = fwrite(image, 1, 8192, fo);
+	if (fclose(fo)) writebytes = 0;
+	if (writebytes != 8192) {
+		remove(tmpfile);
+		return 0;
+	}
+
+	// Replace old file
+#ifdef _WIN32
+	remove(filename);
+#endif
+	if (rename(tmpfile, filename)) {
+		remove(tmpfile);
+		return 0;
+	}
 
-	return (writebytes == 8192);
+	// Journal is now part of the image
+	PokeMini_EEPROMPath(tmpfile, filename, ".jnl");
+	remove(tmpfile);
+
+	return 1;
+}
+
+// Replay journal of writes over loaded EEPROM, return number of writes
+int PokeMini_ReplayEEPROMJournal(const char *filename)
+{
+	char jnlfile[PMTMPV*2+8];
+	uint8_t rec[4];
+	int writes = 0;
+	FILE *fi;
+
+	PokeMini_EEPROMPath(jnlfile, filename, ".jnl");
+	fi = fopen(jnlfile, "rb");
+	if (fi == NULL) return 0;
+	if ((fread(rec, 1, 4, fi) == 4) && !memcmp(rec, "PMEJ", 4)) {
+		while (fread(rec, 1, 3, fi) == 3) {
+			EEPROM[((rec[0] << 8) | rec[1]) & 0x1FFF] = rec[2];
+			writes++;
+		}
+	}
+	fclose(fi);
+	if (writes) PokeMini_EEPROMWritten = 1;
+
+	return writes;
 }
 
 // Check emulator state
@@ -702,6 +996,9 @@ int PokeMini_LoadSSFile(const char *statefile)
 	// Syncronize with host time
 	PokeMini_SyncHostTime();
 
+	// Frozen values override the state
+	PokeMini_CheatApply();
+
 	// Callback
 	if (PokeMini_OnLoadStateFile) PokeMini_OnLoadStateFile(statefile, 1);
 	return 1;
@@ -932,6 +1229,139 @@ static int PokeMini_iLoadROMZip(const char *zipfile, int *colorloaded)
 }
 #endif
 
+// Save in-memory snapshot
+void PokeMini_SaveSnapshot(TPokeMini_Snapshot *ss)
+{
+	MinxCPU_SyncFlags();
+	memcpy(ss->RAM, PM_RAM, 0x1100);
+	ss->CPU = MinxCPU;
+	ss->MasterIRQ = MinxIRQ_MasterIRQ;
+	ss->Timers = MinxTimers;
+	ss->IO = MinxIO;
+	if (EEPROM) memcpy(ss->EEPROM, EEPROM, 8192);
+	ss->EEPROMDirty[0] = PokeMini_EEPROMDirty[0];
+	ss->EEPROMDirty[1] = PokeMini_EEPROMDirty[1];
+	ss->EEPROMJournalLen = PokeMini_EEPROMJournalLen;
+	ss->EEPROMWritten = PokeMini_EEPROMWritten;
+	ss->Rumbling = PokeMini_Rumbling;
+	ss->RumblingLatch = PokeMini_RumblingLatch;
+	ss->PRC = MinxPRC;
+	ss->StallCPU = StallCPU;
+	ss->StallCycles = StallCycles;
+	ss->ColorPRC = MinxColorPRC;
+	if (PRCColorVMem) memcpy(ss->ColorVMem, PRCColorVMem, 16384);
+	ss->LCD = MinxLCD;
+	if (LCDData) memcpy(ss->LCDData, LCDData, 256*9);
+	ss->Audio = MinxAudio;
+	ss->MM_Type = PM_MM_Type;
+	ss->MM_Dirty = PM_MM_Dirty;
+	ss->MM_BusCycle = PM_MM_BusCycle;
+	ss->MM_GetID = PM_MM_GetID;
+	ss->MM_Bypass = PM_MM_Bypass;
+	ss->MM_Command = PM_MM_Command;
+	ss->MM_Offset = PM_MM_Offset;
+}
+
+// Load in-memory snapshot
+void PokeMini_LoadSnapshot(const TPokeMini_Snapshot *ss)
+{
+	memcpy(PM_RAM, ss->RAM, 0x1100);
+	MinxCPU = ss->CPU;
+#ifdef LAZYFLAGS
+	MinxCPU_LazyOp = MINX_LAZY_NONE;
+#endif
+	MinxIRQ_MasterIRQ = ss->MasterIRQ;
+	MinxTimers = ss->Timers;
+	MinxIO = ss->IO;
+	if (EEPROM) memcpy(EEPROM, ss->EEPROM, 8192);
+	PokeMini_EEPROMDirty[0] = ss->EEPROMDirty[0];
+	PokeMini_EEPROMDirty[1] = ss->EEPROMDirty[1];
+	PokeMini_EEPROMJournalLen = ss->EEPROMJournalLen;
+	PokeMini_EEPROMWritten = ss->EEPROMWritten;
+	PokeMini_Rumbling = ss->Rumbling;
+	PokeMini_RumblingLatch = ss->RumblingLatch;
+	MinxPRC = ss->PRC;
+	StallCPU = ss->StallCPU;
+	StallCycles = ss->StallCycles;
+	MinxColorPRC = ss->ColorPRC;
+	if (PRCColorVMem) memcpy(PRCColorVMem, ss->ColorVMem, 16384);
+	MinxColorPRC_StateChanged();
+	MinxLCD = ss->LCD;
+	if (LCDData) memcpy(LCDData, ss->LCDData, 256*9);
+	MinxAudio = ss->Audio;
+	PM_MM_Type = ss->MM_Type;
+	PM_MM_Dirty = ss->MM_Dirty;
+	PM_MM_BusCycle = ss->MM_BusCycle;
+	PM_MM_GetID = ss->MM_GetID;
+	PM_MM_Bypass = ss->MM_Bypass;
+	PM_MM_Command = ss->MM_Command;
+	PM_MM_Offset = ss->MM_Offset;
+}
+
+// Cheats
+TPokeMini_Cheat PokeMini_Cheats[POKEMINI_MAXCHEATS];
+int PokeMini_NumCheats = 0;
+uint8_t PokeMini_CheatPages[16];
+uint16_t PokeMini_CheatFrozen[4096];
+
+static void PokeMini_CheatPoke(uint32_t addr, uint8_t data)
+{
+	PM_RAM[addr-0x1000] = data;
+	if (PRCColorMap && (addr < 0x1300)) MinxColorPRC_WriteFramebuffer(addr-0x1000, data);
+}
+
+// Add cheat, replaces any cheat on the same address, return 0 on failure
+int PokeMini_CheatAdd(uint32_t addr, uint8_t data, int type)
+{
+	if ((addr < 0x1000) || (addr >= 0x2000)) return 0;
+	PokeMini_CheatRemove(addr);
+	if (type == PokeMini_CheatPatch) {
+		PokeMini_CheatPoke(addr, data);
+		return 1;
+	}
+	if (PokeMini_NumCheats >= POKEMINI_MAXCHEATS) return 0;
+	PokeMini_Cheats[PokeMini_NumCheats].addr = (uint16_t)addr;
+	PokeMini_Cheats[PokeMini_NumCheats].data = data;
+	PokeMini_Cheats[PokeMini_NumCheats].type = (uint8_t)type;
+	PokeMini_NumCheats++;
+	PokeMini_CheatFrozen[addr & 0xFFF] = 0x100 | data;
+	PokeMini_CheatPages[(addr >> 8) & 15]++;
+	PokeMini_CheatPoke(addr, data);
+	return 1;
+}
+
+// Remove cheat on address, return 0 if not found
+int PokeMini_CheatRemove(uint32_t addr)
+{
+	int i;
+	for (i=0; i<PokeMini_NumCheats; i++) {
+		if (PokeMini_Cheats[i].addr == addr) {
+			PokeMini_CheatFrozen[addr & 0xFFF] = 0;
+			PokeMini_CheatPages[(addr >> 8) & 15]--;
+			PokeMini_Cheats[i] = PokeMini_Cheats[--PokeMini_NumCheats];
+			return 1;
+		}
+	}
+	return 0;
+}
+
+// Remove all cheats
+void PokeMini_CheatClear(void)
+{
+	PokeMini_NumCheats = 0;
+	memset(PokeMini_CheatPages, 0, sizeof(PokeMini_CheatPages));
+	memset(PokeMini_CheatFrozen, 0, sizeof(PokeMini_CheatFrozen));
+}
+
+// Write all frozen values to RAM
+void PokeMini_CheatApply(void)
+{
+	int i;
+	for (i=0; i<PokeMini_NumCheats; i++) {
+		PokeMini_CheatPoke(PokeMini_Cheats[i].addr, PokeMini_Cheats[i].data);
+	}
+}
+
 // Load MIN ROM (and others)
 int PokeMini_LoadROM(const char *filename)
 {
@@ -943,6 +1373,7 @@ int PokeMini_LoadROM(const char *filename)
 
 	// Save Individual EEPROM
 	if (!CommandLine.eeprom_share) {
+		PokeMini_EEPROMWriteBehind(NULL);
 		if (PokeMini_EEPROMWritten && StringIsSet(CommandLine.eeprom_file)) {
 			PokeMini_EEPROMWritten = 0;
 			PokeMini_SaveEEPROMFile(CommandLine.eeprom_file);
@@ -994,6 +1425,7 @@ int PokeMini_LoadROM(const char *filename)
 #endif
 		MinxIO_FormatEEPROM();
 		if (FileExist(CommandLine.eeprom_file)) PokeMini_LoadEEPROMFile(CommandLine.eeprom_file);
+		PokeMini_EEPROMWriteBehind(CommandLine.eeprom_file);
 	}
 
 	// Soft reset hardware
@@ -1042,6 +1474,7 @@ int PokeMini_LoadFromCommandLines(const char *nobios, const char *noeeprom)
 	}
 
 	// Load EEPROM
+	PokeMini_EEPROMWriteBehind(NULL);
 	if (CommandLine.eeprom_share) {
 		// Shared EEPROM
 		PokeMini_GetCustomDir(tmp, PMTMPV);
@@ -1049,6 +1482,7 @@ int PokeMini_LoadFromCommandLines(const char *nobios, const char *noeeprom)
 		MinxIO_FormatEEPROM();
 		if (StringIsSet(CommandLine.eeprom_file)) {
 			if (FileExist(CommandLine.eeprom_file)) PokeMini_LoadEEPROMFile(CommandLine.eeprom_file);
+			PokeMini_EEPROMWriteBehind(CommandLine.eeprom_file);
 		} else {
 			if (noeeprom) PokeDPrint(POKEMSG_OUT, "%s\n", noeeprom);
 		}
@@ -1066,6 +1500,7 @@ int PokeMini_LoadFromCommandLines(const char *nobios, const char *noeeprom)
 #endif
 		MinxIO_FormatEEPROM();
 		if (FileExist(CommandLine.eeprom_file)) PokeMini_LoadEEPROMFile(CommandLine.eeprom_file);
+		PokeMini_EEPROMWriteBehind(CommandLine.eeprom_file);
 	}
 
 	// Reset CPU (soft reset)
@@ -1085,6 +1520,7 @@ void PokeMini_SaveFromCommandLines(int exitemulator)
 	char tmp[PMTMPV];
 
 	// Save EEPROM
+	PokeMini_EEPROMFlush();
 	PokeMini_GetCustomDir(tmp, PMTMPV);
 	PokeMini_GotoExecDir();
 	if (PokeMini_EEPROMWritten && StringIsSet(CommandLine.eeprom_file)) {
@@ -1216,6 +1652,9 @@ void PokeMini_Reset(int hardreset)
 	SetMulticart(CommandLine.multicart);
 #endif
 
+	// Frozen values survive reset
+	PokeMini_CheatApply();
+
 	// Callback
 	if (PokeMini_OnReset) PokeMini_OnReset(hardreset);
 }
@@ -77,6 +77,7 @@ enum {
 #include "CommandLine.h"
 #include "Multicart.h"
 #include "UI.h"
+#include "Coverage.h"
 
 // Callbacks
 extern void (*PokeMini_OnAllocMIN)(int newsize, int success);
@@ -92,6 +93,7 @@ extern void (*PokeMini_OnReset)(int hardreset);
 
 extern int (*PokeMini_CustomLoadEEPROM)(const char *filename);
 extern int (*PokeMini_CustomSaveEEPROM)(const char *filename);
+extern void (*PokeMini_CustomKeypadEvent)(uint8_t key, int pressed);
 
 // PRC Read/Write
 #ifdef PERFORMANCE
@@ -100,6 +102,9 @@ static inline uint8_t MinxPRC_OnRead(int cpu, uint32_t addr)
 {
 	if (addr >= 0x2100) {
 		// ROM Read
+#ifdef COVERAGE
+		Coverage_Mark(COVERAGE_READ, addr);
+#endif
 		if (PM_ROM) return PM_ROM[addr & PM_ROM_Mask];
 	} else if (addr >= 0x2000) {
 		// I/O Read (Unused)
@@ -126,7 +131,19 @@ static inline void MinxPRC_OnWrite(int cpu, uint32_t addr, uint8_t data)
 
 #include "Multicart.h"
 
+#ifdef COVERAGE
+
+static inline uint8_t MinxPRC_OnRead(int cpu, uint32_t addr)
+{
+	if (addr >= 0x2100) Coverage_Mark(COVERAGE_READ, addr);
+	return MinxCPU_OnRead(cpu, addr);
+}
+
+#else
+
 #define MinxPRC_OnRead	MinxCPU_OnRead
+
+#endif
 #define MinxPRC_OnWrite	MinxCPU_OnWrite
 
 #endif
@@ -267,6 +284,88 @@ int PokeMini_LoadEEPROMFile(const char *filename);
 // Save EEPROM data
 int PokeMini_SaveEEPROMFile(const char *filename);
 
+// EEPROM write-behind, EEPROM page size and maximum pending journal writes
+#define EEPROM_PAGE_SIZE	128
+#define EEPROM_JOURNAL_MAX	1024
+extern uint32_t PokeMini_EEPROMDirty[2];
+extern uint8_t PokeMini_EEPROMJournal[];
+extern int PokeMini_EEPROMJournalLen;
+
+// Set while emulating frames ahead, their side effects are discarded
+extern int PokeMini_RunningAhead;
+
+// Start background EEPROM writer for this file (NULL to stop)
+int PokeMini_EEPROMWriteBehind(const char *filename);
+
+// Send dirty EEPROM pages to the background writer
+void PokeMini_EEPROMCommit(void);
+
+// Wait until background writer saved everything
+void PokeMini_EEPROMFlush(void);
+
+// Write EEPROM image safely (temporary file + rename)
+int PokeMini_WriteEEPROMImage(const char *filename, const uint8_t *image);
+
+// Replay EEPROM writes journal, return number of writes
+int PokeMini_ReplayEEPROMJournal(const char *filename);
+
+// Log EEPROM write for background writer
+static inline void PokeMini_EEPROMLog(uint16_t addr, uint8_t data)
+{
+	int page = (addr & 0x1FFF) / EEPROM_PAGE_SIZE;
+	PokeMini_EEPROMDirty[page >> 5] |= (uint32_t)1 << (page & 31);
+	if (PokeMini_EEPROMJournalLen >= EEPROM_JOURNAL_MAX*3) {
+		// Hand the full journal to the writer first
+		PokeMini_EEPROMCommit();
+	}
+	if (PokeMini_EEPROMJournalLen < EEPROM_JOURNAL_MAX*3) {
+		PokeMini_EEPROMJournal[PokeMini_EEPROMJournalLen++] = (uint8_t)(addr >> 8);
+		PokeMini_EEPROMJournal[PokeMini_EEPROMJournalLen++] = (uint8_t)addr;
+		PokeMini_EEPROMJournal[PokeMini_EEPROMJournalLen++] = data;
+	}
+}
+
+// Cheats on RAM ($001000 to $001FFF)
+// Freeze replaces every CPU write with the cheat value, patch is written once
+#define POKEMINI_MAXCHEATS	64
+enum {
+	PokeMini_CheatFreeze = 0,
+	PokeMini_CheatPatch
+};
+
+typedef struct {
+	uint16_t addr;		// Address
+	uint8_t data;		// Value
+	uint8_t type;		// PokeMini_Cheat*
+} TPokeMini_Cheat;
+
+extern TPokeMini_Cheat PokeMini_Cheats[POKEMINI_MAXCHEATS];
+extern int PokeMini_NumCheats;
+extern uint8_t PokeMini_CheatPages[16];		// Frozen addresses per 256 bytes page
+extern uint16_t PokeMini_CheatFrozen[4096];	// 0x100 | value on frozen addresses
+
+// Add cheat, replaces any cheat on the same address, return 0 on failure
+int PokeMini_CheatAdd(uint32_t addr, uint8_t data, int type);
+
+// Remove cheat on address, return 0 if not found
+int PokeMini_CheatRemove(uint32_t addr);
+
+// Remove all cheats
+void PokeMini_CheatClear(void);
+
+// Write all frozen values to RAM
+void PokeMini_CheatApply(void);
+
+// Filter CPU write into RAM, only pages with frozen addresses are looked up
+static inline uint8_t PokeMini_CheatWrite(uint32_t addr, uint8_t data)
+{
+	if (PokeMini_CheatPages[(addr >> 8) & 15]) {
+		uint16_t frozen = PokeMini_CheatFrozen[addr & 0xFFF];
+		if (frozen) return (uint8_t)frozen;
+	}
+	return data;
+}
+
 // Check emulator state, output romfile from assigned ROM in state
 int PokeMini_CheckSSFile(const char *statefile, char *romfile);
 
@@ -276,6 +375,36 @@ int PokeMini_LoadSSFile(const char *statefile);
 // Save emulator state
 int PokeMini_SaveSSFile(const char *statefile, const char *romfile);
 
+// Fast in-memory snapshot of the emulated hardware
+// ROM and files aren't included, used for run-ahead and reverse execution
+typedef struct {
+	uint8_t RAM[0x1100];
+	TMinxCPU CPU;
+	int MasterIRQ;
+	TMinxTimers Timers;
+	TMinxIO IO;
+	uint8_t EEPROM[8192];
+	uint32_t EEPROMDirty[2];
+	int EEPROMJournalLen;
+	int EEPROMWritten;
+	int Rumbling;
+	int RumblingLatch;
+	TMinxPRC PRC;
+	int StallCPU;
+	int StallCycles;
+	TMinxColorPRC ColorPRC;
+	uint8_t ColorVMem[16384];
+	TMinxLCD LCD;
+	uint8_t LCDData[256*9];
+	TMinxAudio Audio;
+	int MM_Type, MM_Dirty, MM_BusCycle, MM_GetID, MM_Bypass, MM_Command;
+	uint32_t MM_Offset;
+} TPokeMini_Snapshot;
+
+// Save and load snapshot
+void PokeMini_SaveSnapshot(TPokeMini_Snapshot *ss);
+void PokeMini_LoadSnapshot(const TPokeMini_Snapshot *ss);
+
 // Load MIN ROM (and others)
 int PokeMini_LoadROM(const char *filename);
 
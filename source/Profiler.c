@@ -0,0 +1,326 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PokeMini.h"
+#include "Profiler.h"
+
+#ifdef PROFILER
+
+// Maximum different stacks
+#define PROFILER_MAXSTACKS	65536
+
+// Hash table size, power of 2
+#define PROFILER_HASHSIZE	16384
+
+typedef struct {
+	uint32_t entry;		// Physical address of called code
+	uint16_t sp;		// SP after pushing return address
+} TProfilerFrame;
+
+typedef struct {
+	uint32_t hash;
+	int next;		// Next stack with same hash, -1 for none
+	int depth;		// Frames including leaf
+	int addrs;		// Index of frames in Profiler.addrs
+	uint32_t count;		// Samples
+} TProfilerStack;
+
+typedef struct {
+	int period;
+	int depth;
+	TProfilerFrame frame[PROFILER_MAXDEPTH];
+	int hash[PROFILER_HASHSIZE];
+	TProfilerStack *stacks;
+	int numstacks;
+	uint32_t *addrs;
+	int numaddrs, allocaddrs;
+	int samples;
+	int dropped;
+} TProfiler;
+
+int Profiler_Active = 0;
+uint64_t *Profiler_Cycles = NULL;
+int Profiler_SampleLeft = 0;
+static TProfiler Profiler;
+
+static inline uint32_t Profiler_PhysPC(void)
+{
+	uint32_t pc = MinxCPU.PC.W.L;
+	if (pc & 0x8000) pc = ((MinxCPU.PC.B.I << 15) | (pc & 0x7FFF)) & 0x1FFFFF;
+	return pc;
+}
+
+// Called after CALL or IRQ entry
+void MinxCPU_OnCall(void)
+{
+	uint16_t sp = MinxCPU.SP.W.L;
+	if (!Profiler_Active) return;
+	// Drop frames left behind without return
+	while (Profiler.depth && (Profiler.frame[Profiler.depth-1].sp <= sp)) Profiler.depth--;
+	if (Profiler.depth < PROFILER_MAXDEPTH) {
+		Profiler.frame[Profiler.depth].entry = Profiler_PhysPC();
+		Profiler.frame[Profiler.depth].sp = sp;
+		Profiler.depth++;
+	}
+}
+
+// Called after RET or RETI
+void MinxCPU_OnReturn(void)
+{
+	uint16_t sp = MinxCPU.SP.W.L;
+	if (!Profiler_Active) return;
+	while (Profiler.depth && (Profiler.frame[Profiler.depth-1].sp < sp)) Profiler.depth--;
+}
+
+int Profiler_Start(int period)
+{
+	Profiler_Free();
+	Profiler_Cycles = (uint64_t *)malloc(0x200000 * sizeof(uint64_t));
+	Profiler.stacks = (TProfilerStack *)malloc(PROFILER_MAXSTACKS * sizeof(TProfilerStack));
+	Profiler.allocaddrs = 65536;
+	Profiler.addrs = (uint32_t *)malloc(Profiler.allocaddrs * sizeof(uint32_t));
+	if (!Profiler_Cycles || !Profiler.stacks || !Profiler.addrs) {
+		Profiler_Free();
+		return 0;
+	}
+	memset(Profiler_Cycles, 0, 0x200000 * sizeof(uint64_t));
+	memset(Profiler.hash, -1, sizeof(Profiler.hash));
+	Profiler.period = (period > 0) ? period : PROFILER_PERIOD;
+	Profiler_SampleLeft = Profiler.period;
+	Profiler_Active = 1;
+	return 1;
+}
+
+void Profiler_Stop(void)
+{
+	Profiler_Active = 0;
+}
+
+void Profiler_Free(void)
+{
+	Profiler_Active = 0;
+	if (Profiler_Cycles) {
+		free(Profiler_Cycles);
+		Profiler_Cycles = NULL;
+	}
+	if (Profiler.stacks) free(Profiler.stacks);
+	if (Profiler.addrs) free(Profiler.addrs);
+	memset(&Profiler, 0, sizeof(TProfiler));
+}
+
+int Profiler_Samples(void)
+{
+	return Profiler.samples;
+}
+
+int Profiler_Dropped(void)
+{
+	return Profiler.dropped;
+}
+
+void Profiler_Sample(void)
+{
+	uint32_t key[PROFILER_MAXDEPTH+1], hash;
+	TProfilerStack *stk;
+	int i, depth, idx;
+
+	Profiler_SampleLeft += Profiler.period;
+	if (Profiler_SampleLeft <= 0) Profiler_SampleLeft = Profiler.period;
+	Profiler.samples++;
+
+	// Key is the call entries followed by leaf
+	depth = Profiler.depth;
+	for (i=0; i<depth; i++) key[i] = Profiler.frame[i].entry;
+	key[depth] = Profiler_PhysPC();
+	if (MinxCPU.Status == MINX_STATUS_HALT || MinxCPU.Status == MINX_STATUS_STOP) key[depth] |= PROFILER_IDLE;
+	depth++;
+
+	// FNV-1a
+	hash = 2166136261u;
+	for (i=0; i<depth; i++) hash = (hash ^ key[i]) * 16777619u;
+
+	// Find stack
+	idx = Profiler.hash[hash & (PROFILER_HASHSIZE-1)];
+	while (idx >= 0) {
+		stk = &Profiler.stacks[idx];
+		if ((stk->hash == hash) && (stk->depth == depth) && !memcmp(&Profiler.addrs[stk->addrs], key, depth * sizeof(uint32_t))) {
+			stk->count++;
+			return;
+		}
+		idx = stk->next;
+	}
+
+	// Add new stack
+	if (Profiler.numstacks >= PROFILER_MAXSTACKS) {
+		Profiler.dropped++;
+		return;
+	}
+	if (Profiler.numaddrs + depth > Profiler.allocaddrs) {
+		uint32_t *addrs = (uint32_t *)realloc(Profiler.addrs, Profiler.allocaddrs * 2 * sizeof(uint32_t));
+		if (!addrs) {
+			Profiler.dropped++;
+			return;
+		}
+		Profiler.addrs = addrs;
+		Profiler.allocaddrs *= 2;
+	}
+	stk = &Profiler.stacks[Profiler.numstacks];
+	stk->hash = hash;
+	stk->depth = depth;
+	stk->addrs = Profiler.numaddrs;
+	stk->count = 1;
+	stk->next = Profiler.hash[hash & (PROFILER_HASHSIZE-1)];
+	Profiler.hash[hash & (PROFILER_HASHSIZE-1)] = Profiler.numstacks++;
+	memcpy(&Profiler.addrs[Profiler.numaddrs], key, depth * sizeof(uint32_t));
+	Profiler.numaddrs += depth;
+}
+
+typedef struct {
+	char *stack;
+	uint32_t count;
+} TProfilerLine;
+
+static int Profiler_LineCmp(const void *a, const void *b)
+{
+	return strcmp(((const TProfilerLine *)a)->stack, ((const TProfilerLine *)b)->stack);
+}
+
+// Append frame name, return new length
+static int Profiler_AppendName(char *out, int len, const char *name)
+{
+	int nlen = strlen(name);
+	if (len + nlen + 2 > PMTMPV * 4) return len;
+	if (len) out[len++] = ';';
+	memcpy(out + len, name, nlen + 1);
+	return len + nlen;
+}
+
+int Profiler_SaveFolded(const char *filename, TProfiler_Resolve resolve)
+{
+	TProfilerLine *lines;
+	TProfilerStack *stk;
+	const char *name;
+	char out[PMTMPV * 4], tmp[PMTMPV];
+	uint32_t addr, symaddr, lastsym;
+	int i, j, len, numlines;
+	FILE *fo;
+
+	if (!Profiler.stacks) return 0;
+	lines = (TProfilerLine *)malloc((Profiler.numstacks + 1) * sizeof(TProfilerLine));
+	if (!lines) return 0;
+
+	// Resolve stacks, leaf collapses to its function
+	numlines = 0;
+	for (i=0; i<Profiler.numstacks; i++) {
+		stk = &Profiler.stacks[i];
+		len = 0;
+		lastsym = 0xFFFFFFFF;
+		out[0] = 0;
+		for (j=0; j<stk->depth; j++) {
+			addr = Profiler.addrs[stk->addrs + j] & ~PROFILER_IDLE;
+			name = resolve ? resolve(addr, &symaddr) : NULL;
+			if (j < stk->depth-1) {
+				if (name) lastsym = symaddr;
+				else {
+					sprintf(tmp, "$%06X", (unsigned int)addr);
+					name = tmp;
+					lastsym = addr;
+				}
+				len = Profiler_AppendName(out, len, name);
+			} else {
+				// Leaf inside last call is self time
+				if (name && (symaddr != lastsym)) len = Profiler_AppendName(out, len, name);
+				else if (!name && !len) len = Profiler_AppendName(out, len, "[root]");
+				if (Profiler.addrs[stk->addrs + j] & PROFILER_IDLE) len = Profiler_AppendName(out, len, "[idle]");
+			}
+		}
+		lines[numlines].stack = (char *)malloc(len + 1);
+		if (!lines[numlines].stack) break;
+		memcpy(lines[numlines].stack, out, len + 1);
+		lines[numlines].count = stk->count;
+		numlines++;
+	}
+
+	// Merge equal stacks and save
+	qsort(lines, numlines, sizeof(TProfilerLine), Profiler_LineCmp);
+	fo = fopen(filename, "w");
+	if (fo) {
+		for (i=0; i<numlines; i=j) {
+			uint32_t count = lines[i].count;
+			for (j=i+1; (j<numlines) && !strcmp(lines[i].stack, lines[j].stack); j++) count += lines[j].count;
+			fprintf(fo, "%s %u\n", lines[i].stack, (unsigned int)count);
+		}
+		fclose(fo);
+	}
+	for (i=0; i<numlines; i++) free(lines[i].stack);
+	free(lines);
+	return fo != NULL;
+}
+
+static int Profiler_CyclesCmp(const void *a, const void *b)
+{
+	uint64_t ca = Profiler_Cycles[*(const uint32_t *)a];
+	uint64_t cb = Profiler_Cycles[*(const uint32_t *)b];
+	if (ca != cb) return (ca < cb) ? 1 : -1;
+	return (*(const uint32_t *)a < *(const uint32_t *)b) ? -1 : 1;
+}
+
+int Profiler_SaveCycles(const char *filename, TProfiler_Resolve resolve)
+{
+	uint32_t *addrs, addr, symaddr;
+	uint64_t total = 0;
+	const char *name;
+	int i, num = 0;
+	FILE *fo;
+
+	if (!Profiler_Cycles) return 0;
+	for (addr=0; addr<0x200000; addr++) {
+		if (Profiler_Cycles[addr]) {
+			total += Profiler_Cycles[addr];
+			num++;
+		}
+	}
+	addrs = (uint32_t *)malloc((num + 1) * sizeof(uint32_t));
+	if (!addrs) return 0;
+	num = 0;
+	for (addr=0; addr<0x200000; addr++) {
+		if (Profiler_Cycles[addr]) addrs[num++] = addr;
+	}
+	qsort(addrs, num, sizeof(uint32_t), Profiler_CyclesCmp);
+
+	fo = fopen(filename, "w");
+	if (!fo) {
+		free(addrs);
+		return 0;
+	}
+	fprintf(fo, "; Address, Cycles, Percent, Symbol\n");
+	fprintf(fo, "; Total %llu cycles, %i samples\n", (unsigned long long)total, Profiler.samples);
+	for (i=0; i<num; i++) {
+		addr = addrs[i];
+		fprintf(fo, "$%06X %12llu %6.2f%%", (unsigned int)addr, (unsigned long long)Profiler_Cycles[addr], (double)Profiler_Cycles[addr] * 100.0 / (double)total);
+		name = resolve ? resolve(addr, &symaddr) : NULL;
+		if (name && (symaddr == addr)) fprintf(fo, " %s", name);
+		else if (name) fprintf(fo, " %s+$%X", name, (unsigned int)(addr - symaddr));
+		fprintf(fo, "\n");
+	}
+	fclose(fo);
+	free(addrs);
+	return 1;
+}
+
+#endif
@@ -0,0 +1,95 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef POKEMINI_PROFILER
+#define POKEMINI_PROFILER
+
+#include <stdint.h>
+#include "MinxCPU.h"
+
+// Guest code profiler
+//
+// Count CPU cycles per physical PC and sample the call stack every few
+// thousand cycles. The stack is rebuilt from CALL/RET and IRQ entry/RETI,
+// samples are merged into folded stacks ("a;b;c count") for flamegraphs.
+// Only compiled with PROFILER, otherwise Profiler_Exec() is MinxCPU_Exec().
+
+#ifdef PROFILER
+
+// Maximum tracked call depth, deeper calls are left out of the samples
+#define PROFILER_MAXDEPTH	64
+
+// Default sample period in cycles
+#define PROFILER_PERIOD		4000
+
+// Set on the leaf address when the CPU is halted or stopped
+#define PROFILER_IDLE		0x80000000
+
+// Resolve address to symbol name, set symaddr to the symbol address
+// Return NULL if there's no symbol
+typedef const char *(*TProfiler_Resolve)(uint32_t addr, uint32_t *symaddr);
+
+extern int Profiler_Active;		// Profiling enabled
+extern uint64_t *Profiler_Cycles;	// Cycles per physical PC (2MB range)
+extern int Profiler_SampleLeft;		// Cycles left for next sample
+
+// Start profiling, sample every period cycles, return 0 on failure
+int Profiler_Start(int period);
+
+// Stop profiling, results are kept until next start
+void Profiler_Stop(void);
+
+// Free results
+void Profiler_Free(void);
+
+// Number of samples taken and dropped (stack table full)
+int Profiler_Samples(void);
+int Profiler_Dropped(void);
+
+// Take a sample, called by Profiler_Exec()
+void Profiler_Sample(void);
+
+// Save folded stacks, resolve can be NULL, return 0 on failure
+int Profiler_SaveFolded(const char *filename, TProfiler_Resolve resolve);
+
+// Save cycles per address, sorted by cycles, return 0 on failure
+int Profiler_SaveCycles(const char *filename, TProfiler_Resolve resolve);
+
+// Execute 1 CPU instruction, counting cycles
+static inline int Profiler_Exec(void)
+{
+	uint32_t pc;
+	int cylc;
+
+	if (!Profiler_Active) return MinxCPU_Exec();
+	pc = MinxCPU.PC.W.L;
+	if (pc & 0x8000) pc = ((MinxCPU.PC.B.I << 15) | (pc & 0x7FFF)) & 0x1FFFFF;
+	cylc = MinxCPU_Exec();
+	Profiler_Cycles[pc] += cylc;
+	Profiler_SampleLeft -= cylc;
+	if (Profiler_SampleLeft <= 0) Profiler_Sample();
+	return cylc;
+}
+
+#else
+
+#define Profiler_Exec()	MinxCPU_Exec()
+
+#endif
+
+#endif
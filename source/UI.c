@@ -203,6 +203,7 @@ int UIMenu_Savestate = 0;	// Savestate offset
 int UIMenu_CurrentItemsNum = 0;			// Number of current items
 TUIMenu_Item *UIMenu_CurrentItems = NULL;	// Current items list
 TUIMenu_FileListCache *UIMenu_FileListCache = NULL;	// Files list cache
+int UIMenu_FileListAlloc = 0;	// Number of entries allocated in files list cache
 int UIMenu_ListOffs = 0;	// Offset on list cache
 int UIMenu_ListFiles = 0;	// Number of files in files list cache
 
@@ -256,6 +257,10 @@ TUIMenu_Item UIItems_Options[] = {
 	{ 0, 20, "Multicart      %s", UIItems_OptionsC },
 #endif
 	{ 0, 50, "Sync Cycles    %d", UIItems_OptionsC },
+	{ 0, 51, "Run-ahead      %d", UIItems_OptionsC },
+#ifdef FRAMEPACE
+	{ 0, 52, "Frame pacing   %s", UIItems_OptionsC },
+#endif
 	{ 0, 60, "Reload Color Info", UIItems_OptionsC },
 	{ 0, 99, "Save Settings", UIItems_OptionsC },
 	{ 9,  0, "Settings", UIItems_OptionsC }
@@ -327,9 +332,10 @@ int UIMenu_Init(void)
 	UI_Enabled = 1;
 	UI_FirstLoad = 1;
 
-	// Allocate files list cache
+	// Allocate files list cache, grows as needed
 	UIMenu_FileListCache = (TUIMenu_FileListCache *)malloc(UI_MAXCACHE * sizeof(TUIMenu_FileListCache));
 	if (!UIMenu_FileListCache) return 0;
+	UIMenu_FileListAlloc = UI_MAXCACHE;
 
 	return 1;
 }
@@ -342,30 +348,112 @@ void UIMenu_Destroy(void)
 	if (UIMenu_FileListCache) {
 		free(UIMenu_FileListCache);
 		UIMenu_FileListCache = NULL;
+		UIMenu_FileListAlloc = 0;
 	}
 }
 
-void UIMenu_SwapEntries(int a, int b)
+#ifndef NO_SCANDIRS
+
+// Make sure the files list cache can hold this entry
+static int UIMenu_FileListGrow(int index)
 {
-	TUIMenu_FileListCache tmp;
-	memcpy(&tmp, &UIMenu_FileListCache[a], sizeof(TUIMenu_FileListCache));
-	memcpy(&UIMenu_FileListCache[a], &UIMenu_FileListCache[b], sizeof(TUIMenu_FileListCache));
-	memcpy(&UIMenu_FileListCache[b], &tmp, sizeof(TUIMenu_FileListCache));
+	TUIMenu_FileListCache *newlist;
+	int newalloc = UIMenu_FileListAlloc;
+	if (index < UIMenu_FileListAlloc) return 1;
+	while (index >= newalloc) newalloc *= 2;
+	newlist = (TUIMenu_FileListCache *)realloc(UIMenu_FileListCache, newalloc * sizeof(TUIMenu_FileListCache));
+	if (!newlist) return 0;
+	UIMenu_FileListCache = newlist;
+	UIMenu_FileListAlloc = newalloc;
+	return 1;
 }
 
-#ifndef NO_SCANDIRS
+// Color info first, then directories and files
+static int UIMenu_CompareEntries(const void *a, const void *b)
+{
+	const TUIMenu_FileListCache *ea = (const TUIMenu_FileListCache *)a;
+	const TUIMenu_FileListCache *eb = (const TUIMenu_FileListCache *)b;
+	if (ea->stats != eb->stats) return ea->stats - eb->stats;
+	if (ea->stats == 0) return strcasecmp(ea->name, eb->name);
+	if (!strcmp(ea->name, "..")) return -1;
+	if (!strcmp(eb->name, "..")) return 1;
+	return strcasecmp(ea->name, eb->name);
+}
 
-int UIMenu_ReadDir(char *dirname)
+static int UIMenu_CompareColorInfo(const void *key, const void *elem)
 {
-	int i, j, cmp, hasslash, isdir, items = 0;
-	char file[PMTMPV];
+	return strcasecmp((const char *)key, ((const TUIMenu_FileListCache *)elem)->name);
+}
 
-	// Clear all cache
-	for (i=0; i<UI_MAXCACHE; i++) {
-		UIMenu_FileListCache[i].name[0] = 0;
-		UIMenu_FileListCache[i].stats = 0;
-		UIMenu_FileListCache[i].color = 0;
+// Sort entries and match color information (listed with stats = 0)
+static int UIMenu_SortEntries(int items)
+{
+	char file[PMTMPV];
+	int i, colorinfo = 0;
+
+	qsort(UIMenu_FileListCache, items, sizeof(TUIMenu_FileListCache), UIMenu_CompareEntries);
+	while ((colorinfo < items) && (UIMenu_FileListCache[colorinfo].stats == 0)) colorinfo++;
+	if (!colorinfo) return items;
+	for (i=colorinfo; i<items; i++) {
+		if ((UIMenu_FileListCache[i].stats != 2) || UIMenu_FileListCache[i].color) continue;
+		sprintf(file, "%sc", UIMenu_FileListCache[i].name);
+		if (bsearch(file, UIMenu_FileListCache, colorinfo, sizeof(TUIMenu_FileListCache), UIMenu_CompareColorInfo)) {
+			UIMenu_FileListCache[i].color = 1;
+		}
 	}
+	memmove(UIMenu_FileListCache, UIMenu_FileListCache + colorinfo, (items - colorinfo) * sizeof(TUIMenu_FileListCache));
+
+	return items - colorinfo;
+}
+
+// Set entry name, truncated to fit
+static void UIMenu_SetEntryName(int item, const char *name)
+{
+	size_t len = strlen(name);
+	if (len > sizeof(UIMenu_FileListCache[item].name) - 1) len = sizeof(UIMenu_FileListCache[item].name) - 1;
+	memcpy(UIMenu_FileListCache[item].name, name, len);
+	UIMenu_FileListCache[item].name[len] = 0;
+}
+
+// Add file entry if it's a ROM or color information, return new number of items
+static int UIMenu_AddFileEntry(int items, const char *name)
+{
+	int stats, color = 0;
+	if (ExtensionCheck(name, ".min")
+#ifdef _TINSPIRE
+	|	ExtensionCheck(name, ".tns")
+#endif
+	) {
+		stats = 2;
+	} else if (ExtensionCheck(name, ".minc")) {
+		stats = 0;
+#ifndef NO_ZIP
+	} else if (ExtensionCheck(name, ".zip")) {
+		stats = 2;
+		color = 2;
+#endif
+	} else return items;
+	if (!UIMenu_FileListGrow(items)) return items;
+	UIMenu_SetEntryName(items, name);
+	UIMenu_FileListCache[items].stats = stats;
+	UIMenu_FileListCache[items].color = color;
+	return items + 1;
+}
+
+// Add directory entry, return new number of items
+static int UIMenu_AddDirEntry(int items, const char *name)
+{
+	if (!UIMenu_FileListGrow(items)) return items;
+	UIMenu_SetEntryName(items, name);
+	UIMenu_FileListCache[items].stats = 1;
+	UIMenu_FileListCache[items].color = 0;
+	return items + 1;
+}
+
+int UIMenu_ReadDir(char *dirname)
+{
+	int hasslash, isdir, items = 0;
+	char file[PMTMPV];
 
 	// Read directories and files
 	hasslash = HasLastSlash(dirname);
@@ -373,42 +461,14 @@ int UIMenu_ReadDir(char *dirname)
 	file_t d = fs_open(dirname, O_RDONLY | O_DIR);
 	dirent_t *de;
 	if (strlen(dirname) > 1) {
-		strcpy(UIMenu_FileListCache[0].name, "..");
-		UIMenu_FileListCache[0].stats = 1;
-		items = 1;
+		items = UIMenu_AddDirEntry(items, "..");
 	}
 	while ( (de = fs_readdir(d)) ) {
 		if (de->name[0] == 0) break;
 		if (de->name[0] == '.') continue;
-		UIMenu_FileListCache[items].stats = 1;
-		strcpy(UIMenu_FileListCache[items].name, de->name);
-		if (hasslash) sprintf(file, "%s%s", dirname, de->name);
-		else sprintf(file, "%s/%s", dirname, de->name);
 		isdir = (de->size < 0);
-		if (isdir) {
-			// Directory
-			UIMenu_FileListCache[items++].stats = 1;
-			if (items >= UI_MAXCACHE) break;
-		} else {
-			// File
-			if (ExtensionCheck(de->name, ".min")
-#ifdef _TINSPIRE
-			|	ExtensionCheck(de->name, ".tns")
-#endif
-			) {
-				UIMenu_FileListCache[items].stats = 2;
-				sprintf(file, "%sc", de->name);
-				if (FileExist(file)) UIMenu_FileListCache[items].color = 1;
-				items++;
-#ifndef NO_ZIP
-			} else if (ExtensionCheck(de->name, ".zip")) {
-				UIMenu_FileListCache[items].stats = 2;
-				UIMenu_FileListCache[items].color = 2;
-				items++;
-#endif
-			}
-			if (items >= UI_MAXCACHE) break;
-		}
+		if (isdir) items = UIMenu_AddDirEntry(items, de->name);
+		else items = UIMenu_AddFileEntry(items, de->name);
 	}
 	fs_close(d);
 #else
@@ -421,63 +481,33 @@ int UIMenu_ReadDir(char *dirname)
 	}
 	while((dirEntry = readdir(dir)) != NULL) {
 		if (dirEntry->d_name[0] == 0) break;
-		UIMenu_FileListCache[items].stats = 0;
-		strcpy(UIMenu_FileListCache[items].name, dirEntry->d_name);
 		if (strcmp(dirEntry->d_name, ".") == 0) {
 			// Current directory
 			continue;
-		} else {
-			// Current directory, file or directory
+		}
+#ifdef _DIRENT_HAVE_D_TYPE
+		// Only ask the filesystem when the type is unknown
+		if (dirEntry->d_type == DT_DIR) isdir = 1;
+		else if (dirEntry->d_type == DT_REG) isdir = 0;
+		else
+#endif
+		{
 			if (hasslash) sprintf(file, "%s%s", dirname, dirEntry->d_name);
 			else sprintf(file, "%s/%s", dirname, dirEntry->d_name);
 			if (stat(file, &Stat) == -1) {
 				PokeDPrint(POKEMSG_ERR, "stat('%s') error\n", file);
 				continue;
-			} else {
-				isdir = S_ISDIR(Stat.st_mode);
-			}
-			
-		}
-		if (isdir) {
-			// Directory
-			UIMenu_FileListCache[items++].stats = 1;
-			if (items >= UI_MAXCACHE) break;
-		} else {
-			// File
-			if (ExtensionCheck(dirEntry->d_name, ".min")
-#ifdef _TINSPIRE
-			|	ExtensionCheck(dirEntry->d_name, ".tns")
-#endif
-			) {
-				UIMenu_FileListCache[items].stats = 2;
-				sprintf(file, "%sc", dirEntry->d_name);
-				if (FileExist(file)) UIMenu_FileListCache[items].color = 1;
-				items++;
-#ifndef NO_ZIP
-			} else if (ExtensionCheck(dirEntry->d_name, ".zip")) {
-				UIMenu_FileListCache[items].stats = 2;
-				UIMenu_FileListCache[items].color = 2;
-				items++;
-#endif
 			}
+			isdir = S_ISDIR(Stat.st_mode);
 		}
+		if (isdir) items = UIMenu_AddDirEntry(items, dirEntry->d_name);
+		else items = UIMenu_AddFileEntry(items, dirEntry->d_name);
 	}
 	closedir(dir);
 #endif
 
 	// Sort the list
-	for (i=0; i<items; i++) {
-		for (j=i; j<items; j++) {
-			cmp = strcasecmp(UIMenu_FileListCache[j].name, UIMenu_FileListCache[i].name);
-			if (UIMenu_FileListCache[j].stats < UIMenu_FileListCache[i].stats) {
-				UIMenu_SwapEntries(i, j);
-			} else if (cmp < 0) {
-				UIMenu_SwapEntries(i, j);
-			}
-		}
-	}
-
-	return items;
+	return UIMenu_SortEntries(items);
 }
 
 void UIMenu_GotoRelativeDir(char *newdir)
@@ -777,6 +807,10 @@ char *UIMenuTxt_Multicart[3] = {
 	"Disabled", "Flash 512K", "Lupin 512K"
 };
 
+char *UIMenuTxt_FramePace[3] = {
+	"Off", "On", "Blend"
+};
+
 char *UIMenuTxt_Enabled[2] = {
 	"Disabled", "Enabled"
 };
@@ -881,6 +915,12 @@ int UIItems_OptionsC(int index, int reason)
 			case 50: CommandLine.synccycles >>= 1;
 				if (CommandLine.synccycles < 8) CommandLine.synccycles = 8;
 				break;
+			case 51: CommandLine.runahead--;
+				if (CommandLine.runahead < 0) CommandLine.runahead = 3;
+				break;
+			case 52: CommandLine.framepace--;
+				if (CommandLine.framepace < 0) CommandLine.framepace = 2;
+				break;
 		}
 	}
 	if (reason == UIMENU_RIGHT) {
@@ -934,6 +974,12 @@ int UIItems_OptionsC(int index, int reason)
 				if (CommandLine.synccycles > 64) CommandLine.synccycles = 64;
 #endif
 				break;
+			case 51: CommandLine.runahead++;
+				if (CommandLine.runahead > 3) CommandLine.runahead = 0;
+				break;
+			case 52: CommandLine.framepace++;
+				if (CommandLine.framepace > 2) CommandLine.framepace = 0;
+				break;
 		}
 	}
 
@@ -962,6 +1008,8 @@ int UIItems_OptionsC(int index, int reason)
 	UIMenu_ChangeItem(UIItems_Options,  9, "Force FreeBIOS %s", CommandLine.forcefreebios ? "Yes" : "No");
 	UIMenu_ChangeItem(UIItems_Options, 20, "Multicart      %s", UIMenuTxt_Multicart[CommandLine.multicart]);
 	UIMenu_ChangeItem(UIItems_Options, 50, "Sync Cycles    %d", CommandLine.synccycles);
+	UIMenu_ChangeItem(UIItems_Options, 51, "Run-ahead      %d", CommandLine.runahead);
+	UIMenu_ChangeItem(UIItems_Options, 52, "Frame pacing   %s", UIMenuTxt_FramePace[CommandLine.framepace]);
 
 	return 1;
 }
@@ -32,7 +32,7 @@ typedef struct {
 	char color;	// 0 = Normal, 1 = Color available, 2 = Package	| 0 = Yellow, 1 = Aqua
 } TUIMenu_FileListCache;
 
-// Maximum files/directories per directory
+// Initial files/directories per directory, list grows when needed
 #ifndef UI_MAXCACHE
 #define UI_MAXCACHE	512
 #endif
@@ -18,6 +18,13 @@
 
 #include "PokeMini.h"
 #include "PokeMini_ColorPal.h"
+#include "Video_x1.h"
+#include "Video_x2.h"
+#include "Video_x3.h"
+#include "Video_x4.h"
+#include "Video_x5.h"
+#include "Video_x6.h"
+#include "Video_xN.h"
 
 int VidPixelLayout = 0;
 int VidEnableHighcolor = 0;
@@ -422,3 +429,117 @@ void PokeMini_VideoPreviewCH_16(uint16_t *screen, int pitchW)
 		screen += pitchW;
 	}
 }
+
+// Runtime scale
+
+TPokeMini_VideoSpec PokeMini_VideoNxN = {
+	1, 1,
+	PokeMini_GetVideoNxN_16,
+	PokeMini_GetVideoNxN_32
+};
+
+int PokeMini_VideoNxNScale = 1;
+static int LCDMaskNxN[PokeMini_VideoNxN_MaxScale * PokeMini_VideoNxN_MaxScale];
+
+// Same shape as the fixed masks from 4x4 and above
+static int LCDMaskNxN_Value(int x, int y, int scale)
+{
+	int t;
+	if (y == scale-1) {
+		t = x; x = y; y = t;
+	}
+	if (x == scale-1) {
+		if (y == 0) return 128;
+		if (y == scale-2) return 192;
+		return 160;
+	}
+	if ((y == 0 || y == scale-2) && (x == 0 || x == scale-2)) return 240;
+	return 256;
+}
+
+int PokeMini_VideoNxN_SetScale(int scale)
+{
+	int x, y;
+	if ((scale < 1) || (scale > PokeMini_VideoNxN_MaxScale)) return 0;
+	PokeMini_VideoNxN.WScale = scale;
+	PokeMini_VideoNxN.HScale = scale;
+	PokeMini_VideoNxNScale = scale;
+	if (scale > 6) {
+		for (y=0; y<scale; y++) {
+			for (x=0; x<scale; x++) LCDMaskNxN[y*scale+x] = LCDMaskNxN_Value(x, y, scale);
+		}
+	}
+	return 1;
+}
+
+TPokeMini_DrawVideo32 PokeMini_GetVideoNxN_32(int filter, int lcdmode)
+{
+	switch (PokeMini_VideoNxNScale) {
+		case 1: return PokeMini_GetVideo1x1_32(filter, lcdmode);
+		case 2: return PokeMini_GetVideo2x2_32(filter, lcdmode);
+		case 3: return PokeMini_GetVideo3x3_32(filter, lcdmode);
+		case 4: return PokeMini_GetVideo4x4_32(filter, lcdmode);
+		case 5: return PokeMini_GetVideo5x5_32(filter, lcdmode);
+		case 6: return PokeMini_GetVideo6x6_32(filter, lcdmode);
+	}
+	if (filter == PokeMini_Scanline) {
+		switch (lcdmode) {
+			case 3: return PokeMini_VideoColorLNxN_32;
+			case 2: return PokeMini_Video2ScanLineNxN_32;
+			case 1: return PokeMini_Video3ScanLineNxN_32;
+			default: return PokeMini_VideoAScanLineNxN_32;
+		}
+	} else if (filter == PokeMini_Matrix) {
+		switch (lcdmode) {
+			case 3: return (VidEnableHighcolor) ? PokeMini_VideoColorHNxN_32 : PokeMini_VideoColorNxN_32;
+			case 2: return PokeMini_Video2MatrixNxN_32;
+			case 1: return PokeMini_Video3MatrixNxN_32;
+			default: return PokeMini_VideoAMatrixNxN_32;
+		}
+	} else {
+		switch (lcdmode) {
+			case 3: return PokeMini_VideoColorNxN_32;
+			case 2: return PokeMini_Video2NoneNxN_32;
+			case 1: return PokeMini_Video3NoneNxN_32;
+			default: return PokeMini_VideoANoneNxN_32;
+		}
+	}
+}
+
+TPokeMini_DrawVideo16 PokeMini_GetVideoNxN_16(int filter, int lcdmode)
+{
+	switch (PokeMini_VideoNxNScale) {
+		case 1: return PokeMini_GetVideo1x1_16(filter, lcdmode);
+		case 2: return PokeMini_GetVideo2x2_16(filter, lcdmode);
+		case 3: return PokeMini_GetVideo3x3_16(filter, lcdmode);
+		case 4: return PokeMini_GetVideo4x4_16(filter, lcdmode);
+		case 5: return PokeMini_GetVideo5x5_16(filter, lcdmode);
+		case 6: return PokeMini_GetVideo6x6_16(filter, lcdmode);
+	}
+	if (filter == PokeMini_Scanline) {
+		switch (lcdmode) {
+			case 3: return PokeMini_VideoColorLNxN_16;
+			case 2: return PokeMini_Video2ScanLineNxN_16;
+			case 1: return PokeMini_Video3ScanLineNxN_16;
+			default: return PokeMini_VideoAScanLineNxN_16;
+		}
+	} else if (filter == PokeMini_Matrix) {
+		switch (lcdmode) {
+			case 3: return (VidEnableHighcolor) ? PokeMini_VideoColorHNxN_16 : PokeMini_VideoColorNxN_16;
+			case 2: return PokeMini_Video2MatrixNxN_16;
+			case 1: return PokeMini_Video3MatrixNxN_16;
+			default: return PokeMini_VideoAMatrixNxN_16;
+		}
+	} else {
+		switch (lcdmode) {
+			case 3: return PokeMini_VideoColorNxN_16;
+			case 2: return PokeMini_Video2NoneNxN_16;
+			case 1: return PokeMini_Video3NoneNxN_16;
+			default: return PokeMini_VideoANoneNxN_16;
+		}
+	}
+}
+
+// Blitters for scales above 6
+POKEMINI_VIDEO_SCALER_NONE(NxN, PokeMini_VideoNxNScale)
+POKEMINI_VIDEO_SCALER_FILTERS(NxN, PokeMini_VideoNxNScale, LCDMaskNxN)
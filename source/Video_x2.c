@@ -18,6 +18,7 @@
 
 #include "PokeMini.h"
 #include "Video_x2.h"
+#include "Video_xN.h"
 
 const TPokeMini_VideoSpec PokeMini_Video2x2 = {
 	2, 2,
@@ -114,43 +115,9 @@ TPokeMini_DrawVideo16 PokeMini_GetVideo2x2_8P(int filter, int lcdmode)
 	}
 }
 
-void PokeMini_VideoAScanLine2x2_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint32_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette32[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 192*4);
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_VideoAScanLine2x2_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint16_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette16[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 192*2);
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
+// Blitters, generated from the kernel in Video_xN.h
+POKEMINI_VIDEO_SCALER_NONE(2x2, 2)
+POKEMINI_VIDEO_SCALER_FILTERS(2x2, 2, LCDMask2x2)
 
 void PokeMini_VideoAScanLine2x2_8P(uint16_t *screen, int pitchW)
 {
@@ -175,54 +142,6 @@ void PokeMini_VideoAScanLine2x2_8P(uint16_t *screen, int pitchW)
 	}
 }
 
-void PokeMini_Video3ScanLine2x2_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint32_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette32[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette32[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette32[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		memset(screen, 0, 192*4);
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_Video3ScanLine2x2_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint16_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette16[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette16[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette16[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		memset(screen, 0, 192*2);
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
 void PokeMini_Video3ScanLine2x2_8P(uint16_t *screen, int pitchW)
 {
 	int xk, yk, LCDY;
@@ -250,52 +169,6 @@ void PokeMini_Video3ScanLine2x2_8P(uint16_t *screen, int pitchW)
 	}
 }
 
-void PokeMini_Video2ScanLine2x2_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint32_t *ptr, pix, pix1, pix0;
-
-	LCDY = 0;
-	pix1 = VidPalette32[MinxLCD.Pixel1Intensity];
-	pix0 = VidPalette32[MinxLCD.Pixel0Intensity];
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		memset(screen, 0, 192*4);
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_Video2ScanLine2x2_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint16_t *ptr, pix, pix1, pix0;
-
-	LCDY = 0;
-	pix1 = VidPalette16[MinxLCD.Pixel1Intensity];
-	pix0 = VidPalette16[MinxLCD.Pixel0Intensity];
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		memset(screen, 0, 192*2);
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
 void PokeMini_Video2ScanLine2x2_8P(uint16_t *screen, int pitchW)
 {
 	int xk, yk, LCDY;
@@ -320,52 +193,6 @@ void PokeMini_Video2ScanLine2x2_8P(uint16_t *screen, int pitchW)
 	}
 }
 
-void PokeMini_VideoAMatrix2x2_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, level, LCDY, maskH;
-	uint32_t *ptr;
-
-	LCDY = 0;
-	maskH = 0;
-	for (yk=0; yk<64*2; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			level = LCDPixelsA[LCDY + xk];
-			*ptr++ = VidPalette32[level * LCDMask2x2[maskH] >> 8];
-			*ptr++ = VidPalette32[level * LCDMask2x2[maskH+1] >> 8];
-		}
-		screen += pitchW;
-		maskH += 2;
-		if (maskH >= 4) {
-			maskH = 0;
-			LCDY += 96;
-		}
-	}
-}
-
-void PokeMini_VideoAMatrix2x2_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, level, LCDY, maskH;
-	uint16_t *ptr;
-
-	LCDY = 0;
-	maskH = 0;
-	for (yk=0; yk<64*2; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			level = LCDPixelsA[LCDY + xk];
-			*ptr++ = VidPalette16[level * LCDMask2x2[maskH] >> 8];
-			*ptr++ = VidPalette16[level * LCDMask2x2[maskH+1] >> 8];
-		}
-		screen += pitchW;
-		maskH += 2;
-		if (maskH >= 4) {
-			maskH = 0;
-			LCDY += 96;
-		}
-	}
-}
-
 void PokeMini_VideoAMatrix2x2_8P(uint16_t *screen, int pitchW)
 {
 	int xk, yk, level, LCDY, maskH;
@@ -388,60 +215,6 @@ void PokeMini_VideoAMatrix2x2_8P(uint16_t *screen, int pitchW)
 	}
 }
 
-void PokeMini_Video3Matrix2x2_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, level, LCDY, maskH;
-	uint32_t *ptr;
-
-	LCDY = 0;
-	maskH = 0;
-	for (yk=0; yk<64*2; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: level = MinxLCD.Pixel1Intensity; break;
-				case 1: level = (MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1; break;
-				default: level = MinxLCD.Pixel0Intensity; break;
-			}
-			*ptr++ = VidPalette32[level * LCDMask2x2[maskH] >> 8];
-			*ptr++ = VidPalette32[level * LCDMask2x2[maskH+1] >> 8];
-		}
-		screen += pitchW;
-		maskH += 2;
-		if (maskH >= 4) {
-			maskH = 0;
-			LCDY += 96;
-		}
-	}
-}
-
-void PokeMini_Video3Matrix2x2_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, level, LCDY, maskH;
-	uint16_t *ptr;
-
-	LCDY = 0;
-	maskH = 0;
-	for (yk=0; yk<64*2; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: level = MinxLCD.Pixel1Intensity; break;
-				case 1: level = (MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1; break;
-				default: level = MinxLCD.Pixel0Intensity; break;
-			}
-			*ptr++ = VidPalette16[level * LCDMask2x2[maskH] >> 8];
-			*ptr++ = VidPalette16[level * LCDMask2x2[maskH+1] >> 8];
-		}
-		screen += pitchW;
-		maskH += 2;
-		if (maskH >= 4) {
-			maskH = 0;
-			LCDY += 96;
-		}
-	}
-}
-
 void PokeMini_Video3Matrix2x2_8P(uint16_t *screen, int pitchW)
 {
 	int xk, yk, level, LCDY, maskH;
@@ -468,54 +241,6 @@ void PokeMini_Video3Matrix2x2_8P(uint16_t *screen, int pitchW)
 	}
 }
 
-void PokeMini_Video2Matrix2x2_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, level, LCDY, maskH;
-	uint32_t *ptr;
-
-	LCDY = 0;
-	maskH = 0;
-	for (yk=0; yk<64*2; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) level = MinxLCD.Pixel1Intensity;
-			else level = MinxLCD.Pixel0Intensity;
-			*ptr++ = VidPalette32[level * LCDMask2x2[maskH] >> 8];
-			*ptr++ = VidPalette32[level * LCDMask2x2[maskH+1] >> 8];
-		}
-		screen += pitchW;
-		maskH += 2;
-		if (maskH >= 4) {
-			maskH = 0;
-			LCDY += 96;
-		}
-	}
-}
-
-void PokeMini_Video2Matrix2x2_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, level, LCDY, maskH;
-	uint16_t *ptr;
-
-	LCDY = 0;
-	maskH = 0;
-	for (yk=0; yk<64*2; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) level = MinxLCD.Pixel1Intensity;
-			else level = MinxLCD.Pixel0Intensity;
-			*ptr++ = VidPalette16[level * LCDMask2x2[maskH] >> 8];
-			*ptr++ = VidPalette16[level * LCDMask2x2[maskH+1] >> 8];
-		}
-		screen += pitchW;
-		maskH += 2;
-		if (maskH >= 4) {
-			maskH = 0;
-			LCDY += 96;
-		}
-	}
-}
-
 void PokeMini_Video2Matrix2x2_8P(uint16_t *screen, int pitchW)
 {
 	int xk, yk, level, LCDY, maskH;
@@ -539,52 +264,6 @@ void PokeMini_Video2Matrix2x2_8P(uint16_t *screen, int pitchW)
 	}
 }
 
-void PokeMini_VideoANone2x2_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint32_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette32[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette32[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_VideoANone2x2_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint16_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette16[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette16[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
 void PokeMini_VideoANone2x2_8P(uint16_t *screen, int pitchW)
 {
 	int xk, yk, LCDY;
@@ -608,68 +287,6 @@ void PokeMini_VideoANone2x2_8P(uint16_t *screen, int pitchW)
 	}
 }
 
-void PokeMini_Video3None2x2_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint32_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette32[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette32[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette32[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette32[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette32[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette32[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_Video3None2x2_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint16_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette16[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette16[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette16[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette16[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette16[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette16[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
 void PokeMini_Video3None2x2_8P(uint16_t *screen, int pitchW)
 {
 	int xk, yk, LCDY;
@@ -701,60 +318,6 @@ void PokeMini_Video3None2x2_8P(uint16_t *screen, int pitchW)
 	}
 }
 
-void PokeMini_Video2None2x2_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint32_t *ptr, pix, pix1, pix0;
-
-	LCDY = 0;
-	pix1 = VidPalette32[MinxLCD.Pixel1Intensity];
-	pix0 = VidPalette32[MinxLCD.Pixel0Intensity];
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_Video2None2x2_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint16_t *ptr, pix, pix1, pix0;
-
-	LCDY = 0;
-	pix1 = VidPalette16[MinxLCD.Pixel1Intensity];
-	pix0 = VidPalette16[MinxLCD.Pixel0Intensity];
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
 void PokeMini_Video2None2x2_8P(uint16_t *screen, int pitchW)
 {
 	int xk, yk, LCDY;
@@ -780,52 +343,6 @@ void PokeMini_Video2None2x2_8P(uint16_t *screen, int pitchW)
 	}
 }
 
-void PokeMini_VideoColor2x2_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint32_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor32[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor32[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_VideoColor2x2_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint16_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor16[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor16[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
 // WARNING! Color palette should be in CRAM!
 void PokeMini_VideoColor2x2_8P(uint16_t *screen, int pitchW)
 {
@@ -850,52 +367,6 @@ void PokeMini_VideoColor2x2_8P(uint16_t *screen, int pitchW)
 	}
 }
 
-void PokeMini_VideoColorL2x2_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint32_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor32[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<(96>>2); xk++) {
-			*ptr++ = 0; *ptr++ = 0;
-			*ptr++ = 0; *ptr++ = 0;
-		}
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_VideoColorL2x2_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint16_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor16[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<(96>>2); xk++) {
-			*ptr++ = 0; *ptr++ = 0;
-			*ptr++ = 0; *ptr++ = 0;
-		}
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
 // WARNING! Color palette should be in CRAM!
 void PokeMini_VideoColorL2x2_8P(uint16_t *screen, int pitchW)
 {
@@ -919,49 +390,3 @@ void PokeMini_VideoColorL2x2_8P(uint16_t *screen, int pitchW)
 		LCDY += 96;
 	}
 }
-
-void PokeMini_VideoColorH2x2_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint32_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColorH32[PRCColorPixels[LCDY + xk] * 256 + PRCColorPixelsOld[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColorH32[PRCColorPixels[LCDY + xk] * 256 + PRCColorPixelsOld[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_VideoColorH2x2_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint16_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColorH16[PRCColorPixels[LCDY + xk] * 256 + PRCColorPixelsOld[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColorH16[PRCColorPixels[LCDY + xk] * 256 + PRCColorPixelsOld[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
@@ -18,6 +18,7 @@
 
 #include "PokeMini.h"
 #include "Video_x5.h"
+#include "Video_xN.h"
 
 const TPokeMini_VideoSpec PokeMini_Video5x5 = {
 	5, 5,
@@ -85,1102 +86,6 @@ TPokeMini_DrawVideo16 PokeMini_GetVideo5x5_16(int filter, int lcdmode)
 	}
 }
 
-void PokeMini_VideoAScanLine5x5_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint32_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<32; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette32[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*4);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette32[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*4);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette32[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-		memset(screen, 0, 480*4);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette32[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*4);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette32[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*4);
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_VideoAScanLine5x5_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint16_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<32; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette16[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*2);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette16[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*2);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette16[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-		memset(screen, 0, 480*2);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette16[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*2);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette16[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*2);
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_Video3ScanLine5x5_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint32_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<32; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette32[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette32[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette32[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*4);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette32[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette32[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette32[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*4);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette32[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette32[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette32[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-		memset(screen, 0, 480*4);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette32[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette32[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette32[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*4);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette32[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette32[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette32[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*4);
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_Video3ScanLine5x5_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint16_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<32; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette16[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette16[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette16[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*2);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette16[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette16[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette16[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*2);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette16[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette16[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette16[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-		memset(screen, 0, 480*2);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette16[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette16[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette16[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*2);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette16[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette16[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette16[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*2);
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_Video2ScanLine5x5_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint32_t *ptr, pix, pix1, pix0;
-
-	LCDY = 0;
-	pix1 = VidPalette32[MinxLCD.Pixel1Intensity];
-	pix0 = VidPalette32[MinxLCD.Pixel0Intensity];
-	for (yk=0; yk<32; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*4);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*4);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-		memset(screen, 0, 480*4);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*4);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*4);
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_Video2ScanLine5x5_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint16_t *ptr, pix, pix1, pix0;
-
-	LCDY = 0;
-	pix1 = VidPalette16[MinxLCD.Pixel1Intensity];
-	pix0 = VidPalette16[MinxLCD.Pixel0Intensity];
-	for (yk=0; yk<32; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*2);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*2);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-		memset(screen, 0, 480*2);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*2);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*2);
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_VideoAMatrix5x5_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, level, LCDY, maskH;
-	uint32_t *ptr;
-
-	LCDY = 0;
-	maskH = 0;
-	for (yk=0; yk<64*5; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			level = LCDPixelsA[LCDY + xk];
-			*ptr++ = VidPalette32[level * LCDMask5x5[maskH] >> 8];
-			*ptr++ = VidPalette32[level * LCDMask5x5[maskH+1] >> 8];
-			*ptr++ = VidPalette32[level * LCDMask5x5[maskH+2] >> 8];
-			*ptr++ = VidPalette32[level * LCDMask5x5[maskH+3] >> 8];
-			*ptr++ = VidPalette32[level * LCDMask5x5[maskH+4] >> 8];
-		}
-		screen += pitchW;
-		maskH += 5;
-		if (maskH >= 25) {
-			maskH = 0;
-			LCDY += 96;
-		}
-	}
-}
-
-void PokeMini_VideoAMatrix5x5_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, level, LCDY, maskH;
-	uint16_t *ptr;
-
-	LCDY = 0;
-	maskH = 0;
-	for (yk=0; yk<64*5; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			level = LCDPixelsA[LCDY + xk];
-			*ptr++ = VidPalette16[level * LCDMask5x5[maskH] >> 8];
-			*ptr++ = VidPalette16[level * LCDMask5x5[maskH+1] >> 8];
-			*ptr++ = VidPalette16[level * LCDMask5x5[maskH+2] >> 8];
-			*ptr++ = VidPalette16[level * LCDMask5x5[maskH+3] >> 8];
-			*ptr++ = VidPalette16[level * LCDMask5x5[maskH+4] >> 8];
-		}
-		screen += pitchW;
-		maskH += 5;
-		if (maskH >= 25) {
-			maskH = 0;
-			LCDY += 96;
-		}
-	}
-}
-
-void PokeMini_Video3Matrix5x5_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, level, LCDY, maskH;
-	uint32_t *ptr;
-
-	LCDY = 0;
-	maskH = 0;
-	for (yk=0; yk<64*5; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: level = MinxLCD.Pixel1Intensity; break;
-				case 1: level = (MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1; break;
-				default: level = MinxLCD.Pixel0Intensity; break;
-			}
-			*ptr++ = VidPalette32[level * LCDMask5x5[maskH] >> 8];
-			*ptr++ = VidPalette32[level * LCDMask5x5[maskH+1] >> 8];
-			*ptr++ = VidPalette32[level * LCDMask5x5[maskH+2] >> 8];
-			*ptr++ = VidPalette32[level * LCDMask5x5[maskH+3] >> 8];
-			*ptr++ = VidPalette32[level * LCDMask5x5[maskH+4] >> 8];
-		}
-		screen += pitchW;
-		maskH += 5;
-		if (maskH >= 25) {
-			maskH = 0;
-			LCDY += 96;
-		}
-	}
-}
-
-void PokeMini_Video3Matrix5x5_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, level, LCDY, maskH;
-	uint16_t *ptr;
-
-	LCDY = 0;
-	maskH = 0;
-	for (yk=0; yk<64*5; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: level = MinxLCD.Pixel1Intensity; break;
-				case 1: level = (MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1; break;
-				default: level = MinxLCD.Pixel0Intensity; break;
-			}
-			*ptr++ = VidPalette16[level * LCDMask5x5[maskH] >> 8];
-			*ptr++ = VidPalette16[level * LCDMask5x5[maskH+1] >> 8];
-			*ptr++ = VidPalette16[level * LCDMask5x5[maskH+2] >> 8];
-			*ptr++ = VidPalette16[level * LCDMask5x5[maskH+3] >> 8];
-			*ptr++ = VidPalette16[level * LCDMask5x5[maskH+4] >> 8];
-		}
-		screen += pitchW;
-		maskH += 5;
-		if (maskH >= 25) {
-			maskH = 0;
-			LCDY += 96;
-		}
-	}
-}
-
-void PokeMini_Video2Matrix5x5_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, level, LCDY, maskH;
-	uint32_t *ptr;
-
-	LCDY = 0;
-	maskH = 0;
-	for (yk=0; yk<64*5; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) level = MinxLCD.Pixel1Intensity;
-			else level = MinxLCD.Pixel0Intensity;
-			*ptr++ = VidPalette32[level * LCDMask5x5[maskH] >> 8];
-			*ptr++ = VidPalette32[level * LCDMask5x5[maskH+1] >> 8];
-			*ptr++ = VidPalette32[level * LCDMask5x5[maskH+2] >> 8];
-			*ptr++ = VidPalette32[level * LCDMask5x5[maskH+3] >> 8];
-			*ptr++ = VidPalette32[level * LCDMask5x5[maskH+4] >> 8];
-		}
-		screen += pitchW;
-		maskH += 5;
-		if (maskH >= 25) {
-			maskH = 0;
-			LCDY += 96;
-		}
-	}
-}
-
-void PokeMini_Video2Matrix5x5_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, level, LCDY, maskH;
-	uint16_t *ptr;
-
-	LCDY = 0;
-	maskH = 0;
-	for (yk=0; yk<64*5; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) level = MinxLCD.Pixel1Intensity;
-			else level = MinxLCD.Pixel0Intensity;
-			*ptr++ = VidPalette16[level * LCDMask5x5[maskH] >> 8];
-			*ptr++ = VidPalette16[level * LCDMask5x5[maskH+1] >> 8];
-			*ptr++ = VidPalette16[level * LCDMask5x5[maskH+2] >> 8];
-			*ptr++ = VidPalette16[level * LCDMask5x5[maskH+3] >> 8];
-			*ptr++ = VidPalette16[level * LCDMask5x5[maskH+4] >> 8];
-		}
-		screen += pitchW;
-		maskH += 5;
-		if (maskH >= 25) {
-			maskH = 0;
-			LCDY += 96;
-		}
-	}
-}
-
-void PokeMini_VideoANone5x5_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint32_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette32[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette32[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette32[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette32[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette32[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_VideoANone5x5_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint16_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette16[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette16[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette16[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette16[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalette16[LCDPixelsA[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_Video3None5x5_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint32_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette32[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette32[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette32[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette32[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette32[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette32[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette32[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette32[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette32[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette32[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette32[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette32[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette32[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette32[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette32[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_Video3None5x5_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint16_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette16[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette16[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette16[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette16[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette16[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette16[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette16[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette16[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette16[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette16[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette16[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette16[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			switch (LCDPixelsD[LCDY + xk] + LCDPixelsA[LCDY + xk]) {
-				case 2: pix = VidPalette16[MinxLCD.Pixel1Intensity]; break;
-				case 1: pix = VidPalette16[(MinxLCD.Pixel0Intensity + MinxLCD.Pixel1Intensity) >> 1]; break;
-				default: pix = VidPalette16[MinxLCD.Pixel0Intensity]; break;
-			}
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_Video2None5x5_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint32_t *ptr, pix, pix1, pix0;
-
-	LCDY = 0;
-	pix1 = VidPalette32[MinxLCD.Pixel1Intensity];
-	pix0 = VidPalette32[MinxLCD.Pixel0Intensity];
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_Video2None5x5_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint16_t *ptr, pix, pix1, pix0;
-
-	LCDY = 0;
-	pix1 = VidPalette16[MinxLCD.Pixel1Intensity];
-	pix0 = VidPalette16[MinxLCD.Pixel0Intensity];
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			if (LCDPixelsD[LCDY + xk]) pix = pix1;
-			else pix = pix0;
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_VideoColor5x5_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint32_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor32[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor32[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor32[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor32[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor32[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_VideoColor5x5_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint16_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor16[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor16[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor16[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor16[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor16[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_VideoColorL5x5_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint32_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<32; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor32[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*4);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor32[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*4);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor32[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-		memset(screen, 0, 480*4);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor32[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*4);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor32[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*4);
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_VideoColorL5x5_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint16_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<32; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor16[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*2);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor16[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*2);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor16[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-		memset(screen, 0, 480*2);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor16[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*2);
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColor16[PRCColorPixels[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		memset(screen, 0, 480*2);
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_VideoColorH5x5_32(uint32_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint32_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColorH32[PRCColorPixels[LCDY + xk] * 256 + PRCColorPixelsOld[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColorH32[PRCColorPixels[LCDY + xk] * 256 + PRCColorPixelsOld[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColorH32[PRCColorPixels[LCDY + xk] * 256 + PRCColorPixelsOld[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColorH32[PRCColorPixels[LCDY + xk] * 256 + PRCColorPixelsOld[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColorH32[PRCColorPixels[LCDY + xk] * 256 + PRCColorPixelsOld[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
-
-void PokeMini_VideoColorH5x5_16(uint16_t *screen, int pitchW)
-{
-	int xk, yk, LCDY;
-	uint16_t *ptr, pix;
-
-	LCDY = 0;
-	for (yk=0; yk<64; yk++) {
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColorH16[PRCColorPixels[LCDY + xk] * 256 + PRCColorPixelsOld[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColorH16[PRCColorPixels[LCDY + xk] * 256 + PRCColorPixelsOld[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColorH16[PRCColorPixels[LCDY + xk] * 256 + PRCColorPixelsOld[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColorH16[PRCColorPixels[LCDY + xk] * 256 + PRCColorPixelsOld[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		ptr = screen;
-		for (xk=0; xk<96; xk++) {
-			pix = VidPalColorH16[PRCColorPixels[LCDY + xk] * 256 + PRCColorPixelsOld[LCDY + xk]];
-			*ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix; *ptr++ = pix;
-		}
-		screen += pitchW;
-		LCDY += 96;
-	}
-}
+// Blitters, generated from the kernel in Video_xN.h
+POKEMINI_VIDEO_SCALER_NONE(5x5, 5)
+POKEMINI_VIDEO_SCALER_FILTERS(5x5, 5, LCDMask5x5)
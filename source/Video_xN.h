@@ -0,0 +1,212 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2012  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef POKEMINI_VIDEO_XN
+#define POKEMINI_VIDEO_XN
+
+#include <stdint.h>
+
+// Generic scaler
+//
+// Every Video_x* blitter is an instance of the same kernel, scale, filter
+// and source are constants at the instantiation so the compiler can unroll
+// the pixel replication and drop the unused paths.
+// Requires PokeMini.h to be included first.
+
+#if defined(_MSC_VER)
+#define PMVIDEO_INLINE static __forceinline
+#elif defined(__GNUC__)
+#define PMVIDEO_INLINE static inline __attribute__((always_inline))
+#else
+#define PMVIDEO_INLINE static inline
+#endif
+
+// Source of the pixels
+enum {
+	PokeMini_VideoSrcA = 0,		// Analog
+	PokeMini_VideoSrc3,		// 3-colors
+	PokeMini_VideoSrc2,		// 2-colors
+	PokeMini_VideoSrcColor,		// Unofficial colors
+	PokeMini_VideoSrcColorH		// Unofficial colors, blend with last frame
+};
+
+// Maximum scale of the runtime scaler
+#define PokeMini_VideoNxN_MaxScale	16
+
+// Intensity level of a monochrome pixel
+PMVIDEO_INLINE int PokeMini_VideoLevel(int src, int offset, int level0, int levelM, int level1)
+{
+	if (src == PokeMini_VideoSrcA) return LCDPixelsA[offset];
+	if (src == PokeMini_VideoSrc2) return LCDPixelsD[offset] ? level1 : level0;
+	switch (LCDPixelsD[offset] + LCDPixelsA[offset]) {
+		case 2: return level1;
+		case 1: return levelM;
+		default: return level0;
+	}
+}
+
+// Kernel, one per depth
+// Source row is decoded once, then written scale times. Scanline clears
+// the odd output lines, dot matrix applies the mask to monochrome sources.
+// Scales up to 6 are unrolled through the switch fall-through, writing
+// from left to right.
+#define POKEMINI_VIDEO_KERNEL(BITS) \
+PMVIDEO_INLINE void PokeMini_VideoRow_##BITS(uint##BITS##_t *ptr, const uint##BITS##_t *line, int scale) \
+{ \
+	int xk, sx; \
+	uint##BITS##_t pix; \
+\
+	for (xk=0; xk<96; xk++) { \
+		pix = line[xk]; \
+		switch (scale) { \
+			case 6: ptr[scale-6] = pix; \
+			case 5: ptr[scale-5] = pix; \
+			case 4: ptr[scale-4] = pix; \
+			case 3: ptr[scale-3] = pix; \
+			case 2: ptr[scale-2] = pix; \
+			case 1: ptr[scale-1] = pix; break; \
+			default: for (sx=0; sx<scale; sx++) ptr[sx] = pix; break; \
+		} \
+		ptr += scale; \
+	} \
+} \
+\
+PMVIDEO_INLINE void PokeMini_VideoRowMask_##BITS(uint##BITS##_t *ptr, const int *level, const int *maskH, int scale) \
+{ \
+	const uint##BITS##_t *pal = VidPalette##BITS; \
+	int m[PokeMini_VideoNxN_MaxScale]; \
+	int xk, sx, lv; \
+\
+	for (sx=0; sx<scale; sx++) m[sx] = maskH[sx]; \
+	for (xk=0; xk<96; xk++) { \
+		lv = level[xk]; \
+		switch (scale) { \
+			case 6: ptr[scale-6] = pal[lv * m[scale-6] >> 8]; \
+			case 5: ptr[scale-5] = pal[lv * m[scale-5] >> 8]; \
+			case 4: ptr[scale-4] = pal[lv * m[scale-4] >> 8]; \
+			case 3: ptr[scale-3] = pal[lv * m[scale-3] >> 8]; \
+			case 2: ptr[scale-2] = pal[lv * m[scale-2] >> 8]; \
+			case 1: ptr[scale-1] = pal[lv * m[scale-1] >> 8]; break; \
+			default: for (sx=0; sx<scale; sx++) ptr[sx] = pal[lv * m[sx] >> 8]; break; \
+		} \
+		ptr += scale; \
+	} \
+} \
+\
+PMVIDEO_INLINE void PokeMini_VideoScale_##BITS(uint##BITS##_t *screen, int pitchW, int scale, int filter, int src, const int *mask) \
+{ \
+	uint##BITS##_t line[96]; \
+	int level[96]; \
+	int xk, yk, sy, LCDY, row, matrix; \
+	int level0, levelM, level1; \
+\
+	level0 = MinxLCD.Pixel0Intensity; \
+	level1 = MinxLCD.Pixel1Intensity; \
+	levelM = (level0 + level1) >> 1; \
+	matrix = (filter == PokeMini_Matrix) && (src < PokeMini_VideoSrcColor); \
+	LCDY = 0; \
+	row = 0; \
+	for (yk=0; yk<64; yk++) { \
+		for (xk=0; xk<96; xk++) { \
+			if (src == PokeMini_VideoSrcColorH) line[xk] = VidPalColorH##BITS[PRCColorPixels[LCDY + xk] * 256 + PRCColorPixelsOld[LCDY + xk]]; \
+			else if (src == PokeMini_VideoSrcColor) line[xk] = VidPalColor##BITS[PRCColorPixels[LCDY + xk]]; \
+			else if (matrix) level[xk] = PokeMini_VideoLevel(src, LCDY + xk, level0, levelM, level1); \
+			else line[xk] = VidPalette##BITS[PokeMini_VideoLevel(src, LCDY + xk, level0, levelM, level1)]; \
+		} \
+		for (sy=0; sy<scale; sy++) { \
+			if ((filter == PokeMini_Scanline) && (row & 1)) memset(screen, 0, 96 * scale * sizeof(uint##BITS##_t)); \
+			else if (matrix) PokeMini_VideoRowMask_##BITS(screen, level, mask + sy * scale, scale); \
+			else PokeMini_VideoRow_##BITS(screen, line, scale); \
+			screen += pitchW; \
+			row++; \
+		} \
+		LCDY += 96; \
+	} \
+}
+
+POKEMINI_VIDEO_KERNEL(32)
+POKEMINI_VIDEO_KERNEL(16)
+
+// Define a blitter
+#define POKEMINI_VIDEO_BLIT(FUNC, SCALE, FILTER, SRC, MASK) \
+void FUNC##_32(uint32_t *screen, int pitchW) \
+{ \
+	PokeMini_VideoScale_32(screen, pitchW, SCALE, FILTER, SRC, MASK); \
+} \
+void FUNC##_16(uint16_t *screen, int pitchW) \
+{ \
+	PokeMini_VideoScale_16(screen, pitchW, SCALE, FILTER, SRC, MASK); \
+}
+
+// Define blitters without filter, NAME is the suffix (ie: 3x3)
+#define POKEMINI_VIDEO_SCALER_NONE(NAME, SCALE) \
+	POKEMINI_VIDEO_BLIT(PokeMini_VideoANone##NAME, SCALE, PokeMini_NoFilter, PokeMini_VideoSrcA, NULL) \
+	POKEMINI_VIDEO_BLIT(PokeMini_Video3None##NAME, SCALE, PokeMini_NoFilter, PokeMini_VideoSrc3, NULL) \
+	POKEMINI_VIDEO_BLIT(PokeMini_Video2None##NAME, SCALE, PokeMini_NoFilter, PokeMini_VideoSrc2, NULL) \
+	POKEMINI_VIDEO_BLIT(PokeMini_VideoColor##NAME, SCALE, PokeMini_NoFilter, PokeMini_VideoSrcColor, NULL) \
+	POKEMINI_VIDEO_BLIT(PokeMini_VideoColorH##NAME, SCALE, PokeMini_NoFilter, PokeMini_VideoSrcColorH, NULL)
+
+// Define scanline and dot matrix blitters
+#define POKEMINI_VIDEO_SCALER_FILTERS(NAME, SCALE, MASK) \
+	POKEMINI_VIDEO_BLIT(PokeMini_VideoAScanLine##NAME, SCALE, PokeMini_Scanline, PokeMini_VideoSrcA, NULL) \
+	POKEMINI_VIDEO_BLIT(PokeMini_Video3ScanLine##NAME, SCALE, PokeMini_Scanline, PokeMini_VideoSrc3, NULL) \
+	POKEMINI_VIDEO_BLIT(PokeMini_Video2ScanLine##NAME, SCALE, PokeMini_Scanline, PokeMini_VideoSrc2, NULL) \
+	POKEMINI_VIDEO_BLIT(PokeMini_VideoAMatrix##NAME, SCALE, PokeMini_Matrix, PokeMini_VideoSrcA, MASK) \
+	POKEMINI_VIDEO_BLIT(PokeMini_Video3Matrix##NAME, SCALE, PokeMini_Matrix, PokeMini_VideoSrc3, MASK) \
+	POKEMINI_VIDEO_BLIT(PokeMini_Video2Matrix##NAME, SCALE, PokeMini_Matrix, PokeMini_VideoSrc2, MASK) \
+	POKEMINI_VIDEO_BLIT(PokeMini_VideoColorL##NAME, SCALE, PokeMini_Scanline, PokeMini_VideoSrcColor, NULL)
+
+// Video specs, any scale from 1 to PokeMini_VideoNxN_MaxScale
+// Scales up to 6 use the fixed blitters
+extern TPokeMini_VideoSpec PokeMini_VideoNxN;
+extern int PokeMini_VideoNxNScale;
+
+// Set scale of PokeMini_VideoNxN, return 0 if out of range
+int PokeMini_VideoNxN_SetScale(int scale);
+
+// Return the best blitter
+TPokeMini_DrawVideo32 PokeMini_GetVideoNxN_32(int filter, int lcdmode);
+TPokeMini_DrawVideo16 PokeMini_GetVideoNxN_16(int filter, int lcdmode);
+
+// Render to (96*N)x(64*N), runtime scale
+void PokeMini_VideoAScanLineNxN_32(uint32_t *screen, int pitchW);
+void PokeMini_VideoAScanLineNxN_16(uint16_t *screen, int pitchW);
+void PokeMini_Video3ScanLineNxN_32(uint32_t *screen, int pitchW);
+void PokeMini_Video3ScanLineNxN_16(uint16_t *screen, int pitchW);
+void PokeMini_Video2ScanLineNxN_32(uint32_t *screen, int pitchW);
+void PokeMini_Video2ScanLineNxN_16(uint16_t *screen, int pitchW);
+void PokeMini_VideoAMatrixNxN_32(uint32_t *screen, int pitchW);
+void PokeMini_VideoAMatrixNxN_16(uint16_t *screen, int pitchW);
+void PokeMini_Video3MatrixNxN_32(uint32_t *screen, int pitchW);
+void PokeMini_Video3MatrixNxN_16(uint16_t *screen, int pitchW);
+void PokeMini_Video2MatrixNxN_32(uint32_t *screen, int pitchW);
+void PokeMini_Video2MatrixNxN_16(uint16_t *screen, int pitchW);
+void PokeMini_VideoANoneNxN_32(uint32_t *screen, int pitchW);
+void PokeMini_VideoANoneNxN_16(uint16_t *screen, int pitchW);
+void PokeMini_Video3NoneNxN_32(uint32_t *screen, int pitchW);
+void PokeMini_Video3NoneNxN_16(uint16_t *screen, int pitchW);
+void PokeMini_Video2NoneNxN_32(uint32_t *screen, int pitchW);
+void PokeMini_Video2NoneNxN_16(uint16_t *screen, int pitchW);
+void PokeMini_VideoColorNxN_32(uint32_t *screen, int pitchW);
+void PokeMini_VideoColorNxN_16(uint16_t *screen, int pitchW);
+void PokeMini_VideoColorLNxN_32(uint32_t *screen, int pitchW);
+void PokeMini_VideoColorLNxN_16(uint16_t *screen, int pitchW);
+void PokeMini_VideoColorHNxN_32(uint32_t *screen, int pitchW);
+void PokeMini_VideoColorHNxN_16(uint16_t *screen, int pitchW);
+
+#endif
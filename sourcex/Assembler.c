@@ -0,0 +1,512 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+
+#include "Assembler.h"
+#include "PMCommon.h"
+
+#define ASSEMBLER_SYMBHASH	1024
+#define ASSEMBLER_SYMBLEN	64
+
+typedef struct {
+	char name[ASSEMBLER_SYMBLEN];
+	int value;		// Value from last definition
+	int known;		// Defined in any pass
+	int pass;		// Last pass that defined it
+	int next;		// Next symbol in the chain, -1 = End
+} TAssemblerSymb;
+
+static TAssemblerSymb *Asm_Symb = NULL;
+static int Asm_NumSymb = 0, Asm_MaxSymb = 0;
+static int Asm_SymbHash[ASSEMBLER_SYMBHASH];
+
+static TAssemblerWriteCB Asm_WriteCB;
+static TAssemblerErrorCB Asm_ErrorCB;
+static TSOpcDec *Asm_SOpcDec;
+static int Asm_Pass;		// Pass number
+static int Asm_Emit;		// Output and report errors
+static int Asm_Changed;		// A symbol changed on this pass
+static int Asm_Errors;
+static int Asm_Line;
+static uint32_t Asm_Addr;
+
+static void Assembler_Error(const char *format, ...)
+{
+	char tmp[PMTMPV];
+	va_list args;
+	Asm_Errors++;
+	if (!Asm_Emit || !Asm_ErrorCB) return;
+	va_start(args, format);
+	vsnprintf(tmp, PMTMPV, format, args);
+	va_end(args);
+	Asm_ErrorCB(Asm_Line, tmp);
+}
+
+// ---------- Symbols ----------
+
+static int Assembler_HashName(const char *name, int len)
+{
+	uint32_t hash = 2166136261U;
+	while (len--) {
+		hash = (hash ^ (uint8_t)toupper((int)*name++)) * 16777619U;
+	}
+	return hash & (ASSEMBLER_SYMBHASH - 1);
+}
+
+static TAssemblerSymb *Assembler_FindSymb(const char *name, int len)
+{
+	int i;
+	if (len >= ASSEMBLER_SYMBLEN) return NULL;
+	for (i = Asm_SymbHash[Assembler_HashName(name, len)]; i >= 0; i = Asm_Symb[i].next) {
+		if (!strncasecmp(Asm_Symb[i].name, name, len) && !Asm_Symb[i].name[len]) return &Asm_Symb[i];
+	}
+	return NULL;
+}
+
+static TAssemblerSymb *Assembler_AddSymb(const char *name, int len)
+{
+	TAssemblerSymb *symb, *newsymb;
+	int hash;
+	symb = Assembler_FindSymb(name, len);
+	if (symb) return symb;
+	if (len >= ASSEMBLER_SYMBLEN) return NULL;
+	if (Asm_NumSymb >= Asm_MaxSymb) {
+		newsymb = (TAssemblerSymb *)realloc(Asm_Symb, (Asm_MaxSymb + 256) * sizeof(TAssemblerSymb));
+		if (!newsymb) return NULL;
+		Asm_Symb = newsymb;
+		Asm_MaxSymb += 256;
+	}
+	symb = &Asm_Symb[Asm_NumSymb];
+	memcpy(symb->name, name, len);
+	symb->name[len] = 0;
+	symb->value = 0;
+	symb->known = 0;
+	symb->pass = -1;
+	hash = Assembler_HashName(name, len);
+	symb->next = Asm_SymbHash[hash];
+	Asm_SymbHash[hash] = Asm_NumSymb++;
+	return symb;
+}
+
+static void Assembler_FreeSymbs(void)
+{
+	int i;
+	if (Asm_Symb) free(Asm_Symb);
+	Asm_Symb = NULL;
+	Asm_NumSymb = 0;
+	Asm_MaxSymb = 0;
+	for (i=0; i<ASSEMBLER_SYMBHASH; i++) Asm_SymbHash[i] = -1;
+}
+
+static void Assembler_DefineSymb(const char *name, int len, int value)
+{
+	TAssemblerSymb *symb = Assembler_FindSymb(name, len);
+	if (!symb) {
+		Assembler_Error("Error: Symbol too long");
+		return;
+	}
+	if (symb->pass == Asm_Pass) {
+		Assembler_Error("Error: Symbol '%s' already defined", symb->name);
+		return;
+	}
+	if (!symb->known || (symb->value != value)) Asm_Changed = 1;
+	symb->value = value;
+	symb->known = 1;
+	symb->pass = Asm_Pass;
+}
+
+static int Assembler_IsSymbStart(char ch)
+{
+	return isalpha((int)ch) || (ch == '_') || (ch == '.');
+}
+
+static int Assembler_IsSymbChar(char ch)
+{
+	return isalnum((int)ch) || (ch == '_') || (ch == '.');
+}
+
+// ---------- Expressions ----------
+
+// Evaluate term, return number of characters used, 0 on error
+static int Assembler_Term(const char *s, int *value)
+{
+	TAssemblerSymb *symb;
+	const char *p = s;
+	int base = 10, val = 0, digit, len;
+
+	if (*p == '\'') {
+		// Character
+		if (!p[1] || (p[2] != '\'')) return 0;
+		*value = (uint8_t)p[1];
+		return 3;
+	}
+	if (Assembler_IsSymbStart(*p)) {
+		// Symbol, unknown values use current address until they are defined
+		for (len=1; Assembler_IsSymbChar(p[len]); len++);
+		symb = Assembler_FindSymb(p, len);
+		if (!symb) return 0;
+		*value = symb->known ? symb->value : (int)Asm_Addr;
+		return len;
+	}
+	if ((*p == '$') || (*p == '@')) {
+		base = 16;
+		p++;
+	} else if ((p[0] == '0') && ((p[1] == 'x') || (p[1] == 'X'))) {
+		base = 16;
+		p += 2;
+	} else if (*p == '%') {
+		base = 2;
+		p++;
+	}
+	len = 0;
+	while (1) {
+		if ((*p >= '0') && (*p <= '9')) digit = *p - '0';
+		else if ((*p >= 'a') && (*p <= 'f')) digit = *p - 'a' + 10;
+		else if ((*p >= 'A') && (*p <= 'F')) digit = *p - 'A' + 10;
+		else break;
+		if (digit >= base) return 0;
+		val = val * base + digit;
+		len++;
+		p++;
+	}
+	if (!len) return 0;
+	*value = val;
+	return p - s;
+}
+
+// Evaluate terms separated by + and -, return number of characters used, 0 on error
+static int Assembler_Expr(const char *s, int *value)
+{
+	const char *p = s;
+	int val = 0, term, neg = 0, len;
+
+	while (1) {
+		while ((*p == '+') || (*p == '-') || (*p == '#')) {
+			if (*p == '-') neg = !neg;
+			p++;
+		}
+		len = Assembler_Term(p, &term);
+		if (!len) return 0;
+		val += neg ? -term : term;
+		p += len;
+		if ((*p != '+') && (*p != '-')) break;
+		neg = 0;
+	}
+	*value = val;
+	return p - s;
+}
+
+// Evaluate whole string
+static int Assembler_Eval(const char *s, int *value)
+{
+	int len;
+	while (isspace((int)*s)) s++;
+	len = Assembler_Expr(s, value);
+	if (!len) return 0;
+	s += len;
+	while (isspace((int)*s)) s++;
+	return (*s == 0);
+}
+
+// Replace expressions with symbols by their values
+static int Assembler_Subst(char *out, const char *in, int outlen)
+{
+	const char *start;
+	int value, len, prev = 0;
+	while (*in) {
+		if (outlen < 16) return 0;	// Room for any value or character
+		if ((*in == '\'') && in[1] && (in[2] == '\'')) {
+			// Character
+			len = sprintf(out, "@%X", (uint8_t)in[1]);
+			out += len;
+			outlen -= len;
+			in += 3;
+			prev = 0;
+			continue;
+		}
+		if (Assembler_IsSymbStart(*in) && !Assembler_IsSymbChar(prev) && (prev != '$')) {
+			for (len=1; Assembler_IsSymbChar(in[len]); len++);
+			if (Assembler_FindSymb(in, len)) {
+				// Include the sign and terms around the symbol
+				start = in;
+				if ((prev == '-') && (out[-1] == '-')) {
+					start--;
+					out--;
+					outlen++;
+				}
+				len = Assembler_Expr(start, &value);
+				if (len) {
+					if (value < 0) len = sprintf(out, "-@%X", -value);
+					else len = sprintf(out, "@%X", value);
+					out += len;
+					outlen -= len;
+					in = start + Assembler_Expr(start, &value);
+					prev = 0;
+					continue;
+				}
+			}
+			// Not a symbol, copy as it is
+			if (len >= outlen) return 0;
+			while (len--) {
+				prev = *out++ = *in++;
+				outlen--;
+			}
+			continue;
+		}
+		prev = *out++ = *in++;
+		outlen--;
+	}
+	*out = 0;
+	return 1;
+}
+
+// ---------- Lines ----------
+
+static void Assembler_Write(uint8_t *data, int size)
+{
+	if (Asm_Emit && Asm_WriteCB) {
+		if (!Asm_WriteCB(Asm_Addr, data, size)) Assembler_Error("Error: Couldn't write at $%06X", Asm_Addr);
+	}
+	Asm_Addr += size;
+}
+
+// .DB and .DW
+static void Assembler_Data(char *s, int word)
+{
+	uint8_t data[2];
+	char *next;
+	int value;
+
+	while (1) {
+		while (isspace((int)*s)) s++;
+		if (!*s) {
+			Assembler_Error("Error: Missing value");
+			return;
+		}
+		if ((*s == '"') && !word) {
+			// Text
+			s++;
+			while (*s && (*s != '"')) {
+				data[0] = *s++;
+				Assembler_Write(data, 1);
+			}
+			if (*s != '"') {
+				Assembler_Error("Error: Missing closing quote");
+				return;
+			}
+			s++;
+		} else {
+			next = strchr(s, ',');
+			if (next) *next = 0;
+			if (!Assembler_Eval(s, &value)) {
+				Assembler_Error("Error: Invalid value '%s'", s);
+				value = 0;
+			} else if (word && ((value < -32768) || (value > 65535))) {
+				Assembler_Error("Error: Value out of range: %i", value);
+			} else if (!word && ((value < -128) || (value > 255))) {
+				Assembler_Error("Error: Value out of range: %i", value);
+			}
+			data[0] = value;
+			data[1] = value >> 8;
+			Assembler_Write(data, word ? 2 : 1);
+			if (!next) return;
+			*next = ',';
+			s = next;
+		}
+		while (isspace((int)*s)) s++;
+		if (!*s) return;
+		if (*s != ',') {
+			Assembler_Error("Error: Syntax error");
+			return;
+		}
+		s++;
+	}
+}
+
+static void Assembler_ProcessLine(char *s, int prescan)
+{
+	InstructionInfo *opcode;
+	char tmp[256], err[PMTMPV], *word;
+	uint8_t data[8];
+	int len, wlen, value, quote = 0;
+
+	// Remove comments and trim
+	for (word = s; *word; word++) {
+		if (*word == '"') quote = !quote;
+		else if ((*word == '\'') && word[1] && (word[2] == '\'')) word += 2;
+		else if ((*word == ';') && !quote) break;
+	}
+	*word = 0;
+	s = TrimStr(s);
+
+	// Label
+	if (Assembler_IsSymbStart(*s)) {
+		for (len=1; Assembler_IsSymbChar(s[len]); len++);
+		if (s[len] == ':') {
+			if (prescan) Assembler_AddSymb(s, len);
+			else Assembler_DefineSymb(s, len, Asm_Addr);
+			s = TrimStr(s + len + 1);
+		}
+	}
+	if (!*s) return;
+
+	// First word
+	for (wlen=0; s[wlen] && !isspace((int)s[wlen]); wlen++);
+	word = s + wlen;
+	while (isspace((int)*word)) word++;
+
+	// Symbol definition
+	if (!strncasecmp(word, ".EQU", 4) && (!word[4] || isspace((int)word[4]))) {
+		if (prescan) Assembler_AddSymb(s, wlen);
+		else if (!Assembler_Eval(word + 4, &value)) Assembler_Error("Error: Invalid value '%s'", TrimStr(word + 4));
+		else Assembler_DefineSymb(s, wlen, value);
+		return;
+	}
+	if (prescan) return;
+
+	// Directives
+	if ((wlen == 4) && !strncasecmp(s, ".ORG", 4)) {
+		if (!Assembler_Eval(word, &value) || (value < 0)) Assembler_Error("Error: Invalid address '%s'", word);
+		else Asm_Addr = value;
+		return;
+	}
+	if ((wlen == 3) && !strncasecmp(s, ".DS", 3)) {
+		if (!Assembler_Eval(word, &value) || (value < 0)) Assembler_Error("Error: Invalid size '%s'", word);
+		else Asm_Addr += value;
+		return;
+	}
+	if ((wlen == 3) && !strncasecmp(s, ".DB", 3)) {
+		Assembler_Data(word, 0);
+		return;
+	}
+	if ((wlen == 3) && !strncasecmp(s, ".DW", 3)) {
+		Assembler_Data(word, 1);
+		return;
+	}
+
+	// Instruction, symbols are only replaced in the operands
+	memcpy(tmp, s, wlen);
+	if (!Assembler_Subst(tmp + wlen, s + wlen, 256 - wlen)) {
+		Assembler_Error("Error: Line too long");
+		return;
+	}
+	opcode = AsmSingleOpcode(tmp, Asm_Addr, data, Asm_SOpcDec, err);
+	if (!opcode) {
+		Assembler_Error("%s", TrimStr(err));
+		return;
+	}
+	Assembler_Write(data, opcode->size);
+}
+
+static void Assembler_Pass(const char *source, int prescan)
+{
+	char line[256];
+	const char *next;
+	int len;
+
+	Asm_Addr = 0;
+	Asm_Line = 0;
+	Asm_Changed = 0;
+	while (*source) {
+		Asm_Line++;
+		next = strchr(source, '\n');
+		len = next ? (next - source) : (int)strlen(source);
+		if (len >= 256) {
+			Assembler_Error("Error: Line too long");
+		} else {
+			memcpy(line, source, len);
+			line[len] = 0;
+			Assembler_ProcessLine(line, prescan);
+		}
+		if (!next) break;
+		source = next + 1;
+	}
+}
+
+int Assembler_Source(const char *source, TAssemblerWriteCB writecb, TAssemblerErrorCB errcb, TSOpcDec *sopcdec)
+{
+	Asm_WriteCB = writecb;
+	Asm_ErrorCB = errcb;
+	Asm_SOpcDec = sopcdec;
+	Asm_Errors = 0;
+	Asm_Emit = 0;
+	Assembler_FreeSymbs();
+
+	// Collect symbol names
+	Asm_Pass = -2;
+	Assembler_Pass(source, 1);
+
+	// Repeat until symbols are stable
+	for (Asm_Pass=0; Asm_Pass<ASSEMBLER_MAXPASS; Asm_Pass++) {
+		Assembler_Pass(source, 0);
+		if (!Asm_Changed) break;
+	}
+
+	// Output
+	Asm_Errors = 0;
+	Asm_Emit = 1;
+	Asm_Pass = ASSEMBLER_MAXPASS;
+	Assembler_Pass(source, 0);
+	if (Asm_Changed) {
+		Asm_Line = 0;
+		Assembler_Error("Error: Symbols didn't settle after %i passes", ASSEMBLER_MAXPASS);
+	}
+
+	Assembler_FreeSymbs();
+	return (Asm_Errors == 0);
+}
+
+int Assembler_File(const char *filename, TAssemblerWriteCB writecb, TAssemblerErrorCB errcb, TSOpcDec *sopcdec)
+{
+	FILE *fi;
+	char *source;
+	long size;
+	int res;
+
+	fi = fopen(filename, "rb");
+	if (!fi) {
+		if (errcb) errcb(0, "Error: Couldn't open file");
+		return 0;
+	}
+	fseek(fi, 0, SEEK_END);
+	size = ftell(fi);
+	fseek(fi, 0, SEEK_SET);
+	source = (size >= 0) ? (char *)malloc(size + 1) : NULL;
+	if (!source) {
+		fclose(fi);
+		if (errcb) errcb(0, "Error: Not enough memory");
+		return 0;
+	}
+	if (fread(source, 1, size, fi) != (size_t)size) {
+		free(source);
+		fclose(fi);
+		if (errcb) errcb(0, "Error: Read error");
+		return 0;
+	}
+	fclose(fi);
+	source[size] = 0;
+
+	res = Assembler_Source(source, writecb, errcb, sopcdec);
+	free(source);
+	return res;
+}
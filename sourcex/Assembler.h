@@ -0,0 +1,54 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ASSEMBLER_H
+#define ASSEMBLER_H
+
+#include <stdint.h>
+#include "InstructionProc.h"
+
+// Source assembler
+//
+// Assembles whole sources through AsmSingleOpcode, one instruction per line:
+//   [label:] [instruction or directive] [; comment]
+// Labels and .EQU values are resolved by repeating the passes until they
+// are stable, so jumps to forward labels pick the right size.
+// Symbols can be used in operands, with + and - between terms.
+//
+// Directives:
+//   .ORG addr            Set address
+//   name .EQU value      Define symbol
+//   .DB value, "text"    Bytes
+//   .DW value            Words, little-endian
+//   .DS count            Reserve bytes
+
+#define ASSEMBLER_MAXPASS	16
+
+// Write callback, return 0 to abort
+typedef int (*TAssemblerWriteCB)(uint32_t addr, uint8_t *data, int size);
+
+// Error callback, line starts from 1, 0 for file errors
+typedef void (*TAssemblerErrorCB)(int line, const char *msg);
+
+// Assemble source text, return 0 if there was errors
+int Assembler_Source(const char *source, TAssemblerWriteCB writecb, TAssemblerErrorCB errcb, TSOpcDec *sopcdec);
+
+// Assemble source file, return 0 if there was errors
+int Assembler_File(const char *filename, TAssemblerWriteCB writecb, TAssemblerErrorCB errcb, TSOpcDec *sopcdec);
+
+#endif
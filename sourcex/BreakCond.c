@@ -0,0 +1,464 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "MinxCPU.h"
+#include "BreakCond.h"
+
+// Bytecode
+enum {
+	BCOP_END = 0,
+	BCOP_NUM,		// Push next word
+	BCOP_REG,		// Push register, next word is BCREG_*
+	BCOP_READB,		// Pop address, push byte
+	BCOP_READW,		// Pop address, push word
+	BCOP_NEG, BCOP_NOT, BCOP_LNOT,
+	BCOP_MUL, BCOP_DIV, BCOP_MOD,
+	BCOP_ADD, BCOP_SUB,
+	BCOP_SHL, BCOP_SHR,
+	BCOP_LT, BCOP_LE, BCOP_GT, BCOP_GE,
+	BCOP_EQ, BCOP_NE,
+	BCOP_AND, BCOP_XOR, BCOP_OR,
+	BCOP_LAND, BCOP_LOR
+};
+
+// Registers and counters
+enum {
+	BCREG_A, BCREG_B, BCREG_L, BCREG_H, BCREG_I,
+	BCREG_BA, BCREG_HL, BCREG_X, BCREG_Y, BCREG_XI, BCREG_YI,
+	BCREG_SP, BCREG_PC, BCREG_V, BCREG_N, BCREG_F, BCREG_E, BCREG_U,
+	BCREG_CYC, BCREG_TMR1, BCREG_TMR2, BCREG_TMR3, BCREG_HITS
+};
+
+static const char *BreakCond_RegNames[] = {
+	"A", "B", "L", "H", "I",
+	"BA", "HL", "X", "Y", "XI", "YI",
+	"SP", "PC", "V", "N", "F", "E", "U",
+	"CYC", "TMR1", "TMR2", "TMR3", "HITS",
+	NULL
+};
+
+// Binary operators, lowest precedence first
+typedef struct {
+	const char *sym;
+	int prec;
+	int op;
+} TBreakCondBinOp;
+
+static const TBreakCondBinOp BreakCond_BinOps[] = {
+	// Longer symbols first
+	{"||", 0, BCOP_LOR}, {"&&", 1, BCOP_LAND},
+	{"==", 5, BCOP_EQ}, {"!=", 5, BCOP_NE},
+	{"<=", 6, BCOP_LE}, {">=", 6, BCOP_GE},
+	{"<<", 7, BCOP_SHL}, {">>", 7, BCOP_SHR},
+	{"|", 2, BCOP_OR}, {"^", 3, BCOP_XOR}, {"&", 4, BCOP_AND},
+	{"=", 5, BCOP_EQ}, {"<", 6, BCOP_LT}, {">", 6, BCOP_GT},
+	{"+", 8, BCOP_ADD}, {"-", 8, BCOP_SUB},
+	{"*", 9, BCOP_MUL}, {"/", 9, BCOP_DIV}, {"%", 9, BCOP_MOD},
+	{NULL, 0, 0}
+};
+
+int BreakCond_Anywhere = 0;
+
+static TBreakCond BreakCond_List[BREAKCOND_MAX];
+static int BreakCond_Count = 0;
+
+static InstructionProcReadCB BreakCond_Read = NULL;
+static const uint64_t *BreakCond_Cycles = NULL;
+static const uint32_t *BreakCond_Timer[3] = {NULL, NULL, NULL};
+
+void BreakCond_SetHost(InstructionProcReadCB read, const uint64_t *cycles, const uint32_t *timer1, const uint32_t *timer2, const uint32_t *timer3)
+{
+	BreakCond_Read = read;
+	BreakCond_Cycles = cycles;
+	BreakCond_Timer[0] = timer1;
+	BreakCond_Timer[1] = timer2;
+	BreakCond_Timer[2] = timer3;
+}
+
+// -----------
+// Compiler
+// -----------
+
+typedef struct {
+	const char *src;		// Current position
+	TBreakCondExpr *expr;
+	int depth, maxdepth;		// Stack usage
+	char *err;
+} TBreakCondParser;
+
+static int BreakCond_Error(TBreakCondParser *p, const char *msg)
+{
+	if (p->err) sprintf(p->err, "%s at \"%.16s\"", msg, p->src);
+	return 0;
+}
+
+static void BreakCond_SkipSpaces(TBreakCondParser *p)
+{
+	while (isspace((unsigned char)*p->src)) p->src++;
+}
+
+// Emit word, delta is the change in stack depth
+static int BreakCond_Emit(TBreakCondParser *p, int32_t word, int delta)
+{
+	if (p->expr->len >= BREAKCOND_MAXCODE) return BreakCond_Error(p, "Expression too long");
+	p->expr->code[p->expr->len++] = word;
+	p->depth += delta;
+	if (p->depth > p->maxdepth) p->maxdepth = p->depth;
+	if (p->maxdepth > BREAKCOND_MAXSTACK) return BreakCond_Error(p, "Expression too complex");
+	return 1;
+}
+
+static int BreakCond_ParseBinary(TBreakCondParser *p, int minprec);
+
+static int BreakCond_ParseUnary(TBreakCondParser *p)
+{
+	char name[8];
+	int i, len;
+	uint32_t num;
+	char *end;
+
+	BreakCond_SkipSpaces(p);
+	switch (*p->src) {
+		case '-':
+			p->src++;
+			if (!BreakCond_ParseUnary(p)) return 0;
+			return BreakCond_Emit(p, BCOP_NEG, 0);
+		case '~':
+			p->src++;
+			if (!BreakCond_ParseUnary(p)) return 0;
+			return BreakCond_Emit(p, BCOP_NOT, 0);
+		case '!':
+			p->src++;
+			if (!BreakCond_ParseUnary(p)) return 0;
+			return BreakCond_Emit(p, BCOP_LNOT, 0);
+		case '(':
+			p->src++;
+			if (!BreakCond_ParseBinary(p, 0)) return 0;
+			BreakCond_SkipSpaces(p);
+			if (*p->src != ')') return BreakCond_Error(p, "Missing ')'");
+			p->src++;
+			return 1;
+		case '[':
+			p->src++;
+			if (!BreakCond_ParseBinary(p, 0)) return 0;
+			BreakCond_SkipSpaces(p);
+			if (*p->src != ']') return BreakCond_Error(p, "Missing ']'");
+			p->src++;
+			return BreakCond_Emit(p, BCOP_READB, 0);
+		case '$':
+			num = strtoul(p->src + 1, &end, 16);
+			if (end == p->src + 1) return BreakCond_Error(p, "Invalid number");
+			p->src = end;
+			if (!BreakCond_Emit(p, BCOP_NUM, 1)) return 0;
+			return BreakCond_Emit(p, (int32_t)num, 0);
+	}
+	if (isdigit((unsigned char)*p->src)) {
+		if ((p->src[0] == '0') && (toupper((unsigned char)p->src[1]) == 'X')) num = strtoul(p->src + 2, &end, 16);
+		else num = strtoul(p->src, &end, 10);
+		p->src = end;
+		if (!BreakCond_Emit(p, BCOP_NUM, 1)) return 0;
+		return BreakCond_Emit(p, (int32_t)num, 0);
+	}
+	if (isalpha((unsigned char)*p->src)) {
+		// Word in memory
+		if ((toupper((unsigned char)p->src[0]) == 'W') && (p->src[1] == '[')) {
+			p->src += 2;
+			if (!BreakCond_ParseBinary(p, 0)) return 0;
+			BreakCond_SkipSpaces(p);
+			if (*p->src != ']') return BreakCond_Error(p, "Missing ']'");
+			p->src++;
+			return BreakCond_Emit(p, BCOP_READW, 0);
+		}
+		// Register or counter
+		for (len=0; isalnum((unsigned char)p->src[len]); len++) {
+			if (len < 7) name[len] = toupper((unsigned char)p->src[len]);
+		}
+		name[(len < 7) ? len : 7] = 0;
+		for (i=0; BreakCond_RegNames[i]; i++) {
+			if ((len < 7) && !strcmp(name, BreakCond_RegNames[i])) {
+				p->src += len;
+				if (!BreakCond_Emit(p, BCOP_REG, 1)) return 0;
+				return BreakCond_Emit(p, i, 0);
+			}
+		}
+		return BreakCond_Error(p, "Unknown register");
+	}
+	return BreakCond_Error(p, "Operand expected");
+}
+
+static int BreakCond_ParseBinary(TBreakCondParser *p, int minprec)
+{
+	const TBreakCondBinOp *bop;
+	int len;
+
+	if (!BreakCond_ParseUnary(p)) return 0;
+	for (;;) {
+		BreakCond_SkipSpaces(p);
+		for (bop = BreakCond_BinOps; bop->sym; bop++) {
+			len = strlen(bop->sym);
+			if (!strncmp(p->src, bop->sym, len)) break;
+		}
+		if (!bop->sym || (bop->prec < minprec)) return 1;
+		p->src += len;
+		if (!BreakCond_ParseBinary(p, bop->prec + 1)) return 0;
+		if (!BreakCond_Emit(p, bop->op, -1)) return 0;
+	}
+}
+
+int BreakCond_Compile(TBreakCondExpr *expr, const char *src, char *err)
+{
+	TBreakCondParser p;
+
+	p.src = src;
+	p.expr = expr;
+	p.depth = p.maxdepth = 0;
+	p.err = err;
+	expr->len = 0;
+	BreakCond_SkipSpaces(&p);
+	if (*p.src == 0) {
+		// Empty is always true
+		BreakCond_Emit(&p, BCOP_NUM, 1);
+		BreakCond_Emit(&p, 1, 0);
+	} else {
+		if (!BreakCond_ParseBinary(&p, 0)) return 0;
+		BreakCond_SkipSpaces(&p);
+		if (*p.src) return BreakCond_Error(&p, "Unexpected character");
+	}
+	return BreakCond_Emit(&p, BCOP_END, 0);
+}
+
+// -----------
+// Evaluation
+// -----------
+
+static inline int64_t BreakCond_ReadMem(int64_t addr)
+{
+	if (!BreakCond_Read) return 0;
+	return BreakCond_Read(0, (uint32_t)addr & 0x1FFFFF);
+}
+
+static inline int64_t BreakCond_GetReg(int reg, uint32_t hits)
+{
+	switch (reg) {
+		case BCREG_A: return MinxCPU.BA.B.L;
+		case BCREG_B: return MinxCPU.BA.B.H;
+		case BCREG_L: return MinxCPU.HL.B.L;
+		case BCREG_H: return MinxCPU.HL.B.H;
+		case BCREG_I: return MinxCPU.HL.B.I;
+		case BCREG_BA: return MinxCPU.BA.W.L;
+		case BCREG_HL: return MinxCPU.HL.W.L;
+		case BCREG_X: return MinxCPU.X.W.L;
+		case BCREG_Y: return MinxCPU.Y.W.L;
+		case BCREG_XI: return MinxCPU.X.B.I;
+		case BCREG_YI: return MinxCPU.Y.B.I;
+		case BCREG_SP: return MinxCPU.SP.W.L;
+		case BCREG_PC: return MinxCPU.PC.W.L;
+		case BCREG_V: return MinxCPU.PC.B.I;
+		case BCREG_N: return MinxCPU.N.B.H;
+		case BCREG_F: return MinxCPU.F;
+		case BCREG_E: return MinxCPU.E;
+		case BCREG_U: return MinxCPU.U1;
+		case BCREG_CYC: return BreakCond_Cycles ? (int64_t)*BreakCond_Cycles : 0;
+		case BCREG_TMR1: return BreakCond_Timer[0] ? *BreakCond_Timer[0] : 0;
+		case BCREG_TMR2: return BreakCond_Timer[1] ? *BreakCond_Timer[1] : 0;
+		case BCREG_TMR3: return BreakCond_Timer[2] ? *BreakCond_Timer[2] : 0;
+		case BCREG_HITS: return hits;
+	}
+	return 0;
+}
+
+int64_t BreakCond_Eval(const TBreakCondExpr *expr, uint32_t hits)
+{
+	int64_t stack[BREAKCOND_MAXSTACK + 1], *sp = stack;
+	const int32_t *pc = expr->code;
+
+	stack[0] = 0;
+	for (;;) {
+		switch (*pc++) {
+			case BCOP_END: return *sp;
+			case BCOP_NUM: *++sp = (uint32_t)*pc++; break;
+			case BCOP_REG: *++sp = BreakCond_GetReg(*pc++, hits); break;
+			case BCOP_READB: *sp = BreakCond_ReadMem(*sp); break;
+			case BCOP_READW: *sp = BreakCond_ReadMem(*sp) | (BreakCond_ReadMem(*sp + 1) << 8); break;
+			case BCOP_NEG: *sp = (int64_t)(0 - (uint64_t)*sp); break;
+			case BCOP_NOT: *sp = ~*sp; break;
+			case BCOP_LNOT: *sp = !*sp; break;
+			case BCOP_MUL: sp--; *sp = (int64_t)((uint64_t)*sp * (uint64_t)sp[1]); break;
+			case BCOP_DIV: sp--; *sp = (sp[1] == -1) ? (int64_t)(0 - (uint64_t)*sp) : sp[1] ? *sp / sp[1] : 0; break;
+			case BCOP_MOD: sp--; *sp = ((sp[1] == -1) || !sp[1]) ? 0 : *sp % sp[1]; break;
+			case BCOP_ADD: sp--; *sp = (int64_t)((uint64_t)*sp + (uint64_t)sp[1]); break;
+			case BCOP_SUB: sp--; *sp = (int64_t)((uint64_t)*sp - (uint64_t)sp[1]); break;
+			case BCOP_SHL: sp--; *sp = (int64_t)((uint64_t)*sp << (sp[1] & 63)); break;
+			case BCOP_SHR: sp--; *sp = *sp >> (sp[1] & 63); break;
+			case BCOP_LT: sp--; *sp = *sp < sp[1]; break;
+			case BCOP_LE: sp--; *sp = *sp <= sp[1]; break;
+			case BCOP_GT: sp--; *sp = *sp > sp[1]; break;
+			case BCOP_GE: sp--; *sp = *sp >= sp[1]; break;
+			case BCOP_EQ: sp--; *sp = *sp == sp[1]; break;
+			case BCOP_NE: sp--; *sp = *sp != sp[1]; break;
+			case BCOP_AND: sp--; *sp = *sp & sp[1]; break;
+			case BCOP_XOR: sp--; *sp = *sp ^ sp[1]; break;
+			case BCOP_OR: sp--; *sp = *sp | sp[1]; break;
+			case BCOP_LAND: sp--; *sp = *sp && sp[1]; break;
+			case BCOP_LOR: sp--; *sp = *sp || sp[1]; break;
+			default: return 0;
+		}
+	}
+}
+
+// -----------
+// Breakpoints
+// -----------
+
+// Compile {expr} in message
+static int BreakCond_CompileLog(TBreakCond *bc, char *err)
+{
+	char tmp[BREAKCOND_MAXTEXT];
+	const char *s = bc->log, *e;
+	int len;
+
+	bc->numlogexpr = 0;
+	while ((s = strchr(s, '{')) != NULL) {
+		e = strchr(s, '}');
+		if (!e) {
+			if (err) strcpy(err, "Missing '}' in message");
+			return 0;
+		}
+		if (bc->numlogexpr >= BREAKCOND_MAXLOGEXPR) {
+			if (err) strcpy(err, "Too many expressions in message");
+			return 0;
+		}
+		len = e - s - 1;
+		memcpy(tmp, s + 1, len);
+		tmp[len] = 0;
+		if ((len >= 2) && (tmp[len-2] == ':')) tmp[len-2] = 0;
+		if (!BreakCond_Compile(&bc->logexpr[bc->numlogexpr], tmp, err)) return 0;
+		bc->numlogexpr++;
+		s = e + 1;
+	}
+	return 1;
+}
+
+// Format message
+static void BreakCond_FormatLog(TBreakCond *bc, char *out, int outsize)
+{
+	const char *s = bc->log, *e;
+	int n = 0, len = 0;
+	int64_t val;
+
+	while (*s && (len < outsize - 24)) {
+		if ((*s == '{') && ((e = strchr(s, '}')) != NULL) && (n < bc->numlogexpr)) {
+			val = BreakCond_Eval(&bc->logexpr[n++], bc->hits);
+			if ((e - s >= 3) && (e[-2] == ':') && (toupper((unsigned char)e[-1]) == 'D')) {
+				len += sprintf(out + len, "%lld", (long long)val);
+			} else {
+				len += sprintf(out + len, "$%llX", (unsigned long long)val);
+			}
+			s = e + 1;
+		} else {
+			out[len++] = *s++;
+		}
+	}
+	out[len] = 0;
+}
+
+int BreakCond_Add(uint32_t addr, const char *cond, int action, const char *log, uint32_t passcount, char *err)
+{
+	TBreakCond *bc;
+
+	if (!cond) cond = "";
+	if (!log) log = "";
+	if (BreakCond_Count >= BREAKCOND_MAX) {
+		if (err) strcpy(err, "Too many conditional breakpoints");
+		return -1;
+	}
+	if ((strlen(cond) >= BREAKCOND_MAXTEXT) || (strlen(log) >= BREAKCOND_MAXTEXT)) {
+		if (err) strcpy(err, "Condition or message too long");
+		return -1;
+	}
+	bc = &BreakCond_List[BreakCond_Count];
+	memset(bc, 0, sizeof(TBreakCond));
+	bc->addr = (addr == BREAKCOND_ANYWHERE) ? addr : (addr & 0x1FFFFF);
+	bc->action = action;
+	bc->enabled = 1;
+	bc->passcount = passcount;
+	strcpy(bc->cond, cond);
+	strcpy(bc->log, log);
+	if (!BreakCond_Compile(&bc->expr, bc->cond, err)) return -1;
+	if (!BreakCond_CompileLog(bc, err)) return -1;
+	if (bc->addr == BREAKCOND_ANYWHERE) BreakCond_Anywhere++;
+	return BreakCond_Count++;
+}
+
+int BreakCond_Remove(int index)
+{
+	if ((index < 0) || (index >= BreakCond_Count)) return 0;
+	if (BreakCond_List[index].addr == BREAKCOND_ANYWHERE) BreakCond_Anywhere--;
+	BreakCond_Count--;
+	memmove(&BreakCond_List[index], &BreakCond_List[index+1], (BreakCond_Count - index) * sizeof(TBreakCond));
+	return 1;
+}
+
+void BreakCond_ClearAll(void)
+{
+	BreakCond_Count = 0;
+	BreakCond_Anywhere = 0;
+}
+
+void BreakCond_ResetHits(void)
+{
+	int i;
+	for (i=0; i<BreakCond_Count; i++) BreakCond_List[i].hits = 0;
+}
+
+int BreakCond_Num(void)
+{
+	return BreakCond_Count;
+}
+
+TBreakCond *BreakCond_Get(int index)
+{
+	if ((index < 0) || (index >= BreakCond_Count)) return NULL;
+	return &BreakCond_List[index];
+}
+
+int BreakCond_Test(uint32_t addr, TBreakCondLogCB logcb)
+{
+	char msg[BREAKCOND_MAXTEXT * 2];
+	TBreakCond *bc;
+	int i, stop = 0;
+
+	for (i=0; i<BreakCond_Count; i++) {
+		bc = &BreakCond_List[i];
+		if ((bc->addr != addr) || !bc->enabled) continue;
+		if (!BreakCond_Eval(&bc->expr, bc->hits)) continue;
+		bc->hits++;
+		if (bc->hits < bc->passcount) continue;
+		if (bc->action == BREAKCOND_LOG) {
+			if (logcb) {
+				BreakCond_FormatLog(bc, msg, sizeof(msg));
+				logcb(msg);
+			}
+		} else stop = 1;
+	}
+	return stop;
+}
@@ -0,0 +1,100 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BREAKCOND_H
+#define BREAKCOND_H
+
+#include <stdint.h>
+#include "InstructionProc.h"
+
+// Conditional breakpoints and tracepoints
+//
+// Conditions are C-like expressions compiled once into a small stack
+// bytecode, ie: "A == 3 && [$1A20] > 10". Operands are numbers ($hex, 0x
+// hex or decimal), registers (A B L H I BA HL X Y XI YI SP PC V N F E U),
+// CYC (cycles ran), TMR1..TMR3 (cycle timers), HITS (times the condition
+// was true), [addr] for a byte and W[addr] for a word in memory.
+// Tracepoints don't stop, they send their message to the log callback,
+// {expr} in the message is replaced by the value in hex, {expr:d} in decimal.
+
+#define BREAKCOND_ANYWHERE	0xFFFFFFFF	// Tested before every instruction
+#define BREAKCOND_MAX		64		// Conditional breakpoints
+#define BREAKCOND_MAXCODE	64		// Bytecode words per expression
+#define BREAKCOND_MAXSTACK	16		// Evaluation stack depth
+#define BREAKCOND_MAXLOGEXPR	4		// Expressions per message
+#define BREAKCOND_MAXTEXT	128		// Condition and message length
+
+// Actions
+enum {
+	BREAKCOND_BREAK = 0,		// Stop emulation
+	BREAKCOND_LOG			// Log message and continue
+};
+
+typedef struct {
+	int len;
+	int32_t code[BREAKCOND_MAXCODE];
+} TBreakCondExpr;
+
+typedef struct {
+	uint32_t addr;			// Physical address or BREAKCOND_ANYWHERE
+	int action;			// BREAKCOND_*
+	int enabled;			// Tested only when set
+	uint32_t passcount;		// Trigger from this hit, 0 or 1 for every hit
+	uint32_t hits;			// Times the condition was true
+	char cond[BREAKCOND_MAXTEXT];	// Condition source, empty for always
+	char log[BREAKCOND_MAXTEXT];	// Message source
+	TBreakCondExpr expr;		// Compiled condition
+	int numlogexpr;			// Compiled message expressions
+	TBreakCondExpr logexpr[BREAKCOND_MAXLOGEXPR];
+} TBreakCond;
+
+// Message callback for tracepoints
+typedef void (*TBreakCondLogCB)(const char *msg);
+
+// Number of breakpoints with BREAKCOND_ANYWHERE address
+extern int BreakCond_Anywhere;
+
+// Set memory read and counters used by expressions, NULL reads as 0
+void BreakCond_SetHost(InstructionProcReadCB read, const uint64_t *cycles, const uint32_t *timer1, const uint32_t *timer2, const uint32_t *timer3);
+
+// Compile expression, return 0 on failure with the reason in err (if not NULL)
+int BreakCond_Compile(TBreakCondExpr *expr, const char *src, char *err);
+
+// Evaluate compiled expression
+int64_t BreakCond_Eval(const TBreakCondExpr *expr, uint32_t hits);
+
+// Add breakpoint, return index or -1 on failure with the reason in err (if not NULL)
+int BreakCond_Add(uint32_t addr, const char *cond, int action, const char *log, uint32_t passcount, char *err);
+
+// Remove breakpoint, return 0 if index is invalid
+int BreakCond_Remove(int index);
+
+// Remove all breakpoints
+void BreakCond_ClearAll(void);
+
+// Reset hit counters
+void BreakCond_ResetHits(void);
+
+// Number of breakpoints and breakpoint at index (NULL if invalid)
+int BreakCond_Num(void);
+TBreakCond *BreakCond_Get(int index);
+
+// Test breakpoints at address (BREAKCOND_ANYWHERE for those), return 1 to stop
+int BreakCond_Test(uint32_t addr, TBreakCondLogCB logcb);
+
+#endif
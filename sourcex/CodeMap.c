@@ -0,0 +1,349 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "CodeMap.h"
+
+// Opcode names that change the flow
+#define OPC_CALLCC	24	// 24 to 27, CALLC to CALLNZ
+#define OPC_JCC		28	// 28 to 31, JC to JNZ
+#define OPC_CALL	32
+#define OPC_JMP		33
+#define OPC_JDBNZ	34
+#define OPC_RET		35
+#define OPC_RETI	36
+#define OPC_RETSKIP	37
+#define OPC_CINT	38
+#define OPC_JINT	39
+#define OPC_JCCE	56	// 56 to 71, JL to JX3
+#define OPC_CALLCCE	72	// 72 to 87, CALLL to CALLX3
+#define OPC_STOP	88
+
+TCodeMap *CodeMap_Create(uint32_t size)
+{
+	TCodeMap *cm = (TCodeMap *)malloc(sizeof(TCodeMap));
+	if (!cm) return NULL;
+	memset(cm, 0, sizeof(TCodeMap));
+	cm->size = size;
+	cm->start = (uint8_t *)malloc((size + 7) >> 3);
+	cm->code = (uint8_t *)malloc((size + 7) >> 3);
+	if (!cm->start || !cm->code) {
+		CodeMap_Destroy(cm);
+		return NULL;
+	}
+	CodeMap_Clear(cm);
+	return cm;
+}
+
+void CodeMap_Destroy(TCodeMap *cm)
+{
+	if (!cm) return;
+	if (cm->start) free(cm->start);
+	if (cm->code) free(cm->code);
+	if (cm->xref) free(cm->xref);
+	free(cm);
+}
+
+void CodeMap_Clear(TCodeMap *cm)
+{
+	memset(cm->start, 0, (cm->size + 7) >> 3);
+	memset(cm->code, 0, (cm->size + 7) >> 3);
+	cm->numxref = 0;
+	cm->sorted = 1;
+	cm->instructions = 0;
+}
+
+static int CodeMap_AddXRef(TCodeMap *cm, uint32_t from, uint32_t to, int type)
+{
+	TCodeMapXRef *newxref;
+	if (cm->numxref >= cm->maxxref) {
+		newxref = (TCodeMapXRef *)realloc(cm->xref, (cm->maxxref + 1024) * 2 * sizeof(TCodeMapXRef));
+		if (!newxref) return 0;
+		cm->xref = newxref;
+		cm->maxxref = (cm->maxxref + 1024) * 2;
+	}
+	cm->xref[cm->numxref].from = from;
+	cm->xref[cm->numxref].to = to;
+	cm->xref[cm->numxref].type = type;
+	cm->numxref++;
+	cm->sorted = 0;
+	return 1;
+}
+
+static int CodeMap_XRefCompare(const void *a, const void *b)
+{
+	const TCodeMapXRef *xa = (const TCodeMapXRef *)a;
+	const TCodeMapXRef *xb = (const TCodeMapXRef *)b;
+	if (xa->to != xb->to) return (xa->to < xb->to) ? -1 : 1;
+	if (xa->from != xb->from) return (xa->from < xb->from) ? -1 : 1;
+	return 0;
+}
+
+static uint16_t CodeMap_Read16(InstructionProcReadCB readcb, uint32_t addr)
+{
+	return readcb(0, addr) | (readcb(0, addr+1) << 8);
+}
+
+// Logical address of a physical address
+static uint32_t CodeMap_Logical(uint32_t addr)
+{
+	if (addr >= 0x8000) return 0x8000 | (addr & 0x7FFF);
+	return addr;
+}
+
+// Physical address of a logical target, bank is -1 if unknown
+// Return 0 if it can't be resolved
+static int CodeMap_Physical(TCodeMap *cm, uint32_t from, int bank, uint32_t laddr, uint32_t *addr)
+{
+	laddr &= 0xFFFF;
+	if (laddr < 0x8000) *addr = laddr;
+	else if (bank >= 0) *addr = (bank << 15) | (laddr & 0x7FFF);
+	else if (from >= 0x8000) *addr = (from & ~0x7FFF) | (laddr & 0x7FFF);
+	else if (cm->size <= 0x10000) *addr = laddr;
+	else return 0;
+	return (*addr < cm->size);
+}
+
+int CodeMap_AddEntry(TCodeMap *cm, InstructionProcReadCB readcb, uint32_t addr)
+{
+	InstructionInfo *II;
+	uint32_t *stack, *newstack, target;
+	int sp, maxsp, size, i, type, bank, resolved, endflow;
+	uint8_t data[4];
+
+	if (CodeMap_IsCode(cm, addr)) return 1;
+	maxsp = 256;
+	stack = (uint32_t *)malloc(maxsp * sizeof(uint32_t));
+	if (!stack) return 0;
+	sp = 0;
+	stack[sp++] = addr;
+	while (sp) {
+		addr = stack[--sp];
+		bank = -1;
+		while ((addr < cm->size) && !CodeMap_IsCode(cm, addr)) {
+			// Decode, stop at invalid opcodes or overlaps
+			II = GetInstructionInfo(readcb, 0, addr, data, &size);
+			if (!II->opc || ((addr + size) > cm->size)) break;
+			for (i=1; i<size; i++) {
+				if (CodeMap_IsCode(cm, addr + i)) break;
+			}
+			if (i < size) break;
+			cm->start[addr >> 3] |= 1 << (addr & 7);
+			for (i=0; i<size; i++) {
+				cm->code[(addr + i) >> 3] |= 1 << ((addr + i) & 7);
+			}
+			cm->instructions++;
+
+			// Follow the flow
+			resolved = 0;
+			endflow = 0;
+			type = CODEMAP_XREF_JUMP;
+			switch (II->opc) {
+				case OPC_CALLCC: case OPC_CALLCC+1: case OPC_CALLCC+2: case OPC_CALLCC+3:
+				case OPC_CALL:
+				case OPC_CALLCCE: case OPC_CALLCCE+1: case OPC_CALLCCE+2: case OPC_CALLCCE+3:
+				case OPC_CALLCCE+4: case OPC_CALLCCE+5: case OPC_CALLCCE+6: case OPC_CALLCCE+7:
+				case OPC_CALLCCE+8: case OPC_CALLCCE+9: case OPC_CALLCCE+10: case OPC_CALLCCE+11:
+				case OPC_CALLCCE+12: case OPC_CALLCCE+13: case OPC_CALLCCE+14: case OPC_CALLCCE+15:
+					type = CODEMAP_XREF_CALL;
+				case OPC_JCC: case OPC_JCC+1: case OPC_JCC+2: case OPC_JCC+3:
+				case OPC_JMP: case OPC_JDBNZ:
+				case OPC_JCCE: case OPC_JCCE+1: case OPC_JCCE+2: case OPC_JCCE+3:
+				case OPC_JCCE+4: case OPC_JCCE+5: case OPC_JCCE+6: case OPC_JCCE+7:
+				case OPC_JCCE+8: case OPC_JCCE+9: case OPC_JCCE+10: case OPC_JCCE+11:
+				case OPC_JCCE+12: case OPC_JCCE+13: case OPC_JCCE+14: case OPC_JCCE+15:
+					switch (II->p1) {
+						case 1:		// %j
+							resolved = CodeMap_Physical(cm, addr, bank, CodeMap_Logical(addr) + 1 + (int8_t)data[II->p1off], &target);
+							break;
+						case 2:		// %J
+							resolved = CodeMap_Physical(cm, addr, bank, CodeMap_Logical(addr) + 2 + (int16_t)(data[II->p1off] | (data[II->p1off+1] << 8)), &target);
+							break;
+						case 38:	// %h
+							resolved = CodeMap_Physical(cm, addr, bank, CodeMap_Logical(addr) + 2 + (int8_t)data[II->p1off], &target);
+							break;
+						case 5:		// [%U]
+							if (CodeMap_Physical(cm, addr, -1, data[II->p1off] | (data[II->p1off+1] << 8), &target)) {
+								resolved = CodeMap_Physical(cm, addr, bank, CodeMap_Read16(readcb, target), &target);
+							}
+							break;
+					}
+					if (II->opc == OPC_JMP) endflow = 1;
+					break;
+				case OPC_CINT:
+					type = CODEMAP_XREF_CALL;
+				case OPC_JINT:
+					resolved = CodeMap_Physical(cm, addr, bank, CodeMap_Read16(readcb, data[II->p1off]), &target);
+					if (II->opc == OPC_JINT) endflow = 1;
+					break;
+				case OPC_RET: case OPC_RETI: case OPC_RETSKIP:
+				case OPC_STOP:
+					endflow = 1;
+					break;
+			}
+			if (resolved) {
+				if (!CodeMap_AddXRef(cm, addr, target, type)) {
+					free(stack);
+					return 0;
+				}
+				if (!CodeMap_IsCode(cm, target)) {
+					if (sp >= maxsp) {
+						newstack = (uint32_t *)realloc(stack, maxsp * 2 * sizeof(uint32_t));
+						if (!newstack) {
+							free(stack);
+							return 0;
+						}
+						stack = newstack;
+						maxsp *= 2;
+					}
+					stack[sp++] = target;
+				}
+			}
+			if (endflow) break;
+
+			// Track bank for the next jump
+			if (II == &DebugCPUInstructions_CE[0xC4]) bank = data[2];		// MOV U, #nn
+			else if (II == &DebugCPUInstructions_CE[0xCC]) bank = -1;	// MOV U, A
+			addr += size;
+		}
+	}
+	free(stack);
+	return 1;
+}
+
+int CodeMap_Analyze(TCodeMap *cm, InstructionProcReadCB readcb, int bios)
+{
+	uint32_t addr, target;
+	int i;
+
+	CodeMap_Clear(cm);
+
+	// BIOS vectors
+	if (bios) {
+		for (i=0; i<0x42; i+=2) {
+			target = CodeMap_Read16(readcb, i);
+			if ((target < 0x1000) || ((target >= 0x2100) && (target < 0x8000))) {
+				if (target >= cm->size) continue;
+				if (!CodeMap_AddXRef(cm, i, target, CODEMAP_XREF_VECTOR)) return 0;
+				if (!CodeMap_AddEntry(cm, readcb, target)) return 0;
+			}
+		}
+	}
+
+	// Cartridge reset and IRQ jump table
+	if (!CodeMap_AddEntry(cm, readcb, 0x2102)) return 0;
+	for (addr=0x2108; addr<=0x219E; addr+=6) {
+		if (!CodeMap_AddEntry(cm, readcb, addr)) return 0;
+	}
+
+	return 1;
+}
+
+uint32_t CodeMap_Align(TCodeMap *cm, uint32_t addr)
+{
+	uint32_t i;
+	if (!CodeMap_IsCode(cm, addr)) return addr;
+	for (i=0; (i<4) && (i<=addr); i++) {
+		if (CodeMap_IsStart(cm, addr - i)) return addr - i;
+	}
+	return addr;
+}
+
+InstructionInfo *CodeMap_GetInstruction(TCodeMap *cm, InstructionProcReadCB readcb, uint32_t addr, uint8_t *data, int *size)
+{
+	InstructionInfo *II;
+	int i, isize;
+
+	II = GetInstructionInfo(readcb, 0, addr, data, &isize);
+	if (cm && !CodeMap_IsStart(cm, addr)) {
+		if (CodeMap_IsCode(cm, addr)) {
+			// Middle of an instruction, up to the next one
+			for (i=1; i<4; i++) {
+				if (!CodeMap_IsCode(cm, addr + i) || CodeMap_IsStart(cm, addr + i)) break;
+			}
+			isize = 0;
+		} else {
+			// Data, shouldn't overlap code
+			for (i=1; i<isize; i++) {
+				if (CodeMap_IsCode(cm, addr + i)) break;
+			}
+		}
+		if (i != isize) {
+			II = &DebugCPUInstructions_DX[i-1];
+			isize = i;
+			if (data) {
+				for (i=0; i<isize; i++) data[i] = readcb(0, addr + i);
+			}
+		}
+	}
+	if (size) *size = isize;
+	return II;
+}
+
+uint32_t CodeMap_Next(TCodeMap *cm, InstructionProcReadCB readcb, uint32_t addr)
+{
+	int i, size;
+	if (cm && CodeMap_IsStart(cm, addr)) {
+		for (i=1; i<4; i++) {
+			if (!CodeMap_IsCode(cm, addr + i) || CodeMap_IsStart(cm, addr + i)) break;
+		}
+		return addr + i;
+	}
+	CodeMap_GetInstruction(cm, readcb, addr, NULL, &size);
+	return addr + size;
+}
+
+uint32_t CodeMap_Prev(TCodeMap *cm, InstructionProcReadCB readcb, uint32_t addr)
+{
+	uint32_t i, best;
+	int size;
+	if (!addr) return 0;
+	if (!cm) return addr - 1;
+	if (CodeMap_IsCode(cm, addr - 1)) return CodeMap_Align(cm, addr - 1);
+
+	// Data, take the longest decode that end at the address
+	best = addr - 1;
+	for (i=2; (i<=4) && (i<=addr); i++) {
+		if (CodeMap_IsCode(cm, addr - i)) break;
+		CodeMap_GetInstruction(cm, readcb, addr - i, NULL, &size);
+		if (size == i) best = addr - i;
+	}
+	return best;
+}
+
+int CodeMap_XRefsTo(TCodeMap *cm, uint32_t addr, TCodeMapXRef **xref)
+{
+	int lo, hi, mid, first;
+	if (!cm->sorted) {
+		qsort(cm->xref, cm->numxref, sizeof(TCodeMapXRef), CodeMap_XRefCompare);
+		cm->sorted = 1;
+	}
+	lo = 0;
+	hi = cm->numxref;
+	while (lo < hi) {
+		mid = (lo + hi) >> 1;
+		if (cm->xref[mid].to < addr) lo = mid + 1;
+		else hi = mid;
+	}
+	first = lo;
+	while ((lo < cm->numxref) && (cm->xref[lo].to == addr)) lo++;
+	if (xref) *xref = cm->xref + first;
+	return lo - first;
+}
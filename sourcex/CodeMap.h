@@ -0,0 +1,101 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CODEMAP_H
+#define CODEMAP_H
+
+#include <stdint.h>
+#include "InstructionProc.h"
+
+// Code map
+//
+// Recursive descent over the physical address space, starting from the
+// BIOS and cartridge vectors and following every branch it can resolve.
+// Result is a bitmap of instruction starts, a bitmap of bytes that belong
+// to instructions and an index of jump/call references sorted by target.
+// Banked targets are assumed to stay in the same bank, indirect jumps
+// (JMP HL) are not followed, more entries can be added at any time.
+
+// Reference types
+enum {
+	CODEMAP_XREF_JUMP = 0,		// Jump or branch
+	CODEMAP_XREF_CALL,		// Call or CINT
+	CODEMAP_XREF_VECTOR		// Vector table entry
+};
+
+typedef struct {
+	uint32_t from;			// Referring instruction or vector
+	uint32_t to;			// Target
+	int type;			// CODEMAP_XREF_*
+} TCodeMapXRef;
+
+typedef struct {
+	uint32_t size;			// Address space size in bytes
+	uint8_t *start;			// Instruction start bitmap
+	uint8_t *code;			// Instruction bytes bitmap
+	TCodeMapXRef *xref;		// References
+	int numxref, maxxref;
+	int sorted;			// References are sorted
+	int instructions;		// Number of instructions found
+} TCodeMap;
+
+// Create code map for size bytes, return NULL on failure
+TCodeMap *CodeMap_Create(uint32_t size);
+
+// Destroy code map
+void CodeMap_Destroy(TCodeMap *cm);
+
+// Clear code map
+void CodeMap_Clear(TCodeMap *cm);
+
+// Disassemble from entry point, return 0 on failure
+int CodeMap_AddEntry(TCodeMap *cm, InstructionProcReadCB readcb, uint32_t addr);
+
+// Clear and disassemble from cartridge vectors, BIOS vectors are included if bios is set
+// Return 0 on failure
+int CodeMap_Analyze(TCodeMap *cm, InstructionProcReadCB readcb, int bios);
+
+// Address is the start of an instruction
+static inline int CodeMap_IsStart(TCodeMap *cm, uint32_t addr)
+{
+	if (addr >= cm->size) return 0;
+	return (cm->start[addr >> 3] >> (addr & 7)) & 1;
+}
+
+// Address belongs to an instruction
+static inline int CodeMap_IsCode(TCodeMap *cm, uint32_t addr)
+{
+	if (addr >= cm->size) return 0;
+	return (cm->code[addr >> 3] >> (addr & 7)) & 1;
+}
+
+// Get start of the instruction that contain the address
+uint32_t CodeMap_Align(TCodeMap *cm, uint32_t addr);
+
+// Same as GetInstructionInfo, but data that overlap a known instruction
+// is returned as .DB
+InstructionInfo *CodeMap_GetInstruction(TCodeMap *cm, InstructionProcReadCB readcb, uint32_t addr, uint8_t *data, int *size);
+
+// Get address of next and previous instruction
+uint32_t CodeMap_Next(TCodeMap *cm, InstructionProcReadCB readcb, uint32_t addr);
+uint32_t CodeMap_Prev(TCodeMap *cm, InstructionProcReadCB readcb, uint32_t addr);
+
+// Get references to address, return number of references
+int CodeMap_XRefsTo(TCodeMap *cm, uint32_t addr, TCodeMapXRef **xref);
+
+#endif
@@ -0,0 +1,304 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+typedef SOCKET TGDBSocket;
+#define GDBREMOTE_INVALID	INVALID_SOCKET
+#define GDBRemote_CloseSocket	closesocket
+#else
+#include <unistd.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+typedef int TGDBSocket;
+#define GDBREMOTE_INVALID	-1
+#define GDBRemote_CloseSocket	close
+#endif
+
+#include "GDBRemote.h"
+
+static TGDBSocket GDBRemote_Listener = GDBREMOTE_INVALID;
+static TGDBSocket GDBRemote_Client = GDBREMOTE_INVALID;
+static int GDBRemote_Ack = 1;
+static char GDBRemote_UnixPath[108];
+
+// Receive buffer
+static uint8_t GDBRemote_RxBuf[4096];
+static int GDBRemote_RxPos = 0, GDBRemote_RxLen = 0;
+
+// Transmit buffer, data is escaped so it can double
+static uint8_t GDBRemote_TxBuf[GDBREMOTE_PACKETSIZE * 2 + 8];
+
+static const char GDBRemote_Hex[] = "0123456789abcdef";
+
+static int GDBRemote_Startup(void)
+{
+#ifdef _WIN32
+	static int started = 0;
+	WSADATA wsa;
+	if (!started) {
+		if (WSAStartup(MAKEWORD(2, 2), &wsa)) return 0;
+		started = 1;
+	}
+#else
+	// Disconnected client must not terminate the server
+	signal(SIGPIPE, SIG_IGN);
+#endif
+	return 1;
+}
+
+int GDBRemote_ListenTCP(int port)
+{
+	struct sockaddr_in sa;
+	int one = 1;
+
+	GDBRemote_Shutdown();
+	if (!GDBRemote_Startup()) return 0;
+	GDBRemote_Listener = socket(AF_INET, SOCK_STREAM, 0);
+	if (GDBRemote_Listener == GDBREMOTE_INVALID) return 0;
+	setsockopt(GDBRemote_Listener, SOL_SOCKET, SO_REUSEADDR, (const char *)&one, sizeof(one));
+	memset(&sa, 0, sizeof(sa));
+	sa.sin_family = AF_INET;
+	sa.sin_port = htons((uint16_t)port);
+	sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);	// Local only
+	if (bind(GDBRemote_Listener, (struct sockaddr *)&sa, sizeof(sa)) || listen(GDBRemote_Listener, 1)) {
+		GDBRemote_Shutdown();
+		return 0;
+	}
+	return 1;
+}
+
+int GDBRemote_ListenUnix(const char *path)
+{
+#ifdef _WIN32
+	return 0;
+#else
+	struct sockaddr_un sa;
+
+	GDBRemote_Shutdown();
+	if (!GDBRemote_Startup()) return 0;
+	if (strlen(path) >= sizeof(sa.sun_path)) return 0;
+	GDBRemote_Listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (GDBRemote_Listener == GDBREMOTE_INVALID) return 0;
+	memset(&sa, 0, sizeof(sa));
+	sa.sun_family = AF_UNIX;
+	strcpy(sa.sun_path, path);
+	unlink(path);
+	if (bind(GDBRemote_Listener, (struct sockaddr *)&sa, sizeof(sa)) || listen(GDBRemote_Listener, 1)) {
+		GDBRemote_Shutdown();
+		return 0;
+	}
+	strcpy(GDBRemote_UnixPath, path);
+	return 1;
+#endif
+}
+
+int GDBRemote_Accept(void)
+{
+	int one = 1;
+
+	GDBRemote_Close();
+	if (GDBRemote_Listener == GDBREMOTE_INVALID) return 0;
+	GDBRemote_Client = accept(GDBRemote_Listener, NULL, NULL);
+	if (GDBRemote_Client == GDBREMOTE_INVALID) return 0;
+	// Small packets going back and forth
+	setsockopt(GDBRemote_Client, IPPROTO_TCP, TCP_NODELAY, (const char *)&one, sizeof(one));
+	GDBRemote_Ack = 1;
+	GDBRemote_RxPos = GDBRemote_RxLen = 0;
+	return 1;
+}
+
+// Get byte from client, -1 if disconnected
+static int GDBRemote_GetByte(void)
+{
+	int len;
+	if (GDBRemote_RxPos >= GDBRemote_RxLen) {
+		if (GDBRemote_Client == GDBREMOTE_INVALID) return -1;
+		len = recv(GDBRemote_Client, (char *)GDBRemote_RxBuf, sizeof(GDBRemote_RxBuf), 0);
+		if (len <= 0) return -1;
+		GDBRemote_RxPos = 0;
+		GDBRemote_RxLen = len;
+	}
+	return GDBRemote_RxBuf[GDBRemote_RxPos++];
+}
+
+static int GDBRemote_Send(const void *data, int len)
+{
+	const char *ptr = (const char *)data;
+	int res;
+	while (len > 0) {
+		res = send(GDBRemote_Client, ptr, len, 0);
+		if (res <= 0) return 0;
+		ptr += res;
+		len -= res;
+	}
+	return 1;
+}
+
+static inline int GDBRemote_HexVal(int ch)
+{
+	if ((ch >= '0') && (ch <= '9')) return ch - '0';
+	if ((ch >= 'a') && (ch <= 'f')) return ch - 'a' + 10;
+	if ((ch >= 'A') && (ch <= 'F')) return ch - 'A' + 10;
+	return -1;
+}
+
+int GDBRemote_GetPacket(char *data, int maxlen)
+{
+	int ch, len, sum, cs, overflow;
+
+	for (;;) {
+		// Skip acks and interrupts outside of packets
+		do {
+			ch = GDBRemote_GetByte();
+			if (ch < 0) return -1;
+		} while (ch != '$');
+
+		len = 0;
+		sum = 0;
+		overflow = 0;
+		for (;;) {
+			ch = GDBRemote_GetByte();
+			if (ch < 0) return -1;
+			if (ch == '#') break;
+			sum += ch;
+			if (len < maxlen - 1) data[len++] = (char)ch;
+			else overflow = 1;
+		}
+		data[len] = 0;
+		ch = GDBRemote_GetByte();
+		if (ch < 0) return -1;
+		cs = GDBRemote_HexVal(ch) << 4;
+		ch = GDBRemote_GetByte();
+		if (ch < 0) return -1;
+		cs |= GDBRemote_HexVal(ch);
+		if (GDBRemote_Ack && (cs != (sum & 0xFF))) {
+			if (!GDBRemote_Send("-", 1)) return -1;
+			continue;
+		}
+		if (GDBRemote_Ack && !GDBRemote_Send("+", 1)) return -1;
+		if (!overflow) return len;
+		// Received fine but doesn't fit, refuse it instead of truncating
+		if (!GDBRemote_PutString("E01")) return -1;
+	}
+}
+
+int GDBRemote_PutPacket(const char *data, int len)
+{
+	uint8_t *out = GDBRemote_TxBuf;
+	int i, sum = 0, ch;
+
+	if (GDBRemote_Client == GDBREMOTE_INVALID) return 0;
+	if (len > GDBREMOTE_PACKETSIZE) len = GDBREMOTE_PACKETSIZE;
+	*out++ = '$';
+	for (i=0; i<len; i++) {
+		ch = (uint8_t)data[i];
+		if ((ch == '$') || (ch == '#') || (ch == '}') || (ch == '*')) {
+			*out++ = '}';
+			sum += '}';
+			ch ^= 0x20;
+		}
+		*out++ = (uint8_t)ch;
+		sum += ch;
+	}
+	*out++ = '#';
+	*out++ = GDBRemote_Hex[(sum >> 4) & 15];
+	*out++ = GDBRemote_Hex[sum & 15];
+
+	for (;;) {
+		if (!GDBRemote_Send(GDBRemote_TxBuf, (int)(out - GDBRemote_TxBuf))) return 0;
+		if (!GDBRemote_Ack) return 1;
+		do {
+			ch = GDBRemote_GetByte();
+			if (ch < 0) return 0;
+		} while ((ch != '+') && (ch != '-'));
+		if (ch == '+') return 1;
+	}
+}
+
+int GDBRemote_PutString(const char *str)
+{
+	return GDBRemote_PutPacket(str, (int)strlen(str));
+}
+
+int GDBRemote_Interrupted(void)
+{
+	struct timeval tv;
+	fd_set fds;
+	int ch;
+
+	if (GDBRemote_Client == GDBREMOTE_INVALID) return -1;
+	for (;;) {
+		while (GDBRemote_RxPos >= GDBRemote_RxLen) {
+			FD_ZERO(&fds);
+			FD_SET(GDBRemote_Client, &fds);
+			tv.tv_sec = 0;
+			tv.tv_usec = 0;
+			if (select((int)GDBRemote_Client + 1, &fds, NULL, NULL, &tv) <= 0) return 0;
+			if (GDBRemote_GetByte() < 0) return -1;
+			GDBRemote_RxPos--;
+		}
+		ch = GDBRemote_RxBuf[GDBRemote_RxPos];
+		if (ch == 0x03) {
+			GDBRemote_RxPos++;
+			return 1;
+		}
+		// Stray acks are dropped, anything else is kept for the next packet
+		if ((ch != '+') && (ch != '-')) return 0;
+		GDBRemote_RxPos++;
+	}
+}
+
+void GDBRemote_NoAck(void)
+{
+	GDBRemote_Ack = 0;
+}
+
+void GDBRemote_Close(void)
+{
+	if (GDBRemote_Client != GDBREMOTE_INVALID) {
+		GDBRemote_CloseSocket(GDBRemote_Client);
+		GDBRemote_Client = GDBREMOTE_INVALID;
+	}
+	GDBRemote_RxPos = GDBRemote_RxLen = 0;
+}
+
+void GDBRemote_Shutdown(void)
+{
+	GDBRemote_Close();
+	if (GDBRemote_Listener != GDBREMOTE_INVALID) {
+		GDBRemote_CloseSocket(GDBRemote_Listener);
+		GDBRemote_Listener = GDBREMOTE_INVALID;
+	}
+#ifndef _WIN32
+	if (GDBRemote_UnixPath[0]) {
+		unlink(GDBRemote_UnixPath);
+		GDBRemote_UnixPath[0] = 0;
+	}
+#endif
+}
@@ -0,0 +1,64 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GDBREMOTE_H
+#define GDBREMOTE_H
+
+#include <stdint.h>
+
+// GDB remote serial protocol transport
+//
+// Listens on a local TCP port or Unix socket and serves one client at a
+// time. Packets are "$data#checksum", each one is acknowledged with '+'
+// until the client asks for no-ack mode. A 0x03 byte from the client
+// interrupts a running target. Replies are escaped, so binary data can be
+// sent as is.
+
+#define GDBREMOTE_PACKETSIZE	16384		// Maximum packet data
+
+// Listen on local TCP port, return 0 on failure
+int GDBRemote_ListenTCP(int port);
+
+// Listen on Unix socket, return 0 on failure or if unsupported
+int GDBRemote_ListenUnix(const char *path);
+
+// Wait for a client, return 0 on failure
+int GDBRemote_Accept(void);
+
+// Receive packet into data (0-terminated), return length or -1 if disconnected
+// Packets that don't fit are answered with an error and skipped
+int GDBRemote_GetPacket(char *data, int maxlen);
+
+// Send packet, return 0 if disconnected
+int GDBRemote_PutPacket(const char *data, int len);
+int GDBRemote_PutString(const char *str);
+
+// Check for interrupt without waiting
+// Return 1 if interrupted, 0 if not and -1 if disconnected
+int GDBRemote_Interrupted(void);
+
+// Stop acknowledging packets
+void GDBRemote_NoAck(void);
+
+// Close client
+void GDBRemote_Close(void);
+
+// Close client and stop listening
+void GDBRemote_Shutdown(void);
+
+#endif
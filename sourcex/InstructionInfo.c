@@ -672,7 +672,7 @@ InstructionInfo DebugCPUInstructions_CE[256] = {
 	{0x00, 3,66, 0,38, 2, 0, 0},	// CE EA "JNX2 %h"
 	{0x00, 3,67, 0,38, 2, 0, 0},	// CE EB "JNX3 %h"
 	{0x00, 3,68, 0,38, 2, 0, 0},	// CE EC "JX0 %h"
-	{0x00, 2,69, 0,38, 2, 0, 0},	// CE ED "JX1 %h"
+	{0x00, 3,69, 0,38, 2, 0, 0},	// CE ED "JX1 %h"
 	{0x00, 3,70, 0,38, 2, 0, 0},	// CE EE "JX2 %h"
 	{0x00, 3,71, 0,38, 2, 0, 0},	// CE EF "JX3 %h"
 	{0x00, 3,72, 0,38, 2, 0, 0},	// CE F0 "CALLL %h"
@@ -382,14 +382,105 @@ static int ParseOperandStringEnc(char *operand, uint32_t addr, uint8_t *data, ch
 	return 0;
 }
 
+// Assembler index
+// Candidates are chained by mnemonic hash in the same order as the
+// opcode tables are searched, each candidate once per spelling
+// (with and without size suffix).
+#define ASMINDEX_HASH	256
+#define ASMINDEX_MAX	(3 * 256 * 2)
+
+typedef struct {
+	char name[16];		// Mnemonic
+	uint8_t prefix;		// 0x00 = None, 0xCE or 0xCF
+	uint8_t code;		// Opcode
+	int next;		// Next candidate in the chain, -1 = End
+	InstructionInfo *opcode;
+} TAsmIndexItem;
+
+static char **AsmIndex_Dict = NULL;
+static int AsmIndex_Hash[ASMINDEX_HASH];
+static int AsmIndex_Tail[ASMINDEX_HASH];
+static TAsmIndexItem AsmIndex_Items[ASMINDEX_MAX];
+static int AsmIndex_NumItems = 0;
+
+static int AsmIndex_HashName(const char *name)
+{
+	uint32_t hash = 2166136261U;
+	while (*name) {
+		hash = (hash ^ (uint8_t)toupper((int)*name++)) * 16777619U;
+	}
+	return hash & (ASMINDEX_HASH - 1);
+}
+
+static void AsmIndex_Add(const char *name, uint8_t prefix, uint8_t code, InstructionInfo *opcode)
+{
+	TAsmIndexItem *item;
+	int hash;
+	if (AsmIndex_NumItems >= ASMINDEX_MAX) return;
+	item = &AsmIndex_Items[AsmIndex_NumItems];
+	strncpy(item->name, name, 15);
+	item->name[15] = 0;
+	item->prefix = prefix;
+	item->code = code;
+	item->next = -1;
+	item->opcode = opcode;
+	hash = AsmIndex_HashName(item->name);
+	if (AsmIndex_Tail[hash] < 0) AsmIndex_Hash[hash] = AsmIndex_NumItems;
+	else AsmIndex_Items[AsmIndex_Tail[hash]].next = AsmIndex_NumItems;
+	AsmIndex_Tail[hash] = AsmIndex_NumItems;
+	AsmIndex_NumItems++;
+}
+
+static void AsmIndex_AddOpcode(char **dict, uint8_t prefix, uint8_t code, InstructionInfo *opcode)
+{
+	char tmp[32];
+	strncpy(tmp, dict[opcode->opc], 15);
+	tmp[15] = 0;
+	if (opcode->opclen == 1) strcat(tmp, "b");
+	if (opcode->opclen == 2) strcat(tmp, "w");
+	AsmIndex_Add(tmp, prefix, code, opcode);
+	if (opcode->opclen) AsmIndex_Add(dict[opcode->opc], prefix, code, opcode);
+}
+
+static void AsmIndex_Build(char **dict)
+{
+	int i;
+	for (i=0; i<ASMINDEX_HASH; i++) {
+		AsmIndex_Hash[i] = -1;
+		AsmIndex_Tail[i] = -1;
+	}
+	AsmIndex_NumItems = 0;
+	for (i=0; i<256; i++) {
+		AsmIndex_AddOpcode(dict, 0x00, i, &DebugCPUInstructions_XX[i]);
+		AsmIndex_AddOpcode(dict, 0xCE, i, &DebugCPUInstructions_CE[i]);
+		AsmIndex_AddOpcode(dict, 0xCF, i, &DebugCPUInstructions_CF[i]);
+	}
+	AsmIndex_Dict = dict;
+}
+
+// Quick check of operand shape, literal text around the number must match
+static int AsmOperandShape(const char *operand, const char *pin)
+{
+	const char *num = strchr(operand, '%');
+	int prelen, postlen, pinlen;
+	if (!num) return !strcasecmp(operand, pin);
+	prelen = num - operand;
+	if (strncasecmp(operand, pin, prelen)) return 0;
+	postlen = strlen(num + 2);
+	pinlen = strlen(pin);
+	if (pinlen < (prelen + postlen)) return 0;
+	return !strcasecmp(num + 2, pin + pinlen - postlen);
+}
+
 // Assemble single opcode
 InstructionInfo *AsmSingleOpcode(char *sin, uint32_t addr, uint8_t *data, TSOpcDec *sopcdec, char *err)
 {
-	char tmp[256], *ctmp = tmp;
+	char tmp[256+8], *ctmp = tmp;
 	char opcname[256];
 	char operand1[256], operand2[256];
 	char operand3[256], operand4[256];
 	InstructionInfo *opcode;
+	TAsmIndexItem *item;
 	int i;
 
 	// Empty strings
@@ -401,7 +492,9 @@ InstructionInfo *AsmSingleOpcode(char *sin, uint32_t addr, uint8_t *data, TSOpcD
 	sprintf(err, "Error: Syntax error");
 
 	// Remove comments and trim
-	strcpy(ctmp, sin);
+	// Tokens past the end read zeros
+	memset(tmp, 0, sizeof(tmp));
+	strncpy(ctmp, sin, 255);
 	RemoveComments(ctmp);
 	ctmp = TrimStr(tmp);
 	ctmp = UpToToken(opcname, ctmp, " \t", NULL);
@@ -452,55 +545,25 @@ InstructionInfo *AsmSingleOpcode(char *sin, uint32_t addr, uint8_t *data, TSOpcD
 		return &DebugCPUInstructions_DX[i];
 	}
 
-	// Find opcode from the list
-	for (i=0; i<256; i++) {
-		// XX Opcode
-		opcode = (InstructionInfo *)&DebugCPUInstructions_XX[i];
-		strcpy(tmp, sopcdec->opcode_dict[opcode->opc]);
-		if (opcode->opclen == 1) strcat(tmp, "b");
-		if (opcode->opclen == 2) strcat(tmp, "w");
-		if ((!strcasecmp(opcname, tmp)) || (!strcasecmp(opcname, sopcdec->opcode_dict[opcode->opc]))) {
-			data[0] = i;
-			if (opcode->p1 == 0) return opcode;
-			if (ParseOperandStringEnc(sopcdec->operand_dict[opcode->p1], addr, (uint8_t *)data + opcode->p1off, operand1, opcode, sopcdec, err)) {
-				if (opcode->p2 == 0) return opcode;
-				if (ParseOperandStringEnc(sopcdec->operand_dict[opcode->p2], addr, (uint8_t *)data + opcode->p2off, operand2, opcode, sopcdec, err)) {
-					return opcode;
-				}
-			}
+	// Find opcode from the index
+	if (AsmIndex_Dict != sopcdec->opcode_dict) AsmIndex_Build(sopcdec->opcode_dict);
+	for (i = AsmIndex_Hash[AsmIndex_HashName(opcname)]; i >= 0; i = item->next) {
+		item = &AsmIndex_Items[i];
+		if (strcasecmp(opcname, item->name)) continue;
+		opcode = item->opcode;
+		if (opcode->p1 && !AsmOperandShape(sopcdec->operand_dict[opcode->p1], operand1)) continue;
+		if (opcode->p2 && !AsmOperandShape(sopcdec->operand_dict[opcode->p2], operand2)) continue;
+		if (item->prefix) {
+			data[0] = item->prefix;
+			data[1] = item->code;
+		} else {
+			data[0] = item->code;
 		}
-
-		// CE Opcode
-		opcode = (InstructionInfo *)&DebugCPUInstructions_CE[i];
-		strcpy(tmp, sopcdec->opcode_dict[opcode->opc]);
-		if (opcode->opclen == 1) strcat(tmp, "b");
-		if (opcode->opclen == 2) strcat(tmp, "w");
-		if ((!strcasecmp(opcname, tmp)) || (!strcasecmp(opcname, sopcdec->opcode_dict[opcode->opc]))) {
-			data[0] = 0xCE;
-			data[1] = i;
-			if (opcode->p1 == 0) return opcode;
-			if (ParseOperandStringEnc(sopcdec->operand_dict[opcode->p1], addr, (uint8_t *)data + opcode->p1off, operand1, opcode, sopcdec, err)) {
-				if (opcode->p2 == 0) return opcode;
-				if (ParseOperandStringEnc(sopcdec->operand_dict[opcode->p2], addr, (uint8_t *)data + opcode->p2off, operand2, opcode, sopcdec, err)) {
-					return opcode;
-				}
-			}
-		}
-
-		// CF Opcode
-		opcode = (InstructionInfo *)&DebugCPUInstructions_CF[i];
-		strcpy(tmp, sopcdec->opcode_dict[opcode->opc]);
-		if (opcode->opclen == 1) strcat(tmp, "b");
-		if (opcode->opclen == 2) strcat(tmp, "w");
-		if ((!strcasecmp(opcname, tmp)) || (!strcasecmp(opcname, sopcdec->opcode_dict[opcode->opc]))) {
-			data[0] = 0xCF;
-			data[1] = i;
-			if (opcode->p1 == 0) return opcode;
-			if (ParseOperandStringEnc(sopcdec->operand_dict[opcode->p1], addr, (uint8_t *)data + opcode->p1off, operand1, opcode, sopcdec, err)) {
-				if (opcode->p2 == 0) return opcode;
-				if (ParseOperandStringEnc(sopcdec->operand_dict[opcode->p2], addr, (uint8_t *)data + opcode->p2off, operand2, opcode, sopcdec, err)) {
-					return opcode;
-				}
+		if (opcode->p1 == 0) return opcode;
+		if (ParseOperandStringEnc(sopcdec->operand_dict[opcode->p1], addr, (uint8_t *)data + opcode->p1off, operand1, opcode, sopcdec, err)) {
+			if (opcode->p2 == 0) return opcode;
+			if (ParseOperandStringEnc(sopcdec->operand_dict[opcode->p2], addr, (uint8_t *)data + opcode->p2off, operand2, opcode, sopcdec, err)) {
+				return opcode;
 			}
 		}
 	}
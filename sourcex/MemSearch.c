@@ -0,0 +1,202 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "PokeMini.h"
+#include "MemSearch.h"
+
+// Multiplier that gathers the low bit of 8 bytes into the top byte
+#ifdef _BIG_ENDIAN
+#define MEMSEARCH_PACKMUL	0x8040201008040201ULL
+#else
+#define MEMSEARCH_PACKMUL	0x0102040810204080ULL
+#endif
+
+static int MemSearch_Size = 0;		// Bytes searched, 0 if there's no search
+static int MemSearch_Bytes = 0;		// Width of values
+static uint8_t MemSearch_Prev[MEMSEARCH_MAXSIZE + 8];
+static uint8_t MemSearch_Match[MEMSEARCH_MAXSIZE + 8];
+static uint32_t MemSearch_Bits[MEMSEARCH_MAXSIZE / 32];
+
+#define MEMSEARCH_LOAD8(p, i)	(p)[i]
+#define MEMSEARCH_LOAD16(p, i)	(uint16_t)((p)[i] | ((p)[(i)+1] << 8))
+
+// Compare loop per comparison, one per width and reference so the
+// compiler can vectorize each of them
+#define MEMSEARCH_KERNEL(LOAD, REF) \
+	switch (cmp) { \
+		case MEMSEARCH_EQUAL: \
+			for (i=0; i<n; i++) match[i] = LOAD(cur, i) == (REF); \
+			break; \
+		case MEMSEARCH_NOTEQUAL: \
+			for (i=0; i<n; i++) match[i] = LOAD(cur, i) != (REF); \
+			break; \
+		case MEMSEARCH_GREATER: \
+			for (i=0; i<n; i++) match[i] = LOAD(cur, i) > (REF); \
+			break; \
+		case MEMSEARCH_LESS: \
+			for (i=0; i<n; i++) match[i] = LOAD(cur, i) < (REF); \
+			break; \
+		case MEMSEARCH_GREATEREQ: \
+			for (i=0; i<n; i++) match[i] = LOAD(cur, i) >= (REF); \
+			break; \
+		case MEMSEARCH_LESSEQ: \
+			for (i=0; i<n; i++) match[i] = LOAD(cur, i) <= (REF); \
+			break; \
+		default: \
+			return 0; \
+	}
+
+static int MemSearch_Compare8(uint8_t *match, const uint8_t *cur, const uint8_t *prev, int n, int cmp, int ref, int32_t operand)
+{
+	uint8_t op = (uint8_t)operand;
+	int i;
+	if (ref == MEMSEARCH_VALUE) {
+		MEMSEARCH_KERNEL(MEMSEARCH_LOAD8, op)
+	} else {
+		MEMSEARCH_KERNEL(MEMSEARCH_LOAD8, (uint8_t)(prev[i] + op))
+	}
+	return 1;
+}
+
+static int MemSearch_Compare16(uint8_t *match, const uint8_t *cur, const uint8_t *prev, int n, int cmp, int ref, int32_t operand)
+{
+	uint16_t op = (uint16_t)operand;
+	int i;
+	if (ref == MEMSEARCH_VALUE) {
+		MEMSEARCH_KERNEL(MEMSEARCH_LOAD16, op)
+	} else {
+		MEMSEARCH_KERNEL(MEMSEARCH_LOAD16, (uint16_t)(MEMSEARCH_LOAD16(prev, i) + op))
+	}
+	return 1;
+}
+
+// Pack 8 match bytes (0 or 1) into 8 bits, first byte in bit 0
+static inline uint32_t MemSearch_Pack8(const uint8_t *match)
+{
+	uint64_t val;
+	memcpy(&val, match, 8);
+	return (uint32_t)((val * MEMSEARCH_PACKMUL) >> 56);
+}
+
+static inline int MemSearch_PopCount(uint32_t val)
+{
+	val = val - ((val >> 1) & 0x55555555);
+	val = (val & 0x33333333) + ((val >> 2) & 0x33333333);
+	val = (val + (val >> 4)) & 0x0F0F0F0F;
+	return (int)((val * 0x01010101) >> 24);
+}
+
+// Start new search with all addresses as candidates
+int MemSearch_Start(int width, int withio)
+{
+	if ((width != 1) && (width != 2)) return 0;
+	MemSearch_Bytes = width;
+	MemSearch_Size = withio ? MEMSEARCH_MAXSIZE : MEMSEARCH_RAMSIZE;
+	memset(MemSearch_Bits, 0xFF, sizeof(MemSearch_Bits));
+	memset(MemSearch_Bits + MemSearch_Size / 32, 0, sizeof(MemSearch_Bits) - MemSearch_Size / 8);
+	if (width == 2) MemSearch_Bits[MemSearch_Size / 32 - 1] &= 0x7FFFFFFF;	// Last byte has no pair
+	MemSearch_Snapshot();
+	return 1;
+}
+
+// Take snapshot for next MEMSEARCH_PREVIOUS comparison
+void MemSearch_Snapshot(void)
+{
+	if (!MemSearch_Size) return;
+	memcpy(MemSearch_Prev, PM_RAM, MemSearch_Size);
+}
+
+// Remove candidates that fail the comparison and take snapshot
+int MemSearch_Filter(int cmp, int ref, int32_t operand)
+{
+	int i, n = MemSearch_Size;
+	uint32_t bits;
+
+	if (!n) return -1;
+	if (MemSearch_Bytes == 2) {
+		n--;
+		if (!MemSearch_Compare16(MemSearch_Match, PM_RAM, MemSearch_Prev, n, cmp, ref, operand)) return -1;
+	} else {
+		if (!MemSearch_Compare8(MemSearch_Match, PM_RAM, MemSearch_Prev, n, cmp, ref, operand)) return -1;
+	}
+	memset(MemSearch_Match + n, 0, MemSearch_Size - n);
+	for (i=0; i<MemSearch_Size/32; i++) {
+		if (!MemSearch_Bits[i]) continue;
+		bits = MemSearch_Pack8(MemSearch_Match + i*32);
+		bits |= MemSearch_Pack8(MemSearch_Match + i*32 + 8) << 8;
+		bits |= MemSearch_Pack8(MemSearch_Match + i*32 + 16) << 16;
+		bits |= MemSearch_Pack8(MemSearch_Match + i*32 + 24) << 24;
+		MemSearch_Bits[i] &= bits;
+	}
+	MemSearch_Snapshot();
+	return MemSearch_Count();
+}
+
+// Number of candidates
+int MemSearch_Count(void)
+{
+	int i, count = 0;
+	for (i=0; i<MemSearch_Size/32; i++) count += MemSearch_PopCount(MemSearch_Bits[i]);
+	return count;
+}
+
+// Next candidate index starting at index, -1 if there's none
+int MemSearch_Next(int index)
+{
+	uint32_t bits;
+	if (index < 0) index = 0;
+	while (index < MemSearch_Size) {
+		bits = MemSearch_Bits[index >> 5] >> (index & 31);
+		if (bits) {
+			while (!(bits & 1)) {
+				bits >>= 1;
+				index++;
+			}
+			return index;
+		}
+		index = (index | 31) + 1;
+	}
+	return -1;
+}
+
+// Address, current value and snapshot value of candidate index
+uint32_t MemSearch_Address(int index)
+{
+	return 0x1000 + index;
+}
+
+uint32_t MemSearch_Value(int index)
+{
+	if (MemSearch_Bytes == 2) return MEMSEARCH_LOAD16(PM_RAM, index);
+	return PM_RAM[index];
+}
+
+uint32_t MemSearch_PrevValue(int index)
+{
+	if (MemSearch_Bytes == 2) return MEMSEARCH_LOAD16(MemSearch_Prev, index);
+	return MemSearch_Prev[index];
+}
+
+// Width of current search, 0 if none
+int MemSearch_Width(void)
+{
+	return MemSearch_Size ? MemSearch_Bytes : 0;
+}
@@ -0,0 +1,77 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MEMSEARCH_H
+#define MEMSEARCH_H
+
+#include <stdint.h>
+
+// RAM search
+//
+// Narrows down addresses by comparing RAM against the snapshot taken at the
+// last search step (or MemSearch_Snapshot) or against a constant. Candidates
+// are kept in a bitmap, the compare loops are plain per-byte loops the
+// compiler turns into SIMD and the results are packed 8 bytes at a time.
+// Index 0 is $001000, with I/O included the indexes $1000-$10FF are $002000.
+
+#define MEMSEARCH_RAMSIZE	0x1000
+#define MEMSEARCH_MAXSIZE	0x1100
+
+// Reference value
+enum {
+	MEMSEARCH_PREVIOUS = 0,		// Snapshot value plus operand
+	MEMSEARCH_VALUE			// Operand
+};
+
+// Comparison of current value against reference
+enum {
+	MEMSEARCH_EQUAL = 0,
+	MEMSEARCH_NOTEQUAL,
+	MEMSEARCH_GREATER,
+	MEMSEARCH_LESS,
+	MEMSEARCH_GREATEREQ,
+	MEMSEARCH_LESSEQ
+};
+
+// Start new search with all addresses as candidates
+// width is 1 or 2 bytes (16-bits little-endian), withio includes I/O page
+int MemSearch_Start(int width, int withio);
+
+// Take snapshot for next MEMSEARCH_PREVIOUS comparison
+void MemSearch_Snapshot(void);
+
+// Remove candidates that fail the comparison and take snapshot
+// ie: increased by 1 = (MEMSEARCH_EQUAL, MEMSEARCH_PREVIOUS, 1)
+// Return number of candidates left or -1 if there's no search
+int MemSearch_Filter(int cmp, int ref, int32_t operand);
+
+// Number of candidates
+int MemSearch_Count(void);
+
+// Next candidate index starting at index, -1 if there's none
+int MemSearch_Next(int index);
+
+// Address, current value and snapshot value of candidate index
+uint32_t MemSearch_Address(int index);
+uint32_t MemSearch_Value(int index);
+uint32_t MemSearch_PrevValue(int index);
+
+// Width of current search, 0 if none
+int MemSearch_Width(void);
+
+#endif
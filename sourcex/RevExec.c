@@ -0,0 +1,265 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "PokeMini.h"
+#include "RevExec.h"
+
+int RevExec_Enabled = 0;
+int RevExec_Replaying = 0;
+uint64_t RevExec_Pos = 0;
+uint64_t RevExec_NextSnap = 0;
+
+typedef struct {
+	uint64_t step;
+	uint8_t key;
+	uint8_t pressed;
+} TRevExecEvent;
+
+// Snapshot ring
+static TPokeMini_Snapshot *RevExec_Snaps = NULL;
+static uint64_t *RevExec_SnapPos = NULL;
+static uint64_t *RevExec_SnapCycles = NULL;
+static int RevExec_MaxSnaps = 0;
+static int RevExec_SnapFirst = 0;
+static int RevExec_SnapNum = 0;
+static int RevExec_SnapInterval = 4096;
+static uint64_t *RevExec_Cycles = NULL;
+
+// Input log, sorted by step
+static TRevExecEvent *RevExec_Events = NULL;
+static int RevExec_EventNum = 0;
+static int RevExec_EventMax = 0;
+
+// Ring index of the nth snapshot (0 = oldest)
+static inline int RevExec_SnapIdx(int n)
+{
+	return (RevExec_SnapFirst + n) % RevExec_MaxSnaps;
+}
+
+int RevExec_Start(int maxsnaps, uint64_t *cycles)
+{
+	RevExec_Stop();
+	if (maxsnaps < 2) maxsnaps = 2;
+	RevExec_Snaps = (TPokeMini_Snapshot *)malloc(maxsnaps * sizeof(TPokeMini_Snapshot));
+	RevExec_SnapPos = (uint64_t *)malloc(maxsnaps * sizeof(uint64_t));
+	RevExec_SnapCycles = (uint64_t *)malloc(maxsnaps * sizeof(uint64_t));
+	if (!RevExec_Snaps || !RevExec_SnapPos || !RevExec_SnapCycles) {
+		RevExec_Stop();
+		return 0;
+	}
+	RevExec_MaxSnaps = maxsnaps;
+	RevExec_Cycles = cycles;
+	RevExec_Enabled = 1;
+	RevExec_Restart();
+	return 1;
+}
+
+void RevExec_Stop(void)
+{
+	RevExec_Enabled = 0;
+	RevExec_Replaying = 0;
+	if (RevExec_Snaps) free(RevExec_Snaps);
+	if (RevExec_SnapPos) free(RevExec_SnapPos);
+	if (RevExec_SnapCycles) free(RevExec_SnapCycles);
+	if (RevExec_Events) free(RevExec_Events);
+	RevExec_Snaps = NULL;
+	RevExec_SnapPos = NULL;
+	RevExec_SnapCycles = NULL;
+	RevExec_Events = NULL;
+	RevExec_MaxSnaps = 0;
+	RevExec_SnapNum = 0;
+	RevExec_EventNum = 0;
+	RevExec_EventMax = 0;
+	RevExec_Cycles = NULL;
+}
+
+void RevExec_Restart(void)
+{
+	if (!RevExec_Enabled) return;
+	RevExec_SnapFirst = 0;
+	RevExec_SnapNum = 0;
+	RevExec_EventNum = 0;
+	RevExec_Pos = 0;
+	RevExec_Snapshot();
+}
+
+void RevExec_Snapshot(void)
+{
+	int i, idx;
+
+	if (!RevExec_Enabled) return;
+
+	// Drop oldest snapshot and the input before it
+	if (RevExec_SnapNum >= RevExec_MaxSnaps) {
+		RevExec_SnapFirst = RevExec_SnapIdx(1);
+		RevExec_SnapNum--;
+		for (i=0; i<RevExec_EventNum; i++) {
+			if (RevExec_Events[i].step >= RevExec_SnapPos[RevExec_SnapFirst]) break;
+		}
+		if (i) {
+			RevExec_EventNum -= i;
+			memmove(RevExec_Events, RevExec_Events + i, RevExec_EventNum * sizeof(TRevExecEvent));
+		}
+	}
+
+	idx = RevExec_SnapIdx(RevExec_SnapNum++);
+	PokeMini_SaveSnapshot(&RevExec_Snaps[idx]);
+	RevExec_SnapPos[idx] = RevExec_Pos;
+	RevExec_SnapCycles[idx] = RevExec_Cycles ? *RevExec_Cycles : 0;
+	RevExec_NextSnap = RevExec_Pos + RevExec_SnapInterval;
+}
+
+void RevExec_KeypadEvent(uint8_t key, int pressed)
+{
+	TRevExecEvent *events;
+
+	if (RevExec_Enabled && !RevExec_Replaying) {
+		if (RevExec_EventNum >= RevExec_EventMax) {
+			events = (TRevExecEvent *)realloc(RevExec_Events, (RevExec_EventMax + 256) * sizeof(TRevExecEvent));
+			if (events) {
+				RevExec_Events = events;
+				RevExec_EventMax += 256;
+			}
+		}
+		if (RevExec_EventNum < RevExec_EventMax) {
+			RevExec_Events[RevExec_EventNum].step = RevExec_Pos;
+			RevExec_Events[RevExec_EventNum].key = key;
+			RevExec_Events[RevExec_EventNum].pressed = (uint8_t)pressed;
+			RevExec_EventNum++;
+		}
+	}
+	MinxIO_Keypad(key, pressed);
+}
+
+uint64_t RevExec_Oldest(void)
+{
+	if (!RevExec_SnapNum) return RevExec_Pos;
+	return RevExec_SnapPos[RevExec_SnapFirst];
+}
+
+int RevExec_Interval(void)
+{
+	return RevExec_SnapInterval;
+}
+
+// Load nth snapshot and run until step end, replaying input
+// Return the last step that trapped or -1
+static int64_t RevExec_Replay(TRevExecStepCB step, int n, uint64_t end)
+{
+	int idx = RevExec_SnapIdx(n);
+	int64_t trap = -1;
+	int ev;
+
+	PokeMini_LoadSnapshot(&RevExec_Snaps[idx]);
+	if (RevExec_Cycles) *RevExec_Cycles = RevExec_SnapCycles[idx];
+	RevExec_Pos = RevExec_SnapPos[idx];
+	for (ev=0; ev<RevExec_EventNum; ev++) {
+		if (RevExec_Events[ev].step >= RevExec_Pos) break;
+	}
+	RevExec_Replaying = 1;
+	while (RevExec_Pos < end) {
+		while ((ev < RevExec_EventNum) && (RevExec_Events[ev].step == RevExec_Pos)) {
+			MinxIO_Keypad(RevExec_Events[ev].key, RevExec_Events[ev].pressed);
+			ev++;
+		}
+		if (step()) trap = (int64_t)RevExec_Pos;
+		RevExec_Pos++;
+	}
+	RevExec_Replaying = 0;
+	return trap;
+}
+
+// Adapt snapshot interval to the replay speed
+static void RevExec_Tune(uint64_t steps, clock_t elapsed)
+{
+	double rate;
+
+	if ((steps < REVEXEC_MININTERVAL) || (elapsed <= 0)) return;
+	rate = (double)steps * CLOCKS_PER_SEC / (double)elapsed;
+	rate = rate * REVEXEC_LATENCY_US / 1000000.0;
+	if (rate < REVEXEC_MININTERVAL) rate = REVEXEC_MININTERVAL;
+	if (rate > REVEXEC_MAXINTERVAL) rate = REVEXEC_MAXINTERVAL;
+	RevExec_SnapInterval = (int)rate;
+}
+
+int RevExec_Goto(TRevExecStepCB step, uint64_t pos)
+{
+	int n, i;
+	clock_t start;
+
+	if (!RevExec_Enabled || !RevExec_SnapNum) return 0;
+	if ((pos > RevExec_Pos) || (pos < RevExec_Oldest())) return 0;
+
+	// Nearest snapshot before target
+	for (n=RevExec_SnapNum-1; n>0; n--) {
+		if (RevExec_SnapPos[RevExec_SnapIdx(n)] <= pos) break;
+	}
+	start = clock();
+	RevExec_Replay(step, n, pos);
+	RevExec_Tune(pos - RevExec_SnapPos[RevExec_SnapIdx(n)], clock() - start);
+
+	// Future is gone
+	RevExec_SnapNum = n + 1;
+	for (i=0; i<RevExec_EventNum; i++) {
+		if (RevExec_Events[i].step >= pos) break;
+	}
+	RevExec_EventNum = i;
+	RevExec_NextSnap = RevExec_SnapPos[RevExec_SnapIdx(n)] + RevExec_SnapInterval;
+	if (RevExec_NextSnap <= RevExec_Pos) RevExec_Snapshot();
+	return 1;
+}
+
+int RevExec_StepBack(TRevExecStepCB step, uint64_t steps)
+{
+	uint64_t oldest = RevExec_Oldest();
+
+	if (!RevExec_Enabled) return 0;
+	if (RevExec_Pos - oldest < steps) {
+		RevExec_Goto(step, oldest);
+		return 0;
+	}
+	return RevExec_Goto(step, RevExec_Pos - steps);
+}
+
+int RevExec_ContinueBack(TRevExecStepCB step)
+{
+	uint64_t cur = RevExec_Pos, end, spos;
+	int64_t trap;
+	int n;
+
+	if (!RevExec_Enabled || !RevExec_SnapNum) return 0;
+
+	// A trap in step p stops execution at p+1, the current position
+	// is usually a stop so look for traps before cur-1
+	for (n=RevExec_SnapNum-1; n>=0; n--) {
+		spos = RevExec_SnapPos[RevExec_SnapIdx(n)];
+		if (spos + 1 >= cur) continue;
+		end = cur - 1;
+		if ((n < RevExec_SnapNum-1) && (RevExec_SnapPos[RevExec_SnapIdx(n+1)] < end)) {
+			end = RevExec_SnapPos[RevExec_SnapIdx(n+1)];
+		}
+		trap = RevExec_Replay(step, n, end);
+		if (trap >= 0) return RevExec_Goto(step, (uint64_t)trap + 1);
+	}
+	RevExec_Pos = cur;
+	RevExec_Goto(step, RevExec_Oldest());
+	return 0;
+}
@@ -0,0 +1,95 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef REVEXEC_H
+#define REVEXEC_H
+
+#include <stdint.h>
+
+// Reverse execution
+//
+// While recording, a snapshot of the machine is taken every few thousand
+// steps (instruction or PRC stall) and keypad input is logged with the
+// step it happened at. Going back restores the nearest snapshot before the
+// target and runs forward again through the step callback, replaying the
+// input. The interval follows the measured replay speed so going back
+// costs about REVEXEC_LATENCY_US, the oldest snapshots are dropped when
+// the ring is full. Replay must run the same hardware sync as recording,
+// the host is responsible for that.
+
+#define REVEXEC_LATENCY_US	2000		// Target replay time
+#define REVEXEC_MININTERVAL	256		// Steps between snapshots
+#define REVEXEC_MAXINTERVAL	1048576
+#define REVEXEC_DEFSNAPS	256		// Default ring size (~8MB)
+
+// Execute one step, return 1 if it hit a breakpoint or watchpoint
+typedef int (*TRevExecStepCB)(void);
+
+// Recording history
+extern int RevExec_Enabled;
+
+// Re-executing history, host should be silent
+extern int RevExec_Replaying;
+
+// Steps executed since recording started
+extern uint64_t RevExec_Pos;
+
+// Step of the next snapshot
+extern uint64_t RevExec_NextSnap;
+
+// Start recording with a ring of maxsnaps snapshots, cycles (if not NULL)
+// is saved and restored with the snapshots, return 0 on failure
+int RevExec_Start(int maxsnaps, uint64_t *cycles);
+
+// Stop recording and free history
+void RevExec_Stop(void);
+
+// Drop history and start again from the current state
+void RevExec_Restart(void);
+
+// Take snapshot at the current step
+void RevExec_Snapshot(void);
+
+// Call after each step
+static inline void RevExec_Record(void)
+{
+	if (!RevExec_Enabled || RevExec_Replaying) return;
+	if (++RevExec_Pos >= RevExec_NextSnap) RevExec_Snapshot();
+}
+
+// Keypad event, logged and sent to the hardware
+// Use as PokeMini_CustomKeypadEvent while recording
+void RevExec_KeypadEvent(uint8_t key, int pressed);
+
+// First step in history
+uint64_t RevExec_Oldest(void);
+
+// Current interval between snapshots
+int RevExec_Interval(void);
+
+// Go to step, history after it is dropped, return 0 if out of history
+int RevExec_Goto(TRevExecStepCB step, uint64_t pos);
+
+// Go back the number of steps, return 0 if out of history
+int RevExec_StepBack(TRevExecStepCB step, uint64_t steps);
+
+// Go back to the previous breakpoint or watchpoint hit
+// Return 1 if found, 0 if it stopped at the oldest step
+int RevExec_ContinueBack(TRevExecStepCB step);
+
+#endif
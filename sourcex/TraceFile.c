@@ -0,0 +1,647 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+#include "TraceFile.h"
+#include "PMCommon.h"
+
+// Raw block size, flushed when it can't hold another entry
+#define TRACEFILE_BLOCKSIZE	(256*1024)
+#define TRACEFILE_ENTRYMAX	(32 + TRACEREG_NUM + TRACEFILE_MAXACCESS * 6)
+
+// Number of blocks in flight between emulator and writer thread
+#define TRACEFILE_BUFFERS	4
+
+// Large file offsets
+#ifdef _WIN32
+#define TraceFile_Seek(f, o)	_fseeki64(f, o, SEEK_SET)
+#define TraceFile_Tell(f)	_ftelli64(f)
+#else
+#define TraceFile_Seek(f, o)	fseeko(f, o, SEEK_SET)
+#define TraceFile_Tell(f)	ftello(f)
+#endif
+
+// Entry head byte
+#define TRACEHEAD_OPLEN		0x07
+#define TRACEHEAD_JUMP		0x08
+#define TRACEHEAD_REGS		0x10
+#define TRACEHEAD_ACCESS	0x20
+#define TRACEHEAD_STATUS	6
+
+// Delta encoder/decoder state, reset at each block
+typedef struct {
+	uint64_t cycle;
+	uint32_t nextpc;
+	uint32_t lastaddr;
+	uint8_t regs[TRACEREG_NUM];
+} TTraceState;
+
+typedef struct {
+	uint8_t *data;
+	int size;
+	int entries;
+	uint64_t startcycle;
+} TTraceBlock;
+
+struct TTraceWriter {
+	FILE *fo;
+	TTraceBlock block[TRACEFILE_BUFFERS];
+	int fill;			// Block being filled by the emulator
+	TTraceState state;
+	uint8_t *packed;
+	uLong packedsize;
+	uint64_t *idxoffset;
+	uint64_t *idxcycle;
+	int numblocks, allocblocks;
+	int error;
+	int failed;			// Copy of error taken by the emulator side
+#ifdef MULTITHREAD
+	PMThread thread;
+	PMMutex mutex;
+	PMCond cond;
+	int head, count;		// Blocks queued for the writer thread
+	int quit;
+#endif
+};
+
+struct TTraceReader {
+	FILE *fi;
+	uint64_t *idxoffset;
+	uint64_t *idxcycle;
+	int numblocks;
+	int block;			// Current block, -1 if none
+	uint8_t *raw;
+	int rawsize, rawalloc;
+	uint8_t *packed;
+	int packedalloc;
+	int pos, entries;
+	TTraceState state;
+	TTraceEntry pending;		// Entry found by seek
+	int haspending;
+};
+
+// -------
+// Helpers
+// -------
+
+static void PutU32(uint8_t *p, uint32_t v)
+{
+	p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8);
+	p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+static void PutU64(uint8_t *p, uint64_t v)
+{
+	PutU32(p, (uint32_t)v);
+	PutU32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint32_t GetU32(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t GetU64(const uint8_t *p)
+{
+	return GetU32(p) | ((uint64_t)GetU32(p + 4) << 32);
+}
+
+static int PutVarint(uint8_t *p, uint32_t v)
+{
+	int len = 0;
+	while (v >= 0x80) {
+		p[len++] = (uint8_t)v | 0x80;
+		v >>= 7;
+	}
+	p[len++] = (uint8_t)v;
+	return len;
+}
+
+static uint32_t GetVarint(const uint8_t *p, int *pos, int size)
+{
+	uint32_t v = 0;
+	int shift = 0;
+	while (*pos < size && shift < 32) {
+		uint8_t b = p[(*pos)++];
+		v |= (uint32_t)(b & 0x7F) << shift;
+		if (!(b & 0x80)) break;
+		shift += 7;
+	}
+	return v;
+}
+
+static uint32_t ZigZag(int32_t v)
+{
+	return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t UnZigZag(uint32_t v)
+{
+	return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static void ResetState(TTraceState *st, uint64_t cycle)
+{
+	memset(st, 0, sizeof(TTraceState));
+	st->cycle = cycle;
+}
+
+// ------
+// Writer
+// ------
+
+// Compress and write a block, called from the writer thread
+static int WriteBlock(TTraceWriter *tw, TTraceBlock *blk)
+{
+	uint8_t hdr[24];
+	uLongf packedlen = tw->packedsize;
+	if (tw->error) return 0;
+	if (compress2(tw->packed, &packedlen, blk->data, blk->size, 1) != Z_OK) {
+		tw->error = 1;
+		return 0;
+	}
+	if (tw->numblocks >= tw->allocblocks) {
+		int alloc = tw->allocblocks ? tw->allocblocks * 2 : 256;
+		uint64_t *noffset = (uint64_t *)realloc(tw->idxoffset, alloc * sizeof(uint64_t));
+		uint64_t *ncycle;
+		if (noffset) tw->idxoffset = noffset;
+		ncycle = (uint64_t *)realloc(tw->idxcycle, alloc * sizeof(uint64_t));
+		if (ncycle) tw->idxcycle = ncycle;
+		if (!noffset || !ncycle) {
+			tw->error = 1;
+			return 0;
+		}
+		tw->allocblocks = alloc;
+	}
+	tw->idxoffset[tw->numblocks] = TraceFile_Tell(tw->fo);
+	tw->idxcycle[tw->numblocks] = blk->startcycle;
+	tw->numblocks++;
+	memcpy(hdr, "TBLK", 4);
+	PutU64(hdr + 4, blk->startcycle);
+	PutU32(hdr + 12, blk->entries);
+	PutU32(hdr + 16, blk->size);
+	PutU32(hdr + 20, packedlen);
+	if (fwrite(hdr, 1, 24, tw->fo) != 24) tw->error = 1;
+	else if (fwrite(tw->packed, 1, packedlen, tw->fo) != packedlen) tw->error = 1;
+	return !tw->error;
+}
+
+#ifdef MULTITHREAD
+
+static int TraceWriter_Thread(void *data)
+{
+	TTraceWriter *tw = (TTraceWriter *)data;
+	int index;
+	PMMutex_Lock(&tw->mutex);
+	for (;;) {
+		while (!tw->count && !tw->quit) PMCond_Wait(&tw->cond, &tw->mutex);
+		if (!tw->count) break;
+		index = tw->head;
+		PMMutex_Unlock(&tw->mutex);
+		WriteBlock(tw, &tw->block[index]);
+		PMMutex_Lock(&tw->mutex);
+		tw->head = (tw->head + 1) % TRACEFILE_BUFFERS;
+		tw->count--;
+		PMCond_Broadcast(&tw->cond);
+	}
+	PMMutex_Unlock(&tw->mutex);
+	return 1;
+}
+
+#endif
+
+// Hand the filled block to the writer and start a new one
+static void FlushBlock(TTraceWriter *tw)
+{
+	TTraceBlock *blk = &tw->block[tw->fill];
+	if (!blk->entries) return;
+#ifdef MULTITHREAD
+	PMMutex_Lock(&tw->mutex);
+	while (tw->count >= TRACEFILE_BUFFERS - 1) PMCond_Wait(&tw->cond, &tw->mutex);
+	tw->count++;
+	tw->fill = (tw->head + tw->count) % TRACEFILE_BUFFERS;
+	tw->failed = tw->error;
+	PMCond_Broadcast(&tw->cond);
+	PMMutex_Unlock(&tw->mutex);
+	blk = &tw->block[tw->fill];
+#else
+	WriteBlock(tw, blk);
+	tw->failed = tw->error;
+#endif
+	blk->size = 0;
+	blk->entries = 0;
+}
+
+TTraceWriter *TraceWriter_Open(const char *filename)
+{
+	TTraceWriter *tw;
+	uint8_t hdr[12];
+	int i;
+
+	tw = (TTraceWriter *)malloc(sizeof(TTraceWriter));
+	if (!tw) return NULL;
+	memset(tw, 0, sizeof(TTraceWriter));
+	tw->packedsize = compressBound(TRACEFILE_BLOCKSIZE);
+	tw->packed = (uint8_t *)malloc(tw->packedsize);
+	for (i=0; i<TRACEFILE_BUFFERS; i++) {
+		tw->block[i].data = (uint8_t *)malloc(TRACEFILE_BLOCKSIZE);
+		if (!tw->block[i].data) tw->error = 1;
+	}
+	if (!tw->packed || tw->error) {
+		for (i=0; i<TRACEFILE_BUFFERS; i++) free(tw->block[i].data);
+		free(tw->packed);
+		free(tw);
+		return NULL;
+	}
+
+	tw->fo = fopen(filename, "wb");
+	if (!tw->fo) {
+		for (i=0; i<TRACEFILE_BUFFERS; i++) free(tw->block[i].data);
+		free(tw->packed);
+		free(tw);
+		return NULL;
+	}
+	memcpy(hdr, "PMTRACE", 8);
+	PutU32(hdr + 8, TRACEFILE_VERSION);
+	fwrite(hdr, 1, 12, tw->fo);
+
+#ifdef MULTITHREAD
+	PMMutex_Init(&tw->mutex);
+	PMCond_Init(&tw->cond);
+	if (!PMThread_Create(&tw->thread, TraceWriter_Thread, tw)) {
+		PMCond_Destroy(&tw->cond);
+		PMMutex_Destroy(&tw->mutex);
+		fclose(tw->fo);
+		for (i=0; i<TRACEFILE_BUFFERS; i++) free(tw->block[i].data);
+		free(tw->packed);
+		free(tw);
+		return NULL;
+	}
+#endif
+
+	return tw;
+}
+
+int TraceWriter_Add(TTraceWriter *tw, const TTraceEntry *entry)
+{
+	TTraceBlock *blk = &tw->block[tw->fill];
+	TTraceState *st = &tw->state;
+	uint8_t *p, *head;
+	uint16_t mask = 0;
+	int i, numaccess;
+
+	// Writer thread owns error, only check the copy taken on flush
+	if (tw->failed) return 0;
+
+	// New block when full or when cycles are not continuous
+	if (blk->entries && ((blk->size > TRACEFILE_BLOCKSIZE - TRACEFILE_ENTRYMAX) || (entry->cycle != st->cycle))) {
+		FlushBlock(tw);
+		blk = &tw->block[tw->fill];
+	}
+	if (!blk->entries) {
+		blk->startcycle = entry->cycle;
+		ResetState(st, entry->cycle);
+	}
+
+	p = blk->data + blk->size;
+	head = p++;
+	*head = (entry->oplen & TRACEHEAD_OPLEN) | (entry->status << TRACEHEAD_STATUS);
+	p += PutVarint(p, entry->cycles);
+	if (entry->pc != st->nextpc) {
+		*head |= TRACEHEAD_JUMP;
+		p += PutVarint(p, ZigZag((int32_t)(entry->pc - st->nextpc)));
+	}
+	for (i=0; i<(entry->oplen & TRACEHEAD_OPLEN); i++) *p++ = entry->opcode[i];
+	for (i=0; i<TRACEREG_NUM; i++) {
+		if (entry->regs[i] != st->regs[i]) mask |= (1 << i);
+	}
+	if (mask) {
+		*head |= TRACEHEAD_REGS;
+		*p++ = (uint8_t)mask;
+		*p++ = (uint8_t)(mask >> 8);
+		for (i=0; i<TRACEREG_NUM; i++) {
+			if (mask & (1 << i)) *p++ = st->regs[i] = entry->regs[i];
+		}
+	}
+	numaccess = entry->numaccess;
+	if (numaccess > TRACEFILE_MAXACCESS) numaccess = TRACEFILE_MAXACCESS;
+	if (numaccess > 0) {
+		*head |= TRACEHEAD_ACCESS;
+		*p++ = (uint8_t)numaccess;
+		for (i=0; i<numaccess; i++) {
+			const TTraceAccess *acc = &entry->access[i];
+			p += PutVarint(p, (ZigZag((int32_t)(acc->addr - st->lastaddr)) << 1) | (acc->write ? 1 : 0));
+			*p++ = acc->data;
+			st->lastaddr = acc->addr;
+		}
+	}
+
+	st->nextpc = entry->pc + (entry->oplen & TRACEHEAD_OPLEN);
+	st->cycle = entry->cycle + entry->cycles;
+	blk->size = (int)(p - blk->data);
+	blk->entries++;
+
+	return 1;
+}
+
+int TraceWriter_Close(TTraceWriter *tw)
+{
+	uint8_t tmp[16];
+	uint64_t idxoffset;
+	int i, success;
+
+	if (!tw) return 0;
+	FlushBlock(tw);
+#ifdef MULTITHREAD
+	PMMutex_Lock(&tw->mutex);
+	tw->quit = 1;
+	PMCond_Broadcast(&tw->cond);
+	PMMutex_Unlock(&tw->mutex);
+	PMThread_Join(tw->thread);
+	PMCond_Destroy(&tw->cond);
+	PMMutex_Destroy(&tw->mutex);
+#endif
+
+	// Block index and footer
+	if (!tw->error) {
+		idxoffset = TraceFile_Tell(tw->fo);
+		memcpy(tmp, "TIDX", 4);
+		PutU32(tmp + 4, tw->numblocks);
+		fwrite(tmp, 1, 8, tw->fo);
+		for (i=0; i<tw->numblocks; i++) {
+			PutU64(tmp, tw->idxoffset[i]);
+			PutU64(tmp + 8, tw->idxcycle[i]);
+			fwrite(tmp, 1, 16, tw->fo);
+		}
+		PutU64(tmp, idxoffset);
+		memcpy(tmp + 8, "TEND", 4);
+		if (fwrite(tmp, 1, 12, tw->fo) != 12) tw->error = 1;
+	}
+	if (fclose(tw->fo)) tw->error = 1;
+	success = !tw->error;
+
+	for (i=0; i<TRACEFILE_BUFFERS; i++) free(tw->block[i].data);
+	free(tw->packed);
+	free(tw->idxoffset);
+	free(tw->idxcycle);
+	free(tw);
+
+	return success;
+}
+
+// ------
+// Reader
+// ------
+
+static int AddIndex(TTraceReader *tr, int *alloc, uint64_t offset, uint64_t cycle)
+{
+	if (tr->numblocks >= *alloc) {
+		int nalloc = *alloc ? *alloc * 2 : 256;
+		uint64_t *noffset = (uint64_t *)realloc(tr->idxoffset, nalloc * sizeof(uint64_t));
+		uint64_t *ncycle;
+		if (noffset) tr->idxoffset = noffset;
+		ncycle = (uint64_t *)realloc(tr->idxcycle, nalloc * sizeof(uint64_t));
+		if (ncycle) tr->idxcycle = ncycle;
+		if (!noffset || !ncycle) return 0;
+		*alloc = nalloc;
+	}
+	tr->idxoffset[tr->numblocks] = offset;
+	tr->idxcycle[tr->numblocks] = cycle;
+	tr->numblocks++;
+	return 1;
+}
+
+// Read index from footer
+static int ReadIndex(TTraceReader *tr)
+{
+	uint8_t tmp[16];
+	uint64_t idxoffset;
+	int i, num, alloc = 0;
+
+	if (fseek(tr->fi, -12, SEEK_END)) return 0;
+	if (fread(tmp, 1, 12, tr->fi) != 12) return 0;
+	if (memcmp(tmp + 8, "TEND", 4)) return 0;
+	idxoffset = GetU64(tmp);
+	if (TraceFile_Seek(tr->fi, idxoffset)) return 0;
+	if (fread(tmp, 1, 8, tr->fi) != 8) return 0;
+	if (memcmp(tmp, "TIDX", 4)) return 0;
+	num = GetU32(tmp + 4);
+	for (i=0; i<num; i++) {
+		if (fread(tmp, 1, 16, tr->fi) != 16) return 0;
+		if (!AddIndex(tr, &alloc, GetU64(tmp), GetU64(tmp + 8))) return 0;
+	}
+	return 1;
+}
+
+// Rebuild index by walking the blocks
+static int ScanIndex(TTraceReader *tr)
+{
+	uint8_t hdr[24];
+	uint64_t offset = 12;
+	int alloc = 0;
+
+	tr->numblocks = 0;
+	for (;;) {
+		if (TraceFile_Seek(tr->fi, offset)) break;
+		if (fread(hdr, 1, 24, tr->fi) != 24) break;
+		if (memcmp(hdr, "TBLK", 4)) break;
+		if (!AddIndex(tr, &alloc, offset, GetU64(hdr + 4))) return 0;
+		offset += 24 + GetU32(hdr + 20);
+	}
+	return 1;
+}
+
+static int LoadBlock(TTraceReader *tr, int block)
+{
+	uint8_t hdr[24];
+	uint32_t rawsize, packedsize;
+	uLongf rawlen;
+
+	if ((block < 0) || (block >= tr->numblocks)) return 0;
+	if (TraceFile_Seek(tr->fi, tr->idxoffset[block])) return 0;
+	if (fread(hdr, 1, 24, tr->fi) != 24) return 0;
+	if (memcmp(hdr, "TBLK", 4)) return 0;
+	rawsize = GetU32(hdr + 16);
+	packedsize = GetU32(hdr + 20);
+	// Padding keeps a corrupted entry from reading past the buffer
+	if (rawsize + TRACEFILE_ENTRYMAX > (uint32_t)tr->rawalloc) {
+		uint8_t *nraw = (uint8_t *)realloc(tr->raw, rawsize + TRACEFILE_ENTRYMAX);
+		if (!nraw) return 0;
+		tr->raw = nraw;
+		tr->rawalloc = rawsize + TRACEFILE_ENTRYMAX;
+	}
+	if (packedsize > (uint32_t)tr->packedalloc) {
+		uint8_t *npacked = (uint8_t *)realloc(tr->packed, packedsize);
+		if (!npacked) return 0;
+		tr->packed = npacked;
+		tr->packedalloc = packedsize;
+	}
+	if (fread(tr->packed, 1, packedsize, tr->fi) != packedsize) return 0;
+	rawlen = rawsize;
+	if (uncompress(tr->raw, &rawlen, tr->packed, packedsize) != Z_OK) return 0;
+	memset(tr->raw + rawlen, 0, TRACEFILE_ENTRYMAX);
+	tr->block = block;
+	tr->rawsize = (int)rawlen;
+	tr->entries = GetU32(hdr + 12);
+	tr->pos = 0;
+	ResetState(&tr->state, GetU64(hdr + 4));
+	return 1;
+}
+
+// Decode next entry from current block
+static int DecodeEntry(TTraceReader *tr, TTraceEntry *entry)
+{
+	TTraceState *st = &tr->state;
+	const uint8_t *raw;
+	uint8_t head;
+	uint16_t mask;
+	uint32_t v;
+	int i;
+
+	while (!tr->entries || (tr->pos >= tr->rawsize)) {
+		if (!LoadBlock(tr, tr->block + 1)) return 0;
+	}
+	raw = tr->raw;
+
+	head = raw[tr->pos++];
+	entry->status = head >> TRACEHEAD_STATUS;
+	entry->oplen = head & TRACEHEAD_OPLEN;
+	entry->cycle = st->cycle;
+	entry->cycles = GetVarint(raw, &tr->pos, tr->rawsize);
+	entry->pc = st->nextpc;
+	if (head & TRACEHEAD_JUMP) {
+		entry->pc += UnZigZag(GetVarint(raw, &tr->pos, tr->rawsize));
+	}
+	if ((entry->oplen > 4) || (tr->pos + entry->oplen > tr->rawsize)) return 0;
+	for (i=0; i<entry->oplen; i++) entry->opcode[i] = raw[tr->pos++];
+	if (head & TRACEHEAD_REGS) {
+		mask = raw[tr->pos] | (raw[tr->pos+1] << 8);
+		tr->pos += 2;
+		for (i=0; i<TRACEREG_NUM; i++) {
+			if (mask & (1 << i)) st->regs[i] = raw[tr->pos++];
+		}
+	}
+	memcpy(entry->regs, st->regs, TRACEREG_NUM);
+	entry->numaccess = 0;
+	if (head & TRACEHEAD_ACCESS) {
+		entry->numaccess = raw[tr->pos++];
+		if (entry->numaccess > TRACEFILE_MAXACCESS) return 0;
+		for (i=0; i<entry->numaccess; i++) {
+			v = GetVarint(raw, &tr->pos, tr->rawsize);
+			st->lastaddr += UnZigZag(v >> 1);
+			entry->access[i].addr = st->lastaddr;
+			entry->access[i].write = v & 1;
+			entry->access[i].data = raw[tr->pos++];
+		}
+	}
+	if (tr->pos > tr->rawsize) return 0;
+
+	st->nextpc = entry->pc + entry->oplen;
+	st->cycle = entry->cycle + entry->cycles;
+	tr->entries--;
+
+	return 1;
+}
+
+TTraceReader *TraceReader_Open(const char *filename)
+{
+	TTraceReader *tr;
+	uint8_t hdr[12];
+
+	tr = (TTraceReader *)malloc(sizeof(TTraceReader));
+	if (!tr) return NULL;
+	memset(tr, 0, sizeof(TTraceReader));
+	tr->block = -1;
+	tr->fi = fopen(filename, "rb");
+	if (!tr->fi) {
+		free(tr);
+		return NULL;
+	}
+	if ((fread(hdr, 1, 12, tr->fi) != 12) || memcmp(hdr, "PMTRACE", 8) || (GetU32(hdr + 8) != TRACEFILE_VERSION)) {
+		fclose(tr->fi);
+		free(tr);
+		return NULL;
+	}
+	if (!ReadIndex(tr)) {
+		if (!ScanIndex(tr)) {
+			TraceReader_Close(tr);
+			return NULL;
+		}
+	}
+	return tr;
+}
+
+int TraceReader_NumBlocks(TTraceReader *tr)
+{
+	return tr->numblocks;
+}
+
+uint64_t TraceReader_BlockCycle(TTraceReader *tr, int block)
+{
+	if ((block < 0) || (block >= tr->numblocks)) return 0;
+	return tr->idxcycle[block];
+}
+
+int TraceReader_SeekCycle(TTraceReader *tr, uint64_t cycle)
+{
+	int lo = 0, hi = tr->numblocks - 1, mid;
+
+	tr->haspending = 0;
+	if (!tr->numblocks) return 0;
+
+	// Last block starting at or before the cycle
+	while (lo < hi) {
+		mid = (lo + hi + 1) >> 1;
+		if (tr->idxcycle[mid] <= cycle) lo = mid;
+		else hi = mid - 1;
+	}
+	if (!LoadBlock(tr, lo)) return 0;
+
+	// Walk until the entry that covers the cycle
+	while (DecodeEntry(tr, &tr->pending)) {
+		if (tr->pending.cycle + tr->pending.cycles > cycle) {
+			tr->haspending = 1;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int TraceReader_Next(TTraceReader *tr, TTraceEntry *entry)
+{
+	if (tr->haspending) {
+		memcpy(entry, &tr->pending, sizeof(TTraceEntry));
+		tr->haspending = 0;
+		return 1;
+	}
+	return DecodeEntry(tr, entry);
+}
+
+void TraceReader_Close(TTraceReader *tr)
+{
+	if (!tr) return;
+	if (tr->fi) fclose(tr->fi);
+	free(tr->idxoffset);
+	free(tr->idxcycle);
+	free(tr->raw);
+	free(tr->packed);
+	free(tr);
+}
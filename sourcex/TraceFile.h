@@ -0,0 +1,104 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACEFILE_H
+#define TRACEFILE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Execution trace file (.pmtrace)
+//
+// Header: "PMTRACE\0", u32 version
+// Blocks: "TBLK", u64 start cycle, u32 entries, u32 raw size, u32 packed size, zlib data
+// Index:  "TIDX", u32 blocks, (u64 offset, u64 start cycle) per block
+// Footer: u64 index offset, "TEND"
+//
+// All values are little-endian. Each block is encoded from a clean state
+// so the reader can start at any block, the index is optional and rebuilt
+// by scanning the blocks if the trace wasn't closed properly.
+
+#define TRACEFILE_VERSION	1
+#define TRACEFILE_MAXACCESS	32
+
+// Registers stored in the entry, in this order
+enum {
+	TRACEREG_A, TRACEREG_B,
+	TRACEREG_L, TRACEREG_H, TRACEREG_I,
+	TRACEREG_XL, TRACEREG_XH, TRACEREG_XI,
+	TRACEREG_YL, TRACEREG_YH, TRACEREG_YI,
+	TRACEREG_SPL, TRACEREG_SPH,
+	TRACEREG_N, TRACEREG_F, TRACEREG_U,
+	TRACEREG_NUM
+};
+
+typedef struct {
+	uint32_t addr;			// Address
+	uint8_t data;			// Data read or written
+	uint8_t write;			// 1 = Write, 0 = Read
+} TTraceAccess;
+
+typedef struct {
+	uint64_t cycle;			// Cycle stamp before execution
+	uint32_t cycles;		// Cycles taken
+	uint32_t pc;			// Physical PC
+	uint8_t status;			// CPU status before execution (MINX_STATUS_*)
+	uint8_t oplen;			// Opcode length, 0 for IRQ, HALT/STOP or PRC stall
+	uint8_t opcode[4];		// Opcode bytes
+	uint8_t regs[TRACEREG_NUM];	// Registers after execution
+	int numaccess;			// Number of memory accesses (excluding opcode fetch)
+	TTraceAccess access[TRACEFILE_MAXACCESS];
+} TTraceEntry;
+
+typedef struct TTraceWriter TTraceWriter;
+typedef struct TTraceReader TTraceReader;
+
+// Create trace file, return NULL on failure
+TTraceWriter *TraceWriter_Open(const char *filename);
+
+// Append entry, return 0 on failure
+int TraceWriter_Add(TTraceWriter *tw, const TTraceEntry *entry);
+
+// Flush remaining data and close, return 0 on failure
+int TraceWriter_Close(TTraceWriter *tw);
+
+// Open trace file, return NULL on failure
+TTraceReader *TraceReader_Open(const char *filename);
+
+// Number of blocks and cycle stamp at the start of a block
+int TraceReader_NumBlocks(TTraceReader *tr);
+uint64_t TraceReader_BlockCycle(TTraceReader *tr, int block);
+
+// Seek to the entry executing at the specified cycle, return 0 if out of range
+int TraceReader_SeekCycle(TTraceReader *tr, uint64_t cycle);
+
+// Read next entry, return 0 at the end of trace
+int TraceReader_Next(TTraceReader *tr, TTraceEntry *entry);
+
+// Close trace file
+void TraceReader_Close(TTraceReader *tr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,178 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "WatchPoints.h"
+
+uint32_t WatchPoints_Summary[WATCHPOINTS_PAGES / 32];
+int WatchPoints_Count = 0;
+
+static uint8_t *WatchPoints_Flags = NULL;		// Per address, allocated on first use
+static uint16_t WatchPoints_PageCount[WATCHPOINTS_PAGES];	// Single watchpoints per page
+static TWatchRange WatchPoints_Ranges[WATCHPOINTS_MAXRANGES];
+static int WatchPoints_NRanges = 0;
+
+// Recalculate summary bit of a page
+static void WatchPoints_UpdatePage(uint32_t page)
+{
+	uint32_t first = page << WATCHPOINTS_PAGEBITS;
+	uint32_t last = first + (1 << WATCHPOINTS_PAGEBITS) - 1;
+	int i, used = WatchPoints_PageCount[page] > 0;
+
+	for (i=0; (i<WatchPoints_NRanges) && !used; i++) {
+		if ((WatchPoints_Ranges[i].start <= last) && (WatchPoints_Ranges[i].end >= first)) used = 1;
+	}
+	if (used) WatchPoints_Summary[page >> 5] |= (1u << (page & 31));
+	else WatchPoints_Summary[page >> 5] &= ~(1u << (page & 31));
+}
+
+// Recalculate summary bits of pages covered by a range
+static void WatchPoints_UpdateRange(uint32_t start, uint32_t end)
+{
+	uint32_t page;
+	for (page = start >> WATCHPOINTS_PAGEBITS; page <= (end >> WATCHPOINTS_PAGEBITS); page++) {
+		WatchPoints_UpdatePage(page);
+	}
+}
+
+void WatchPoints_Free(void)
+{
+	if (WatchPoints_Flags) {
+		free(WatchPoints_Flags);
+		WatchPoints_Flags = NULL;
+	}
+	WatchPoints_ClearAll();
+}
+
+int WatchPoints_Get(uint32_t addr)
+{
+	if (!WatchPoints_Flags) return 0;
+	return WatchPoints_Flags[addr & WATCHPOINTS_MASK];
+}
+
+int WatchPoints_Covered(uint32_t addr)
+{
+	int i, flags = WatchPoints_Get(addr);
+
+	addr &= WATCHPOINTS_MASK;
+	for (i=0; i<WatchPoints_NRanges; i++) {
+		if ((addr >= WatchPoints_Ranges[i].start) && (addr <= WatchPoints_Ranges[i].end)) flags |= WatchPoints_Ranges[i].flags;
+	}
+	return flags;
+}
+
+int WatchPoints_Set(uint32_t addr, int flags)
+{
+	uint32_t page;
+	int old;
+
+	addr &= WATCHPOINTS_MASK;
+	flags &= WATCHPOINT_RW;
+	if (!WatchPoints_Flags) {
+		if (!flags) return 1;
+		WatchPoints_Flags = (uint8_t *)malloc(WATCHPOINTS_SIZE);
+		if (!WatchPoints_Flags) return 0;
+		memset(WatchPoints_Flags, 0, WATCHPOINTS_SIZE);
+	}
+	old = WatchPoints_Flags[addr];
+	if (old == flags) return 1;
+	WatchPoints_Flags[addr] = (uint8_t)flags;
+
+	// Update counters and summary only when the address changes state
+	if (!old == !flags) return 1;
+	page = addr >> WATCHPOINTS_PAGEBITS;
+	if (flags) {
+		WatchPoints_PageCount[page]++;
+		WatchPoints_Count++;
+	} else {
+		WatchPoints_PageCount[page]--;
+		WatchPoints_Count--;
+	}
+	WatchPoints_UpdatePage(page);
+	return 1;
+}
+
+void WatchPoints_ClearAll(void)
+{
+	if (WatchPoints_Flags) memset(WatchPoints_Flags, 0, WATCHPOINTS_SIZE);
+	memset(WatchPoints_PageCount, 0, sizeof(WatchPoints_PageCount));
+	memset(WatchPoints_Summary, 0, sizeof(WatchPoints_Summary));
+	WatchPoints_NRanges = 0;
+	WatchPoints_Count = 0;
+}
+
+int WatchPoints_AddRange(uint32_t start, uint32_t end, int flags, int value)
+{
+	TWatchRange *range;
+
+	start &= WATCHPOINTS_MASK;
+	end &= WATCHPOINTS_MASK;
+	flags &= WATCHPOINT_RW;
+	if ((start > end) || !flags || (value > 255)) return 0;
+	if (WatchPoints_NRanges >= WATCHPOINTS_MAXRANGES) return 0;
+	range = &WatchPoints_Ranges[WatchPoints_NRanges++];
+	range->start = start;
+	range->end = end;
+	range->flags = flags;
+	range->value = (value < 0) ? -1 : value;
+	WatchPoints_Count++;
+	WatchPoints_UpdateRange(start, end);
+	return 1;
+}
+
+int WatchPoints_RemoveRange(int index)
+{
+	TWatchRange range;
+
+	if ((index < 0) || (index >= WatchPoints_NRanges)) return 0;
+	range = WatchPoints_Ranges[index];
+	WatchPoints_NRanges--;
+	memmove(&WatchPoints_Ranges[index], &WatchPoints_Ranges[index+1], (WatchPoints_NRanges - index) * sizeof(TWatchRange));
+	WatchPoints_Count--;
+	WatchPoints_UpdateRange(range.start, range.end);
+	return 1;
+}
+
+int WatchPoints_NumRanges(void)
+{
+	return WatchPoints_NRanges;
+}
+
+const TWatchRange *WatchPoints_GetRange(int index)
+{
+	if ((index < 0) || (index >= WatchPoints_NRanges)) return NULL;
+	return &WatchPoints_Ranges[index];
+}
+
+int WatchPoints_Hit(uint32_t addr, int access, uint8_t data)
+{
+	TWatchRange *range;
+	int i;
+
+	addr &= WATCHPOINTS_MASK;
+	if (WatchPoints_Flags && (WatchPoints_Flags[addr] & access)) return 1;
+	for (i=0; i<WatchPoints_NRanges; i++) {
+		range = &WatchPoints_Ranges[i];
+		if ((addr < range->start) || (addr > range->end)) continue;
+		if (!(range->flags & access)) continue;
+		if ((range->value >= 0) && (range->value != data)) continue;
+		return 1;
+	}
+	return 0;
+}
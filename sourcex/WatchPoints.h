@@ -0,0 +1,93 @@
+/*
+  PokeMini - Pokmon-Mini Emulator
+  Copyright (C) 2009-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef WATCHPOINTS_H
+#define WATCHPOINTS_H
+
+#include <stdint.h>
+
+// Watchpoints
+//
+// Covers the whole 21-bit physical address space, RAM and I/O don't alias
+// with the cartridge. Each 256 bytes page has a bit in the summary that is
+// set when any single or range watchpoint touches it, the access handlers
+// only test that bit so nothing else is checked until a watch is set.
+
+#define WATCHPOINTS_SIZE	0x200000
+#define WATCHPOINTS_MASK	0x1FFFFF
+#define WATCHPOINTS_PAGEBITS	8
+#define WATCHPOINTS_PAGES	(WATCHPOINTS_SIZE >> WATCHPOINTS_PAGEBITS)
+#define WATCHPOINTS_MAXRANGES	32
+
+// Access flags, same values as TRAPPOINT_WATCH*
+enum {
+	WATCHPOINT_READ  = 2,		// Read access
+	WATCHPOINT_WRITE = 4,		// Write access
+	WATCHPOINT_RW    = 6		// Read & Write access
+};
+
+typedef struct {
+	uint32_t start;			// First address
+	uint32_t end;			// Last address (inclusive)
+	int flags;			// WATCHPOINT_*
+	int value;			// Data to match, -1 for any
+} TWatchRange;
+
+// Page summary, 1 bit per page
+extern uint32_t WatchPoints_Summary[WATCHPOINTS_PAGES / 32];
+
+// Number of single watchpoints and ranges, 0 when none are set
+extern int WatchPoints_Count;
+
+// Free resources and remove all watchpoints
+void WatchPoints_Free(void);
+
+// Get watch flags at address
+int WatchPoints_Get(uint32_t addr);
+
+// Set watch flags at address, 0 removes, return 0 on failure
+int WatchPoints_Set(uint32_t addr, int flags);
+
+// Get watch flags at address including ranges
+int WatchPoints_Covered(uint32_t addr);
+
+// Remove all single watchpoints and ranges
+void WatchPoints_ClearAll(void);
+
+// Add range watchpoint, value is -1 for any data, return 0 on failure
+int WatchPoints_AddRange(uint32_t start, uint32_t end, int flags, int value);
+
+// Remove range watchpoint, return 0 if index is invalid
+int WatchPoints_RemoveRange(int index);
+
+// Number of range watchpoints and range at index (NULL if invalid)
+int WatchPoints_NumRanges(void);
+const TWatchRange *WatchPoints_GetRange(int index);
+
+// Test access in a marked page, return 1 if it trigger
+int WatchPoints_Hit(uint32_t addr, int access, uint8_t data);
+
+// Test access, return 1 if it trigger
+static inline int WatchPoints_Test(uint32_t addr, int access, uint8_t data)
+{
+	addr &= WATCHPOINTS_MASK;
+	if (!(WatchPoints_Summary[addr >> (WATCHPOINTS_PAGEBITS + 5)] & (1u << ((addr >> WATCHPOINTS_PAGEBITS) & 31)))) return 0;
+	return WatchPoints_Hit(addr, access, data);
+}
+
+#endif
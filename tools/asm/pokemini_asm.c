@@ -0,0 +1,135 @@
+/*
+  PokeMini Assembler
+  Copyright (C) 2011-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "PMCommon.h"
+#include "InstructionProc.h"
+#include "Assembler.h"
+
+#define VERSION_STR	"v1.0"
+
+#define MAXROMSIZE	0x200000
+
+// ---------- Configs ----------
+
+typedef struct {
+	char source_f[PMTMPV];	// Source file
+	char output_f[PMTMPV];	// Output file
+	uint32_t size;		// Minimum output size
+	int fill;		// Fill byte
+} TConfs;
+
+TConfs confs;
+
+void init_confs()
+{
+	memset(&confs, 0, sizeof(TConfs));
+	confs.fill = 0xFF;
+}
+
+int load_confs_args(int argc, char **argv)
+{
+	argv++;
+	while (*argv) {
+		if (*argv[0] == '-') {
+			if (!strcasecmp(*argv, "-o")) { if (*++argv) strncpy(confs.output_f, *argv, PMTMPV-1); }
+			else if (!strcasecmp(*argv, "-size")) { if (*++argv) confs.size = strtoul(*argv, NULL, 0); }
+			else if (!strcasecmp(*argv, "-fill")) { if (*++argv) confs.fill = strtoul(*argv, NULL, 0) & 0xFF; }
+			else return 0;
+		} else {
+			strncpy(confs.source_f, *argv, PMTMPV-1);
+		}
+		argv++;
+	}
+	if (confs.size > MAXROMSIZE) confs.size = MAXROMSIZE;
+	return (confs.source_f[0] != 0);
+}
+
+// ---------- Output ----------
+
+static uint8_t *ROM = NULL;
+static uint32_t ROMSize = 0;
+
+static int WriteCB(uint32_t addr, uint8_t *data, int size)
+{
+	if ((addr + size) > MAXROMSIZE) return 0;
+	memcpy(ROM + addr, data, size);
+	if ((addr + size) > ROMSize) ROMSize = addr + size;
+	return 1;
+}
+
+static void ErrorCB(int line, const char *msg)
+{
+	if (line) fprintf(stderr, "%s:%i: %s\n", confs.source_f, line, msg);
+	else fprintf(stderr, "%s: %s\n", confs.source_f, msg);
+}
+
+int main(int argc, char **argv)
+{
+	FILE *fo;
+
+	// Read from command line
+	init_confs();
+	if (!load_confs_args(argc, argv)) {
+		printf("PokeMini Assembler " VERSION_STR "\n\n");
+		printf("Usage: pokemini_asm [options] source.asm\n\n");
+		printf("  -o rom.min          Output file (def: source with .min)\n");
+		printf("  -size 0             Minimum output size\n");
+		printf("  -fill 0xFF          Fill unused bytes\n");
+		return 1;
+	}
+	if (!confs.output_f[0]) {
+		strcpy(confs.output_f, confs.source_f);
+		RemoveExtension(confs.output_f);
+		strcat(confs.output_f, ".min");
+	}
+
+	ROM = (uint8_t *)malloc(MAXROMSIZE);
+	if (!ROM) {
+		fprintf(stderr, "Error: Not enough memory\n");
+		return 1;
+	}
+	memset(ROM, confs.fill, MAXROMSIZE);
+
+	if (!Assembler_File(confs.source_f, WriteCB, ErrorCB, &DefaultSOpcDec)) {
+		free(ROM);
+		return 1;
+	}
+	if (ROMSize < confs.size) ROMSize = confs.size;
+
+	fo = fopen(confs.output_f, "wb");
+	if (!fo) {
+		fprintf(stderr, "Error: Couldn't create '%s'\n", confs.output_f);
+		free(ROM);
+		return 1;
+	}
+	if (fwrite(ROM, 1, ROMSize, fo) != ROMSize) {
+		fprintf(stderr, "Error: Couldn't write '%s'\n", confs.output_f);
+		fclose(fo);
+		free(ROM);
+		return 1;
+	}
+	fclose(fo);
+	printf("%u bytes written to '%s'\n", (unsigned int)ROMSize, confs.output_f);
+
+	free(ROM);
+	return 0;
+}
@@ -0,0 +1,333 @@
+/*
+  PokeMini Disassembler
+  Copyright (C) 2011-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "PMCommon.h"
+#include "InstructionProc.h"
+#include "CodeMap.h"
+#include "freebios.h"
+
+#define VERSION_STR	"v1.0"
+
+#define MAXENTRIES	64
+
+// ---------- Configs ----------
+
+typedef struct {
+	char rom_f[PMTMPV];	// ROM file
+	char bios_f[PMTMPV];	// BIOS file, empty for FreeBIOS
+	int bios;		// Analyze BIOS vectors
+	uint32_t start;		// Start address
+	uint32_t end;		// End address, 0 for end of ROM
+	int data;		// Show data
+	int xref;		// Show references
+	int info;		// Show statistics only
+	int source;		// Assembler source, without address and bytes
+	uint32_t entry[MAXENTRIES];	// Extra entry points
+	int numentries;
+} TConfs;
+
+TConfs confs;
+
+void init_confs()
+{
+	memset(&confs, 0, sizeof(TConfs));
+	confs.bios = 1;
+	confs.data = 1;
+	confs.xref = 1;
+}
+
+int load_confs_args(int argc, char **argv)
+{
+	argv++;
+	while (*argv) {
+		if (*argv[0] == '-') {
+			if (!strcasecmp(*argv, "-bios")) { if (*++argv) strncpy(confs.bios_f, *argv, PMTMPV-1); }
+			else if (!strcasecmp(*argv, "-nobios")) confs.bios = 0;
+			else if (!strcasecmp(*argv, "-e")) { if (*++argv) { if (confs.numentries < MAXENTRIES) confs.entry[confs.numentries++] = strtoul(*argv, NULL, 0); } }
+			else if (!strcasecmp(*argv, "-entry")) { if (*++argv) { if (confs.numentries < MAXENTRIES) confs.entry[confs.numentries++] = strtoul(*argv, NULL, 0); } }
+			else if (!strcasecmp(*argv, "-s")) { if (*++argv) confs.start = strtoul(*argv, NULL, 0); }
+			else if (!strcasecmp(*argv, "-start")) { if (*++argv) confs.start = strtoul(*argv, NULL, 0); }
+			else if (!strcasecmp(*argv, "-end")) { if (*++argv) confs.end = strtoul(*argv, NULL, 0); }
+			else if (!strcasecmp(*argv, "-nodata")) confs.data = 0;
+			else if (!strcasecmp(*argv, "-data")) confs.data = 1;
+			else if (!strcasecmp(*argv, "-noxref")) confs.xref = 0;
+			else if (!strcasecmp(*argv, "-xref")) confs.xref = 1;
+			else if (!strcasecmp(*argv, "-info")) confs.info = 1;
+			else if (!strcasecmp(*argv, "-source")) confs.source = 1;
+			else return 0;
+		} else {
+			strncpy(confs.rom_f, *argv, PMTMPV-1);
+		}
+		argv++;
+	}
+	return (confs.rom_f[0] != 0);
+}
+
+// ---------- Memory ----------
+
+static uint8_t *ROM = NULL;
+static uint32_t ROMSize = 0;
+static uint8_t BIOS[4096];
+
+static uint8_t ReadCB(int cpu, uint32_t addr)
+{
+	if (addr < 0x1000) return BIOS[addr];
+	if (addr < ROMSize) return ROM[addr];
+	return 0xFF;
+}
+
+int load_rom(const char *filename)
+{
+	FILE *fi;
+	long size;
+
+	fi = fopen(filename, "rb");
+	if (!fi) return 0;
+	fseek(fi, 0, SEEK_END);
+	size = ftell(fi);
+	fseek(fi, 0, SEEK_SET);
+	if ((size <= 0) || (size > 0x200000)) {
+		fclose(fi);
+		return 0;
+	}
+	ROMSize = 0x2000;
+	while (ROMSize < (uint32_t)size) ROMSize <<= 1;
+	ROM = (uint8_t *)malloc(ROMSize);
+	if (!ROM) {
+		fclose(fi);
+		return 0;
+	}
+	memset(ROM, 0xFF, ROMSize);
+	if (fread(ROM, 1, size, fi) != (size_t)size) {
+		fclose(fi);
+		return 0;
+	}
+	fclose(fi);
+	return 1;
+}
+
+int load_bios(const char *filename)
+{
+	FILE *fi;
+	if (!filename[0]) {
+		memcpy(BIOS, FreeBIOS, 4096);
+		return 1;
+	}
+	fi = fopen(filename, "rb");
+	if (!fi) return 0;
+	if (fread(BIOS, 1, 4096, fi) != 4096) {
+		fclose(fi);
+		return 0;
+	}
+	fclose(fi);
+	return 1;
+}
+
+// ---------- Disassembly ----------
+
+static TCodeMap *CM = NULL;
+
+// Label of an address, NULL if there's none
+const char *get_label(uint32_t addr)
+{
+	static char label[32];
+	TCodeMapXRef *xref;
+	int i, num;
+
+	if (!CodeMap_IsStart(CM, addr)) return NULL;
+	num = CodeMap_XRefsTo(CM, addr, &xref);
+	if (!num) return NULL;
+	for (i=0; i<num; i++) {
+		if (xref[i].type != CODEMAP_XREF_JUMP) break;
+	}
+	sprintf(label, "%s_%06X", (i < num) ? "SUB" : "LBL", (unsigned int)addr);
+	return label;
+}
+
+// Operand decoder with labels
+int LabelOperandNumberDec(char *sout, char type, uint32_t addr, int value)
+{
+	const char *label;
+	if ((type == 'j') || (type == 'J') || (type == 'h')) {
+		label = get_label(value);
+		if (label) {
+			strcpy(sout, label);
+			return 1;
+		}
+	}
+	return DefaultOperandNumberDec(sout, type, addr, value);
+}
+
+TSOpcDec LabelSOpcDec = {
+	LabelOperandNumberDec,		// Operand number decode
+	DefaultOperandNumberEnc,	// Operand number encode
+	DebugCPUInstructions_Opcode,	// Opcode dictionary
+	DebugCPUInstructions_Operand,	// Operand dictionary
+	"",				// Opcode pre-text
+	" ",				// Opcode post-text
+	", "				// Operand separator
+};
+
+static const char *XRefType = "JCV";
+static uint32_t SourceAddr = 0xFFFFFFFF;
+
+// Source only, set origin when the address doesn't follow the last line
+void print_org(uint32_t addr)
+{
+	if (!confs.source || (addr == SourceAddr)) return;
+	printf("\n\t.ORG $%06X\n", (unsigned int)addr);
+	SourceAddr = addr;
+}
+
+void print_line(uint32_t addr, InstructionInfo *opcode, uint8_t *data, int size)
+{
+	char opcodename[PMTMPV];
+	int i;
+
+	DisasmSingleOpcode(opcode, addr, data, opcodename, &LabelSOpcDec);
+	if (confs.source) {
+		printf("\t%s\n", opcodename);
+		SourceAddr = addr + size;
+		return;
+	}
+	printf("$%06X  ", (unsigned int)addr);
+	for (i=0; i<4; i++) {
+		if (i < size) printf("%02X ", data[i]);
+		else printf("   ");
+	}
+	printf(" %s\n", opcodename);
+}
+
+void disasm_range(uint32_t start, uint32_t end)
+{
+	TCodeMapXRef *xref;
+	InstructionInfo *opcode;
+	uint8_t data[4];
+	const char *label;
+	uint32_t addr;
+	int i, size, num;
+
+	addr = start;
+	while (addr < end) {
+		if (CodeMap_IsCode(CM, addr)) {
+			// Instruction, with label and references
+			print_org(addr);
+			label = get_label(addr);
+			if (label) {
+				printf("\n%s:", label);
+				if (confs.xref) {
+					num = CodeMap_XRefsTo(CM, addr, &xref);
+					printf("\t\t\t;");
+					for (i=0; i<num; i++) {
+						printf(" %c$%06X", XRefType[xref[i].type], (unsigned int)xref[i].from);
+					}
+				}
+				printf("\n");
+			}
+			opcode = CodeMap_GetInstruction(CM, ReadCB, addr, data, &size);
+			print_line(addr, opcode, data, size);
+			addr += size;
+		} else {
+			// Data, up to 4 bytes per line
+			for (size=1; size<4; size++) {
+				if (((addr + size) >= end) || CodeMap_IsCode(CM, addr + size)) break;
+				if (!((addr + size) & 3)) break;
+			}
+			if (confs.data) {
+				print_org(addr);
+				for (i=0; i<size; i++) data[i] = ReadCB(0, addr + i);
+				print_line(addr, &DebugCPUInstructions_DX[size-1], data, size);
+			}
+			addr += size;
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t addr, codesize;
+	int i;
+
+	// Read from command line
+	init_confs();
+	if (!load_confs_args(argc, argv)) {
+		printf("PokeMini Disassembler " VERSION_STR "\n\n");
+		printf("Usage: pokemini_disasm [options] rom.min\n\n");
+		printf("  -bios bios.min      Use BIOS file (def: FreeBIOS)\n");
+		printf("  -nobios             Don't follow BIOS vectors\n");
+		printf("  -e 0x2102           Add entry point, up to %i\n", MAXENTRIES);
+		printf("  -s 0                Start address\n");
+		printf("  -end 0              End address, 0 for end of ROM (def)\n");
+		printf("  -nodata             Don't show data\n");
+		printf("  -data               Show data (def)\n");
+		printf("  -noxref             Don't show references\n");
+		printf("  -xref               Show references (def)\n");
+		printf("  -info               Show statistics and exit\n");
+		printf("  -source             Output for pokemini_asm, no address and bytes\n");
+		return 1;
+	}
+
+	if (!load_bios(confs.bios_f)) {
+		fprintf(stderr, "Error: Couldn't load BIOS '%s'\n", confs.bios_f);
+		return 1;
+	}
+	if (!load_rom(confs.rom_f)) {
+		fprintf(stderr, "Error: Couldn't load ROM '%s'\n", confs.rom_f);
+		return 1;
+	}
+
+	// Analyze
+	CM = CodeMap_Create(ROMSize);
+	if (!CM || !CodeMap_Analyze(CM, ReadCB, confs.bios)) {
+		fprintf(stderr, "Error: Not enough memory\n");
+		return 1;
+	}
+	for (i=0; i<confs.numentries; i++) {
+		if (!CodeMap_AddEntry(CM, ReadCB, confs.entry[i])) {
+			fprintf(stderr, "Error: Not enough memory\n");
+			return 1;
+		}
+	}
+
+	if (confs.info) {
+		codesize = 0;
+		for (addr=0x2100; addr<ROMSize; addr++) {
+			if (CodeMap_IsCode(CM, addr)) codesize++;
+		}
+		printf("ROM size: %u bytes\n", (unsigned int)ROMSize);
+		printf("Instructions: %i\n", CM->instructions);
+		printf("Code bytes in cartridge: %u\n", (unsigned int)codesize);
+		printf("References: %i\n", CM->numxref);
+		CodeMap_Destroy(CM);
+		free(ROM);
+		return 0;
+	}
+
+	if (!confs.end || (confs.end > ROMSize)) confs.end = ROMSize;
+	printf("; %s\n", confs.rom_f);
+	printf("; %i instructions, %i references\n", CM->instructions, CM->numxref);
+	disasm_range(CodeMap_Align(CM, confs.start), confs.end);
+
+	CodeMap_Destroy(CM);
+	free(ROM);
+	return 0;
+}
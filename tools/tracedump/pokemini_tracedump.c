@@ -0,0 +1,169 @@
+/*
+  PokeMini Trace Dump
+  Copyright (C) 2011-2015  JustBurn
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "PMCommon.h"
+#include "InstructionProc.h"
+#include "TraceFile.h"
+
+#define VERSION_STR	"v1.0"
+
+// ---------- Configs ----------
+
+typedef struct {
+	char trace_f[PMTMPV];	// Trace file
+	uint64_t cycle;		// Start cycle
+	int seek;		// Seek to start cycle
+	long count;		// Number of entries, -1 for all
+	int regs;		// Show registers
+	int access;		// Show memory accesses
+	int info;		// Show blocks only
+} TConfs;
+
+TConfs confs;
+
+void init_confs()
+{
+	memset(&confs, 0, sizeof(TConfs));
+	confs.count = -1;
+	confs.regs = 1;
+	confs.access = 1;
+}
+
+int load_confs_args(int argc, char **argv)
+{
+	argv++;
+	while (*argv) {
+		if (*argv[0] == '-') {
+			if (!strcasecmp(*argv, "-c")) { if (*++argv) { confs.cycle = strtoull(*argv, NULL, 0); confs.seek = 1; } }
+			else if (!strcasecmp(*argv, "-cycle")) { if (*++argv) { confs.cycle = strtoull(*argv, NULL, 0); confs.seek = 1; } }
+			else if (!strcasecmp(*argv, "-n")) { if (*++argv) confs.count = atol(*argv); }
+			else if (!strcasecmp(*argv, "-count")) { if (*++argv) confs.count = atol(*argv); }
+			else if (!strcasecmp(*argv, "-noregs")) confs.regs = 0;
+			else if (!strcasecmp(*argv, "-regs")) confs.regs = 1;
+			else if (!strcasecmp(*argv, "-nomem")) confs.access = 0;
+			else if (!strcasecmp(*argv, "-mem")) confs.access = 1;
+			else if (!strcasecmp(*argv, "-info")) confs.info = 1;
+			else return 0;
+		} else {
+			strncpy(confs.trace_f, *argv, PMTMPV-1);
+		}
+		argv++;
+	}
+	return (confs.trace_f[0] != 0);
+}
+
+// ---------- Dump ----------
+
+static TTraceEntry *DumpEntry;
+
+static uint8_t DumpReadCB(int cpu, uint32_t addr)
+{
+	uint32_t offset = addr - DumpEntry->pc;
+	if (offset < DumpEntry->oplen) return DumpEntry->opcode[offset];
+	return 0x00;
+}
+
+void dump_entry(TTraceEntry *entry)
+{
+	const uint8_t *r = entry->regs;
+	char opcodename[PMTMPV];
+	InstructionInfo *opcode;
+	int i;
+
+	DumpEntry = entry;
+	if (entry->oplen) {
+		opcode = GetInstructionInfo(DumpReadCB, 0, entry->pc, NULL, NULL);
+		DisasmSingleOpcode(opcode, entry->pc, entry->opcode, opcodename, &DefaultSOpcDec);
+	} else if (entry->status == 3) strcpy(opcodename, "(IRQ)");
+	else if (entry->status == 2) strcpy(opcodename, "(STOP)");
+	else if (entry->status == 1) strcpy(opcodename, "(HALT)");
+	else strcpy(opcodename, "(STALL)");
+
+	printf("%12llu %3u $%06X  ", (unsigned long long)entry->cycle, (unsigned int)entry->cycles, (unsigned int)entry->pc);
+	for (i=0; i<4; i++) {
+		if (i < entry->oplen) printf("%02X ", entry->opcode[i]);
+		else printf("   ");
+	}
+	printf(" %-20s", opcodename);
+	if (confs.regs) {
+		printf(" BA=%02X%02X HL=%02X%02X%02X X=%02X%02X%02X Y=%02X%02X%02X SP=%02X%02X N=%02X F=%02X U=%02X",
+			r[TRACEREG_B], r[TRACEREG_A], r[TRACEREG_I], r[TRACEREG_H], r[TRACEREG_L],
+			r[TRACEREG_XI], r[TRACEREG_XH], r[TRACEREG_XL], r[TRACEREG_YI], r[TRACEREG_YH], r[TRACEREG_YL],
+			r[TRACEREG_SPH], r[TRACEREG_SPL], r[TRACEREG_N], r[TRACEREG_F], r[TRACEREG_U]);
+	}
+	if (confs.access) {
+		for (i=0; i<entry->numaccess; i++) {
+			printf(" %c$%06X=%02X", entry->access[i].write ? 'W' : 'R', (unsigned int)entry->access[i].addr, entry->access[i].data);
+		}
+	}
+	printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+	TTraceReader *tr;
+	TTraceEntry entry;
+	int i;
+
+	// Read from command line
+	init_confs();
+	if (!load_confs_args(argc, argv)) {
+		printf("PokeMini Trace Dump " VERSION_STR "\n\n");
+		printf("Usage: pokemini_tracedump [options] trace.pmtrace\n\n");
+		printf("  -c 0                Start at cycle\n");
+		printf("  -n -1               Number of instructions, -1 for all (def)\n");
+		printf("  -noregs             Don't show registers\n");
+		printf("  -regs               Show registers (def)\n");
+		printf("  -nomem              Don't show memory accesses\n");
+		printf("  -mem                Show memory accesses (def)\n");
+		printf("  -info               Show blocks and exit\n");
+		return 1;
+	}
+
+	tr = TraceReader_Open(confs.trace_f);
+	if (!tr) {
+		fprintf(stderr, "Error: Couldn't open trace '%s'\n", confs.trace_f);
+		return 1;
+	}
+
+	if (confs.info) {
+		printf("%i blocks\n", TraceReader_NumBlocks(tr));
+		for (i=0; i<TraceReader_NumBlocks(tr); i++) {
+			printf("Block %i at cycle %llu\n", i, (unsigned long long)TraceReader_BlockCycle(tr, i));
+		}
+		TraceReader_Close(tr);
+		return 0;
+	}
+
+	if (confs.seek && !TraceReader_SeekCycle(tr, confs.cycle)) {
+		fprintf(stderr, "Error: Cycle %llu out of range\n", (unsigned long long)confs.cycle);
+		TraceReader_Close(tr);
+		return 1;
+	}
+	while (confs.count && TraceReader_Next(tr, &entry)) {
+		dump_entry(&entry);
+		if (confs.count > 0) confs.count--;
+	}
+
+	TraceReader_Close(tr);
+	return 0;
+}